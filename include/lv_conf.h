@@ -327,7 +327,14 @@
 #define LV_ATTRIBUTE_TIMER_HANDLER
 
 /*Define a custom attribute to `lv_disp_flush_ready` function*/
+/*DMA 写屏完成中断中调用（见 LVGL_Driver.cpp 的 Lvgl_FlushDone），须放在 IRAM：
+ *闪存操作期间 cache 关闭，中断仍可能执行*/
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define LV_ATTRIBUTE_FLUSH_READY IRAM_ATTR
+#else
 #define LV_ATTRIBUTE_FLUSH_READY
+#endif
 
 /*Required alignment size for buffers*/
 #define LV_ATTRIBUTE_MEM_ALIGN_SIZE 1
@@ -1,12 +1,50 @@
 #include "Display_ST7789.h"
+#include "Vsync_Pacer.h"
+#include <esp_heap_caps.h>
+#if LCD_BACKEND == LCD_BACKEND_DMA
+#include <driver/spi_master.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_memory_utils.h>
+#include <esp_timer.h>
+#include <esp_idf_version.h>
+#endif
    
 SPIClass LCDspi(FSPI);
+
+// 像素数据传输统计：同一时间只有一方在发送（同步绘制前须 LCD_Async_WaitAll），
+// bytes / busyUs 不会被并发写（DMA 后端只在完成回调中写）；waitUs 只由生产者写
+static LCD_TransferStats transferStats = { 0, 0, 0, 0, 0 };
+static TaskHandle_t asyncTask = NULL;
+static uint8_t orientation = 0x00;      // 当前 MADCTL（不含颜色顺序位）
+static bool dmaReady = false;           // DMA 后端初始化成功；false 时使用 Arduino SPI
+static LCD_BenchResult lastBench = { false };
+
+// 控制器当前的写入窗口：同一列范围内上下相接的绘制不再重新设置窗口，接着写显存即可。
+// 窗口的结束行总是设到屏幕底部，winPos 为窗口内已写入的像素数；winValid 为 false 时下一次必须重新设置
+static bool winValid = false;
+static uint16_t winX0, winX1, winY0, winY1;
+static uint32_t winPos = 0;
+
+static void LCD_Vsync_Init(void);
+
+static void LCD_AdvanceWindow(uint32_t bytes)
+{
+  winPos += bytes / sizeof(uint16_t);
+  if (bytes % sizeof(uint16_t) != 0) {
+    winValid = false;
+  }
+}
+
 void SPI_Init()
 {
   LCDspi.begin(EXAMPLE_PIN_NUM_SCLK,EXAMPLE_PIN_NUM_MISO,EXAMPLE_PIN_NUM_MOSI); 
 }
 
-void LCD_WriteCommand(uint8_t Cmd)  
+/******************************************************************************
+Arduino SPI 后端：每个命令 / 参数字节单独一次事务，CS / DC 用 GPIO 控制，
+像素数据由 CPU 发送，调用方阻塞到发送完成
+******************************************************************************/
+static void LCD_WriteCommand(uint8_t Cmd)  
 { 
   LCDspi.beginTransaction(SPISettings(SPIFreq, MSBFIRST, SPI_MODE0));
   digitalWrite(EXAMPLE_PIN_NUM_LCD_CS, LOW);  
@@ -15,7 +53,7 @@ void LCD_WriteCommand(uint8_t Cmd)
   digitalWrite(EXAMPLE_PIN_NUM_LCD_CS, HIGH);  
   LCDspi.endTransaction();
 }
-void LCD_WriteData(uint8_t Data) 
+static void LCD_WriteData(uint8_t Data) 
 { 
   LCDspi.beginTransaction(SPISettings(SPIFreq, MSBFIRST, SPI_MODE0));
   digitalWrite(EXAMPLE_PIN_NUM_LCD_CS, LOW);  
@@ -24,23 +62,223 @@ void LCD_WriteData(uint8_t Data)
   digitalWrite(EXAMPLE_PIN_NUM_LCD_CS, HIGH);  
   LCDspi.endTransaction();
 }    
-void LCD_WriteData_Word(uint16_t Data)
-{
-  LCDspi.beginTransaction(SPISettings(SPIFreq, MSBFIRST, SPI_MODE0));
-  digitalWrite(EXAMPLE_PIN_NUM_LCD_CS, LOW);  
-  digitalWrite(EXAMPLE_PIN_NUM_LCD_DC, HIGH); 
-  LCDspi.transfer16(Data);
-  digitalWrite(EXAMPLE_PIN_NUM_LCD_CS, HIGH);  
-  LCDspi.endTransaction();
-}   
-void LCD_WriteData_nbyte(uint8_t* SetData,uint8_t* ReadData,uint32_t Size) 
+static void LCD_SPI_WriteBytes(const uint8_t* SetData, uint32_t Size)
 { 
+  uint32_t t0 = micros();
   LCDspi.beginTransaction(SPISettings(SPIFreq, MSBFIRST, SPI_MODE0));
   digitalWrite(EXAMPLE_PIN_NUM_LCD_CS, LOW);  
   digitalWrite(EXAMPLE_PIN_NUM_LCD_DC, HIGH);  
-  LCDspi.transferBytes(SetData, ReadData, Size);
+  LCDspi.transferBytes(SetData, NULL, Size);
   digitalWrite(EXAMPLE_PIN_NUM_LCD_CS, HIGH);  
   LCDspi.endTransaction();
+  uint32_t dt = micros() - t0;
+  transferStats.bytes += Size;
+  transferStats.busyUs += dt;
+  if (asyncTask == NULL || xTaskGetCurrentTaskHandle() != asyncTask) {
+    transferStats.waitUs += dt;
+  }
+} 
+
+#if LCD_BACKEND == LCD_BACKEND_DMA
+/******************************************************************************
+DMA 后端：esp_lcd SPI 面板 IO
+    CS 由 SPI 外设控制，DC 由 esp_lcd 在每笔传输前设置，命令与参数一次发出。
+    像素数据排队交给 DMA，提交后立即返回；每一块完成时进入 LCD_DmaDone（中断），
+    整笔传输的最后一块释放调用方给出的信号量。
+    DMA 不能直接读 PSRAM 和未对齐的缓冲区：这类数据按 LCD_DMA_BOUNCE_BYTES 拷进内部 RAM 的
+    中转缓冲区分块发送，拷贝下一块时上一块正在传输。
+    esp_lcd 发送命令前会等待已排队的像素数据发完，窗口不会在传输中途被改写。
+******************************************************************************/
+typedef struct {
+  SemaphoreHandle_t notify;   // 这一块完成时释放（只有整笔传输的最后一块设置）
+  LCD_DoneCallback done;      // 这一块完成时调用（同上）
+  void* doneArg;
+  bool bounce;                // 占用一块中转缓冲区，完成后归还
+  uint32_t bytes;
+  int64_t queuedUs;
+} LCD_DmaChunk;
+
+static esp_lcd_panel_io_handle_t lcdIo = NULL;
+static uint8_t* bounceBuf[LCD_DMA_BOUNCE_BUFFERS] = { NULL };
+static uint8_t bounceNext = 0;
+static SemaphoreHandle_t bounceFree = NULL;     // 空闲的中转缓冲区数
+static SemaphoreHandle_t syncDoneSem = NULL;    // 同步绘制等待完成
+// 已提交、尚未完成的块（按提交顺序完成）；在途数受 LCD_DMA_QUEUE_DEPTH 限制，不会超过 LCD_DMA_RING
+static LCD_DmaChunk chunkRing[LCD_DMA_RING];
+static volatile uint32_t chunkHead = 0;         // 只由提交方写
+static volatile uint32_t chunkTail = 0;         // 只由完成回调写
+static int64_t lastDoneUs = 0;
+
+static bool IRAM_ATTR LCD_DmaDone(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *ctx)
+{
+  BaseType_t woken = pdFALSE;
+  LCD_DmaChunk* c = &chunkRing[chunkTail % LCD_DMA_RING];
+  // 排队期间上一块还在传输，从两者中较晚的时间算起
+  int64_t now = esp_timer_get_time();
+  int64_t start = c->queuedUs > lastDoneUs ? c->queuedUs : lastDoneUs;
+  transferStats.bytes += c->bytes;
+  transferStats.busyUs += (uint32_t)(now - start);
+  lastDoneUs = now;
+  if (c->bounce) {
+    xSemaphoreGiveFromISR(bounceFree, &woken);
+  }
+  if (c->done != NULL) {
+    c->done(c->doneArg);
+  }
+  if (c->notify != NULL) {
+    xSemaphoreGiveFromISR(c->notify, &woken);
+  }
+  chunkTail = chunkTail + 1;
+  return woken == pdTRUE;
+}
+
+static bool LCD_DmaInit(void)
+{
+  spi_bus_config_t bus = {};
+  bus.sclk_io_num = EXAMPLE_PIN_NUM_SCLK;
+  bus.mosi_io_num = EXAMPLE_PIN_NUM_MOSI;
+  bus.miso_io_num = EXAMPLE_PIN_NUM_MISO;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  bus.max_transfer_sz = LCD_DMA_MAX_TRANSFER;
+  if (spi_bus_initialize(LCD_DMA_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK) {
+    printf("LCD DMA: spi_bus_initialize failed\r\n");
+    return false;
+  }
+
+  esp_lcd_panel_io_spi_config_t io = {};
+  io.cs_gpio_num = EXAMPLE_PIN_NUM_LCD_CS;
+  io.dc_gpio_num = EXAMPLE_PIN_NUM_LCD_DC;
+  io.spi_mode = 0;
+  io.pclk_hz = SPIFreq;
+  io.trans_queue_depth = LCD_DMA_QUEUE_DEPTH;
+  io.on_color_trans_done = LCD_DmaDone;
+  io.lcd_cmd_bits = 8;
+  io.lcd_param_bits = 8;
+  if (esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_DMA_HOST, &io, &lcdIo) != ESP_OK) {
+    printf("LCD DMA: esp_lcd_new_panel_io_spi failed\r\n");
+    spi_bus_free(LCD_DMA_HOST);
+    return false;
+  }
+
+  bounceFree = xSemaphoreCreateCounting(LCD_DMA_BOUNCE_BUFFERS, LCD_DMA_BOUNCE_BUFFERS);
+  syncDoneSem = xSemaphoreCreateBinary();
+  bool ok = bounceFree != NULL && syncDoneSem != NULL;
+  for (int i = 0; ok && i < LCD_DMA_BOUNCE_BUFFERS; i++) {
+    bounceBuf[i] = (uint8_t*)heap_caps_malloc(LCD_DMA_BOUNCE_BYTES, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    ok = bounceBuf[i] != NULL;
+  }
+  if (!ok) {
+    printf("LCD DMA: bounce buffer allocation failed\r\n");
+    esp_lcd_panel_io_del(lcdIo);
+    lcdIo = NULL;
+    spi_bus_free(LCD_DMA_HOST);
+    return false;
+  }
+  return true;
+}
+
+static void LCD_DmaCommand(uint8_t cmd, const uint8_t* params, size_t len)
+{
+  esp_lcd_panel_io_tx_param(lcdIo, cmd, params, len);
+}
+
+// 接着上一块写显存：IDF 5 的 esp_lcd 可以不带命令发送数据（不等前面的传输结束，DMA 连续发送），
+// 更早的版本总会先发命令，用 RAMWRC（0x3C）
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#define LCD_DMA_CONTINUE        -1
+#else
+#define LCD_DMA_CONTINUE        0x3C
+#endif
+
+/**
+ * 排队发送像素数据，立即返回；最后一块完成时调用 done(doneArg) 并释放 notify（均可为 NULL）
+ * cmd 为 0x2C（RAMWR，从窗口起点写）或 LCD_DMA_CONTINUE（接着上一块写）；
+ * 中转分块时后续各块都接着写，窗口内的写入位置不会回到起点
+ */
+static void LCD_DmaQueue(int cmd, const uint8_t* data, uint32_t size, SemaphoreHandle_t notify,
+                         LCD_DoneCallback done, void* doneArg)
+{
+  if (esp_ptr_dma_capable(data) && ((uintptr_t)data & 3) == 0) {
+    LCD_DmaChunk* c = &chunkRing[chunkHead % LCD_DMA_RING];
+    c->notify = notify;
+    c->done = done;
+    c->doneArg = doneArg;
+    c->bounce = false;
+    c->bytes = size;
+    c->queuedUs = esp_timer_get_time();
+    chunkHead = chunkHead + 1;
+    esp_lcd_panel_io_tx_color(lcdIo, cmd, data, size);
+    return;
+  }
+
+  while (size > 0) {
+    uint32_t n = size < LCD_DMA_BOUNCE_BYTES ? size : LCD_DMA_BOUNCE_BYTES;
+    xSemaphoreTake(bounceFree, portMAX_DELAY);
+    uint8_t* buf = bounceBuf[bounceNext];
+    bounceNext = (bounceNext + 1) % LCD_DMA_BOUNCE_BUFFERS;
+    memcpy(buf, data, n);
+    data += n;
+    size -= n;
+
+    LCD_DmaChunk* c = &chunkRing[chunkHead % LCD_DMA_RING];
+    c->notify = size == 0 ? notify : NULL;
+    c->done = size == 0 ? done : NULL;
+    c->doneArg = doneArg;
+    c->bounce = true;
+    c->bytes = n;
+    c->queuedUs = esp_timer_get_time();
+    chunkHead = chunkHead + 1;
+    esp_lcd_panel_io_tx_color(lcdIo, cmd, buf, n);
+    cmd = LCD_DMA_CONTINUE;
+  }
+}
+
+/**
+ * 等待同步绘制完成（调用方阻塞在信号量上，CPU 可以运行其他任务）
+ */
+static void LCD_DmaWaitSync(uint32_t t0)
+{
+  xSemaphoreTake(syncDoneSem, portMAX_DELAY);
+  if (asyncTask == NULL || xTaskGetCurrentTaskHandle() != asyncTask) {
+    transferStats.waitUs += micros() - t0;
+  }
+}
+#endif
+
+/******************************************************************************
+function: Send a command with its parameters
+    DMA 后端一次发出；Arduino SPI 后端逐字节发送
+******************************************************************************/
+static void LCD_WriteCommandParams(uint8_t cmd, const uint8_t* params, size_t len)
+{
+#if LCD_BACKEND == LCD_BACKEND_DMA
+  if (dmaReady) {
+    LCD_DmaCommand(cmd, params, len);
+    return;
+  }
+#endif
+  LCD_WriteCommand(cmd);
+  for (size_t i = 0; i < len; i++) {
+    LCD_WriteData(params[i]);
+  }
+}
+
+void LCD_WriteData_nbyte(uint8_t* SetData,uint8_t* ReadData,uint32_t Size) 
+{ 
+  if (Size == 0) {
+    return;
+  }
+  LCD_AdvanceWindow(Size);
+#if LCD_BACKEND == LCD_BACKEND_DMA
+  if (dmaReady) {
+    uint32_t t0 = micros();
+    LCD_DmaQueue(LCD_DMA_CONTINUE, SetData, Size, syncDoneSem, NULL, NULL);
+    LCD_DmaWaitSync(t0);
+    return;
+  }
+#endif
+  LCD_SPI_WriteBytes(SetData, Size);
 } 
 
 void LCD_Reset(void)
@@ -52,106 +290,117 @@ void LCD_Reset(void)
   digitalWrite(EXAMPLE_PIN_NUM_LCD_RST, HIGH); 
   delay(50);
 }
+
+// 初始化序列（Sleep Out 与 MADCTL 之后）
+typedef struct {
+  uint8_t cmd;
+  uint8_t len;
+  uint8_t params[14];
+} LCD_InitCmd;
+
+static const LCD_InitCmd initCmds[] = {
+  { 0x3A, 1, { 0x05 } },
+  { 0xB0, 2, { 0x00, 0xE8 } },                          // 5 to 6-bit conversion: r0 = r5, b0 = b5
+  { 0xB2, 5, { 0x0C, 0x0C, 0x00, 0x33, 0x33 } },
+  { 0xB7, 1, { 0x75 } },                                // VGH=14.97V,VGL=-7.67V
+  { 0xBB, 1, { 0x1A } },
+  { 0xC0, 1, { 0x2C } },
+  { 0xC2, 2, { 0x01, 0xFF } },
+  { 0xC3, 1, { 0x13 } },
+  { 0xC4, 1, { 0x20 } },
+  { 0xC6, 1, { 0x0F } },
+  { 0xD0, 2, { 0xA4, 0xA1 } },
+  { 0xD6, 1, { 0xA1 } },
+  { 0xE0, 14, { 0xD0, 0x0D, 0x14, 0x0D, 0x0D, 0x09, 0x38, 0x44, 0x4E, 0x3A, 0x17, 0x18, 0x2F, 0x30 } },
+  { 0xE1, 14, { 0xD0, 0x09, 0x0F, 0x08, 0x07, 0x14, 0x37, 0x44, 0x4D, 0x38, 0x15, 0x16, 0x2C, 0x2E } },
+  { 0x21, 0, { 0 } },
+  { 0x29, 0, { 0 } },
+  { 0x2C, 0, { 0 } },
+};
+
 void LCD_Init(void)
 {
   pinMode(EXAMPLE_PIN_NUM_LCD_CS, OUTPUT);
   pinMode(EXAMPLE_PIN_NUM_LCD_DC, OUTPUT);
   pinMode(EXAMPLE_PIN_NUM_LCD_RST, OUTPUT); 
-  SPI_Init();
 
   LCD_Reset();
+
+  // DMA 后端接管 CS / DC 引脚；初始化失败时退回 Arduino SPI
+#if LCD_BACKEND == LCD_BACKEND_DMA
+  dmaReady = LCD_DmaInit();
+  if (!dmaReady) {
+    printf("LCD: DMA backend unavailable, using Arduino SPI\r\n");
+  }
+#endif
+  if (!dmaReady) {
+    SPI_Init();
+  }
   //************* Start Initial Sequence **********// 
 
   delay(120);
-  LCD_WriteCommand(0x29);    //Display on
+  LCD_WriteCommandParams(0x29, NULL, 0);    //Display on
   delay(120);         
-  LCD_WriteCommand(0x11);     
+  LCD_WriteCommandParams(0x11, NULL, 0);
   delay(120);                //ms            
-  LCD_WriteCommand(0x36);     
-  LCD_WriteData(0x00);   
-
-  LCD_WriteCommand(0x3A);     
-  LCD_WriteData(0x05);   
-
-  LCD_WriteCommand(0xB0);
-  LCD_WriteData(0x00);
-  LCD_WriteData(0xE8); // 5 to 6-bit conversion: r0 = r5, b0 = b5
-
-  LCD_WriteCommand(0xB2);     
-  LCD_WriteData(0x0C);   
-  LCD_WriteData(0x0C);   
-  LCD_WriteData(0x00);   
-  LCD_WriteData(0x33);   
-  LCD_WriteData(0x33);   
-
-  LCD_WriteCommand(0xB7);     
-  LCD_WriteData(0x75);   //VGH=14.97V,VGL=-7.67V
-
-  LCD_WriteCommand(0xBB);     
-  LCD_WriteData(0x1A);   
-
-  LCD_WriteCommand(0xC0);     
-  LCD_WriteData(0x2C);   
-
-  LCD_WriteCommand(0xC2);     
-  LCD_WriteData(0x01);    
-  LCD_WriteData(0xFF);     
-
-  LCD_WriteCommand(0xC3);     
-  LCD_WriteData(0x13);   
-
-  LCD_WriteCommand(0xC4);     
-  LCD_WriteData(0x20);   
-
-  LCD_WriteCommand(0xC6);     
-  LCD_WriteData(0x0F);   
-
-  LCD_WriteCommand(0xD0);     
-  LCD_WriteData(0xA4);   
-  LCD_WriteData(0xA1);   
-
-  LCD_WriteCommand(0xD6);     
-  LCD_WriteData(0xA1);   
-
-  LCD_WriteCommand(0xE0);     
-  LCD_WriteData(0xD0);
-  LCD_WriteData(0x0D);
-  LCD_WriteData(0x14);
-  LCD_WriteData(0x0D);
-  LCD_WriteData(0x0D);
-  LCD_WriteData(0x09);
-  LCD_WriteData(0x38);
-  LCD_WriteData(0x44);
-  LCD_WriteData(0x4E);
-  LCD_WriteData(0x3A);
-  LCD_WriteData(0x17);
-  LCD_WriteData(0x18);
-  LCD_WriteData(0x2F);
-  LCD_WriteData(0x30);
-
-  LCD_WriteCommand(0xE1);     
-  LCD_WriteData(0xD0);
-  LCD_WriteData(0x09);
-  LCD_WriteData(0x0F);
-  LCD_WriteData(0x08);
-  LCD_WriteData(0x07);
-  LCD_WriteData(0x14);
-  LCD_WriteData(0x37);
-  LCD_WriteData(0x44);
-  LCD_WriteData(0x4D);
-  LCD_WriteData(0x38);
-  LCD_WriteData(0x15);
-  LCD_WriteData(0x16);
-  LCD_WriteData(0x2C);
-  LCD_WriteData(0x2E);
-
-  LCD_WriteCommand(0x21);     
-
-  LCD_WriteCommand(0x29); 
-
-  LCD_WriteCommand(0x2C);     
+  LCD_WriteCommandParams(0x36, &orientation, 1);
+
+  for (size_t i = 0; i < sizeof(initCmds) / sizeof(initCmds[0]); i++) {
+    LCD_WriteCommandParams(initCmds[i].cmd, initCmds[i].params, initCmds[i].len);
+  }
 
+  LCD_Async_Init();
+  LCD_Vsync_Init();
+}
+
+const char* LCD_BackendName(void)
+{
+  return dmaReady ? "dma" : "arduino";
+}
+/******************************************************************************
+function: Set the window
+    列地址（0x2A）与行地址（0x2B）各为一条命令加 4 字节参数，不含 RAMWR
+******************************************************************************/
+static void LCD_SetWindow(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t  Yend)
+{
+  uint16_t x0 = HORIZONTAL ? Xstart + Offset_X : Ystart + Offset_Y;
+  uint16_t x1 = HORIZONTAL ? Xend + Offset_X : Yend + Offset_Y;
+  uint16_t y0 = HORIZONTAL ? Ystart + Offset_Y : Xstart + Offset_X;
+  uint16_t y1 = HORIZONTAL ? Yend + Offset_Y : Xend + Offset_X;
+  uint8_t caset[4] = { (uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)(x1 >> 8), (uint8_t)x1 };
+  uint8_t raset[4] = { (uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)(y1 >> 8), (uint8_t)y1 };
+  LCD_WriteCommandParams(0x2A, caset, 4);
+  LCD_WriteCommandParams(0x2B, raset, 4);
+}
+/******************************************************************************
+function: Prepare the window for a draw
+    新区域与当前窗口列范围相同、且正好从已写入部分的下一行开始时，不再发送 CASET / RASET，
+    像素数据接着写显存；否则重新设置窗口（结束行延伸到屏幕底部，之后相接的绘制都能接着写）
+    返回 true 表示接着写（调用方用 RAMWRC / 不带命令发送），false 表示已重新设置窗口（调用方用 RAMWR）
+******************************************************************************/
+static bool LCD_BeginWindow(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend)
+{
+  if (winValid && Xstart == winX0 && Xend == winX1) {
+    uint32_t w = winX1 - winX0 + 1;
+    if (winPos % w == 0 && Ystart == winY0 + winPos / w && Yend <= winY1) {
+      transferStats.windowsElided++;
+      return true;
+    }
+  }
+  winX0 = Xstart;
+  winX1 = Xend;
+  winY0 = Ystart;
+  winY1 = LCD_GetHeight() - 1;
+  if (winY1 < Yend) {
+    winY1 = Yend;
+  }
+  winPos = 0;
+  winValid = true;
+  LCD_SetWindow(winX0, winY0, winX1, winY1);
+  transferStats.windows++;
+  return false;
 }
+
 /******************************************************************************
 function: Set the cursor position
 parameter :
@@ -159,39 +408,47 @@ parameter :
     Ystart:   Start uint16_t y coordinate
     Xend  :   End uint16_t coordinates
     Yend  :   End uint16_t coordinatesen
+    之后用 LCD_WriteData_nbyte 写入像素
 ******************************************************************************/
 void LCD_SetCursor(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t  Yend)
 { 
-  if (HORIZONTAL) {
-    // set the X coordinates
-    LCD_WriteCommand(0x2A);
-    LCD_WriteData(Xstart >> 8);
-    LCD_WriteData(Xstart + Offset_X);
-    LCD_WriteData(Xend >> 8);
-    LCD_WriteData(Xend + Offset_X);
-    
-    // set the Y coordinates
-    LCD_WriteCommand(0x2B);
-    LCD_WriteData(Ystart >> 8);
-    LCD_WriteData(Ystart + Offset_Y);
-    LCD_WriteData(Yend >> 8);
-    LCD_WriteData(Yend + Offset_Y);
-  }
-  else {
-    // set the X coordinates
-    LCD_WriteCommand(0x2A);
-    LCD_WriteData(Ystart >> 8);
-    LCD_WriteData(Ystart + Offset_Y);
-    LCD_WriteData(Yend >> 8);
-    LCD_WriteData(Yend + Offset_Y);
-    // set the Y coordinates
-    LCD_WriteCommand(0x2B);
-    LCD_WriteData(Xstart >> 8);
-    LCD_WriteData(Xstart + Offset_X);
-    LCD_WriteData(Xend >> 8);
-    LCD_WriteData(Xend + Offset_X);
-  }
-  LCD_WriteCommand(0x2C);
+  bool cont = LCD_BeginWindow(Xstart, Ystart, Xend, Yend);
+#if LCD_BACKEND == LCD_BACKEND_DMA
+  // LCD_WriteData_nbyte 总是接着写，接着写时这里不用发命令
+  if (dmaReady) {
+    if (!cont) {
+      LCD_WriteCommandParams(0x2C, NULL, 0);
+    }
+    return;
+  }
+#endif
+  LCD_WriteCommandParams(cont ? 0x3C : 0x2C, NULL, 0);
+}
+/******************************************************************************
+function: Submit a window
+    传输完成后调用 done(doneArg) 并释放 notify（均可为 NULL；DMA 后端在完成中断中，
+    Arduino SPI 后端发送完立即在调用方任务中）
+******************************************************************************/
+static void LCD_SubmitWindow(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend, uint16_t* color,
+                             SemaphoreHandle_t notify, LCD_DoneCallback done, void* doneArg)
+{
+  uint32_t numBytes = (uint32_t)(Xend - Xstart + 1) * (Yend - Ystart + 1) * sizeof(uint16_t);
+  bool cont = LCD_BeginWindow(Xstart, Ystart, Xend, Yend);
+  LCD_AdvanceWindow(numBytes);
+#if LCD_BACKEND == LCD_BACKEND_DMA
+  if (dmaReady) {
+    LCD_DmaQueue(cont ? LCD_DMA_CONTINUE : 0x2C, (const uint8_t*)color, numBytes, notify, done, doneArg);
+    return;
+  }
+#endif
+  LCD_WriteCommandParams(cont ? 0x3C : 0x2C, NULL, 0);
+  LCD_SPI_WriteBytes((const uint8_t*)color, numBytes);
+  if (done != NULL) {
+    done(doneArg);
+  }
+  if (notify != NULL) {
+    xSemaphoreGive(notify);
+  }
 }
 /******************************************************************************
 function: Refresh the image in an area
@@ -201,14 +458,378 @@ parameter :
     Xend  :   End uint16_t coordinates
     Yend  :   End uint16_t coordinates
     color :   Set the color
+    返回时数据已发送完毕，color 可以立即改写
 ******************************************************************************/
 void LCD_addWindow(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend,uint16_t* color)
 {             
-  uint16_t Show_Width = Xend - Xstart + 1;
-  uint16_t Show_Height = Yend - Ystart + 1;
-  uint32_t numBytes = Show_Width * Show_Height * sizeof(uint16_t);
-  LCD_SetCursor(Xstart, Ystart, Xend, Yend);
-  LCD_WriteData_nbyte((uint8_t*)color, NULL, numBytes);        
+#if LCD_BACKEND == LCD_BACKEND_DMA
+  if (dmaReady) {
+    uint32_t t0 = micros();
+    LCD_SubmitWindow(Xstart, Ystart, Xend, Yend, color, syncDoneSem, NULL, NULL);
+    LCD_DmaWaitSync(t0);
+    return;
+  }
+#endif
+  LCD_SubmitWindow(Xstart, Ystart, Xend, Yend, color, NULL, NULL, NULL);
+}
+
+/******************************************************************************
+function: Window refresh with a completion callback
+    在调用方任务中直接提交，立即返回（Arduino SPI 后端发送完才返回）；传输完成后调用 done(arg)
+    并释放 notify。DMA 后端的 done 在中断中执行，只能做置标志这类工作
+******************************************************************************/
+void LCD_addWindow_Callback(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend, uint16_t* color,
+                            LCD_DoneCallback done, void* arg, SemaphoreHandle_t notify)
+{
+  LCD_SubmitWindow(Xstart, Ystart, Xend, Yend, color, notify, done, arg);
+}
+
+/******************************************************************************
+function: Command list
+    先记录一组绘制，提交时连续排进 SPI 队列，只等最后一笔完成一次。
+    相接的绘制省掉窗口设置后，DMA 在它们之间不需要停下来等命令，数据连续发送
+******************************************************************************/
+void LCD_CmdList_Reset(LCD_CmdList* list)
+{
+  list->count = 0;
+}
+
+void LCD_CmdList_Add(LCD_CmdList* list, uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend,
+                     uint16_t* color)
+{
+  if (list->count >= LCD_CMDLIST_MAX) {
+    LCD_CmdList_Submit(list);
+  }
+  LCD_DrawOp* op = &list->ops[list->count++];
+  op->Xstart = Xstart;
+  op->Ystart = Ystart;
+  op->Xend = Xend;
+  op->Yend = Yend;
+  op->color = color;
+}
+
+void LCD_CmdList_Submit(LCD_CmdList* list)
+{
+  if (list->count == 0) {
+    return;
+  }
+  uint32_t t0 = micros();
+  for (uint8_t i = 0; i < list->count; i++) {
+    const LCD_DrawOp* op = &list->ops[i];
+    bool last = i + 1 == list->count;
+#if LCD_BACKEND == LCD_BACKEND_DMA
+    if (dmaReady) {
+      LCD_SubmitWindow(op->Xstart, op->Ystart, op->Xend, op->Yend, op->color, last ? syncDoneSem : NULL,
+                       NULL, NULL);
+      if (last) {
+        LCD_DmaWaitSync(t0);
+      }
+      continue;
+    }
+#endif
+    LCD_SubmitWindow(op->Xstart, op->Ystart, op->Xend, op->Yend, op->color, NULL, NULL, NULL);
+  }
+  list->count = 0;
+}
+
+/******************************************************************************
+function: Asynchronous window refresh
+    窗口与像素指针放入队列，由核心 0 上的 SPI 任务提交，解码（核心 1）与 SPI 传输因此可以重叠。
+    每完成一笔传输释放一次 doneSem（DMA 后端在完成回调中释放，SPI 任务不等传输结束就提交下一笔），
+    生产者用 LCD_Async_WaitOne / LCD_Async_WaitAll 回收缓冲区。
+******************************************************************************/
+static QueueHandle_t asyncQueue = NULL;
+static SemaphoreHandle_t asyncDoneSem = NULL;
+static uint32_t asyncPending = 0;       // 仅由生产者读写
+
+static void LCD_AsyncTask(void *parameter)
+{
+  LCD_DrawOp job;
+  while (1) {
+    if (xQueueReceive(asyncQueue, &job, portMAX_DELAY) == pdTRUE) {
+      LCD_SubmitWindow(job.Xstart, job.Ystart, job.Xend, job.Yend, job.color, asyncDoneSem, NULL, NULL);
+    }
+  }
+}
+void LCD_Async_Init(void)
+{
+  if (asyncQueue != NULL) {
+    return;
+  }
+  asyncQueue = xQueueCreate(LCD_ASYNC_QUEUE_LEN, sizeof(LCD_DrawOp));
+  asyncDoneSem = xSemaphoreCreateCounting(LCD_ASYNC_QUEUE_LEN + 1, 0);
+  if (asyncQueue == NULL || asyncDoneSem == NULL) {
+    printf("LCD async: queue create failed, falling back to blocking writes\r\n");
+    return;
+  }
+  xTaskCreatePinnedToCore(LCD_AsyncTask, "LCD_Async", 3072, NULL,
+                          LCD_ASYNC_TASK_PRIO, &asyncTask, LCD_ASYNC_TASK_CORE);
+}
+
+void LCD_addWindow_Async(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend, uint16_t* color)
+{
+  if (asyncQueue == NULL) {
+    LCD_addWindow(Xstart, Ystart, Xend, Yend, color);
+    return;
+  }
+  // 队列已满时先回收最早的一笔，保证 doneSem 计数不会溢出
+  if (asyncPending >= LCD_ASYNC_QUEUE_LEN) {
+    LCD_Async_WaitOne();
+  }
+  LCD_DrawOp job = { Xstart, Ystart, Xend, Yend, color };
+  xQueueSend(asyncQueue, &job, portMAX_DELAY);
+  asyncPending++;
+}
+
+void LCD_Async_WaitOne(void)
+{
+  if (asyncPending == 0) {
+    return;
+  }
+  uint32_t t0 = micros();
+  xSemaphoreTake(asyncDoneSem, portMAX_DELAY);
+  transferStats.waitUs += micros() - t0;
+  asyncPending--;
+}
+
+void LCD_Async_WaitAll(void)
+{
+  while (asyncPending > 0) {
+    LCD_Async_WaitOne();
+  }
+}
+
+uint32_t LCD_Async_Pending(void)
+{
+  return asyncPending;
+}
+
+void LCD_GetTransferStats(LCD_TransferStats* stats)
+{
+  if (stats != NULL) {
+    *stats = transferStats;
+  }
+}
+
+
+/******************************************************************************
+function: Set the display orientation (MADCTL)
+    只改变控制器的地址映射，已经显示的内容不变；新方向下的窗口坐标按逻辑屏幕计算
+******************************************************************************/
+void LCD_SetOrientation(uint8_t madctl)
+{
+  madctl &= 0xE0;
+  if (madctl == orientation) {
+    return;
+  }
+  // 排队中的传输是按旧方向的坐标提交的
+  LCD_Async_WaitAll();
+  LCD_WriteCommandParams(0x36, &madctl, 1);
+  orientation = madctl;
+  winValid = false;
+}
+
+uint8_t LCD_GetOrientation(void)
+{
+  return orientation;
+}
+
+uint16_t LCD_GetWidth(void)
+{
+  return (orientation & 0x20) ? LCD_HEIGHT : LCD_WIDTH;
+}
+
+uint16_t LCD_GetHeight(void)
+{
+  return (orientation & 0x20) ? LCD_WIDTH : LCD_HEIGHT;
+}
+
+/******************************************************************************
+function: Vsync-aligned presentation
+    TE（TEON 模式 0）在每个刷新周期的垂直消隐开始时输出高电平，中断只记下上升沿的时间与计数；
+    周期 / 相位估计与排期在调用方任务中由 Vsync_Pacer 完成。
+    消隐到第 0 行扫描之间的门廊（B2 中的 0x0C 行）约为周期的 1/30，落在排期两端的余量之内
+******************************************************************************/
+static VsyncPacer pacer;
+static bool vsyncEnabled = false;
+static uint32_t vsyncNsPerByte = 0;     // 写屏速率估计（每字节纳秒）
+static uint32_t rateBytes = 0;          // 上次更新速率时的 transferStats
+static uint32_t rateBusyUs = 0;
+
+#if EXAMPLE_PIN_NUM_LCD_TE >= 0
+static volatile uint32_t teLastUs = 0;
+static volatile uint32_t teEdges = 0;
+
+static void IRAM_ATTR LCD_TeIsr(void)
+{
+  teLastUs = micros();
+  teEdges = teEdges + 1;
+}
+#endif
+
+static void LCD_Vsync_Init(void)
+{
+  VsyncPacer_Init(&pacer, LCD_TE_NOMINAL_US, micros());
+  vsyncNsPerByte = (uint32_t)(8000000000ULL / SPIFreq);
+#if EXAMPLE_PIN_NUM_LCD_TE >= 0
+  uint8_t teMode = 0x00;    // 只在垂直消隐期输出
+  LCD_WriteCommandParams(0x35, &teMode, 1);
+  pinMode(EXAMPLE_PIN_NUM_LCD_TE, INPUT);
+  attachInterrupt(digitalPinToInterrupt(EXAMPLE_PIN_NUM_LCD_TE), LCD_TeIsr, RISING);
+#endif
+  vsyncEnabled = LCD_VSYNC_DEFAULT;
+}
+
+/**
+ * 取中断记录的最近一次 TE 边沿（时间与计数须是同一次边沿的）
+ */
+static void LCD_Vsync_ReadTe(VsyncPacer* p)
+{
+#if EXAMPLE_PIN_NUM_LCD_TE >= 0
+  uint32_t edges, at;
+  do {
+    edges = teEdges;
+    at = teLastUs;
+  } while (edges != teEdges);
+  VsyncPacer_Update(p, at, edges);
+#endif
+}
+
+void LCD_Vsync_Enable(bool enable)
+{
+  vsyncEnabled = enable;
+  printf("LCD: vsync %s (%s)\r\n", enable ? "on" : "off",
+         EXAMPLE_PIN_NUM_LCD_TE >= 0 ? "TE" : "free-running");
+}
+
+bool LCD_Vsync_Enabled(void)
+{
+  return vsyncEnabled;
+}
+
+void LCD_Vsync_WaitForWindow(uint32_t bytes)
+{
+  if (!vsyncEnabled) {
+    return;
+  }
+  LCD_Vsync_ReadTe(&pacer);
+
+  // 写屏速率取上次调用以来发送的数据（足够多时），PSRAM 经中转缓冲区时比 SPI 时钟慢
+  uint32_t sent = transferStats.bytes - rateBytes;
+  if (sent >= 65536) {
+    vsyncNsPerByte = (uint32_t)((uint64_t)(transferStats.busyUs - rateBusyUs) * 1000 / sent);
+    rateBytes = transferStats.bytes;
+    rateBusyUs = transferStats.busyUs;
+  }
+
+  uint32_t t0 = micros();
+  uint32_t wait = VsyncPacer_Schedule(&pacer, t0, (uint32_t)((uint64_t)bytes * vsyncNsPerByte / 1000));
+  // 整毫秒的部分让出 CPU（tick 为 1 ms），剩下的忙等到起始时刻
+  if (wait > 2000) {
+    vTaskDelay(pdMS_TO_TICKS(wait / 1000 - 1));
+  }
+  while (micros() - t0 < wait) {
+  }
+}
+
+void LCD_GetVsyncStats(LCD_VsyncStats* stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+  // 在副本上读入最新的 TE 边沿，不改动生产者使用的状态
+  VsyncPacer p = pacer;
+  LCD_Vsync_ReadTe(&p);
+  stats->enabled = vsyncEnabled;
+  stats->hasTe = EXAMPLE_PIN_NUM_LCD_TE >= 0;
+  stats->locked = p.locked;
+  stats->periodUs = p.periodUs;
+  stats->refreshCentiHz = VsyncPacer_RefreshCentiHz(&p);
+  stats->teEdges = p.edges;
+  stats->missedTe = p.missedTe;
+  stats->presents = p.presents;
+  stats->slipped = p.slipped;
+  stats->unavoidable = p.unavoidable;
+  stats->avgWaitUs = p.presents > 0 ? (uint32_t)(p.waitUs / p.presents) : 0;
+}
+
+/******************************************************************************
+function: Throughput benchmark
+    1. 内部 RAM 条带：frame 的前 LCD_BENCH_ROWS 行拷到 DMA 缓冲区，异步连续写到屏幕顶部（DMA 直接读取）
+    2. PSRAM 整帧：frame 整帧同步写屏（DMA 后端经中转缓冲区）
+    3. 窗口开销：连续设置 1×1 窗口并写一个像素
+    理论带宽为 SPI 时钟的 SPIFreq / 8；测试会改写屏幕内容，调用方随后需要重绘
+******************************************************************************/
+static float LCD_MBps(uint64_t bytes, uint32_t us)
+{
+  return us > 0 ? (float)bytes / us : 0.0f;
+}
+
+bool LCD_Benchmark(const uint16_t* frame, uint8_t iterations, LCD_BenchResult* result)
+{
+  if (frame == NULL) {
+    return false;
+  }
+  if (iterations == 0) {
+    iterations = 1;
+  }
+  LCD_Async_WaitAll();
+
+  uint16_t w = LCD_GetWidth();
+  uint16_t h = LCD_GetHeight();
+  uint32_t stripBytes = (uint32_t)w * LCD_BENCH_ROWS * sizeof(uint16_t);
+  uint16_t* strip = (uint16_t*)heap_caps_malloc(stripBytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  if (strip == NULL) {
+    printf("LCD bench: strip allocation failed\r\n");
+    return false;
+  }
+  memcpy(strip, frame, stripBytes);
+
+  LCD_BenchResult r = {};
+  r.backend = dmaReady ? 1 : 0;
+  r.iterations = iterations;
+  r.frameBytes = (uint32_t)w * h * sizeof(uint16_t);
+  r.theoreticalMBps = SPIFreq / 8 / 1e6f;
+
+  // 条带按帧的字节数累计，与整帧结果可直接比较
+  uint32_t stripsPerFrame = (h + LCD_BENCH_ROWS - 1) / LCD_BENCH_ROWS;
+  uint32_t t0 = micros();
+  for (uint32_t i = 0; i < (uint32_t)iterations * stripsPerFrame; i++) {
+    LCD_addWindow_Async(0, 0, w - 1, LCD_BENCH_ROWS - 1, strip);
+  }
+  LCD_Async_WaitAll();
+  r.internalUs = micros() - t0;
+  r.internalMBps = LCD_MBps((uint64_t)stripBytes * iterations * stripsPerFrame, r.internalUs);
+  heap_caps_free(strip);
+
+  t0 = micros();
+  for (uint8_t i = 0; i < iterations; i++) {
+    LCD_addWindow(0, 0, w - 1, h - 1, (uint16_t*)frame);
+  }
+  r.psramUs = micros() - t0;
+  r.psramMBps = LCD_MBps((uint64_t)r.frameBytes * iterations, r.psramUs);
+
+  t0 = micros();
+  for (uint16_t i = 0; i < LCD_BENCH_WINDOWS; i++) {
+    uint16_t x = i % w;
+    LCD_addWindow(x, 0, x, 0, (uint16_t*)frame + x);
+  }
+  r.windowUs = (float)(micros() - t0) / LCD_BENCH_WINDOWS;
+  r.valid = true;
+
+  lastBench = r;
+  if (result != NULL) {
+    *result = r;
+  }
+  return true;
+}
+
+bool LCD_GetLastBenchmark(LCD_BenchResult* result)
+{
+  if (result != NULL) {
+    *result = lastBench;
+  }
+  return lastBench.valid;
 }
 
 
@@ -4,6 +4,7 @@
 
 #define LCD_WIDTH   240 //LCD width
 #define LCD_HEIGHT  320 //LCD height
+#define LCD_LONG_SIDE ((LCD_WIDTH) > (LCD_HEIGHT) ? (LCD_WIDTH) : (LCD_HEIGHT))   // 任意方向下一行的最大像素数
 
 #define SPIFreq                        80000000
 #define EXAMPLE_PIN_NUM_MISO           -1
@@ -26,6 +27,21 @@
 #define Offset_X 0
 #define Offset_Y 0
 
+// 写屏后端
+// - DMA：esp_lcd SPI 面板 IO，CS / DC 由外设控制，窗口命令与参数一次发出，像素数据排队交给 DMA
+//   后立即返回，完成时在中断中释放信号量；初始化失败时自动退回 Arduino SPI
+// - Arduino SPI：原实现，逐字节发送命令，CPU 发送像素数据
+#define LCD_BACKEND_ARDUINO_SPI 0
+#define LCD_BACKEND_DMA         1
+#define LCD_BACKEND             LCD_BACKEND_DMA
+
+#define LCD_DMA_HOST            SPI2_HOST   // FSPI
+#define LCD_DMA_MAX_TRANSFER    32768       // 单笔 SPI 传输上限（esp_lcd 按此拆分更大的缓冲区）
+#define LCD_DMA_QUEUE_DEPTH     8           // esp_lcd 排队的传输数
+#define LCD_DMA_BOUNCE_BYTES    8192        // PSRAM / 未对齐数据经内部 RAM 中转的分块大小
+#define LCD_DMA_BOUNCE_BUFFERS  2
+#define LCD_DMA_RING            32          // 在途数据块记录（须大于 LCD_DMA_QUEUE_DEPTH）
+
 
 extern uint8_t LCD_Backlight;
 
@@ -36,5 +52,125 @@ void LCD_SetCursor(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t  Ye
 void LCD_addWindow(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend,uint16_t* color);
 void LCD_WriteData_nbyte(uint8_t* SetData, uint8_t* ReadData, uint32_t Size);
 
+// 带完成回调的写屏（LVGL 等在 loop 中绘制的界面）：提交后立即返回，传输完成时调用 done(arg) 并释放 notify
+// （均可为 NULL）。DMA 后端的 done 在完成中断中执行；color 在完成前不可改写。
+// 与同步绘制 / 图片流程在同一任务中使用，不可与未完成的异步刷屏（LCD_addWindow_Async）交错提交
+typedef void (*LCD_DoneCallback)(void* arg);
+void LCD_addWindow_Callback(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend, uint16_t* color,
+                            LCD_DoneCallback done, void* arg, SemaphoreHandle_t notify);
+
+// 窗口合并：与上一次绘制列范围相同、从它的下一行开始的绘制不再发送 CASET / RASET，接着写显存。
+// 一列一列向下输出的条带、逐行清屏等都只设置一次窗口
+
+// 命令列表：记录一组绘制后一次提交，连续排进 SPI 队列，只等最后一笔完成（返回时全部发送完毕）
+#define LCD_CMDLIST_MAX         32      // 每个列表最多记录的绘制数，满时 Add 先提交已记录的部分
+
+typedef struct {
+  uint16_t Xstart;
+  uint16_t Ystart;
+  uint16_t Xend;
+  uint16_t Yend;
+  uint16_t* color;
+} LCD_DrawOp;
+
+typedef struct {
+  LCD_DrawOp ops[LCD_CMDLIST_MAX];
+  uint8_t count;
+} LCD_CmdList;
+
+void LCD_CmdList_Reset(LCD_CmdList* list);
+void LCD_CmdList_Add(LCD_CmdList* list, uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend,
+                     uint16_t* color);      // color 在提交完成前不可改写
+void LCD_CmdList_Submit(LCD_CmdList* list); // 同步绘制：须先 LCD_Async_WaitAll()
+
+// 异步刷屏：窗口 + 像素数据交给后台 SPI 任务发送，调用方立即返回
+// 注意：只允许一个生产者（图片解码流程）使用；缓冲区在对应传输完成前不可改写，
+//       调用任何同步绘制函数前必须先 LCD_Async_WaitAll()
+#define LCD_ASYNC_QUEUE_LEN     4       // 最多排队的传输数
+#define LCD_ASYNC_TASK_CORE     0       // SPI 后台任务所在核心（loop 在核心 1）
+#define LCD_ASYNC_TASK_PRIO     4
+
+void LCD_Async_Init(void);
+void LCD_addWindow_Async(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend, uint16_t* color);
+void LCD_Async_WaitOne(void);           // 等待最早提交的一笔传输完成
+void LCD_Async_WaitAll(void);           // 等待全部传输完成
+uint32_t LCD_Async_Pending(void);       // 已提交但尚未确认完成的传输数
+
+// 像素数据传输统计（累计值，调用方前后各取一次求差）
+typedef struct {
+  uint32_t bytes;       // 已发送的像素数据字节数
+  uint32_t busyUs;      // 发送耗时（含 SPI 任务中的异步传输）
+  uint32_t waitUs;      // 调用方被阻塞的时间：同步发送 + 等待异步传输完成
+  uint32_t windows;         // 发送的窗口设置（CASET + RASET）
+  uint32_t windowsElided;   // 因与上一次绘制相接而省掉的窗口设置
+} LCD_TransferStats;
+
+void LCD_GetTransferStats(LCD_TransferStats* stats);
+
+const char* LCD_BackendName(void);      // "dma" / "arduino"
+
+// 写屏带宽测试（会改写屏幕内容）
+#define LCD_BENCH_ROWS          16      // 内部 RAM 条带的行数
+#define LCD_BENCH_WINDOWS       200     // 窗口开销测试的次数
+
+typedef struct {
+  bool valid;
+  uint8_t backend;          // LCD_BACKEND_ARDUINO_SPI / LCD_BACKEND_DMA
+  uint8_t iterations;
+  uint32_t frameBytes;
+  uint32_t internalUs;      // 内部 RAM 条带写满 iterations 帧的总耗时
+  uint32_t psramUs;         // PSRAM 整帧 iterations 次的总耗时
+  float windowUs;           // 每次 1×1 窗口（窗口命令 + 1 个像素）的耗时
+  float internalMBps;
+  float psramMBps;
+  float theoreticalMBps;    // SPIFreq / 8
+} LCD_BenchResult;
+
+/**
+ * frame 为当前方向下的整帧 RGB565（通常在 PSRAM）
+ * 只能由异步刷屏的生产者调用
+ */
+bool LCD_Benchmark(const uint16_t* frame, uint8_t iterations, LCD_BenchResult* result);
+bool LCD_GetLastBenchmark(LCD_BenchResult* result);
+
+// 显示方向：MADCTL（0x36）的 MY / MX / MV 位（取值见 Image_Orientation.h），由面板控制器完成旋转 / 镜像，
+// 写屏不搬移像素。MV 置位时逻辑屏幕为 LCD_HEIGHT × LCD_WIDTH，之后的窗口坐标都按逻辑屏幕计算。
+// 会先等待全部异步传输完成，只能由异步刷屏的生产者（图片解码流程）调用；LVGL 按方向 0 绘制
+void LCD_SetOrientation(uint8_t madctl);
+uint8_t LCD_GetOrientation(void);
+uint16_t LCD_GetWidth(void);            // 当前方向下的逻辑宽度
+uint16_t LCD_GetHeight(void);
+
+// 垂直同步写屏：整帧写屏前等到面板扫描的合适位置再开始，写入与扫描不相交，画面不撕裂（见 Vsync_Pacer.h）
+// - TE 引脚已连接时由 TE 中断给出每个刷新周期的起点，并估计实际刷新率
+// - 未连接（-1）时按标称刷新周期自由运行，只能把整帧写屏间隔开，不能保证不撕裂
+// 只对扫描方向与写入方向一致的方向（MADCTL 不含 MV / MY）有效；横屏时写入按列推进，仍会撕裂
+#define EXAMPLE_PIN_NUM_LCD_TE  -1          // 面板 TE 输出所接的 GPIO（-1 表示未连接）
+#define LCD_TE_NOMINAL_US       16667       // 标称刷新周期：FRCTRL2（0xC6）= 0x0F 时为 60 Hz
+#define LCD_VSYNC_DEFAULT       0           // 上电时是否开启垂直同步写屏
+
+typedef struct {
+  bool enabled;
+  bool hasTe;               // TE 引脚已连接
+  bool locked;              // 已由 TE 边沿估计出刷新周期
+  uint32_t periodUs;        // 估计的刷新周期
+  uint32_t refreshCentiHz;  // 估计的刷新率（Hz × 100）
+  uint32_t teEdges;         // 收到的 TE 边沿数
+  uint32_t missedTe;        // 估计丢失的 TE 边沿数
+  uint32_t presents;        // 按垂直同步排期的整帧写屏次数
+  uint32_t slipped;         // 错过当前周期、顺延一个周期的次数
+  uint32_t unavoidable;     // 写屏耗时超过两个刷新周期、无法避免撕裂的次数
+  uint32_t avgWaitUs;       // 每次写屏平均等待的时间
+} LCD_VsyncStats;
+
+void LCD_Vsync_Enable(bool enable);
+bool LCD_Vsync_Enabled(void);
+/**
+ * 整帧写屏前调用：关闭时立即返回，开启时等到 bytes 字节的写屏可以不撕裂地开始的时刻。
+ * 写屏耗时按已发送数据的平均速率估计；调用方须先等完之前的异步传输，返回后立即提交
+ */
+void LCD_Vsync_WaitForWindow(uint32_t bytes);
+void LCD_GetVsyncStats(LCD_VsyncStats* stats);
+
 void Backlight_Init(void);
 void Set_Backlight(uint8_t Light);
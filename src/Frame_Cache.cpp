@@ -0,0 +1,353 @@
+#include "Frame_Cache.h"
+#include "Display_ST7789.h"
+#include "Image_Orientation.h"
+#include <esp_heap_caps.h>
+
+#define FRAME_PIXELS    (LCD_WIDTH * LCD_HEIGHT)
+#define FRAME_BYTES     (FRAME_PIXELS * 2)
+
+// ============================================================
+// 缓存条目（data == nullptr 表示空槽）
+// ============================================================
+typedef struct {
+    char path[100];
+    uint32_t mtime;
+    uint32_t size;
+    uint8_t orient;         // 方向标记（低 5 位视角键参与匹配）
+    uint16_t* data;         // PSRAM 中的帧数据（原始或 RLE）
+    uint32_t bytes;         // data 占用字节数
+    bool compressed;
+    uint32_t lastUse;       // LRU 时间戳（useCounter 的快照）
+} FrameCacheEntry;
+
+static FrameCacheEntry entries[FRAME_CACHE_MAX_ENTRIES];
+static uint32_t useCounter = 0;
+static FrameCacheStats stats = { 0 };
+
+// RLE 编码暂存区（与一帧等大，压缩后大于原始数据则放弃压缩）
+static uint16_t* encodeScratch = nullptr;
+
+// 互斥锁：loop 与后台任务都可能访问缓存
+static SemaphoreHandle_t cacheMutex = nullptr;
+
+static bool cacheReady = false;
+
+// ============================================================
+// RLE（16-bit 令牌）
+//   令牌最高位为 1：重复段，低 15 位为次数，后跟 1 个像素
+//   令牌最高位为 0：原样段，低 15 位为像素数，后跟对应像素
+// 纯色背景、UI 截图压缩率很高；照片通常压不动，会自动存原始数据
+// ============================================================
+static uint32_t rleEncode(const uint16_t* src, uint32_t n, uint16_t* dst, uint32_t dstCap) {
+    uint32_t out = 0;
+    uint32_t i = 0;
+
+    while (i < n) {
+        uint16_t px = src[i];
+        uint32_t run = 1;
+        while (i + run < n && run < 0x7FFF && src[i + run] == px) {
+            run++;
+        }
+
+        if (run >= 3) {
+            if (out + 2 > dstCap) {
+                return 0;
+            }
+            dst[out++] = 0x8000 | run;
+            dst[out++] = px;
+            i += run;
+            continue;
+        }
+
+        // 原样段：直到出现长度 ≥3 的重复为止
+        uint32_t start = i;
+        uint32_t len = 0;
+        while (i < n && len < 0x7FFF) {
+            if (i + 2 < n && src[i] == src[i + 1] && src[i] == src[i + 2]) {
+                break;
+            }
+            i++;
+            len++;
+        }
+        if (out + 1 + len > dstCap) {
+            return 0;
+        }
+        dst[out++] = len;
+        memcpy(dst + out, src + start, len * 2);
+        out += len;
+    }
+
+    return out;
+}
+
+static void rleDecode(const uint16_t* src, uint16_t* dst, uint32_t n) {
+    uint32_t out = 0;
+
+    while (out < n) {
+        uint16_t token = *src++;
+        uint32_t count = token & 0x7FFF;
+        if (out + count > n) {
+            count = n - out;
+        }
+
+        if (token & 0x8000) {
+            uint16_t px = *src++;
+            for (uint32_t i = 0; i < count; i++) {
+                dst[out + i] = px;
+            }
+        } else {
+            memcpy(dst + out, src, count * 2);
+            src += token & 0x7FFF;
+        }
+        out += count;
+    }
+}
+
+// ============================================================
+// 内部辅助（调用前须已持有 cacheMutex）
+// ============================================================
+static void freeEntry(FrameCacheEntry* e) {
+    if (e->data == nullptr) {
+        return;
+    }
+    heap_caps_free(e->data);
+    e->data = nullptr;
+    stats.bytesUsed -= e->bytes;
+    stats.entries--;
+}
+
+static FrameCacheEntry* findEntry(const char* path, uint32_t mtime, uint32_t size, uint8_t view) {
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES; i++) {
+        FrameCacheEntry* e = &entries[i];
+        if (e->data != nullptr && e->mtime == mtime && e->size == size &&
+            (e->orient & IMAGE_ORIENT_VIEW_MASK) == view && strcmp(e->path, path) == 0) {
+            return e;
+        }
+    }
+    return nullptr;
+}
+
+// 淘汰最久未使用的一帧，缓存为空时返回 false
+static bool evictOldest() {
+    FrameCacheEntry* oldest = nullptr;
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES; i++) {
+        FrameCacheEntry* e = &entries[i];
+        if (e->data != nullptr && (oldest == nullptr || e->lastUse < oldest->lastUse)) {
+            oldest = e;
+        }
+    }
+    if (oldest == nullptr) {
+        return false;
+    }
+    freeEntry(oldest);
+    stats.evictions++;
+    return true;
+}
+
+static FrameCacheEntry* freeSlot() {
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES; i++) {
+        if (entries[i].data == nullptr) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+void FrameCache_Init(void) {
+    if (cacheReady) {
+        return;
+    }
+
+    size_t freePsram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    if (freePsram < FRAME_CACHE_PSRAM_RESERVE + FRAME_BYTES * 2) {
+        Serial.println("⚠️ PSRAM 不足，帧缓存已禁用");
+        return;
+    }
+
+    stats.bytesLimit = freePsram - FRAME_CACHE_PSRAM_RESERVE;
+    if (stats.bytesLimit > FRAME_CACHE_MAX_BYTES) {
+        stats.bytesLimit = FRAME_CACHE_MAX_BYTES;
+    }
+
+#if FRAME_CACHE_COMPRESS
+    encodeScratch = (uint16_t*)heap_caps_malloc(FRAME_BYTES, MALLOC_CAP_SPIRAM);
+    if (encodeScratch == nullptr) {
+        Serial.println("⚠️ 帧缓存压缩暂存区分配失败，以原始格式缓存");
+    } else {
+        stats.bytesLimit -= FRAME_BYTES;
+    }
+#endif
+
+    cacheMutex = xSemaphoreCreateMutex();
+    cacheReady = (cacheMutex != nullptr);
+
+    Serial.printf("✓ 帧缓存初始化完成，上限 %.2f MB\n", stats.bytesLimit / 1048576.0);
+}
+
+bool FrameCache_Lookup(const char* path, uint32_t mtime, uint32_t size, uint8_t view,
+                       uint16_t* frame, uint8_t* orient) {
+    if (!cacheReady || path == nullptr || frame == nullptr) {
+        return false;
+    }
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+
+    FrameCacheEntry* e = findEntry(path, mtime, size, view);
+    if (e == nullptr) {
+        stats.misses++;
+        xSemaphoreGive(cacheMutex);
+        return false;
+    }
+
+    if (e->compressed) {
+        rleDecode(e->data, frame, FRAME_PIXELS);
+    } else {
+        memcpy(frame, e->data, FRAME_BYTES);
+    }
+    if (orient != nullptr) {
+        *orient = e->orient;
+    }
+    e->lastUse = ++useCounter;
+    stats.hits++;
+
+    xSemaphoreGive(cacheMutex);
+    return true;
+}
+
+bool FrameCache_Contains(const char* path, uint32_t mtime, uint32_t size, uint8_t view) {
+    if (!cacheReady || path == nullptr) {
+        return false;
+    }
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    bool found = findEntry(path, mtime, size, view) != nullptr;
+    xSemaphoreGive(cacheMutex);
+    return found;
+}
+
+void FrameCache_Insert(const char* path, uint32_t mtime, uint32_t size, uint8_t orient, const uint16_t* frame) {
+    if (!cacheReady || path == nullptr || frame == nullptr || strlen(path) >= sizeof(entries[0].path)) {
+        return;
+    }
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+
+    FrameCacheEntry* e = findEntry(path, mtime, size, orient & IMAGE_ORIENT_VIEW_MASK);
+    if (e != nullptr) {
+        e->lastUse = ++useCounter;
+        xSemaphoreGive(cacheMutex);
+        return;
+    }
+
+    // 尝试压缩，压不动就存原始数据
+    const uint16_t* src = frame;
+    uint32_t bytes = FRAME_BYTES;
+    bool compressed = false;
+    if (encodeScratch != nullptr) {
+        uint32_t words = rleEncode(frame, FRAME_PIXELS, encodeScratch, FRAME_PIXELS);
+        if (words > 0) {
+            src = encodeScratch;
+            bytes = words * 2;
+            compressed = true;
+        }
+    }
+
+    // 腾出空间与空槽
+    while (stats.bytesUsed + bytes > stats.bytesLimit || freeSlot() == nullptr) {
+        if (!evictOldest()) {
+            break;
+        }
+    }
+
+    uint16_t* data = (uint16_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    while (data == nullptr && evictOldest()) {
+        data = (uint16_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    }
+
+    e = freeSlot();
+    if (data == nullptr || e == nullptr) {
+        if (data != nullptr) {
+            heap_caps_free(data);
+        }
+        xSemaphoreGive(cacheMutex);
+        return;
+    }
+
+    memcpy(data, src, bytes);
+    strncpy(e->path, path, sizeof(e->path) - 1);
+    e->path[sizeof(e->path) - 1] = '\0';
+    e->mtime = mtime;
+    e->size = size;
+    e->orient = orient;
+    e->data = data;
+    e->bytes = bytes;
+    e->compressed = compressed;
+    e->lastUse = ++useCounter;
+    stats.bytesUsed += bytes;
+    stats.entries++;
+
+    xSemaphoreGive(cacheMutex);
+}
+
+bool FrameCache_Trim(size_t bytes) {
+    if (!cacheReady) {
+        return false;
+    }
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    uint32_t evicted = 0;
+    while (heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) < bytes && evictOldest()) {
+        evicted++;
+    }
+    bool ok = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) >= bytes;
+    uint32_t entriesLeft = stats.entries;
+    xSemaphoreGive(cacheMutex);
+
+    if (evicted > 0) {
+        Serial.printf("⚠️ 为 %u KB 分配淘汰 %u 帧缓存（剩余 %u 帧）\n",
+                      (unsigned)(bytes / 1024), (unsigned)evicted, (unsigned)entriesLeft);
+    }
+    return ok;
+}
+
+void FrameCache_Invalidate(const char* path) {
+    if (!cacheReady || path == nullptr) {
+        return;
+    }
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES; i++) {
+        if (entries[i].data != nullptr && strcmp(entries[i].path, path) == 0) {
+            freeEntry(&entries[i]);
+        }
+    }
+    xSemaphoreGive(cacheMutex);
+}
+
+void FrameCache_Clear(void) {
+    if (!cacheReady) {
+        return;
+    }
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES; i++) {
+        freeEntry(&entries[i]);
+    }
+    xSemaphoreGive(cacheMutex);
+}
+
+void FrameCache_GetStats(FrameCacheStats* out) {
+    if (out == nullptr) {
+        return;
+    }
+    if (cacheMutex != nullptr) {
+        xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    }
+    *out = stats;
+    if (cacheMutex != nullptr) {
+        xSemaphoreGive(cacheMutex);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================
+// 解码帧 LRU 缓存（PSRAM）
+// 以 路径 + 修改时间 + 文件大小 + 视角键 为键，缓存解码完成、尚未应用色温的
+// 240×320 RGB565 整帧（横屏方向时按 320×240 存储，见 Image_Orientation.h）。
+// 命中时跳过 SD 读取和解码，直接整帧写屏。
+// ============================================================
+// 容量：一帧原始数据 150 KB，6 MB 只装得下 40 帧；48 帧要求 RLE 平均压到 128 KB 以下（约 85%），
+// 照片类图片压缩无收益时按字节上限先淘汰。8 MB PSRAM 上放不下约 50 帧原始数据（7.3 MB）
+#define FRAME_CACHE_MAX_ENTRIES     48                  // 最多缓存帧数
+#define FRAME_CACHE_MAX_BYTES       (6 * 1024 * 1024)   // PSRAM 占用上限
+#define FRAME_CACHE_PSRAM_RESERVE   (1024 * 1024)       // 给其他模块保留的 PSRAM
+#define FRAME_CACHE_COMPRESS        1                   // 1: 帧以 RLE 压缩存储（压缩无收益时自动存原始数据）
+
+// 缓存统计
+typedef struct {
+    uint32_t hits;          // 命中次数
+    uint32_t misses;        // 未命中次数
+    uint32_t evictions;     // 因容量淘汰的帧数
+    uint32_t entries;       // 当前缓存帧数
+    uint32_t bytesUsed;     // 当前占用字节数
+    uint32_t bytesLimit;    // 字节上限
+} FrameCacheStats;
+
+/**
+ * @brief 初始化缓存（根据剩余 PSRAM 确定容量上限）
+ */
+void FrameCache_Init(void);
+
+/**
+ * @brief 查找缓存帧
+ * @param path  文件路径
+ * @param mtime 文件修改时间
+ * @param size  文件大小
+ * @param view  当前视角键（IMAGE_ORIENT_VIEW_MASK 部分）
+ * @param frame 输出缓冲区（LCD_WIDTH × LCD_HEIGHT 像素）
+ * @param orient 输出：该帧的方向标记（可为 nullptr）
+ * @return true 命中并已写入 frame
+ */
+bool FrameCache_Lookup(const char* path, uint32_t mtime, uint32_t size, uint8_t view,
+                       uint16_t* frame, uint8_t* orient);
+
+/**
+ * @brief 是否已缓存（不计入命中统计，也不更新 LRU）
+ */
+bool FrameCache_Contains(const char* path, uint32_t mtime, uint32_t size, uint8_t view);
+
+/**
+ * @brief 插入一帧，容量不足时淘汰最久未使用的帧
+ * @param orient 帧的方向标记（视角键取自低 5 位）
+ * @param frame  LCD_WIDTH × LCD_HEIGHT 像素的 RGB565 帧
+ */
+void FrameCache_Insert(const char* path, uint32_t mtime, uint32_t size, uint8_t orient, const uint16_t* frame);
+
+/**
+ * @brief 为其他模块腾出 PSRAM：淘汰最久未使用的帧，直到有 bytes 字节的连续空闲块
+ * @return true 已有足够的连续空闲块（可重试分配），false 缓存清空后仍不够
+ * @details 渐进式 JPEG 的系数平面、GIF 整文件等大块分配失败时调用（见 JpegCodec_SetReclaim）
+ */
+bool FrameCache_Trim(size_t bytes);
+
+/**
+ * @brief 删除某个路径的全部缓存帧（文件删除或覆盖时调用）
+ */
+void FrameCache_Invalidate(const char* path);
+
+/**
+ * @brief 清空缓存
+ */
+void FrameCache_Clear(void);
+
+/**
+ * @brief 读取统计信息
+ */
+void FrameCache_GetStats(FrameCacheStats* stats);
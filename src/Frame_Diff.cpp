@@ -0,0 +1,97 @@
+#include "Frame_Diff.h"
+
+/**
+ * @brief 一块是否相同：逐行比较，遇到不同立即返回
+ * @param words 为 true 时按 32 位字比较（w 为偶数，行首 4 字节对齐）
+ */
+static bool tileEqual(const uint16_t* a, const uint16_t* b, uint16_t stride, uint16_t w, uint16_t h, bool words) {
+    for (uint16_t y = 0; y < h; y++, a += stride, b += stride) {
+        if (words) {
+            const uint32_t* wa = (const uint32_t*)a;
+            const uint32_t* wb = (const uint32_t*)b;
+            for (uint16_t i = 0; i < w / 2; i++) {
+                if (wa[i] != wb[i]) {
+                    return false;
+                }
+            }
+        } else {
+            for (uint16_t i = 0; i < w; i++) {
+                if (a[i] != b[i]) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int FrameDiff_Compare(const uint16_t* prev, const uint16_t* next, uint16_t width, uint16_t height,
+                      uint16_t tile, uint8_t maxGap, FrameDiffRect* rects, int maxRects, uint32_t* dirtyTiles) {
+    *dirtyTiles = 0;
+    if (tile == 0) {
+        return -1;
+    }
+    uint16_t cols = (width + tile - 1) / tile;
+    if (cols > FRAME_DIFF_MAX_COLS) {
+        return -1;
+    }
+    bool words = (width % 2) == 0 && (tile % 2) == 0 &&
+                 ((uintptr_t)prev % 4) == 0 && ((uintptr_t)next % 4) == 0;
+
+    int count = 0;
+    bool dirty[FRAME_DIFF_MAX_COLS];
+    for (uint16_t ty = 0; ty < height; ty += tile) {
+        uint16_t th = (height - ty < tile) ? height - ty : tile;
+        size_t row = (size_t)ty * width;
+        for (uint16_t c = 0; c < cols; c++) {
+            uint16_t tx = c * tile;
+            uint16_t tw = (width - tx < tile) ? width - tx : tile;
+            dirty[c] = !tileEqual(prev + row + tx, next + row + tx, width, tw, th, words);
+            if (dirty[c]) {
+                (*dirtyTiles)++;
+            }
+        }
+
+        // 这一行块中的各段 [c0, c1)
+        uint16_t c = 0;
+        while (c < cols) {
+            if (!dirty[c]) {
+                c++;
+                continue;
+            }
+            uint16_t c0 = c;
+            uint16_t c1 = c + 1;
+            for (uint16_t k = c1; k < cols && k <= c1 + maxGap; k++) {
+                if (dirty[k]) {
+                    c1 = k + 1;
+                }
+            }
+            c = c1;
+
+            uint16_t x = c0 * tile;
+            uint16_t w = (c1 * tile > width ? width : c1 * tile) - x;
+
+            // 紧接在上一行块下面、左右边界相同的矩形向下延伸
+            int merged = -1;
+            for (int i = 0; i < count; i++) {
+                if (rects[i].x == x && rects[i].w == w && rects[i].y + rects[i].h == ty) {
+                    merged = i;
+                    break;
+                }
+            }
+            if (merged >= 0) {
+                rects[merged].h += th;
+                continue;
+            }
+            if (count >= maxRects) {
+                return -1;
+            }
+            rects[count].x = x;
+            rects[count].y = ty;
+            rects[count].w = w;
+            rects[count].h = th;
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// 帧差异：新帧与屏幕内容副本按小块比较，只上传变化的块
+// - 每块逐行按 32 位字比较（两帧的宽度为偶数且 4 字节对齐时；否则逐像素），遇到第一处不同即停止
+// - 同一行块中相邻的变化块连成一段，中间只隔 maxGap 个未变化块时也并进来（少开一个窗口比多发几块划算）；
+//   上下相邻且左右边界相同的段再合并成一个矩形
+// 不依赖 Arduino，可直接在 x86 Linux 上编译。
+// ============================================================
+#define FRAME_DIFF_MAX_COLS     64      // 每行最多的块数（宽度 / 块尺寸）
+
+typedef struct {
+    uint16_t x, y, w, h;
+} FrameDiffRect;
+
+/**
+ * @brief 比较两帧，输出需要上传的矩形
+ * @param prev       屏幕内容副本
+ * @param next       新帧（与 prev 尺寸相同）
+ * @param tile       块尺寸（像素，正方形；最后一列 / 一行的块按帧边缘截断）
+ * @param maxGap     同一行中两段之间最多容忍的未变化块数
+ * @param dirtyTiles 返回变化的块数（不含因合并而一起上传的块）
+ * @return 矩形数，两帧相同时为 0；超过 maxRects 或块数超过 FRAME_DIFF_MAX_COLS 时返回 -1（调用方整帧上传）
+ */
+int FrameDiff_Compare(const uint16_t* prev, const uint16_t* next, uint16_t width, uint16_t height,
+                      uint16_t tile, uint8_t maxGap, FrameDiffRect* rects, int maxRects, uint32_t* dirtyTiles);
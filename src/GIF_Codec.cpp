@@ -0,0 +1,563 @@
+#include "GIF_Codec.h"
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
+
+// ============================================================
+// 内存分配：全部放 PSRAM，失败时请回收回调腾出空间后再试一次
+// ============================================================
+static GifReclaimFunc g_reclaim = nullptr;
+
+static void* gifAllocOnce(size_t n) {
+#ifdef ESP_PLATFORM
+    void* p = heap_caps_malloc(n, MALLOC_CAP_SPIRAM);
+    if (p == nullptr) {
+        p = malloc(n);
+    }
+    return p;
+#else
+    return malloc(n);
+#endif
+}
+
+static void* gifAlloc(size_t n) {
+    void* p = gifAllocOnce(n);
+    if (p == nullptr && g_reclaim != nullptr && g_reclaim(n)) {
+        p = gifAllocOnce(n);
+    }
+    return p;
+}
+
+static void gifFree(void* p) {
+    free(p);
+}
+
+// ============================================================
+// 输入
+// ============================================================
+
+static inline bool have(const GifDecoder* dec, size_t n) {
+    return dec->pos + n <= dec->size;
+}
+
+static inline uint16_t le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint16_t pack565(const uint8_t* rgb) {
+    return (uint16_t)(((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3));
+}
+
+/**
+ * @brief 读取调色板（3 × count 字节 RGB）
+ */
+static bool readPalette(GifDecoder* dec, int count, uint16_t* palette) {
+    if (!have(dec, (size_t)count * 3)) {
+        return false;
+    }
+    const uint8_t* p = dec->data + dec->pos;
+    for (int i = 0; i < count; i++, p += 3) {
+        palette[i] = pack565(p);
+    }
+    for (int i = count; i < 256; i++) {
+        palette[i] = 0;
+    }
+    dec->pos += (size_t)count * 3;
+    return true;
+}
+
+/**
+ * @brief 跳过数据子块序列（直到长度为 0 的终止块）
+ */
+static bool skipSubBlocks(GifDecoder* dec) {
+    while (have(dec, 1)) {
+        uint8_t len = dec->data[dec->pos++];
+        if (len == 0) {
+            return true;
+        }
+        if (!have(dec, len)) {
+            return false;
+        }
+        dec->pos += len;
+    }
+    return false;
+}
+
+/**
+ * @brief 读取扩展块（0x21 之后），图形控制扩展与 NETSCAPE 循环次数之外的全部跳过
+ */
+static bool readExtension(GifDecoder* dec) {
+    if (!have(dec, 1)) {
+        return false;
+    }
+    uint8_t label = dec->data[dec->pos++];
+
+    if (label == 0xF9 && have(dec, 6) && dec->data[dec->pos] == 4) {
+        const uint8_t* p = dec->data + dec->pos + 1;
+        dec->gceDisposal = (p[0] >> 2) & 7;
+        dec->gceTransparent = (p[0] & 1) != 0;
+        dec->gceDelayCs = le16(p + 1);
+        dec->gceTransIndex = p[3];
+        dec->pos += 5;
+    } else if (label == 0xFF && have(dec, 12) && dec->data[dec->pos] == 11 &&
+               memcmp(dec->data + dec->pos + 1, "NETSCAPE2.0", 11) == 0) {
+        dec->pos += 12;
+        if (have(dec, 4) && dec->data[dec->pos] == 3 && dec->data[dec->pos + 1] == 1 && dec->loopCount < 0) {
+            uint16_t n = le16(dec->data + dec->pos + 2);
+            dec->loopCount = (n == 0) ? 0 : n + 1;
+        }
+    }
+    return skipSubBlocks(dec);
+}
+
+// ============================================================
+// LZW 解码
+// ============================================================
+
+// 帧内像素写入位置（隔行扫描时按 8/8/4/2 四遍跳行）
+typedef struct {
+    uint16_t* canvas;
+    uint16_t canvasW, canvasH;
+    const uint16_t* palette;
+    int16_t transIndex;         // -1 表示不透明
+    uint16_t fx, fy, fw, fh;
+    uint16_t x, y;
+    uint8_t pass;               // 0 表示非隔行
+    uint32_t remaining;         // 尚未写入的像素数
+} PixelWriter;
+
+static void nextRow(PixelWriter* w) {
+    static const uint8_t start[5] = { 0, 0, 4, 2, 1 };
+    static const uint8_t step[5] = { 1, 8, 8, 4, 2 };
+    w->x = 0;
+    w->y += step[w->pass];
+    while (w->pass > 0 && w->pass < 4 && w->y >= w->fh) {
+        w->pass++;
+        w->y = start[w->pass];
+    }
+}
+
+static inline void putPixel(PixelWriter* w, uint8_t index) {
+    if (w->remaining == 0) {
+        return;
+    }
+    w->remaining--;
+    uint32_t cx = (uint32_t)w->fx + w->x;
+    uint32_t cy = (uint32_t)w->fy + w->y;
+    if ((int16_t)index != w->transIndex && cx < w->canvasW && cy < w->canvasH) {
+        w->canvas[cy * w->canvasW + cx] = w->palette[index];
+    }
+    if (++w->x >= w->fw) {
+        nextRow(w);
+    }
+}
+
+/**
+ * @brief 解码一幅图像的 LZW 数据（dec->pos 指向最小码长字节）
+ */
+static GifResult decodeImageData(GifDecoder* dec, PixelWriter* w) {
+    if (!have(dec, 1)) {
+        return GIF_ERR_DATA;
+    }
+    uint8_t minCodeSize = dec->data[dec->pos++];
+    if (minCodeSize < 2 || minCodeSize > 8) {
+        return GIF_ERR_DATA;
+    }
+
+    GifLzwTables* t = dec->lzw;
+    const uint16_t clearCode = 1 << minCodeSize;
+    const uint16_t endCode = clearCode + 1;
+    for (uint16_t i = 0; i < clearCode; i++) {
+        t->prefix[i] = 0xFFFF;
+        t->suffix[i] = (uint8_t)i;
+    }
+
+    uint8_t codeSize = minCodeSize + 1;
+    uint16_t codeMask = (1 << codeSize) - 1;
+    uint16_t next = endCode + 1;
+    int32_t old = -1;
+    uint8_t first = 0;
+
+    uint32_t bits = 0;
+    uint8_t bitCount = 0;
+    uint8_t blockLeft = 0;
+    bool ended = false;
+
+    while (!ended) {
+        // 补足一个码字的位数，跨子块读取
+        while (bitCount < codeSize) {
+            if (blockLeft == 0) {
+                if (!have(dec, 1)) {
+                    return GIF_OK;          // 文件被截断：已解出的像素保留（与浏览器一致）
+                }
+                blockLeft = dec->data[dec->pos++];
+                if (blockLeft == 0) {
+                    // 没有结束码就遇到终止块：已解出的像素保留
+                    return GIF_OK;
+                }
+                if (!have(dec, blockLeft)) {
+                    blockLeft = (uint8_t)(dec->size - dec->pos);
+                    if (blockLeft == 0) {
+                        return GIF_OK;
+                    }
+                }
+            }
+            bits |= (uint32_t)dec->data[dec->pos++] << bitCount;
+            bitCount += 8;
+            blockLeft--;
+        }
+        uint16_t code = bits & codeMask;
+        bits >>= codeSize;
+        bitCount -= codeSize;
+
+        if (code == clearCode) {
+            codeSize = minCodeSize + 1;
+            codeMask = (1 << codeSize) - 1;
+            next = endCode + 1;
+            old = -1;
+            continue;
+        }
+        if (code == endCode) {
+            ended = true;
+            break;
+        }
+        if (old < 0) {
+            if (code >= clearCode) {
+                return GIF_ERR_DATA;
+            }
+            first = (uint8_t)code;
+            putPixel(w, first);
+            old = code;
+            continue;
+        }
+
+        // 展开码字：后缀按逆序压栈
+        uint16_t in = code;
+        uint16_t sp = 0;
+        if (code >= next) {
+            if (code > next) {
+                return GIF_ERR_DATA;
+            }
+            t->stack[sp++] = first;         // KwKwK：新码字 = 旧串 + 旧串首字符
+            code = (uint16_t)old;
+        }
+        while (code >= clearCode) {
+            if (sp >= GIF_LZW_MAX_CODES - 1) {
+                return GIF_ERR_DATA;
+            }
+            t->stack[sp++] = t->suffix[code];
+            code = t->prefix[code];
+        }
+        first = t->suffix[code];
+        t->stack[sp++] = first;
+
+        if (next < GIF_LZW_MAX_CODES) {
+            t->prefix[next] = (uint16_t)old;
+            t->suffix[next] = first;
+            next++;
+            if (next > codeMask && codeSize < 12) {
+                codeSize++;
+                codeMask = (1 << codeSize) - 1;
+            }
+        }
+        old = in;
+
+        while (sp > 0) {
+            putPixel(w, t->stack[--sp]);
+        }
+    }
+
+    // 跳过结束码之后剩余的子块（截断时下一次 NextFrame 返回 GIF_DONE）
+    dec->pos += blockLeft;
+    if (!skipSubBlocks(dec)) {
+        dec->pos = dec->size;
+    }
+    return GIF_OK;
+}
+
+// ============================================================
+// 画布
+// ============================================================
+
+static void fillRect(GifDecoder* dec, const GifRect* r, uint16_t color) {
+    for (uint16_t y = 0; y < r->h; y++) {
+        uint16_t* row = dec->canvas + (size_t)(r->y + y) * dec->width + r->x;
+        for (uint16_t x = 0; x < r->w; x++) {
+            row[x] = color;
+        }
+    }
+}
+
+static void copyRect(GifDecoder* dec, const GifRect* r, uint16_t* from, uint16_t* to) {
+    for (uint16_t y = 0; y < r->h; y++) {
+        size_t off = (size_t)(r->y + y) * dec->width + r->x;
+        memcpy(to + off, from + off, (size_t)r->w * 2);
+    }
+}
+
+/**
+ * @brief 把帧矩形裁剪到画布内
+ */
+static GifRect clipRect(const GifDecoder* dec, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    GifRect r = { 0, 0, 0, 0 };
+    if (x >= dec->width || y >= dec->height) {
+        return r;
+    }
+    r.x = x;
+    r.y = y;
+    r.w = (x + w > dec->width) ? dec->width - x : w;
+    r.h = (y + h > dec->height) ? dec->height - y : h;
+    return r;
+}
+
+static void unionRect(GifRect* a, const GifRect* b) {
+    if (b->w == 0 || b->h == 0) {
+        return;
+    }
+    if (a->w == 0 || a->h == 0) {
+        *a = *b;
+        return;
+    }
+    uint16_t x0 = a->x < b->x ? a->x : b->x;
+    uint16_t y0 = a->y < b->y ? a->y : b->y;
+    uint16_t x1 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    uint16_t y1 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+    a->x = x0;
+    a->y = y0;
+    a->w = x1 - x0;
+    a->h = y1 - y0;
+}
+
+/**
+ * @brief 预扫描：数帧并读取循环次数，同时检查块结构完整
+ */
+static uint32_t countFrames(GifDecoder* dec) {
+    size_t saved = dec->pos;
+    uint32_t frames = 0;
+    while (have(dec, 1)) {
+        uint8_t sep = dec->data[dec->pos++];
+        if (sep == 0x21) {
+            if (!readExtension(dec)) {
+                break;
+            }
+        } else if (sep == 0x2C) {
+            if (!have(dec, 9)) {
+                break;
+            }
+            uint8_t flags = dec->data[dec->pos + 8];
+            dec->pos += 9;
+            if (flags & 0x80) {
+                dec->pos += 3u << ((flags & 7) + 1);
+            }
+            if (!have(dec, 1)) {
+                break;
+            }
+            dec->pos++;     // 最小码长
+            frames++;       // 数据被截断的最后一帧也算（显示已解出的部分）
+            if (!skipSubBlocks(dec)) {
+                break;
+            }
+        } else {
+            break;          // 0x3B 文件尾或无法识别的块
+        }
+    }
+    dec->pos = saved;
+    dec->gceDisposal = 0;
+    dec->gceTransparent = false;
+    dec->gceDelayCs = 0;
+    return frames;
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+GifResult GifCodec_Open(GifDecoder* dec, const uint8_t* data, size_t size, uint16_t bgColor) {
+    memset(dec, 0, sizeof(*dec));
+    dec->data = data;
+    dec->size = size;
+    dec->bgColor = bgColor;
+    dec->loopCount = -1;
+
+    if (size < 13 || memcmp(data, "GIF8", 4) != 0 || (data[4] != '7' && data[4] != '9') || data[5] != 'a') {
+        return GIF_ERR_FORMAT;
+    }
+    dec->width = le16(data + 6);
+    dec->height = le16(data + 8);
+    uint8_t flags = data[10];
+    dec->pos = 13;
+    if (dec->width == 0 || dec->height == 0) {
+        return GIF_ERR_FORMAT;
+    }
+    if ((uint32_t)dec->width * dec->height > GIF_MAX_CANVAS_PIXELS) {
+        return GIF_ERR_MEMORY;
+    }
+
+    dec->hasGct = (flags & 0x80) != 0;
+    if (dec->hasGct && !readPalette(dec, 2 << (flags & 7), dec->gct)) {
+        return GIF_ERR_FORMAT;
+    }
+    dec->animStart = dec->pos;
+    dec->frameCount = countFrames(dec);
+    if (dec->frameCount == 0) {
+        return GIF_ERR_DATA;
+    }
+
+    size_t pixels = (size_t)dec->width * dec->height;
+    dec->canvas = (uint16_t*)gifAlloc(pixels * 2);
+    dec->lzw = (GifLzwTables*)gifAlloc(sizeof(GifLzwTables));
+    if (dec->canvas == nullptr || dec->lzw == nullptr) {
+        GifCodec_Close(dec);
+        return GIF_ERR_MEMORY;
+    }
+    for (size_t i = 0; i < pixels; i++) {
+        dec->canvas[i] = bgColor;
+    }
+    return GIF_OK;
+}
+
+GifResult GifCodec_NextFrame(GifDecoder* dec, GifRect* dirty, uint32_t* delayMs) {
+    GifRect changed = { 0, 0, 0, 0 };
+
+    // 上一帧的处置方式
+    if (dec->prevDisposal == 2) {
+        fillRect(dec, &dec->prevRect, dec->bgColor);
+        changed = dec->prevRect;
+    } else if (dec->prevDisposal == 3 && dec->backup != nullptr) {
+        copyRect(dec, &dec->prevRect, dec->backup, dec->canvas);
+        changed = dec->prevRect;
+    }
+    dec->prevDisposal = 0;
+
+    while (have(dec, 1)) {
+        uint8_t sep = dec->data[dec->pos++];
+        if (sep == 0x21) {
+            if (!readExtension(dec)) {
+                return GIF_ERR_DATA;
+            }
+            continue;
+        }
+        if (sep == 0x3B) {
+            dec->pos--;             // 停在文件尾，重复调用都返回 GIF_DONE
+            *dirty = changed;
+            return GIF_DONE;
+        }
+        if (sep != 0x2C || !have(dec, 9)) {
+            return GIF_ERR_DATA;
+        }
+
+        // 图像描述符
+        const uint8_t* p = dec->data + dec->pos;
+        uint16_t fx = le16(p), fy = le16(p + 2), fw = le16(p + 4), fh = le16(p + 6);
+        uint8_t flags = p[8];
+        dec->pos += 9;
+
+        const uint16_t* palette = dec->gct;
+        if (flags & 0x80) {
+            if (!readPalette(dec, 2 << (flags & 7), dec->lct)) {
+                return GIF_ERR_DATA;
+            }
+            palette = dec->lct;
+        } else if (!dec->hasGct) {
+            return GIF_ERR_DATA;
+        }
+
+        GifRect rect = clipRect(dec, fx, fy, fw, fh);
+        uint8_t disposal = dec->gceDisposal;
+        if (disposal == 3 && rect.w > 0 && rect.h > 0) {
+            if (dec->backup == nullptr) {
+                dec->backup = (uint16_t*)gifAlloc((size_t)dec->width * dec->height * 2);
+            }
+            if (dec->backup != nullptr) {
+                copyRect(dec, &rect, dec->canvas, dec->backup);
+            }
+        }
+
+        PixelWriter w;
+        w.canvas = dec->canvas;
+        w.canvasW = dec->width;
+        w.canvasH = dec->height;
+        w.palette = palette;
+        w.transIndex = dec->gceTransparent ? dec->gceTransIndex : -1;
+        w.fx = fx;
+        w.fy = fy;
+        w.fw = fw;
+        w.fh = fh;
+        w.x = 0;
+        w.y = 0;
+        w.pass = (flags & 0x40) ? 1 : 0;
+        w.remaining = (uint32_t)fw * fh;
+
+        GifResult r;
+        if (w.remaining > 0) {
+            r = decodeImageData(dec, &w);
+        } else {
+            // 空帧：跳过最小码长与数据子块
+            dec->pos++;
+            r = skipSubBlocks(dec) ? GIF_OK : GIF_ERR_DATA;
+        }
+        if (r != GIF_OK) {
+            return r;
+        }
+
+        unionRect(&changed, &rect);
+        dec->prevDisposal = disposal;
+        dec->prevRect = rect;
+
+        uint16_t cs = dec->gceDelayCs;
+        *delayMs = (cs <= 1) ? 100 : (uint32_t)cs * 10;
+        *dirty = changed;
+
+        // 图形控制扩展只作用于紧随其后的一幅图像
+        dec->gceDisposal = 0;
+        dec->gceTransparent = false;
+        dec->gceDelayCs = 0;
+        dec->frameIndex++;
+        return GIF_OK;
+    }
+    // 没有文件尾标记就到了数据末尾（文件被截断），按文件尾处理
+    *dirty = changed;
+    return GIF_DONE;
+}
+
+void GifCodec_Rewind(GifDecoder* dec) {
+    dec->pos = dec->animStart;
+    dec->frameIndex = 0;
+    dec->gceDisposal = 0;
+    dec->gceTransparent = false;
+    dec->gceDelayCs = 0;
+
+    // 下一帧先把整个画布清成背景色，变化矩形随之覆盖整个画布
+    dec->prevDisposal = 2;
+    dec->prevRect.x = 0;
+    dec->prevRect.y = 0;
+    dec->prevRect.w = dec->width;
+    dec->prevRect.h = dec->height;
+}
+
+void GifCodec_Close(GifDecoder* dec) {
+    gifFree(dec->canvas);
+    gifFree(dec->backup);
+    gifFree(dec->lzw);
+    dec->canvas = nullptr;
+    dec->backup = nullptr;
+    dec->lzw = nullptr;
+}
+
+void GifCodec_SetReclaim(GifReclaimFunc reclaim) {
+    g_reclaim = reclaim;
+}
+
+const char* GifCodec_ResultName(GifResult r) {
+    switch (r) {
+        case GIF_OK:            return "成功";
+        case GIF_DONE:          return "已到文件尾";
+        case GIF_ERR_FORMAT:    return "不是 GIF 或文件头无效";
+        case GIF_ERR_DATA:      return "数据损坏";
+        case GIF_ERR_MEMORY:    return "内存不足";
+        default:                return "未知错误";
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// GIF 动画解码器
+// - GIF87a / GIF89a，全局 / 局部调色板，透明色，隔行扫描，处置方式 0~3，NETSCAPE 循环次数
+// - 逐帧解码到 RGB565 画布（逻辑屏幕尺寸），同时给出本帧相对上一帧变化的矩形，
+//   调用方只需把这块区域送到屏幕
+// - 画布、处置方式 3 的备份和 LZW 表都放 PSRAM（内部 RAM 留给 DMA 缓冲区）
+// - 输入为整个文件的内存映像（动画需要反复回到开头）
+// 不依赖 Arduino，可直接在 x86 Linux 上编译（tools/gif_bench.cpp）。
+// ============================================================
+#define GIF_MAX_CANVAS_PIXELS   (1024 * 1024)   // 画布上限（2 MB RGB565），超出返回 GIF_ERR_MEMORY
+#define GIF_LZW_MAX_CODES       4096
+
+// 解码结果
+enum GifResult {
+    GIF_OK = 0,
+    GIF_DONE,               // 已到文件尾（GifCodec_Rewind 后可以重新播放）
+    GIF_ERR_FORMAT,         // 不是 GIF 或文件头无效
+    GIF_ERR_DATA,           // 数据损坏或提前结束
+    GIF_ERR_MEMORY          // 内存不足或画布过大
+};
+
+// 屏幕上变化的矩形（画布坐标，w 或 h 为 0 表示没有变化）
+typedef struct {
+    uint16_t x, y, w, h;
+} GifRect;
+
+// LZW 表（约 12 KB，PSRAM）
+typedef struct {
+    uint16_t prefix[GIF_LZW_MAX_CODES];
+    uint8_t suffix[GIF_LZW_MAX_CODES];
+    uint8_t stack[GIF_LZW_MAX_CODES];
+} GifLzwTables;
+
+// 解码器状态（调用方分配，缓冲区由 Open/Close 管理）
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    size_t animStart;           // 第一个块的位置（循环播放时回到这里）
+
+    uint16_t width, height;     // 逻辑屏幕尺寸 = 画布尺寸
+    uint16_t* canvas;           // width × height RGB565
+    uint16_t* backup;           // 处置方式 3 时保存被覆盖的区域（按需分配）
+    GifLzwTables* lzw;
+    uint16_t bgColor;           // 初始画布与处置方式 2 的填充色（透明处理，与浏览器一致）
+
+    uint16_t gct[256];          // 全局调色板（RGB565）
+    uint16_t lct[256];          // 局部调色板
+    bool hasGct;
+
+    int32_t loopCount;          // NETSCAPE 循环次数：0 无限，n 为总播放遍数，-1 没有该扩展（播放一遍）
+    uint32_t frameCount;        // 打开时预扫描得到的帧数
+    uint32_t frameIndex;        // 下一帧的序号
+
+    // 下一帧的图形控制扩展
+    uint8_t gceDisposal;
+    bool gceTransparent;
+    uint8_t gceTransIndex;
+    uint16_t gceDelayCs;
+
+    // 上一帧：下一帧开始前按它的处置方式恢复画布
+    uint8_t prevDisposal;
+    GifRect prevRect;
+} GifDecoder;
+
+/**
+ * @brief 打开 GIF 并分配画布（初始为背景色）
+ * @param data,size 整个文件（解码期间须保持有效）
+ * @param bgColor   RGB565 背景色
+ */
+GifResult GifCodec_Open(GifDecoder* dec, const uint8_t* data, size_t size, uint16_t bgColor);
+
+/**
+ * @brief 解码下一帧到画布
+ * @param dirty   本帧变化的矩形（含上一帧的处置区域）
+ * @param delayMs 本帧应停留的时间（延迟为 0 或 1 时按 100 ms，与浏览器一致）
+ * @return GIF_OK 一帧；GIF_DONE 到达文件尾（画布不变）
+ */
+GifResult GifCodec_NextFrame(GifDecoder* dec, GifRect* dirty, uint32_t* delayMs);
+
+/**
+ * @brief 回到第一帧；画布清成背景色，下一次 NextFrame 的变化矩形覆盖整个画布
+ */
+void GifCodec_Rewind(GifDecoder* dec);
+
+/**
+ * @brief 释放画布、备份与 LZW 表
+ */
+void GifCodec_Close(GifDecoder* dec);
+
+/**
+ * @brief 设置内存回收回调（全局，nullptr 取消）：画布、备份、LZW 表分配失败时调用一次，
+ *        返回 true（已腾出 bytes 字节的连续空间）则重试该次分配
+ */
+typedef bool (*GifReclaimFunc)(size_t bytes);
+void GifCodec_SetReclaim(GifReclaimFunc reclaim);
+
+const char* GifCodec_ResultName(GifResult r);
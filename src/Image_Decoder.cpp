@@ -16,7 +16,22 @@
 #include "Image_Decoder.h"
 #include "Display_ST7789.h"
 #include "ColorTemp_Filter.h"  // 色温滤镜模块
+#include "Frame_Cache.h"       // 解码帧 LRU 缓存
+#include "Image_Prefetch.h"    // 后台预解码
+#include "SD_Stream.h"         // JPEG 流式读取
+#include "Pixel_Convert.h"     // BMP 行转换内核
+#include "R565_Format.h"       // .r565 原始像素格式
+#include "Image_Transcode.h"   // 后台转码为 .r565
+#include "Image_Registry.h"    // 解码后端注册表
+#include "MJPEG_Container.h"   // MJPEG 片段容器（读取 AVI 头）
+#include "MJPEG_Player.h"      // MJPEG 片段播放
+#include "Image_Metrics.h"     // 加载耗时统计
+#include "Image_Strip.h"       // 条带拼接
+#include "Log_Ring.h"          // 分级日志
+#include "Gyro_QMI8658.h"      // 加速度计（跟随设备方向）
 #include <esp_heap_caps.h>
+#include <new>
+#include <Preferences.h>
 
 // ============================================================================
 // 全局变量定义
@@ -30,6 +45,91 @@ static uint16_t* g_imageBuffer = nullptr;
 static uint16_t g_bufferWidth = 0;
 static uint16_t g_bufferHeight = 0;
 
+// 输出模式：合成模式下解码器只写 imageBuffer，完成后整帧写屏
+static ImageOutputMode g_outputMode = IMG_OUTPUT_COMPOSE;
+
+// 当前解码对应的帧缓存键（由 loadAndDisplayImage 设置，合成完成后写入缓存）
+static bool g_cacheKeyValid = false;
+static const char* g_cachePath = nullptr;
+static uint32_t g_cacheMtime = 0;
+static uint32_t g_cacheSize = 0;
+
+// 合成完成后是否立即写屏（后台预解码时为 false）
+static bool g_presentOnEnd = true;
+
+// 后台预解码的取消标志（前台解码时为 nullptr）
+static volatile bool* g_cancel = nullptr;
+
+// 解码互斥锁：loop 与预取任务共用 TJpgDec、条带和合成目标等全局状态
+static SemaphoreHandle_t g_decodeMutex = nullptr;
+
+// 内置 JPEG 解码器状态（约 12 KB，放内部 RAM）
+static JpegDecoder* g_jpegDecoder = nullptr;
+
+// 最近一次 JPEG 基准测试结果
+static JpegBenchResult g_lastBench = { false };
+
+// 最近一次 BMP 像素转换基准测试结果
+static PixelBenchResult g_lastPixelBench;
+static AnimationGateResult g_lastAnimationGate = { false };
+static bool g_pixelBenchValid = false;
+
+// JPEG 读取方式；g_streamReady 为 false 时（缓冲区分配失败）总是整文件读取
+static JpegLoadMode g_jpegLoadMode = JPEG_LOAD_MODE_DEFAULT;
+static bool g_streamReady = false;
+
+// 首像素计时：drawBlock 第一次被调用时记下距 g_loadStartUs 的时间
+static uint32_t g_loadStartUs = 0;
+static uint32_t g_firstPixelUs = 0;
+static bool g_firstPixelSeen = false;
+static JpegLoadTiming g_lastLoadTiming = { false };
+
+// 内置解码后端（定义在“解码后端”一节）
+static void registerImageBackends();
+
+// 缩放模式：全局默认值与单张图片的设置（NVS 持久化）
+static ImageScaleMode g_scaleMode = IMG_SCALE_MODE_DEFAULT;
+static Preferences g_scalePrefs;
+static bool g_scalePrefsReady = false;
+
+// 显示方向：设置（NVS 持久化，与缩放模式同一命名空间）与加速度计跟踪
+static ImageRotationMode g_rotateMode = IMG_ROTATE_MODE_DEFAULT;
+static bool g_exifEnabled = IMG_ROTATE_EXIF_DEFAULT;
+static ImageOrientTracker g_imuTracker;
+static uint32_t g_imuPollMs = 0;
+
+// 合成目标中这一帧的方向标记（g_bufferWidth / g_bufferHeight 随之互换）
+static uint8_t g_orient = 0;
+// 正在解码的图片的 EXIF 方向变换（decodeImageFile 设置）
+static uint8_t g_exifXform = 0;
+// ≥ 0 时 imageLayoutBegin 直接使用这个方向标记（转码缓存已按它渲染好）
+static int16_t g_orientPreset = -1;
+static void setFrameOrientation(uint8_t orient);
+
+// 屏幕内容副本（差异上传与切换过渡共用）：g_shownValid 为 false 时屏幕已被其他输出改写
+static ImageTransitionType g_transitionType = IMG_TRANSITION_DEFAULT;
+static uint16_t g_transitionMs = IMG_TRANSITION_MS_DEFAULT;
+static uint16_t* g_shownFrame = nullptr;
+static uint8_t g_shownOrient = 0;
+static bool g_shownValid = false;
+static ImageTransitionStats g_transitionStats = { false };
+
+// 当前图片的摆放；g_scaling 为 true 时解码输出先经过缩放器
+static ImageLayout g_layout;
+static ImageScaler g_scaler;
+static bool g_scaling = false;
+
+#if JPEG_PIPELINE_STRIPS > 0
+// JPEG 条带流水线状态（仅在 displayJPEG 期间有效）
+static uint16_t* g_stripBuf[JPEG_PIPELINE_STRIPS] = { nullptr };
+static ImageStrip g_strip;
+static bool g_pipelineActive = false;
+#endif
+
+#if JPEG_TRACE_RECORD
+static File g_traceFile;               // 正在录制的 TJpgDec 回调序列
+#endif
+
 // ============================================================================
 // 初始化函数
 // ============================================================================
@@ -50,6 +150,9 @@ void initImageDecoder() {
         return;
     }
     
+    // 格式识别只依赖注册表，先于缓冲区分配完成
+    registerImageBackends();
+    
     Serial.printf("正在分配图片缓冲区: %d 字节 (%.2f KB)\n", 
                   IMG_BUFFER_SIZE, IMG_BUFFER_SIZE / 1024.0);
     
@@ -74,594 +177,3563 @@ void initImageDecoder() {
         Serial.println("✓ 图片缓冲区已成功分配到 PSRAM");
     }
     
+    g_decodeMutex = xSemaphoreCreateMutex();
+    ImageMetrics_Init();
+    
+#if JPEG_DECODER_BACKEND == JPEG_BACKEND_NATIVE
+    g_jpegDecoder = (JpegDecoder*)heap_caps_malloc(sizeof(JpegDecoder), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (g_jpegDecoder == nullptr) {
+        g_jpegDecoder = (JpegDecoder*)heap_caps_malloc(sizeof(JpegDecoder), MALLOC_CAP_SPIRAM);
+    }
+    if (g_jpegDecoder == nullptr) {
+        Serial.println("⚠️ 内置 JPEG 解码器分配失败，使用 TJpgDec");
+    }
+#endif
+    
     // 初始化全局变量
     g_imageBuffer = imageBuffer;
-    g_bufferWidth = LCD_WIDTH;
-    g_bufferHeight = LCD_HEIGHT;
+    setFrameOrientation(0);
+    
+#if JPEG_PIPELINE_STRIPS > 0
+    // 条带缓冲区要被 SPI 直接发送，放在内部 DMA 内存（按横屏的行宽分配）
+    for (int i = 0; i < JPEG_PIPELINE_STRIPS; i++) {
+        g_stripBuf[i] = (uint16_t*)heap_caps_malloc(LCD_LONG_SIDE * JPEG_STRIP_LINES * 2,
+                                                     MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (g_stripBuf[i] == nullptr) {
+            Serial.println("⚠️ JPEG 条带缓冲区分配失败，使用逐块同步写屏");
+            for (int j = 0; j < i; j++) {
+                free(g_stripBuf[j]);
+                g_stripBuf[j] = nullptr;
+            }
+            break;
+        }
+    }
+#endif
+    
+    // 缩放模式设置
+    g_scalePrefsReady = g_scalePrefs.begin("scale", false);
+    if (g_scalePrefsReady) {
+        uint8_t mode = g_scalePrefs.getUChar("default", IMG_SCALE_MODE_DEFAULT);
+        g_scaleMode = mode <= IMG_SCALE_CENTER ? (ImageScaleMode)mode : IMG_SCALE_MODE_DEFAULT;
+    }
+    Serial.printf("✓ 缩放模式: %s\n", ImageScaler_ModeName(g_scaleMode));
+    
+    // 显示方向设置
+    if (g_scalePrefsReady) {
+        uint8_t mode = g_scalePrefs.getUChar("rotate", IMG_ROTATE_MODE_DEFAULT);
+        g_rotateMode = mode <= IMG_ROTATE_IMU ? (ImageRotationMode)mode : IMG_ROTATE_MODE_DEFAULT;
+        g_exifEnabled = g_scalePrefs.getBool("exif", IMG_ROTATE_EXIF_DEFAULT);
+    }
+    ImageOrient_TrackerInit(&g_imuTracker, 0);
+    Serial.printf("✓ 显示方向: %s%s\n", getImageRotationModeName(g_rotateMode), g_exifEnabled ? "（按 EXIF 摆正）" : "");
+    
+    // 屏幕内容副本只放 PSRAM，分配失败时总是整帧写屏、直接切换
+    if (g_scalePrefsReady) {
+        uint8_t type = g_scalePrefs.getUChar("trans", IMG_TRANSITION_DEFAULT);
+        g_transitionType = type <= IMG_TRANSITION_SLIDE ? (ImageTransitionType)type : IMG_TRANSITION_DEFAULT;
+        g_transitionMs = g_scalePrefs.getUShort("transms", IMG_TRANSITION_MS_DEFAULT);
+        if (g_transitionMs > IMG_TRANSITION_MS_MAX) {
+            g_transitionMs = IMG_TRANSITION_MS_DEFAULT;
+        }
+    }
+    g_shownFrame = (uint16_t*)heap_caps_malloc(IMG_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    if (g_shownFrame == nullptr) {
+        Serial.println("⚠️ 屏幕副本分配失败，整帧写屏且不做过渡");
+    } else {
+        Serial.printf("✓ 切换过渡: %s %u ms\n", ImageTransition_Name(g_transitionType), g_transitionMs);
+    }
+    
+    // JPEG 流式读取（读卡任务在核心 0）
+    g_streamReady = SdStream_Init();
+    if (!g_streamReady) {
+        Serial.println("⚠️ 流式读取不可用，JPEG 使用整文件读取");
+    }
+    
+    // 帧缓存依赖合成模式的 imageBuffer
+    FrameCache_Init();
+    // 渐进式系数平面与帧缓存共用 PSRAM：分配失败时先淘汰缓存帧
+    JpegCodec_SetReclaim(FrameCache_Trim);
+    GifCodec_SetReclaim(FrameCache_Trim);
     
     Serial.println("✓ 图片解码器初始化完成");
 }
 
 // ============================================================================
-// 格式识别函数
+// 合成模式（compose then blit）
+// ============================================================================
+
+void setImageOutputMode(ImageOutputMode mode) {
+    g_outputMode = mode;
+}
+
+ImageOutputMode getImageOutputMode() {
+    return g_outputMode;
+}
+
+// ============================================================================
+// JPEG 读取方式
+// ============================================================================
+
+void setJpegLoadMode(JpegLoadMode mode) {
+    g_jpegLoadMode = mode;
+    Serial.printf("✓ JPEG 读取方式: %s\n", mode == JPEG_LOAD_STREAM ? "流式" : "整文件");
+}
+
+JpegLoadMode getJpegLoadMode() {
+    return g_jpegLoadMode;
+}
+
+bool getLastJpegLoadTiming(JpegLoadTiming* timing) {
+    if (timing == nullptr || !g_lastLoadTiming.valid) {
+        return false;
+    }
+    *timing = g_lastLoadTiming;
+    return true;
+}
+
+// ============================================================================
+// 加载统计（打开 / 读卡 / 滤镜计时，见 Image_Metrics.h）
 // ============================================================================
 
 /**
- * @brief 获取图片格式
- * @param filename 文件名（完整路径）
- * @return ImageFormat 图片格式枚举
- * 
- * 🔧 【核心修复 2】：修复后缀识别漏洞
- * - 使用 strcasecmp 不区分大小写比较
- * - 同时支持 .jpg 和 .jpeg（它们是同一种格式）
- * - 支持大小写混合（.JPG, .Jpg, .jpg 等）
+ * @brief 打开文件（只读），计入打开耗时
  */
-ImageFormat getImageFormat(const char* filename) {
-    if (filename == nullptr) {
-        Serial.println("✗ 文件名为空");
-        return IMG_UNKNOWN;
+static File openImageFile(const char* path) {
+    uint32_t t0 = micros();
+    File f = SD_MMC.open(path, FILE_READ);
+    ImageMetrics_AddOpen(micros() - t0);
+    return f;
+}
+
+/**
+ * @brief 同步读卡，计入读卡字节数与耗时
+ */
+static size_t readImageFile(File& f, uint8_t* buf, size_t len) {
+    uint32_t t0 = micros();
+    size_t n = f.read(buf, len);
+    uint32_t us = micros() - t0;
+    ImageMetrics_AddRead(n, us, us);
+    return n;
+}
+
+/**
+ * @brief 应用色温滤镜，计入滤镜耗时（调用方已判断色温不是默认值）
+ */
+static void filterPixels(uint16_t* pixels, uint32_t count) {
+    uint32_t t0 = micros();
+    applyColorTemperature(pixels, count);
+    ImageMetrics_AddFilter(micros() - t0);
+}
+
+// ============================================================================
+// 缩放模式
+// ============================================================================
+
+/**
+ * @brief 单张图片设置在 NVS 中的键（NVS 键最长 15 字符，用路径的 FNV-1a 哈希）
+ */
+static void scaleModeKey(const char* filename, char* key, size_t len) {
+    uint32_t h = 2166136261u;
+    for (const char* p = filename; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
     }
-    
-    // 查找最后一个点号（文件扩展名）
-    const char* ext = strrchr(filename, '.');
-    if (ext == nullptr) {
-        Serial.printf("✗ 文件名没有扩展名: %s\n", filename);
-        return IMG_UNKNOWN;
+    snprintf(key, len, "f%08lx", (unsigned long)h);
+}
+
+/**
+ * @brief 解码时实际使用的模式：单张设置优先，否则用全局默认
+ */
+static ImageScaleMode resolveScaleMode(const char* filename) {
+    ImageScaleMode mode = getImageScaleModeFor(filename);
+    return mode == IMG_SCALE_DEFAULT ? g_scaleMode : mode;
+}
+
+void setImageScaleMode(ImageScaleMode mode) {
+    if (mode > IMG_SCALE_CENTER) {
+        mode = IMG_SCALE_MODE_DEFAULT;
     }
-    
-    // 🔧 【核心修复】：使用 strcasecmp 不区分大小写比较
-    // 同时支持 .jpg 和 .jpeg（JPEG 格式的两种常见扩展名）
-    if (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0) {
-        return IMG_JPEG;
-    } else if (strcasecmp(ext, ".png") == 0) {
-        return IMG_PNG;
-    } else if (strcasecmp(ext, ".bmp") == 0) {
-        return IMG_BMP;
+    xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
+    if (mode != g_scaleMode) {
+        g_scaleMode = mode;
+        if (g_scalePrefsReady) {
+            g_scalePrefs.putUChar("default", mode);
+        }
+        // 缓存帧是按旧模式渲染的
+        FrameCache_Clear();
+        Prefetch_Discard();
     }
-    
-    Serial.printf("✗ 不支持的文件格式: %s\n", ext);
-    return IMG_UNKNOWN;
+    xSemaphoreGive(g_decodeMutex);
+    Serial.printf("✓ 默认缩放模式: %s\n", ImageScaler_ModeName(mode));
+}
+
+ImageScaleMode getImageScaleMode() {
+    return g_scaleMode;
+}
+
+void setImageScaleModeFor(const char* filename, ImageScaleMode mode) {
+    if (filename == nullptr || !g_scalePrefsReady) {
+        return;
+    }
+    char key[16];
+    scaleModeKey(filename, key, sizeof(key));
+
+    xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
+    if (mode > IMG_SCALE_CENTER) {
+        g_scalePrefs.remove(key);
+    } else {
+        g_scalePrefs.putUChar(key, mode);
+    }
+    FrameCache_Invalidate(filename);
+    Prefetch_Discard();
+    xSemaphoreGive(g_decodeMutex);
+    Serial.printf("✓ %s 缩放模式: %s\n", filename, ImageScaler_ModeName(mode));
+}
+
+ImageScaleMode getImageScaleModeFor(const char* filename) {
+    if (filename == nullptr || !g_scalePrefsReady) {
+        return IMG_SCALE_DEFAULT;
+    }
+    char key[16];
+    scaleModeKey(filename, key, sizeof(key));
+    if (!g_scalePrefs.isKey(key)) {
+        return IMG_SCALE_DEFAULT;
+    }
+    uint8_t mode = g_scalePrefs.getUChar(key, IMG_SCALE_DEFAULT);
+    return mode <= IMG_SCALE_CENTER ? (ImageScaleMode)mode : IMG_SCALE_DEFAULT;
 }
 
 // ============================================================================
-// JPEG 解码相关函数
+// 显示方向
 // ============================================================================
 
+void setImageRotationMode(ImageRotationMode mode) {
+    if (mode > IMG_ROTATE_IMU) {
+        mode = IMG_ROTATE_MODE_DEFAULT;
+    }
+    xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
+    if (mode != g_rotateMode) {
+        g_rotateMode = mode;
+        if (g_scalePrefsReady) {
+            g_scalePrefs.putUChar("rotate", mode);
+        }
+        // 切到跟随加速度计时从竖屏开始，之后由 serviceImageOrientation 更新
+        ImageOrient_TrackerInit(&g_imuTracker, 0);
+    }
+    xSemaphoreGive(g_decodeMutex);
+    Serial.printf("✓ 显示方向: %s\n", getImageRotationModeName(mode));
+}
+
+ImageRotationMode getImageRotationMode() {
+    return g_rotateMode;
+}
+
+void setImageExifOrientation(bool enabled) {
+    xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
+    if (enabled != g_exifEnabled) {
+        g_exifEnabled = enabled;
+        if (g_scalePrefsReady) {
+            g_scalePrefs.putBool("exif", enabled);
+        }
+    }
+    xSemaphoreGive(g_decodeMutex);
+    Serial.printf("✓ EXIF 方向: %s\n", enabled ? "启用" : "忽略");
+}
+
+bool getImageExifOrientation() {
+    return g_exifEnabled;
+}
+
+static const char* const g_rotateModeNames[] = { "0", "90", "180", "270", "auto", "imu" };
+
+const char* getImageRotationModeName(ImageRotationMode mode) {
+    return mode <= IMG_ROTATE_IMU ? g_rotateModeNames[mode] : "unknown";
+}
+
+bool parseImageRotationMode(const char* name, ImageRotationMode* mode) {
+    for (uint8_t i = 0; i <= IMG_ROTATE_IMU; i++) {
+        if (strcasecmp(name, g_rotateModeNames[i]) == 0) {
+            *mode = (ImageRotationMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t getImageDeviceTurns() {
+    return g_imuTracker.turns;
+}
+
 /**
- * @brief JPEG 解码回调函数
- * @param x 起始 X 坐标
- * @param y 起始 Y 坐标
- * @param w 宽度
- * @param h 高度
- * @param bitmap 位图数据（RGB565 格式）
- * @return true 成功，false 失败
- * 
- * @details TJpgDec 库会将解码后的数据分块传递给这个回调函数
- *          我们需要将数据写入 ST7789 屏幕
+ * @brief 跟随加速度计时按 IMG_IMU_POLL_MS 采样（Accel 由 DriverTask 更新）
+ * @return true 设备方向（防抖后）发生变化
  */
-bool jpegDrawCallback(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap) {
-    // 边界检查
-    if (x < 0 || y < 0 || x + w > LCD_WIDTH || y + h > LCD_HEIGHT) {
-        Serial.printf("⚠️ JPEG 回调：坐标超出屏幕范围 (%d,%d,%d,%d)\n", x, y, w, h);
+bool serviceImageOrientation() {
+    if (g_rotateMode != IMG_ROTATE_IMU) {
         return false;
     }
-    
-    // 🎨 应用色温滤镜（如果色温不为默认值）
-    if (currentColorTemp != COLOR_TEMP_DEFAULT) {
-        applyColorTemperature(bitmap, w * h);
+    uint32_t now = millis();
+    if (now - g_imuPollMs < IMG_IMU_POLL_MS) {
+        return false;
     }
+    g_imuPollMs = now;
     
-    // 设置显示窗口
-    LCD_SetCursor(x, y, x + w - 1, y + h - 1);
-    
-    // 写入位图数据到屏幕
-    // bitmap 已经是 RGB565 格式，可以直接写入
-    LCD_WriteData_nbyte((uint8_t*)bitmap, NULL, w * h * 2);
-    
+    IMUdata a = Accel;
+    if (!ImageOrient_TrackGravity(&g_imuTracker, IMG_IMU_UP_X(a), IMG_IMU_UP_Y(a), now)) {
+        return false;
+    }
+    LOG_I("↻ 设备方向: %d°\n", g_imuTracker.turns * 90);
     return true;
 }
 
 /**
- * @brief 显示 JPEG 图片
- * @param filename 文件路径
- * @return true 成功，false 失败
+ * @brief 当前视角键：同一文件在视角键相同时渲染结果相同（缓存按它区分）
+ */
+uint8_t getImageViewKey() {
+    uint8_t key = g_exifEnabled ? IMAGE_ORIENT_VIEW_EXIF : 0;
+    switch (g_rotateMode) {
+        case IMG_ROTATE_AUTO:   return key | IMAGE_ORIENT_VIEW_AUTO;
+        case IMG_ROTATE_IMU:    return key | g_imuTracker.turns;
+        default:                return key | (uint8_t)g_rotateMode;
+    }
+}
+
+/**
+ * @brief 计算一张图片的方向标记
+ * @param width,height 存储的像素尺寸
+ * @param exifXform    EXIF 方向变换（没有时为 0）
  * 
- * @details 
- * 1. 将整个 JPEG 文件读入 PSRAM
- * 2. 关闭文件，释放 SD 卡总线
- * 3. 从内存解码并显示
- * 4. 释放内存
+ * @details 先按 EXIF 摆正；自动模式下摆正后为横图时转成横屏，
+ *          其他模式按固定方向或设备方向旋转
  */
-bool displayJPEG(const char* filename) {
-    Serial.printf("\n--- 开始加载 JPEG 图片 ---\n");
-    Serial.printf("文件路径: %s\n", filename);
-    
-    // 检查文件是否存在
-    if (!SD_MMC.exists(filename)) {
-        Serial.printf("✗ 文件不存在: %s\n", filename);
-        return false;
+uint8_t resolveImageOrientation(uint16_t width, uint16_t height, uint8_t exifXform) {
+    uint8_t view = getImageViewKey();
+    uint8_t exif = (view & IMAGE_ORIENT_VIEW_EXIF) ? (exifXform & IMAGE_ORIENT_XFORM_MASK) : 0;
+    
+    uint8_t turns = view & IMAGE_ORIENT_VIEW_TURNS;
+    if (view & IMAGE_ORIENT_VIEW_AUTO) {
+        bool swapped = exif & IMAGE_ORIENT_MV;
+        uint16_t uprightW = swapped ? height : width;
+        uint16_t uprightH = swapped ? width : height;
+        bool panelPortrait = LCD_WIDTH < LCD_HEIGHT;
+        bool imagePortrait = uprightW < uprightH;
+        turns = (uprightW != uprightH && imagePortrait != panelPortrait) ? IMG_ROTATE_AUTO_TURNS : 0;
     }
-    
-    // 打开文件
-    File jpegFile = SD_MMC.open(filename, FILE_READ);
-    if (!jpegFile) {
-        Serial.printf("✗ 无法打开文件: %s\n", filename);
-        return false;
+    return ImageOrient_Compose(exif, ImageOrient_FromTurns(turns)) | view;
+}
+
+// ============================================================================
+// 切换过渡
+// ============================================================================
+
+void setImageTransition(ImageTransitionType type, uint16_t durationMs) {
+    if (type > IMG_TRANSITION_SLIDE) {
+        type = IMG_TRANSITION_DEFAULT;
     }
-    
-    size_t fileSize = jpegFile.size();
-    Serial.printf("文件大小: %d 字节 (%.2f KB)\n", fileSize, fileSize / 1024.0);
-    
-    // 🔧 【核心修复 3】：优先使用 PSRAM 分配文件缓冲区
-    uint8_t* jpegBuffer = (uint8_t*)heap_caps_malloc(fileSize, MALLOC_CAP_SPIRAM);
-    if (jpegBuffer == nullptr) {
-        // PSRAM 分配失败，尝试使用内部 RAM
-        Serial.println("⚠️ PSRAM 分配失败，尝试使用内部 RAM");
-        jpegBuffer = (uint8_t*)malloc(fileSize);
-        if (jpegBuffer == nullptr) {
-            Serial.println("✗ 无法分配 JPEG 文件缓冲区");
-            jpegFile.close();
-            return false;
-        }
+    if (durationMs > IMG_TRANSITION_MS_MAX) {
+        durationMs = IMG_TRANSITION_MS_MAX;
     }
-    
-    // 读取整个文件到内存
-    size_t bytesRead = jpegFile.read(jpegBuffer, fileSize);
-    jpegFile.close(); // 🔧 【关键】立即关闭文件，释放 SD 卡总线
-    
-    if (bytesRead != fileSize) {
-        Serial.printf("✗ 文件读取失败 (期望 %d 字节, 实际 %d 字节)\n", fileSize, bytesRead);
-        free(jpegBuffer);
-        return false;
+    xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
+    g_transitionType = type;
+    g_transitionMs = durationMs;
+    if (g_scalePrefsReady) {
+        g_scalePrefs.putUChar("trans", type);
+        g_scalePrefs.putUShort("transms", durationMs);
     }
-    
-    Serial.println("✓ JPEG 文件已完整读入内存，SD 卡总线已释放");
-    
-    // 配置 TJpgDec 解码器
-    TJpgDec.setJpgScale(1);  // 不缩放（1:1 显示）
-    TJpgDec.setCallback(jpegDrawCallback);
-    
-    // 从内存解码并显示
-    Serial.println("开始解码 JPEG...");
-    int result = TJpgDec.drawJpg(0, 0, jpegBuffer, fileSize);
-    
-    // 释放内存
-    free(jpegBuffer);
-    
-    if (result == 0) {
-        Serial.println("✓ JPEG 图片显示完成");
-        Serial.println("--- JPEG 加载结束 ---\n");
-        return true;
-    } else {
-        Serial.printf("✗ JPEG 解码失败，错误码: %d\n", result);
+    xSemaphoreGive(g_decodeMutex);
+    Serial.printf("✓ 切换过渡: %s %u ms\n", ImageTransition_Name(type), durationMs);
+}
+
+ImageTransitionType getImageTransitionType() {
+    return g_transitionType;
+}
+
+uint16_t getImageTransitionMs() {
+    return g_transitionMs;
+}
+
+bool getImageTransitionStats(ImageTransitionStats* stats) {
+    if (stats == nullptr || !g_transitionStats.valid) {
         return false;
     }
+    *stats = g_transitionStats;
+    return true;
 }
 
-// ============================================================================
-// PNG 解码相关函数
-// ============================================================================
+/**
+ * @brief 屏幕被 presentImageBuffer 以外的输出改写（动画帧、直接写屏、渐进式预览、LVGL 界面），下一张直接切换
+ */
+void invalidateShownFrame() {
+    g_shownValid = false;
+}
 
 /**
- * @brief PNG 解码回调函数
- * @param pDraw PNG 绘制结构体
- * @return 0 成功
+ * @brief 把新帧中的一块区域同步到屏幕内容副本
+ */
+static void updateShownFrame(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    for (uint16_t k = 0; k < h; k++) {
+        size_t offset = (size_t)(y + k) * g_bufferWidth + x;
+        memcpy(g_shownFrame + offset, g_imageBuffer + offset, (size_t)w * 2);
+    }
+}
+
+/**
+ * @brief 实测写屏带宽（字节 / 毫秒），还没有写过屏时返回 0（由过渡模块按 SPI 时钟估算）
+ */
+static uint32_t lcdBytesPerMs() {
+    LCD_TransferStats s;
+    LCD_GetTransferStats(&s);
+    return s.busyUs > 0 ? (uint32_t)((uint64_t)s.bytes * 1000 / s.busyUs) : 0;
+}
+
+/**
+ * @brief 从屏幕上的帧过渡到合成好的 imageBuffer
+ * @return false 不能过渡（调用方整帧写屏）；两帧相同时什么也不发送，返回 true
  * 
- * @details PNGdec 库会将解码后的数据逐行传递给这个回调函数
- *          数据格式已经是 RGB565，可以直接写入屏幕
+ * @details 
+ * - 第 k 步的预定时间为 (k − 1) × stepUs；写屏落后时直接跳到当前时间对应的步，总时长不变
+ * - 每步的矩形按 JPEG_STRIP_LINES 行左右分批，轮流填进条带缓冲区异步发送，
+ *   填下一批的同时上一批在传输（在途数量达到条带数时等待最早一笔）
  */
-int pngDrawCallback(PNGDRAW* pDraw) {
-    uint16_t* pPixels = (uint16_t*)pDraw->pPixels;
-    uint16_t y = pDraw->y;
-    uint16_t w = pDraw->iWidth;
-    uint16_t h = 1;  // PNGdec 每次传递一行
-    
-    // 边界检查
-    if (y >= LCD_HEIGHT || w > LCD_WIDTH) {
-        Serial.printf("⚠️ PNG 回调：坐标超出屏幕范围 (y=%d, w=%d)\n", y, w);
-        return 0;
+static bool presentWithTransition() {
+#if JPEG_PIPELINE_STRIPS > 0
+    if (g_transitionType == IMG_TRANSITION_CUT || !g_shownValid || g_stripBuf[0] == nullptr ||
+        (g_orient & IMAGE_ORIENT_XFORM_MASK) != g_shownOrient) {
+        return false;
     }
     
-    // 🎨 应用色温滤镜（如果色温不为默认值）
-    if (currentColorTemp != COLOR_TEMP_DEFAULT) {
-        applyColorTemperature(pPixels, w);
+    ImageTransition t;
+    if (!ImageTransition_Plan(&t, g_transitionType, g_shownFrame, g_imageBuffer, g_bufferWidth, g_bufferHeight,
+                              g_transitionMs, IMG_TRANSITION_FPS, lcdBytesPerMs())) {
+        return true;
     }
     
-    // 设置显示窗口（一行）
-    LCD_SetCursor(0, y, w - 1, y);
-    
-    // 写入像素数据
-    LCD_WriteData_nbyte((uint8_t*)pPixels, NULL, w * 2);
+    ImageTransitionStats& s = g_transitionStats;
+    memset(&s, 0, sizeof(s));
+    s.type = t.type;
+    s.durationMs = g_transitionMs;
+    s.plannedSteps = t.steps;
+    s.estStepUs = t.estStepUs;
+    s.diffX = t.diff.x;
+    s.diffY = t.diff.y;
+    s.diffW = t.diff.w;
+    s.diffH = t.diff.h;
+    
+    LCD_Async_WaitAll();
+    uint8_t band = 0;
+    uint16_t shown = 0;
+    uint32_t startUs = micros();
+    while (shown < t.steps) {
+        uint32_t elapsed = micros() - startUs;
+        uint32_t due = (uint32_t)shown * t.stepUs;
+        if (elapsed + 1000 <= due) {
+            vTaskDelay(pdMS_TO_TICKS((due - elapsed) / 1000));
+            continue;
+        }
+        uint16_t step = shown + 1;
+        if (t.stepUs > 0 && elapsed / t.stepUs + 1 > step) {
+            step = elapsed / t.stepUs + 1 < t.steps ? elapsed / t.stepUs + 1 : t.steps;
+        }
+        
+        ImageTransitionRect r;
+        if (ImageTransition_Region(&t, shown, step, &r)) {
+            uint16_t batch = (LCD_LONG_SIDE * JPEG_STRIP_LINES) / r.w;
+            for (uint16_t y = 0; y < r.h; y += batch) {
+                uint16_t n = (r.h - y < batch) ? r.h - y : batch;
+                uint16_t* buf = g_stripBuf[band];
+                band = (band + 1) % JPEG_PIPELINE_STRIPS;
+                ImageTransition_RenderRows(&t, step, &r, y, n, buf);
+                LCD_addWindow_Async(r.x, r.y + y, r.x + r.w - 1, r.y + y + n - 1, buf);
+                s.bytes += (uint32_t)r.w * n * 2;
+                if (LCD_Async_Pending() >= JPEG_PIPELINE_STRIPS) {
+                    LCD_Async_WaitOne();
+                }
+            }
+        }
+        s.skippedSteps += step - shown - 1;
+        s.shownSteps++;
+        shown = step;
+    }
+    LCD_Async_WaitAll();
+    updateShownFrame(t.diff.x, t.diff.y, t.diff.w, t.diff.h);
     
-    return 0;
+    s.elapsedUs = micros() - startUs;
+    s.valid = true;
+    LOG_D("过渡 %s: %u/%u 步，%lu 字节，%.1f ms\n", ImageTransition_Name(s.type), s.shownSteps, s.plannedSteps,
+          (unsigned long)s.bytes, s.elapsedUs / 1000.0f);
+    return true;
+#else
+    return false;
+#endif
 }
 
 /**
- * @brief 显示 PNG 图片
- * @param filename 文件路径
- * @return true 成功，false 失败
- * 
- * @details 
- * 支持两种解码方式：
- * 1. 文件回调方式（使用 png.open()）
- * 2. 内存方式（使用 png.openRAM()）
+ * @brief 只上传与屏幕内容不同的块
+ * @return false 不能差异上传或变化太多（调用方整帧写屏）
  * 
- * 默认使用文件回调方式，如果失败则尝试内存方式
+ * @details 整行宽的矩形直接从帧缓冲区发送；其余矩形按行拷进条带缓冲区分批异步发送。
+ *          在途数量达到条带数时等待最早一笔，保证下一块要填充的条带已经发完
  */
-bool displayPNG(const char* filename) {
-    Serial.printf("\n========== 开始加载 PNG 图片 ==========\n");
-    Serial.printf("文件路径: %s\n", filename);
-    
-    // 检查文件是否存在
-    if (!SD_MMC.exists(filename)) {
-        Serial.printf("✗ 文件不存在: %s\n", filename);
-        Serial.println("========================================\n");
+static bool presentDirtyTiles() {
+#if JPEG_PIPELINE_STRIPS > 0
+    if (!g_shownValid || g_stripBuf[0] == nullptr || (g_orient & IMAGE_ORIENT_XFORM_MASK) != g_shownOrient) {
         return false;
     }
     
-    // 创建 PNG 解码器实例
-    PNG png;
-    int rc;
+    static FrameDiffRect rects[IMG_DIFF_MAX_RECTS];
+    uint32_t t0 = micros();
+    uint32_t dirtyTiles = 0;
+    int n = FrameDiff_Compare(g_shownFrame, g_imageBuffer, g_bufferWidth, g_bufferHeight, IMG_DIFF_TILE,
+                              IMG_DIFF_GAP_TILES, rects, IMG_DIFF_MAX_RECTS, &dirtyTiles);
+    uint32_t tiles = (uint32_t)((g_bufferWidth + IMG_DIFF_TILE - 1) / IMG_DIFF_TILE) *
+                     ((g_bufferHeight + IMG_DIFF_TILE - 1) / IMG_DIFF_TILE);
+    uint32_t compareUs = micros() - t0;
+    if (n < 0 || dirtyTiles * 100 > tiles * IMG_DIFF_FULL_PERCENT) {
+        return false;
+    }
+    
+    LCD_Async_WaitAll();
+    uint8_t band = 0;
+    uint32_t sent = 0;
+    for (int i = 0; i < n; i++) {
+        const FrameDiffRect& r = rects[i];
+        if (r.w == g_bufferWidth) {
+            LCD_addWindow_Async(0, r.y, r.w - 1, r.y + r.h - 1, g_imageBuffer + (size_t)r.y * g_bufferWidth);
+            if (LCD_Async_Pending() >= JPEG_PIPELINE_STRIPS) {
+                LCD_Async_WaitOne();
+            }
+        } else {
+            uint16_t batch = (LCD_LONG_SIDE * JPEG_STRIP_LINES) / r.w;
+            for (uint16_t y = 0; y < r.h; y += batch) {
+                uint16_t rows = (r.h - y < batch) ? r.h - y : batch;
+                uint16_t* buf = g_stripBuf[band];
+                band = (band + 1) % JPEG_PIPELINE_STRIPS;
+                for (uint16_t k = 0; k < rows; k++) {
+                    memcpy(buf + k * r.w, g_imageBuffer + (size_t)(r.y + y + k) * g_bufferWidth + r.x, r.w * 2);
+                }
+                LCD_addWindow_Async(r.x, r.y + y, r.x + r.w - 1, r.y + y + rows - 1, buf);
+                if (LCD_Async_Pending() >= JPEG_PIPELINE_STRIPS) {
+                    LCD_Async_WaitOne();
+                }
+            }
+        }
+        sent += (uint32_t)r.w * r.h * 2;
+    }
+    LCD_Async_WaitAll();
+    
+    for (int i = 0; i < n; i++) {
+        updateShownFrame(rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+    }
+    uint32_t frameBytes = (uint32_t)g_bufferWidth * g_bufferHeight * 2;
+    ImageMetrics_AddSpiSaved(frameBytes - sent);
+    LOG_D("差异上传: %lu/%lu 块变化，%d 个窗口，发送 %lu 字节，节省 %lu 字节（比较 %.1f ms）\n",
+          (unsigned long)dirtyTiles, (unsigned long)tiles, n, (unsigned long)sent,
+          (unsigned long)(frameBytes - sent), compareUs / 1000.0f);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief 整帧写屏后记下屏幕内容，作为下一次差异上传 / 过渡的起点
+ */
+static void rememberShownFrame() {
+    if (g_shownFrame == nullptr) {
+        g_shownValid = false;
+        return;
+    }
+    memcpy(g_shownFrame, g_imageBuffer, IMG_BUFFER_SIZE);
+    g_shownOrient = g_orient & IMAGE_ORIENT_XFORM_MASK;
+    g_shownValid = true;
+}
+
+/**
+ * @brief 设置合成目标中帧的方向，逻辑宽高随 MV 位互换（像素数不变，缓冲区大小不变）
+ */
+static void setFrameOrientation(uint8_t orient) {
+    g_orient = orient;
+    bool swap = orient & IMAGE_ORIENT_MV;
+    g_bufferWidth = swap ? LCD_HEIGHT : LCD_WIDTH;
+    g_bufferHeight = swap ? LCD_WIDTH : LCD_HEIGHT;
+}
+
+/**
+ * @brief 按帧的方向设置 MADCTL，整帧一次写屏（开启垂直同步时等到不会撕裂的扫描位置再开始）
+ */
+static void blitImageBuffer() {
+    LCD_SetOrientation(g_orient & IMAGE_ORIENT_XFORM_MASK);
+    LCD_Vsync_WaitForWindow(IMG_BUFFER_SIZE);
+    LCD_addWindow(0, 0, g_bufferWidth - 1, g_bufferHeight - 1, g_imageBuffer);
+}
+
+/**
+ * @brief 当前解码是否写入 imageBuffer
+ * @details imageBuffer 分配失败时自动退回直接写屏
+ */
+static inline bool isComposing() {
+    return g_outputMode == IMG_OUTPUT_COMPOSE && g_imageBuffer != nullptr;
+}
+
+/**
+ * @brief 后台预解码是否已被取消
+ */
+static inline bool isCancelled() {
+    return g_cancel != nullptr && *g_cancel;
+}
+
+/**
+ * @brief 开始合成一帧
+ * 
+ * @details 图片（按 g_layout 摆放后）铺不满屏幕时先清成黑色，避免残留上一张图片的内容
+ */
+static void composeBegin() {
+    if (g_layout.viewW < g_bufferWidth || g_layout.viewH < g_bufferHeight) {
+        memset(g_imageBuffer, 0, IMG_BUFFER_SIZE);
+    }
+}
+
+/**
+ * @brief 把一块 RGB565 像素拷贝进 imageBuffer（调用方保证不越界）
+ */
+static void composeBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) {
+    uint16_t* dst = g_imageBuffer + y * g_bufferWidth + x;
+    for (uint16_t row = 0; row < h; row++) {
+        memcpy(dst, pixels, w * 2);
+        dst += g_bufferWidth;
+        pixels += w;
+    }
+}
+
+/**
+ * @brief 结束合成：先把未经后处理的帧写入缓存，再写屏
+ */
+static void composeEnd() {
+    if (g_cacheKeyValid && !isCancelled()) {
+        FrameCache_Insert(g_cachePath, g_cacheMtime, g_cacheSize, g_orient, g_imageBuffer);
+    }
+    if (g_presentOnEnd) {
+        presentImageBuffer();
+    }
+}
+
+/**
+ * @brief 对完成合成的 imageBuffer 做后处理并整帧写屏
+ * 
+ * @details 
+ * - 色温滤镜对整帧只调用一次
+ * - 只设置一次窗口，240×320 像素一次性连续写出，没有逐块/逐行的窗口命令
+ * - 横屏 / 镜像由 MADCTL 完成，帧按逻辑坐标原样写出
+ * - 屏幕上是上一张合成的帧时：开启切换过渡则逐步过渡，否则只上传变化的块；两者都只发送两帧不同的区域
+ */
+void presentImageBuffer() {
+    if (g_imageBuffer == nullptr) {
+        return;
+    }
+    
+    // 🎨 应用色温滤镜（如果色温不为默认值）
+    if (currentColorTemp != COLOR_TEMP_DEFAULT) {
+        filterPixels(g_imageBuffer, g_bufferWidth * g_bufferHeight);
+    }
+    
+    if (!presentWithTransition() && !presentDirtyTiles()) {
+        blitImageBuffer();
+        rememberShownFrame();
+    }
+}
+
+// ============================================================================
+// 格式识别函数
+// ============================================================================
+
+/**
+ * @brief 按扩展名获取图片格式
+ * @param filename 文件名（完整路径）
+ * @return ImageFormat 图片格式枚举
+ * 
+ * @details 扩展名来自已注册后端的列表（不区分大小写，.jpg 与 .jpeg 等价）；
+ *          真正解码时按文件内容分派，见 decodeImageFile
+ */
+ImageFormat getImageFormat(const char* filename) {
+    if (filename == nullptr) {
+        LOG_E("✗ 文件名为空\n");
+        return IMG_UNKNOWN;
+    }
+    
+    const ImageBackend* backend = ImageRegistry_FindByExtension(filename);
+    if (backend == nullptr) {
+        LOG_D("✗ 不支持的文件格式: %s\n", filename);
+        return IMG_UNKNOWN;
+    }
+    return backend->format;
+}
+
+/**
+ * @brief 文件名是否带有已注册格式的扩展名（目录列表过滤用，不打印日志）
+ */
+bool isImageFileName(const char* filename) {
+    return ImageRegistry_FindByExtension(filename) != nullptr;
+}
+
+// ============================================================================
+// JPEG 解码相关函数
+// ============================================================================
+
+#if JPEG_PIPELINE_STRIPS > 0
+/**
+ * @brief 条带交给 SPI 任务前整条应用色温滤镜，比逐块调用开销更小
+ */
+static void stripSubmit(void* user, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    if (currentColorTemp != COLOR_TEMP_DEFAULT) {
+        filterPixels(pixels, w * h);
+    }
+    LCD_addWindow_Async(x, y, x + w - 1, y + h - 1, pixels);
+}
+
+static uint32_t stripPending(void* user) {
+    return LCD_Async_Pending();
+}
+
+static void stripWaitOne(void* user) {
+    LCD_Async_WaitOne();
+}
+
+static const ImageStripSink g_stripSink = { nullptr, stripSubmit, stripPending, stripWaitOne };
+
+/**
+ * @brief 开始一次流水线解码
+ * @param x     图片可见区域左边缘的屏幕坐标
+ * @param width 可见区域宽度
+ */
+static void jpegStripBegin(uint16_t x, uint16_t width) {
+    g_pipelineActive = (g_stripBuf[0] != nullptr);
+    ImageStrip_Begin(&g_strip, g_stripBuf, JPEG_PIPELINE_STRIPS, JPEG_STRIP_LINES, &g_stripSink, x,
+                     width > g_bufferWidth ? g_bufferWidth : width);
+}
+
+/**
+ * @brief 把当前条带交给 SPI 任务，并确保下一块条带缓冲区已空闲（见 Image_Strip.h）
+ */
+static void jpegStripFlush() {
+    ImageStrip_Flush(&g_strip);
+}
+
+/**
+ * @brief 结束流水线：发送最后一条并等待所有传输完成
+ */
+static void jpegStripEnd() {
+    if (!g_pipelineActive) {
+        return;
+    }
+    jpegStripFlush();
+    LCD_Async_WaitAll();
+    g_pipelineActive = false;
+}
+
+/**
+ * @brief 把一个 MCU 块或若干整行拷贝到当前条带
+ * @return true 已暂存，false 该块无法放进条带（调用方改走同步写屏）
+ */
+static bool jpegStripPut(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* bitmap) {
+    return ImageStrip_Put(&g_strip, x, y, w, h, bitmap);
+}
+#endif
+
+/**
+ * @brief 把一块屏幕坐标下的 RGB565 像素送往输出（合成、条带流水线或同步写屏）
+ * @return true 成功，false 失败或已取消
+ * 
+ * @details 缩放器的输出和不需要缩放时的解码输出都走这里
+ */
+static bool drawBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap) {
+    if (isCancelled()) {
+        return false;
+    }
+    if (!g_firstPixelSeen) {
+        g_firstPixelSeen = true;
+        g_firstPixelUs = micros() - g_loadStartUs;
+    }
+    
+    // 边界检查
+    if (x < 0 || y < 0 || x + w > g_bufferWidth || y + h > g_bufferHeight) {
+        LOG_W("⚠️ 输出块超出屏幕范围 (%d,%d,%d,%d)\n", x, y, w, h);
+        return false;
+    }
+    
+    if (isComposing()) {
+        composeBlock(x, y, w, h, bitmap);
+        return true;
+    }
+    
+#if JPEG_PIPELINE_STRIPS > 0
+    if (g_pipelineActive) {
+        if (jpegStripPut(x, y, w, h, bitmap)) {
+            return true;
+        }
+        // 放不进条带：先排空流水线，再同步写这一块
+        jpegStripFlush();
+        LCD_Async_WaitAll();
+    }
+#endif
+    
+    // 🎨 应用色温滤镜（如果色温不为默认值）
+    if (currentColorTemp != COLOR_TEMP_DEFAULT) {
+        filterPixels(bitmap, w * h);
+    }
+    
+    // 设置显示窗口
+    LCD_SetCursor(x, y, x + w - 1, y + h - 1);
+    
+    // 写入位图数据到屏幕
+    // bitmap 已经是 RGB565 格式，可以直接写入
+    LCD_WriteData_nbyte((uint8_t*)bitmap, NULL, w * h * 2);
+    
+    return true;
+}
+
+/**
+ * @brief JPEG 解码回调函数
+ * @param x 起始 X 坐标
+ * @param y 起始 Y 坐标
+ * @param w 宽度
+ * @param h 高度
+ * @param bitmap 位图数据（RGB565 格式）
+ * @return true 成功，false 失败
+ * 
+ * @details TJpgDec 库会将解码后的数据分块传递给这个回调函数
+ *          需要缩放时交给缩放器（TJpgDec 的 MCU 块先拼成整行），否则直接输出
+ */
+bool jpegDrawCallback(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap) {
+    // 返回 false 让 TJpgDec 中止解码
+    if (isCancelled()) {
+        return false;
+    }
+#if JPEG_TRACE_RECORD
+    if (g_traceFile) {
+        int16_t rec[4] = { x, y, (int16_t)w, (int16_t)h };
+        g_traceFile.write((const uint8_t*)rec, sizeof(rec));
+        g_traceFile.write((const uint8_t*)bitmap, (size_t)w * h * 2);
+    }
+#endif
+    if (g_scaling) {
+        return ImageScaler_PushBlock(&g_scaler, x, y, w, h, bitmap);
+    }
+    return drawBlock(x, y, w, h, bitmap);
+}
+
+/**
+ * @brief 输出一行解码结果（PNG/BMP，图片坐标）
+ */
+static bool imageRowOut(uint16_t y, uint16_t w, uint16_t* pixels) {
+    if (isCancelled()) {
+        return false;
+    }
+    if (g_scaling) {
+        return ImageScaler_PushRows(&g_scaler, pixels, 1, w);
+    }
+    return drawBlock(g_layout.offX, g_layout.offY + y, w, 1, pixels);
+}
+
+/**
+ * @brief 把整个文件读入内存（优先 PSRAM），读完立即关闭文件
+ * @return 缓冲区（调用方 free），失败返回 nullptr
+ */
+static uint8_t* loadFileToBuffer(const char* filename, size_t* size) {
+    File file = openImageFile(filename);
+    if (!file) {
+        LOG_E("✗ 无法打开文件: %s\n", filename);
+        return nullptr;
+    }
+    
+    size_t fileSize = file.size();
+    LOG_D("文件大小: %u 字节 (%.2f KB)\n", (unsigned)fileSize, fileSize / 1024.0);
+    
+    // 🔧 【核心修复 3】：优先使用 PSRAM 分配文件缓冲区
+    uint8_t* buffer = (uint8_t*)heap_caps_malloc(fileSize, MALLOC_CAP_SPIRAM);
+    if (buffer == nullptr) {
+        // PSRAM 分配失败，尝试使用内部 RAM
+        LOG_W("⚠️ PSRAM 分配失败，尝试使用内部 RAM\n");
+        buffer = (uint8_t*)malloc(fileSize);
+        if (buffer == nullptr) {
+            LOG_E("✗ 无法分配文件缓冲区\n");
+            file.close();
+            return nullptr;
+        }
+    }
+    
+    // 读取整个文件到内存
+    size_t bytesRead = readImageFile(file, buffer, fileSize);
+    file.close(); // 🔧 【关键】立即关闭文件，释放 SD 卡总线
+    
+    if (bytesRead != fileSize) {
+        LOG_E("✗ 文件读取失败 (期望 %u 字节, 实际 %u 字节)\n", (unsigned)fileSize, (unsigned)bytesRead);
+        free(buffer);
+        return nullptr;
+    }
+    
+    *size = fileSize;
+    return buffer;
+}
+
+/**
+ * @brief 确定显示方向，再按当前图片的缩放模式计算摆放
+ * @param filename 文件路径（查单张图片的设置）
+ * @param width,height 原图尺寸
+ * 
+ * @details 摆放按方向变换后的逻辑屏幕计算，解码器照常按存储顺序输出；
+ *          直接写屏时在这里切换 MADCTL，合成时等整帧写屏再切换
+ */
+static void imageLayoutBegin(const char* filename, uint32_t width, uint32_t height) {
+    uint8_t orient = g_orientPreset >= 0
+        ? (uint8_t)g_orientPreset
+        : resolveImageOrientation(width > 0xFFFF ? 0xFFFF : width, height > 0xFFFF ? 0xFFFF : height, g_exifXform);
+    setFrameOrientation(orient);
+    if (!isComposing()) {
+        LCD_SetOrientation(orient & IMAGE_ORIENT_XFORM_MASK);
+    }
+    if (orient & IMAGE_ORIENT_XFORM_MASK) {
+        LOG_D("显示方向: %s\n", ImageOrient_Name(orient));
+    }
+    
+    ImageScaleMode mode = resolveScaleMode(filename);
+    ImageScaler_Layout(width, height, g_bufferWidth, g_bufferHeight, mode, &g_layout);
+    if (g_layout.dstW != width || g_layout.dstH != height) {
+        LOG_D("缩放: %lu×%lu → %lu×%lu（%s）\n", (unsigned long)width, (unsigned long)height,
+               (unsigned long)g_layout.dstW, (unsigned long)g_layout.dstH, ImageScaler_ModeName(mode));
+    }
+}
+
+/**
+ * @brief 直接写屏时把图片以外的区域清成黑色
+ */
+static void clearOutsideView() {
+    static uint16_t blackLine[LCD_LONG_SIDE] = { 0 };
+    const ImageLayout& l = g_layout;
+    uint16_t right = l.viewX + l.viewW;
+    uint16_t bottom = l.viewY + l.viewH;
+    
+    // 按区域（上、下、左、右）逐行记录：同一区域的各行列范围相同、上下相接，每个区域只设置一次窗口
+    LCD_CmdList list;
+    LCD_CmdList_Reset(&list);
+    for (uint16_t y = 0; y < l.viewY; y++) {
+        LCD_CmdList_Add(&list, 0, y, g_bufferWidth - 1, y, blackLine);
+    }
+    for (uint16_t y = bottom; y < g_bufferHeight; y++) {
+        LCD_CmdList_Add(&list, 0, y, g_bufferWidth - 1, y, blackLine);
+    }
+    for (uint16_t y = l.viewY; y < bottom && l.viewX > 0; y++) {
+        LCD_CmdList_Add(&list, 0, y, l.viewX - 1, y, blackLine);
+    }
+    for (uint16_t y = l.viewY; y < bottom && right < g_bufferWidth; y++) {
+        LCD_CmdList_Add(&list, right, y, g_bufferWidth - 1, y, blackLine);
+    }
+    LCD_CmdList_Submit(&list);
+}
+
+/**
+ * @brief 准备输出（合成或条带流水线），尺寸与摆放不一致时启用缩放器
+ * @param srcW,srcH 解码器实际输出尺寸（JPEG 为解码缩放后的尺寸）
+ * @return false 缩放器内存不足
+ */
+static bool imageOutputBegin(bool composing, uint16_t srcW, uint16_t srcH) {
+    g_scaling = !ImageScaler_IsPassthrough(&g_layout, srcW, srcH);
+    if (g_scaling && !ImageScaler_Begin(&g_scaler, &g_layout, srcW, srcH, drawBlock)) {
+        LOG_E("✗ 缩放缓冲区分配失败\n");
+        g_scaling = false;
+        return false;
+    }
+    ImageMetrics_SampleHeap();   // 解码器与缩放器的缓冲区都已分配
+    
+    if (composing) {
+        composeBegin();
+        return true;
+    }
+    
+    invalidateShownFrame();
+    if (g_layout.viewW < g_bufferWidth || g_layout.viewH < g_bufferHeight) {
+        clearOutsideView();
+    }
+#if JPEG_PIPELINE_STRIPS > 0
+    jpegStripBegin(g_layout.viewX, g_layout.viewW);
+#endif
+    return true;
+}
+
+/**
+ * @brief 结束输出：送出缩放器剩余的行，再排空流水线
+ * @return false 输出中途失败或被取消
+ */
+static bool imageOutputEnd() {
+    bool ok = true;
+    if (g_scaling) {
+        ok = ImageScaler_Finish(&g_scaler);
+        ImageScaler_End(&g_scaler);
+        g_scaling = false;
+    }
+#if JPEG_PIPELINE_STRIPS > 0
+    jpegStripEnd();
+#endif
+    return ok;
+}
+
+#if JPEG_TRACE_RECORD
+/**
+ * @brief 开始录制 TJpgDec 回调（格式见 JPEG_TRACE_RECORD）；合成或需要缩放时回调坐标不是屏幕坐标，不录
+ */
+static void traceBegin(bool composing) {
+    if (composing || g_scaling) {
+        return;
+    }
+    g_traceFile = SD_MMC.open(JPEG_TRACE_PATH, FILE_WRITE);
+    if (!g_traceFile) {
+        LOG_W("⚠️ 无法创建回调录制文件 %s\n", JPEG_TRACE_PATH);
+        return;
+    }
+    uint16_t viewW = g_layout.viewW > g_bufferWidth ? g_bufferWidth : g_layout.viewW;
+    uint16_t header[4] = { g_bufferWidth, g_bufferHeight, g_layout.viewX, viewW };
+    g_traceFile.write((const uint8_t*)"JTR1", 4);
+    g_traceFile.write((const uint8_t*)header, sizeof(header));
+}
+
+static void traceEnd() {
+    if (g_traceFile) {
+        LOG_I("✓ 回调序列已录制到 %s（%lu 字节）\n", JPEG_TRACE_PATH, (unsigned long)g_traceFile.size());
+        g_traceFile.close();
+    }
+}
+#endif
+
+/**
+ * @brief 用 TJpgDec 解码
+ * @return 0 成功，其他为 TJpgDec 错误码（缩放缓冲区不足时为 -1）
+ */
+static int drawJpegTJpgDec(const char* filename, const uint8_t* data, size_t size, bool composing) {
+    uint16_t jpgWidth = 0, jpgHeight = 0;
+    TJpgDec.getJpgSize(&jpgWidth, &jpgHeight, data, size);
+    
+    // 先用 1/2、1/4、1/8 解码缩放逼近目标尺寸，剩下的交给缩放器
+    imageLayoutBegin(filename, jpgWidth, jpgHeight);
+    uint8_t scale = ImageScaler_PickJpegScale(jpgWidth, jpgHeight, &g_layout);
+    TJpgDec.setJpgScale(1 << scale);
+    TJpgDec.setCallback(jpegDrawCallback);
+    
+    if (!imageOutputBegin(composing, jpgWidth >> scale, jpgHeight >> scale)) {
+        return -1;
+    }
+    int16_t x0 = g_scaling ? 0 : g_layout.offX;
+    int16_t y0 = g_scaling ? 0 : g_layout.offY;
+#if JPEG_TRACE_RECORD
+    traceBegin(composing);
+#endif
+    int result = TJpgDec.drawJpg(x0, y0, data, size);
+#if JPEG_TRACE_RECORD
+    traceEnd();
+#endif
+    if (!imageOutputEnd() && result == 0) {
+        result = -1;
+    }
+    
+    return result;
+}
+
+#if JPEG_DECODER_BACKEND == JPEG_BACKEND_NATIVE
+/**
+ * @brief 渐进式 JPEG 预览输出完毕：先把预览显示出来，再从头接收最终结果
+ * @return false 已取消
+ * 
+ * @details 合成模式下预览只改写了可见区域，色温也只作用于这块区域，
+ *          最终结果会整体覆盖它，黑边不会被处理两次
+ */
+static bool jpegPassDone() {
+    if (isCancelled()) {
+        return false;
+    }
+    if (g_scaling) {
+        if (!ImageScaler_Finish(&g_scaler)) {
+            return false;
+        }
+        ImageScaler_Rewind(&g_scaler);
+    }
+    
+    if (isComposing()) {
+        if (currentColorTemp != COLOR_TEMP_DEFAULT) {
+            for (uint16_t y = 0; y < g_layout.viewH; y++) {
+                filterPixels(g_imageBuffer + (g_layout.viewY + y) * g_bufferWidth + g_layout.viewX,
+                             g_layout.viewW);
+            }
+        }
+        invalidateShownFrame();
+        blitImageBuffer();
+        return true;
+    }
+    
+#if JPEG_PIPELINE_STRIPS > 0
+    if (g_pipelineActive) {
+        jpegStripFlush();
+    }
+#endif
+    return true;
+}
+
+/**
+ * @brief 用内置解码器解码
+ * @param data 整个文件；为 nullptr 时从已打开的 SD_Stream 流式读取
+ * @return JpegResult（JPEG_OK 为 0）
+ * 
+ * @details 渐进式图片的系数平面按解码缩放分配，放不下 JPEG_PROGRESSIVE_MAX_BYTES
+ *          时继续加大解码缩放，剩下的比例由缩放器放大
+ */
+static int drawJpegNative(const char* filename, const uint8_t* data, size_t size, bool composing) {
+    JpegResult r = (data != nullptr) ? JpegCodec_OpenMemory(g_jpegDecoder, data, size)
+                                     : JpegCodec_OpenStream(g_jpegDecoder, SdStream_Read, nullptr);
+    if (r != JPEG_OK) {
+        return r;
+    }
+    
+    imageLayoutBegin(filename, g_jpegDecoder->width, g_jpegDecoder->height);
+    uint8_t scale = ImageScaler_PickJpegScale(g_jpegDecoder->width, g_jpegDecoder->height, &g_layout);
+    if (g_jpegDecoder->progressive) {
+        while (scale < 3 && JpegCodec_ProgressiveBytes(g_jpegDecoder, scale) > JPEG_PROGRESSIVE_MAX_BYTES) {
+            scale++;
+        }
+        LOG_D("渐进式 JPEG: 解码缩放 1/%d，系数平面 %u KB\n", 1 << scale,
+               (unsigned)(JpegCodec_ProgressiveBytes(g_jpegDecoder, scale) / 1024));
+        
+        // 后台预解码不上屏，不需要预览
+        if (!composing || g_presentOnEnd) {
+            g_jpegDecoder->passDone = jpegPassDone;
+        }
+    }
+    uint16_t outW = 0, outH = 0;
+    JpegCodec_ScaledSize(g_jpegDecoder, scale, &outW, &outH);
+    
+    if (!imageOutputBegin(composing, outW, outH)) {
+        return JPEG_ERR_MEMORY;
+    }
+    int16_t x0 = g_scaling ? 0 : g_layout.offX;
+    int16_t y0 = g_scaling ? 0 : g_layout.offY;
+    r = JpegCodec_Decode(g_jpegDecoder, scale, x0, y0, jpegDrawCallback);
+    if (!imageOutputEnd() && r == JPEG_OK) {
+        r = JPEG_ERR_ABORTED;
+    }
+    
+    return r;
+}
+#endif
+
+/**
+ * @brief 显示 JPEG 图片
+ * @param filename 文件路径
+ * @return true 成功，false 失败
+ * 
+ * @details 
+ * 流式（JPEG_LOAD_STREAM，默认）：读卡任务把文件分块读进环形缓冲区，
+ * 解码器边读边解，SD 卡总线要到解码结束才释放。
+ * 整文件（JPEG_LOAD_WHOLE，或流式不可用）：
+ * 1. 将整个 JPEG 文件读入 PSRAM
+ * 2. 关闭文件，释放 SD 卡总线
+ * 3. 按缩放模式选择 1/2、1/4、1/8 解码缩放，余下比例由缩放器完成
+ * 4. 从内存解码并显示（内置解码器不支持时改用 TJpgDec）
+ * 5. 释放内存
+ */
+bool displayJPEG(const char* filename) {
+    LOG_D("\n--- 开始加载 JPEG 图片 ---\n");
+    LOG_D("文件路径: %s\n", filename);
+    
+    // 检查文件是否存在
+    if (!SD_MMC.exists(filename)) {
+        LOG_E("✗ 文件不存在: %s\n", filename);
+        return false;
+    }
+    
+    bool composing = isComposing();
+    int result = -1;
+    bool streamed = false;
+    size_t fileSize = 0;
+    SdStreamStats streamStats = { 0 };
+    
+    g_loadStartUs = micros();
+    g_firstPixelSeen = false;
+    g_firstPixelUs = 0;
+    
+#if JPEG_DECODER_BACKEND == JPEG_BACKEND_NATIVE
+    // 流式读取：只有内置解码器支持
+    if (g_jpegLoadMode == JPEG_LOAD_STREAM && g_streamReady && g_jpegDecoder != nullptr &&
+        SdStream_Open(filename, &fileSize)) {
+        LOG_D("开始流式解码 JPEG...\n");
+        result = drawJpegNative(filename, nullptr, fileSize, composing);
+        SdStream_Close();
+        SdStream_GetStats(&streamStats);
+        streamed = (result != JPEG_ERR_UNSUPPORTED);
+        if (result != JPEG_OK && streamed) {
+            LOG_E("✗ 内置解码器: %s\n", JpegCodec_ResultName((JpegResult)result));
+        }
+    }
+#endif
+    
+    if (!streamed) {
+        uint8_t* jpegBuffer = loadFileToBuffer(filename, &fileSize);
+        if (jpegBuffer == nullptr) {
+            return false;
+        }
+        
+        LOG_D("✓ JPEG 文件已完整读入内存，SD 卡总线已释放\n");
+        
+        // 从内存解码并显示
+        LOG_D("开始解码 JPEG...\n");
+#if JPEG_DECODER_BACKEND == JPEG_BACKEND_NATIVE
+        if (result == JPEG_ERR_UNSUPPORTED) {
+            // 流式已经确认内置解码器不支持
+            LOG_W("⚠️ 内置解码器不支持该文件，改用 TJpgDec\n");
+            result = drawJpegTJpgDec(filename, jpegBuffer, fileSize, composing);
+        } else if (g_jpegDecoder != nullptr) {
+            result = drawJpegNative(filename, jpegBuffer, fileSize, composing);
+            if (result == JPEG_ERR_UNSUPPORTED) {
+                LOG_W("⚠️ 内置解码器不支持该文件，改用 TJpgDec\n");
+                result = drawJpegTJpgDec(filename, jpegBuffer, fileSize, composing);
+            } else if (result != JPEG_OK) {
+                LOG_E("✗ 内置解码器: %s\n", JpegCodec_ResultName((JpegResult)result));
+            }
+        } else {
+            result = drawJpegTJpgDec(filename, jpegBuffer, fileSize, composing);
+        }
+#else
+        result = drawJpegTJpgDec(filename, jpegBuffer, fileSize, composing);
+#endif
+        
+        // 释放内存
+        free(jpegBuffer);
+    }
+    
+    if (result == 0 && composing) {
+        composeEnd();
+    }
+    
+    if (result == 0) {
+        uint32_t totalUs = micros() - g_loadStartUs;
+        g_lastLoadTiming.valid = true;
+        g_lastLoadTiming.mode = streamed ? JPEG_LOAD_STREAM : JPEG_LOAD_WHOLE;
+        g_lastLoadTiming.fileBytes = fileSize;
+        g_lastLoadTiming.firstPixelUs = g_firstPixelUs;
+        g_lastLoadTiming.totalUs = totalUs;
+        g_lastLoadTiming.stalls = streamed ? streamStats.stalls : 0;
+        
+        LOG_D("⏱ 首个像素 %lu ms，总计 %lu ms（%s）\n",
+               (unsigned long)(g_firstPixelUs / 1000), (unsigned long)(totalUs / 1000),
+               streamed ? "流式" : "整文件");
+        if (streamed) {
+            LOG_D("  读卡 %lu 次，等数据 %lu 次共 %lu ms\n",
+                   (unsigned long)streamStats.chunks, (unsigned long)streamStats.stalls,
+                   (unsigned long)(streamStats.stallUs / 1000));
+        }
+        LOG_D("✓ JPEG 图片显示完成\n");
+        LOG_D("--- JPEG 加载结束 ---\n\n");
+        return true;
+    } else {
+        LOG_E("✗ JPEG 解码失败，错误码: %d\n", result);
+        return false;
+    }
+}
+
+// ============================================================================
+// JPEG 基准测试
+// ============================================================================
+
+/**
+ * @brief 基准测试用的输出回调：丢弃像素，只计解码本身
+ */
+static bool jpegBenchCallback(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap) {
+    return true;
+}
+
+/**
+ * @brief 首像素计时用的输出回调：只记下第一次被调用的时间
+ */
+static bool jpegFirstPixelCallback(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap) {
+    if (!g_firstPixelSeen) {
+        g_firstPixelSeen = true;
+        g_firstPixelUs = micros() - g_loadStartUs;
+    }
+    return true;
+}
+
+/**
+ * @brief 用内置解码器按指定读取方式完整读卡 + 解码一次
+ * @param firstPixelUs 输出从开始读卡到第一个输出块的时间
+ * @param totalUs      输出总时间
+ * @return true 成功
+ */
+static bool benchJpegLoad(JpegDecoder* dec, const char* filename, JpegLoadMode mode,
+                          uint32_t* firstPixelUs, uint32_t* totalUs) {
+    g_firstPixelSeen = false;
+    g_firstPixelUs = 0;
+    g_loadStartUs = micros();
+    
+    bool ok = false;
+    if (mode == JPEG_LOAD_STREAM) {
+        if (!g_streamReady || !SdStream_Open(filename, nullptr)) {
+            return false;
+        }
+        ok = JpegCodec_OpenStream(dec, SdStream_Read, nullptr) == JPEG_OK &&
+             JpegCodec_Decode(dec, 0, 0, 0, jpegFirstPixelCallback) == JPEG_OK;
+        SdStream_Close();
+    } else {
+        size_t size = 0;
+        uint8_t* data = loadFileToBuffer(filename, &size);
+        if (data == nullptr) {
+            return false;
+        }
+        ok = JpegCodec_OpenMemory(dec, data, size) == JPEG_OK &&
+             JpegCodec_Decode(dec, 0, 0, 0, jpegFirstPixelCallback) == JPEG_OK;
+        free(data);
+    }
+    
+    *firstPixelUs = g_firstPixelUs;
+    *totalUs = micros() - g_loadStartUs;
+    return ok;
+}
+
+/**
+ * @brief 对比两个 JPEG 后端的每 MCU 周期数
+ * @param filename   文件路径
+ * @param iterations 每个后端的解码次数
+ * @param result     输出结果（可为 nullptr）
+ * @return true 成功
+ * 
+ * @details 调用方须持有 sdCardMutex；解码期间持有解码锁，不写屏
+ */
+bool benchmarkJPEG(const char* filename, uint8_t iterations, JpegBenchResult* result) {
+    JpegBenchResult r;
+    memset(&r, 0, sizeof(r));
+    if (iterations == 0) {
+        iterations = 1;
+    }
+    
+    Serial.printf("\n--- JPEG 基准测试: %s ×%d ---\n", filename, iterations);
+    
+    size_t size = 0;
+    uint8_t* data = loadFileToBuffer(filename, &size);
+    if (data == nullptr) {
+        return false;
+    }
+    
+    if (g_decodeMutex != nullptr) {
+        xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
+    }
+    
+    JpegDecoder* dec = g_jpegDecoder;
+    bool ownDecoder = false;
+    if (dec == nullptr) {
+        dec = (JpegDecoder*)heap_caps_malloc(sizeof(JpegDecoder), MALLOC_CAP_SPIRAM);
+        ownDecoder = true;
+    }
+    
+    uint64_t nativeTotal = 0, entropy = 0, idct = 0, color = 0;
+    bool nativeOk = (dec != nullptr);
+    for (uint8_t i = 0; i < iterations && nativeOk; i++) {
+        uint32_t t0 = ESP.getCycleCount();
+        nativeOk = JpegCodec_OpenMemory(dec, data, size) == JPEG_OK &&
+                   JpegCodec_Decode(dec, 0, 0, 0, jpegBenchCallback) == JPEG_OK;
+        nativeTotal += (uint32_t)(ESP.getCycleCount() - t0);
+        entropy += dec->profile.entropy;
+        idct += dec->profile.idct;
+        color += dec->profile.color;
+        r.mcus = dec->profile.mcus;
+        r.width = dec->width;
+        r.height = dec->height;
+    }
+    
+    uint64_t tjpgTotal = 0;
+    bool tjpgOk = true;
+    TJpgDec.setJpgScale(1);
+    TJpgDec.setCallback(jpegBenchCallback);
+    for (uint8_t i = 0; i < iterations && tjpgOk; i++) {
+        uint32_t t0 = ESP.getCycleCount();
+        tjpgOk = TJpgDec.drawJpg(0, 0, data, size) == 0;
+        tjpgTotal += (uint32_t)(ESP.getCycleCount() - t0);
+    }
+    TJpgDec.setCallback(jpegDrawCallback);
+    
+    // 首像素时间：整文件要先读完整个文件，流式只需等第一个 MCU 行的数据
+    bool wholeOk = nativeOk, streamOk = nativeOk && g_streamReady;
+    uint64_t wholeFirst = 0, wholeTotal = 0, streamFirst = 0, streamTotal = 0;
+    for (uint8_t i = 0; i < iterations && (wholeOk || streamOk); i++) {
+        uint32_t first, total;
+        if (wholeOk && (wholeOk = benchJpegLoad(dec, filename, JPEG_LOAD_WHOLE, &first, &total))) {
+            wholeFirst += first;
+            wholeTotal += total;
+        }
+        if (streamOk && (streamOk = benchJpegLoad(dec, filename, JPEG_LOAD_STREAM, &first, &total))) {
+            streamFirst += first;
+            streamTotal += total;
+        }
+    }
+    
+    if (ownDecoder && dec != nullptr) {
+        free(dec);
+    }
+    if (g_decodeMutex != nullptr) {
+        xSemaphoreGive(g_decodeMutex);
+    }
+    free(data);
+    
+    if (!nativeOk || r.mcus == 0) {
+        Serial.println("✗ 内置解码器无法解码该文件");
+        return false;
+    }
+    
+    uint64_t div = (uint64_t)r.mcus * iterations;
+    r.valid = true;
+    r.iterations = iterations;
+    r.nativeCycles = nativeTotal / div;
+    r.entropyCycles = entropy / div;
+    r.idctCycles = idct / div;
+    r.colorCycles = color / div;
+    r.tjpgdecCycles = tjpgOk ? tjpgTotal / div : 0;
+    if (wholeOk) {
+        r.wholeFirstPixelUs = wholeFirst / iterations;
+        r.wholeTotalUs = wholeTotal / iterations;
+    }
+    if (streamOk) {
+        r.streamFirstPixelUs = streamFirst / iterations;
+        r.streamTotalUs = streamTotal / iterations;
+    }
+    
+    Serial.printf("图片 %dx%d，%lu 个 MCU\n", r.width, r.height, (unsigned long)r.mcus);
+    Serial.printf("内置解码器: %lu 周期/MCU（霍夫曼 %lu，IDCT %lu，色彩 %lu）\n",
+                  (unsigned long)r.nativeCycles, (unsigned long)r.entropyCycles,
+                  (unsigned long)r.idctCycles, (unsigned long)r.colorCycles);
+    if (tjpgOk) {
+        Serial.printf("TJpgDec:    %lu 周期/MCU（加速 %.2fx）\n",
+                      (unsigned long)r.tjpgdecCycles, (float)r.tjpgdecCycles / r.nativeCycles);
+    } else {
+        Serial.println("TJpgDec:    不支持该文件");
+    }
+    if (wholeOk) {
+        Serial.printf("整文件读取: 首个像素 %lu us，总计 %lu us\n",
+                      (unsigned long)r.wholeFirstPixelUs, (unsigned long)r.wholeTotalUs);
+    }
+    if (streamOk) {
+        Serial.printf("流式读取:   首个像素 %lu us，总计 %lu us\n",
+                      (unsigned long)r.streamFirstPixelUs, (unsigned long)r.streamTotalUs);
+    }
+    
+    g_lastBench = r;
+    if (result != nullptr) {
+        *result = r;
+    }
+    return true;
+}
+
+bool getLastJpegBenchmark(JpegBenchResult* result) {
+    if (result == nullptr || !g_lastBench.valid) {
+        return false;
+    }
+    *result = g_lastBench;
+    return true;
+}
+
+// ============================================================================
+// BMP 像素转换基准测试
+// ============================================================================
+
+static uint32_t benchMicros(void) {
+    return micros();
+}
+
+/**
+ * @brief 测试 Pixel_Convert 各内核的吞吐量（源数据在 PSRAM，与 displayBMP 一致）
+ * @return true 成功
+ */
+bool benchmarkPixelConvert(PixelBenchResult* result) {
+    Serial.println("\n--- BMP 像素转换基准测试 ---");
+    
+    PixelBenchResult r;
+    if (!PixelConvert_Benchmark(benchMicros, PIXEL_BENCH_WIDTH, PIXEL_BENCH_ROWS, &r)) {
+        Serial.println("✗ 内存不足");
+        return false;
+    }
+    
+    Serial.printf("%d x %d，每个内核 %lu 像素\n", PIXEL_BENCH_WIDTH, PIXEL_BENCH_ROWS, (unsigned long)r.pixels);
+    Serial.printf("BGR888:   %.2f Mpixel/s（逐像素 %.2f，加速 %.2fx）\n", r.bgr888, r.bgr888Scalar,
+                  r.bgr888Scalar > 0 ? r.bgr888 / r.bgr888Scalar : 0.0f);
+    Serial.printf("BGRA8888: %.2f Mpixel/s\n", r.bgra8888);
+    Serial.printf("RGB555:   %.2f Mpixel/s\n", r.rgb555);
+    Serial.printf("RGB565:   %.2f Mpixel/s\n", r.rgb565);
+    Serial.printf("Pal8:     %.2f Mpixel/s\n", r.pal8);
+    if (!r.ok) {
+        Serial.println("✗ 转换结果与参考实现不一致");
+    }
+    
+    g_lastPixelBench = r;
+    g_pixelBenchValid = true;
+    if (result != nullptr) {
+        *result = r;
+    }
+    return true;
+}
+
+bool getLastPixelBenchmark(PixelBenchResult* result) {
+    if (result == nullptr || !g_pixelBenchValid) {
+        return false;
+    }
+    *result = g_lastPixelBench;
+    return true;
+}
+
+// ============================================================================
+// 写屏带宽测试
+// ============================================================================
+
+/**
+ * @brief 以屏幕内容副本（没有时用 imageBuffer）为测试数据，测试结束后写回屏幕
+ * @return true 成功
+ */
+bool benchmarkLcdTransfer(uint8_t iterations, LCD_BenchResult* result) {
+    if (g_imageBuffer == nullptr) {
+        return false;
+    }
+    Serial.println("\n--- 写屏带宽测试 ---");
+    
+    xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
+    const uint16_t* frame = g_imageBuffer;
+    if (g_shownValid) {
+        frame = g_shownFrame;
+        LCD_SetOrientation(g_shownOrient);
+    }
+    
+    LCD_BenchResult r;
+    bool ok = LCD_Benchmark(frame, iterations, &r);
+    if (g_shownValid) {
+        LCD_addWindow(0, 0, LCD_GetWidth() - 1, LCD_GetHeight() - 1, g_shownFrame);
+    }
+    xSemaphoreGive(g_decodeMutex);
+    
+    if (!ok) {
+        Serial.println("✗ 内存不足");
+        return false;
+    }
+    Serial.printf("后端 %s，%lu 字节/帧，每项 %u 帧，理论上限 %.1f MB/s\n", LCD_BackendName(),
+                  (unsigned long)r.frameBytes, r.iterations, r.theoreticalMBps);
+    Serial.printf("内部 RAM 条带: %.2f MB/s（%.0f%%）\n", r.internalMBps,
+                  r.internalMBps * 100 / r.theoreticalMBps);
+    Serial.printf("PSRAM 整帧:    %.2f MB/s（%.0f%%），%.1f ms/帧\n", r.psramMBps,
+                  r.psramMBps * 100 / r.theoreticalMBps, r.psramUs / 1000.0f / r.iterations);
+    Serial.printf("1×1 窗口:      %.1f us\n", r.windowUs);
+    
+    if (result != nullptr) {
+        *result = r;
+    }
+    return true;
+}
+
+// ============================================================================
+// PNG 解码相关函数
+// ============================================================================
+
+// PNG 行转换状态（仅在 displayPNG 期间有效）
+typedef struct {
+    uint16_t* line;             // 一行 RGB565（内部 RAM 优先）
+    uint16_t palette[256];      // 调色板或灰度查找表（已与背景色混合）
+    bool paletteReady;
+} PngLineContext;
+
+static PngLineContext g_pngLine = { nullptr, { 0 }, false };
+
+/**
+ * @brief 为一张 PNG 准备行缓冲区
+ * @return false 内存不足
+ */
+static bool pngLineBegin(int width) {
+    g_pngLine.paletteReady = false;
+    g_pngLine.line = (uint16_t*)heap_caps_malloc(width * 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (g_pngLine.line == nullptr) {
+        g_pngLine.line = (uint16_t*)heap_caps_malloc(width * 2, MALLOC_CAP_SPIRAM);
+    }
+    if (g_pngLine.line == nullptr) {
+        Serial.println("✗ PNG 行缓冲区分配失败");
+        return false;
+    }
+    return true;
+}
+
+static void pngLineEnd() {
+    free(g_pngLine.line);
+    g_pngLine.line = nullptr;
+}
+
+/**
+ * @brief 把 PNGdec 输出的一行原始像素转换成 RGB565
+ * @return false 不支持的像素格式
+ * 
+ * @details pDraw->iBpp 是每个样本的位数；调色板为 768 字节 RGB，
+ *          有 tRNS 时其后紧跟 256 字节 alpha。带 alpha 的像素与 PNG_ALPHA_BACKGROUND 混合
+ */
+static bool pngConvertLine(PNGDRAW* pDraw, uint16_t* dst) {
+    uint8_t* src = pDraw->pPixels;
+    int n = pDraw->iWidth;
+    int bits = pDraw->iBpp;
+    
+    if (bits == 16) {
+        // 16 位样本只保留高字节（原地进行，PNGdec 每行都会重新填充）
+        static const uint8_t channels[7] = { 1, 0, 3, 0, 2, 0, 4 };
+        PixelConvert_Narrow16(src, src, n * channels[pDraw->iPixelType % 7]);
+        bits = 8;
+    }
+    
+    switch (pDraw->iPixelType) {
+        case PNG_PIXEL_TRUECOLOR:
+            if (bits != 8) return false;
+            PixelConvert_RGB888ToRGB565(src, dst, n);
+            return true;
+        case PNG_PIXEL_TRUECOLOR_ALPHA:
+            if (bits != 8) return false;
+            PixelConvert_RGBA8888BlendRGB565(src, dst, n, PNG_ALPHA_BACKGROUND);
+            return true;
+        case PNG_PIXEL_GRAY_ALPHA:
+            if (bits != 8) return false;
+            PixelConvert_GrayAlphaBlendRGB565(src, dst, n, PNG_ALPHA_BACKGROUND);
+            return true;
+        case PNG_PIXEL_GRAYSCALE:
+            if (!g_pngLine.paletteReady) {
+                PixelConvert_BuildGrayPalette(bits, g_pngLine.palette);
+                g_pngLine.paletteReady = true;
+            }
+            PixelConvert_PackedToRGB565(src, bits, g_pngLine.palette, dst, n);
+            return true;
+        case PNG_PIXEL_INDEXED:
+            if (pDraw->pPalette == nullptr) return false;
+            if (!g_pngLine.paletteReady) {
+                const uint8_t* alpha = pDraw->iHasAlpha ? pDraw->pPalette + 768 : nullptr;
+                PixelConvert_BuildPngPalette(pDraw->pPalette, alpha, 256, PNG_ALPHA_BACKGROUND,
+                                             g_pngLine.palette);
+                g_pngLine.paletteReady = true;
+            }
+            PixelConvert_PackedToRGB565(src, bits, g_pngLine.palette, dst, n);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief PNG 解码回调函数
+ * @param pDraw PNG 绘制结构体
+ * @return 1 继续解码，0 中止（已取消、输出失败或像素格式不支持）
+ * 
+ * @details PNGdec 库会将解码后的原始行逐行传递给这个回调函数，
+ *          转换成 RGB565 后按当前缩放模式摆放输出（直接写屏时由条带流水线攒成多行窗口）
+ */
+int pngDrawCallback(PNGDRAW* pDraw) {
+    if (!pngConvertLine(pDraw, g_pngLine.line)) {
+        LOG_E("✗ 不支持的 PNG 像素格式（类型 %d，%d 位）\n", pDraw->iPixelType, pDraw->iBpp);
+        return 0;
+    }
+    return imageRowOut(pDraw->y, pDraw->iWidth, g_pngLine.line) ? 1 : 0;
+}
+
+/**
+ * @brief 显示 PNG 图片
+ * @param filename 文件路径
+ * @return true 成功，false 失败
+ * 
+ * @details 
+ * 支持两种解码方式：
+ * 1. 文件回调方式（使用 png.open()）
+ * 2. 内存方式（使用 png.openRAM()）
+ * 
+ * 默认使用文件回调方式，如果失败则尝试内存方式
+ */
+bool displayPNG(const char* filename) {
+    LOG_D("\n========== 开始加载 PNG 图片 ==========\n");
+    LOG_D("文件路径: %s\n", filename);
+    
+    // 检查文件是否存在
+    if (!SD_MMC.exists(filename)) {
+        LOG_E("✗ 文件不存在: %s\n", filename);
+        LOG_D("========================================\n\n");
+        return false;
+    }
+    
+    // PNG 解码器对象约 40 KB，放在静态区，避免撑爆 loop / 预取任务的栈
+    static PNG png;
+    int rc;
+    
+    // ============================================================================
+    // 方法 1：使用文件回调方式（推荐，内存占用小）
+    // ============================================================================
+    LOG_D("\n--- 尝试方法 1：文件回调方式 ---\n");
+    rc = png.open(filename, pngFileOpen, pngFileClose, pngFileRead, pngFileSeek, pngDrawCallback);
+    
+    if (rc == PNG_SUCCESS) {
+        LOG_D("✓ PNG 文件打开成功\n");
+        LOG_D("  图片信息 - 宽: %d, 高: %d, 位深: %d\n", 
+              png.getWidth(), png.getHeight(), png.getBpp());
+        
+        imageLayoutBegin(filename, png.getWidth(), png.getHeight());
+        if (!pngLineBegin(png.getWidth())) {
+            png.close();
+            LOG_D("========================================\n\n");
+            return false;
+        }
+        if (!imageOutputBegin(isComposing(), png.getWidth(), png.getHeight())) {
+            pngLineEnd();
+            png.close();
+            LOG_D("========================================\n\n");
+            return false;
+        }
+        
+        // 开始解码
+        LOG_D("开始解码 PNG（文件回调方式）...\n");
+        rc = png.decode(NULL, 0);
+        if (!imageOutputEnd() && rc == PNG_SUCCESS) {
+            rc = PNG_QUIT_EARLY;
+        }
+        
+        pngLineEnd();
+        png.close();
+        
+        if (rc == PNG_SUCCESS) {
+            if (isComposing()) {
+                composeEnd();
+            }
+
+            LOG_D("✓ PNG 图片显示完成（文件回调方式）\n");
+            LOG_D("========================================\n\n");
+            return true;
+        } else {
+            LOG_E("✗ PNG 解码失败（文件回调方式）\n");
+            LOG_E("  错误码: %d\n", rc);
+            
+            // 内容本身不支持或已被取消时，换成内存方式也是同样结果，不再读第二遍
+            if (rc == PNG_UNSUPPORTED_FEATURE || rc == PNG_TOO_BIG || rc == PNG_QUIT_EARLY || isCancelled()) {
+                LOG_D("========================================\n\n");
+                return false;
+            }
+            LOG_D("  尝试方法 2...\n");
+        }
+    } else {
+        LOG_E("✗ PNG 文件打开失败（文件回调方式）\n");
+        LOG_E("  错误码: %d\n", rc);
+        
+        // 打印详细的错误信息
+        switch (rc) {
+            case -1:
+                LOG_E("  原因: PNG_INVALID_FILE - 文件无效或不是 PNG 格式\n");
+                break;
+            case -2:
+                LOG_E("  原因: PNG_MEM_ERROR - 内存分配失败\n");
+                break;
+            case -3:
+                LOG_E("  原因: PNG_DECODE_ERROR - 解码错误\n");
+                break;
+            case -4:
+                LOG_E("  原因: PNG_UNSUPPORTED_FEATURE - 不支持的 PNG 特性\n");
+                break;
+            default:
+                LOG_E("  原因: 未知错误码 %d\n", rc);
+                break;
+        }
+        
+        LOG_D("  尝试方法 2...\n");
+    }
     
     // ============================================================================
-    // 方法 1：使用文件回调方式（推荐，内存占用小）
+    // 方法 2：使用内存方式（备用，内存占用大但更稳定）
     // ============================================================================
-    Serial.println("\n--- 尝试方法 1：文件回调方式 ---");
-    rc = png.open(filename, pngFileOpen, pngFileClose, pngFileRead, pngFileSeek, pngDrawCallback);
+    LOG_D("\n--- 尝试方法 2：内存方式 ---\n");
+    
+    // 打开文件
+    File pngFile = openImageFile(filename);
+    if (!pngFile) {
+        LOG_E("✗ 无法打开文件: %s\n", filename);
+        LOG_D("========================================\n\n");
+        return false;
+    }
+    
+    size_t fileSize = pngFile.size();
+    LOG_D("文件大小: %u 字节 (%.2f KB)\n", (unsigned)fileSize, fileSize / 1024.0);
+    
+    // 分配内存缓冲区（优先使用 PSRAM）
+    uint8_t* pngBuffer = (uint8_t*)heap_caps_malloc(fileSize, MALLOC_CAP_SPIRAM);
+    if (pngBuffer == nullptr) {
+        LOG_W("⚠️ PSRAM 分配失败，尝试使用内部 RAM\n");
+        pngBuffer = (uint8_t*)malloc(fileSize);
+        if (pngBuffer == nullptr) {
+            LOG_E("✗ 无法分配 PNG 文件缓冲区\n");
+            LOG_E("  需要: %u 字节 (%.2f KB)\n", (unsigned)fileSize, fileSize / 1024.0);
+            pngFile.close();
+            LOG_D("========================================\n\n");
+            return false;
+        }
+    } else {
+        LOG_D("✓ 已从 PSRAM 分配文件缓冲区\n");
+    }
+    
+    // 读取整个文件到内存
+    size_t bytesRead = readImageFile(pngFile, pngBuffer, fileSize);
+    pngFile.close();
+    
+    if (bytesRead != fileSize) {
+        LOG_E("✗ 文件读取失败 (期望 %u 字节, 实际 %u 字节)\n", (unsigned)fileSize, (unsigned)bytesRead);
+        free(pngBuffer);
+        LOG_D("========================================\n\n");
+        return false;
+    }
+    
+    LOG_D("✓ PNG 文件已完整读入内存，SD 卡总线已释放\n");
+    
+    // 从内存打开 PNG
+    LOG_D("开始解码 PNG（内存方式）...\n");
+    rc = png.openRAM(pngBuffer, fileSize, pngDrawCallback);
+    
+    if (rc == PNG_SUCCESS) {
+        LOG_D("✓ PNG 内存打开成功\n");
+        LOG_D("  图片信息 - 宽: %d, 高: %d, 位深: %d\n", 
+              png.getWidth(), png.getHeight(), png.getBpp());
+        
+        imageLayoutBegin(filename, png.getWidth(), png.getHeight());
+        if (!pngLineBegin(png.getWidth())) {
+            png.close();
+            free(pngBuffer);
+            LOG_D("========================================\n\n");
+            return false;
+        }
+        if (!imageOutputBegin(isComposing(), png.getWidth(), png.getHeight())) {
+            pngLineEnd();
+            png.close();
+            free(pngBuffer);
+            LOG_D("========================================\n\n");
+            return false;
+        }
+        
+        // 解码并显示
+        rc = png.decode(NULL, 0);
+        if (!imageOutputEnd() && rc == PNG_SUCCESS) {
+            rc = PNG_QUIT_EARLY;
+        }
+        
+        pngLineEnd();
+        png.close();
+        free(pngBuffer);
+        
+        if (rc == PNG_SUCCESS) {
+            if (isComposing()) {
+                composeEnd();
+            }
+
+            LOG_D("✓ PNG 图片显示完成（内存方式）\n");
+            LOG_D("========================================\n\n");
+            return true;
+        } else {
+            LOG_E("✗ PNG 解码失败（内存方式）\n");
+            LOG_E("  错误码: %d\n", rc);
+            
+            // 打印详细的错误信息
+            switch (rc) {
+                case -1:
+                    LOG_E("  原因: PNG_INVALID_FILE - 文件无效或不是 PNG 格式\n");
+                    break;
+                case -2:
+                    LOG_E("  原因: PNG_MEM_ERROR - 内存分配失败\n");
+                    LOG_E("  建议: 检查 PSRAM 是否正常工作\n");
+                    break;
+                case -3:
+                    LOG_E("  原因: PNG_DECODE_ERROR - 解码错误\n");
+                    LOG_E("  建议: 检查 PNG 文件是否损坏\n");
+                    break;
+                case -4:
+                    LOG_E("  原因: PNG_UNSUPPORTED_FEATURE - 不支持的 PNG 特性\n");
+                    LOG_E("  建议: 尝试使用标准的 PNG 格式（RGB/RGBA）\n");
+                    break;
+                default:
+                    LOG_E("  原因: 未知错误码 %d\n", rc);
+                    break;
+            }
+            
+            LOG_D("========================================\n\n");
+            return false;
+        }
+    } else {
+        free(pngBuffer);
+        LOG_E("✗ PNG 内存打开失败\n");
+        LOG_E("  错误码: %d\n", rc);
+        
+        // 打印详细的错误信息
+        switch (rc) {
+            case -1:
+                LOG_E("  原因: PNG_INVALID_FILE - 数据无效或不是 PNG 格式\n");
+                LOG_E("  建议: 检查文件是否完整下载\n");
+                break;
+            case -2:
+                LOG_E("  原因: PNG_MEM_ERROR - 内存分配失败\n");
+                LOG_E("  建议: 减小图片尺寸或释放其他内存\n");
+                break;
+            default:
+                LOG_E("  原因: 未知错误码 %d\n", rc);
+                break;
+        }
+        
+        LOG_D("========================================\n\n");
+        return false;
+    }
+}
+
+// ============================================================================
+// QOI 解码相关函数
+// ============================================================================
+
+static QoiBenchResult g_lastQoiBench = { false };
+
+/**
+ * @brief 显示 QOI 图片
+ * @param filename 文件路径
+ * @return true 成功，false 失败
+ * 
+ * @details 单遍解码，每行直接交给 imageRowOut（直接写屏时由条带流水线攒成多行窗口）；
+ *          优先从 SD_Stream 流式读取，流式不可用时整文件读进 PSRAM
+ */
+bool displayQOI(const char* filename) {
+    LOG_D("\n--- 开始加载 QOI 图片 ---\n");
+    LOG_D("文件路径: %s\n", filename);
+    uint32_t t0 = millis();
+    
+    // 解码器带 1 KB 输入缓冲区，放在静态区（调用方持有解码锁）
+    static QoiDecoder dec;
+    uint8_t* data = nullptr;
+    bool streaming = g_streamReady && SdStream_Open(filename, nullptr);
+    QoiResult r;
+    if (streaming) {
+        r = QoiCodec_OpenStream(&dec, SdStream_Read, nullptr, QOI_ALPHA_BACKGROUND);
+    } else {
+        size_t size = 0;
+        data = loadFileToBuffer(filename, &size);
+        if (data == nullptr) {
+            return false;
+        }
+        r = QoiCodec_OpenMemory(&dec, data, size, QOI_ALPHA_BACKGROUND);
+    }
+    
+    bool ok = (r == QOI_OK);
+    uint16_t* line = nullptr;
+    if (ok) {
+        LOG_D("QOI 信息 - 宽: %lu, 高: %lu, %d 通道%s\n", (unsigned long)dec.width,
+               (unsigned long)dec.height, dec.channels, streaming ? "（流式读取）" : "");
+        if (dec.width > 0xFFFF || dec.height > 0xFFFF) {
+            ok = false;
+        } else {
+            line = (uint16_t*)heap_caps_malloc(dec.width * 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            if (line == nullptr) {
+                line = (uint16_t*)heap_caps_malloc(dec.width * 2, MALLOC_CAP_SPIRAM);
+            }
+            if (line == nullptr) {
+                LOG_E("✗ QOI 行缓冲区分配失败\n");
+                ok = false;
+            }
+        }
+    } else {
+        LOG_E("✗ QOI: %s\n", QoiCodec_ResultName(r));
+    }
+    
+    bool composing = isComposing();
+    if (ok) {
+        imageLayoutBegin(filename, dec.width, dec.height);
+        ok = imageOutputBegin(composing, dec.width, dec.height);
+    }
+    if (ok) {
+        r = QoiCodec_Decode(&dec, line, imageRowOut);
+        ok = imageOutputEnd() && r == QOI_OK;
+        if (r != QOI_OK && r != QOI_ERR_ABORTED) {
+            LOG_E("✗ QOI 解码失败: %s\n", QoiCodec_ResultName(r));
+        }
+    }
+    
+    free(line);
+    if (streaming) {
+        SdStream_Close();
+    }
+    free(data);
+    
+    if (ok && !isCancelled() && composing) {
+        composeEnd();
+    }
+    if (ok) {
+        LOG_D("✓ QOI 显示完成（%lu ms）\n", (unsigned long)(millis() - t0));
+    }
+    LOG_D("--- QOI 加载结束 ---\n\n");
+    return ok && !isCancelled();
+}
+
+/**
+ * @brief 基准测试用的 QOI 行回调：像素已是 RGB565，直接丢弃
+ */
+static bool qoiBenchRow(uint16_t y, uint16_t w, uint16_t* pixels) {
+    return true;
+}
+
+/**
+ * @brief 基准测试用的 PNG 回调：与显示时一样转换成 RGB565，但不输出
+ */
+static int pngBenchCallback(PNGDRAW* pDraw) {
+    return pngConvertLine(pDraw, g_pngLine.line) ? 1 : 0;
+}
+
+/**
+ * @brief 读入基准测试的一个文件并计时
+ */
+static uint8_t* qoiBenchLoad(const char* path, size_t* size, uint32_t* readUs) {
+    uint32_t t0 = micros();
+    uint8_t* data = loadFileToBuffer(path, size);
+    *readUs = micros() - t0;
+    return data;
+}
+
+/**
+ * @brief 对比同一张图片的 PNG 与 QOI 文件：大小、读卡时间和解码时间
+ * @param base       不带扩展名的路径（带 .png / .qoi 扩展名时自动去掉）
+ * @param iterations 每种格式的解码次数
+ * @param result     输出结果（可为 nullptr）
+ * @return true 成功
+ * 
+ * @details 调用方须持有 sdCardMutex；两个文件先整读进 PSRAM，解码期间持有解码锁，不写屏。
+ *          两边都包含转成 RGB565 的时间（PNG 走显示时的行转换，带 alpha 时与背景混合）
+ */
+bool benchmarkQOI(const char* base, uint8_t iterations, QoiBenchResult* result) {
+    QoiBenchResult r;
+    memset(&r, 0, sizeof(r));
+    if (iterations == 0) {
+        iterations = 1;
+    }
+    
+    char stem[100];
+    strncpy(stem, base, sizeof(stem) - 1);
+    stem[sizeof(stem) - 1] = '\0';
+    char* dot = strrchr(stem, '.');
+    if (dot != nullptr && (strcasecmp(dot, ".png") == 0 || strcasecmp(dot, ".qoi") == 0)) {
+        *dot = '\0';
+    }
+    char pngPath[104], qoiPath[104];
+    snprintf(pngPath, sizeof(pngPath), "%s.png", stem);
+    snprintf(qoiPath, sizeof(qoiPath), "%s.qoi", stem);
+    
+    Serial.printf("\n--- PNG / QOI 基准测试: %s ×%d ---\n", stem, iterations);
+    
+    size_t pngSize = 0, qoiSize = 0;
+    uint8_t* pngData = qoiBenchLoad(pngPath, &pngSize, &r.pngReadUs);
+    if (pngData == nullptr) {
+        return false;
+    }
+    uint8_t* qoiData = qoiBenchLoad(qoiPath, &qoiSize, &r.qoiReadUs);
+    if (qoiData == nullptr) {
+        free(pngData);
+        return false;
+    }
+    r.pngBytes = pngSize;
+    r.qoiBytes = qoiSize;
+    
+    if (g_decodeMutex != nullptr) {
+        xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
+    }
+    
+    // QOI：解码器和行缓冲区都在内部 RAM（与显示时相同）
+    QoiDecoder* qdec = (QoiDecoder*)malloc(sizeof(QoiDecoder));
+    uint16_t* line = nullptr;
+    bool qoiOk = (qdec != nullptr) && QoiCodec_OpenMemory(qdec, qoiData, qoiSize, QOI_ALPHA_BACKGROUND) == QOI_OK &&
+                 qdec->width <= 0xFFFF;
+    if (qoiOk) {
+        r.width = qdec->width;
+        r.height = qdec->height;
+        line = (uint16_t*)malloc(qdec->width * 2);
+        qoiOk = (line != nullptr);
+    }
+    uint64_t qoiTotal = 0;
+    for (uint8_t i = 0; i < iterations && qoiOk; i++) {
+        uint32_t t0 = micros();
+        qoiOk = QoiCodec_OpenMemory(qdec, qoiData, qoiSize, QOI_ALPHA_BACKGROUND) == QOI_OK &&
+                QoiCodec_Decode(qdec, line, qoiBenchRow) == QOI_OK;
+        qoiTotal += micros() - t0;
+    }
+    free(line);
+    free(qdec);
+    
+    // PNG：解码器对象约 40 KB，放在 PSRAM
+    uint64_t pngTotal = 0;
+    void* pngMem = heap_caps_malloc(sizeof(PNG), MALLOC_CAP_SPIRAM);
+    bool pngOk = (pngMem != nullptr);
+    if (pngOk) {
+        PNG* png = new (pngMem) PNG();
+        for (uint8_t i = 0; i < iterations && pngOk; i++) {
+            uint32_t t0 = micros();
+            pngOk = png->openRAM(pngData, pngSize, pngBenchCallback) == PNG_SUCCESS;
+            if (pngOk && i == 0 && (png->getWidth() != r.width || png->getHeight() != r.height)) {
+                Serial.printf("⚠️ 两个文件尺寸不同（PNG %dx%d，QOI %dx%d）\n",
+                              png->getWidth(), png->getHeight(), r.width, r.height);
+            }
+            pngOk = pngOk && pngLineBegin(png->getWidth());
+            if (pngOk) {
+                pngOk = png->decode(NULL, 0) == PNG_SUCCESS;
+                pngLineEnd();
+            }
+            png->close();
+            pngTotal += micros() - t0;
+        }
+        png->~PNG();
+        free(pngMem);
+    }
+    
+    if (g_decodeMutex != nullptr) {
+        xSemaphoreGive(g_decodeMutex);
+    }
+    free(qoiData);
+    free(pngData);
+    
+    if (!qoiOk || !pngOk) {
+        Serial.printf("✗ %s 解码失败\n", !qoiOk ? qoiPath : pngPath);
+        return false;
+    }
+    
+    r.valid = true;
+    r.iterations = iterations;
+    r.pngUs = pngTotal / iterations;
+    r.qoiUs = qoiTotal / iterations;
+    
+    Serial.printf("图片 %dx%d\n", r.width, r.height);
+    Serial.printf("PNG: %lu 字节，读卡 %lu us，解码 %lu us\n", (unsigned long)r.pngBytes,
+                  (unsigned long)r.pngReadUs, (unsigned long)r.pngUs);
+    Serial.printf("QOI: %lu 字节（PNG 的 %.2fx），读卡 %lu us，解码 %lu us（加速 %.2fx）\n",
+                  (unsigned long)r.qoiBytes, (float)r.qoiBytes / r.pngBytes, (unsigned long)r.qoiReadUs,
+                  (unsigned long)r.qoiUs, r.qoiUs ? (float)r.pngUs / r.qoiUs : 0.0f);
+    
+    g_lastQoiBench = r;
+    if (result != nullptr) {
+        *result = r;
+    }
+    return true;
+}
+
+bool getLastQoiBenchmark(QoiBenchResult* result) {
+    if (result == nullptr || !g_lastQoiBench.valid) {
+        return false;
+    }
+    *result = g_lastQoiBench;
+    return true;
+}
+
+// ============================================================================
+// BMP 解码相关函数
+// ============================================================================
+
+// BMP 像素格式（决定每行使用的转换内核）
+enum BmpPixelFormat {
+    BMP_PAL8,       // 8 位调色板
+    BMP_RGB555,     // 16 位 X1R5G5B5（BI_RGB 默认）
+    BMP_RGB565,     // 16 位 BI_BITFIELDS 5-6-5
+    BMP_BGR888,     // 24 位
+    BMP_BGRA8888    // 32 位（alpha 忽略）
+};
+
+static inline uint32_t readLE32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief 把 BMP 的一行转换为 RGB565
+ */
+static void convertBmpRow(BmpPixelFormat format, const uint8_t* src, const uint16_t* palette,
+                          uint16_t* dst, int width) {
+    switch (format) {
+        case BMP_PAL8:
+            PixelConvert_Pal8ToRGB565(src, palette, dst, width);
+            break;
+        case BMP_RGB555:
+            PixelConvert_RGB555ToRGB565(src, dst, width);
+            break;
+        case BMP_RGB565:
+            PixelConvert_RGB565Copy(src, dst, width);
+            break;
+        case BMP_BGR888:
+            PixelConvert_BGR888ToRGB565(src, dst, width);
+            break;
+        case BMP_BGRA8888:
+            PixelConvert_BGRA8888ToRGB565(src, dst, width);
+            break;
+    }
+}
+
+/**
+ * @brief 显示 BMP 图片
+ * @param filename 文件路径
+ * @return true 成功，false 失败
+ * 
+ * @details 
+ * 1. 读取 BMP 文件头，解析图片信息（以及调色板 / 位域掩码）
+ * 2. 将像素数据读入内存
+ * 3. 关闭文件，释放 SD 卡总线
+ * 4. 逐行用 Pixel_Convert 内核转换到 RGB565，按缩放模式摆放后显示
+ * 5. 释放内存
+ * 
+ * 支持：8 位调色板、16 位（RGB555 / RGB565）、24 位和 32 位未压缩 BMP，
+ *       高度为负（自上而下存储）的 BMP 也支持；RLE 压缩不支持
+ */
+bool displayBMP(const char* filename) {
+    LOG_D("\n--- 开始加载 BMP 图片 ---\n");
+    LOG_D("文件路径: %s\n", filename);
+    
+    // 检查文件是否存在
+    if (!SD_MMC.exists(filename)) {
+        LOG_E("✗ 文件不存在: %s\n", filename);
+        return false;
+    }
+    
+    // 打开文件
+    File bmpFile = openImageFile(filename);
+    if (!bmpFile) {
+        LOG_E("✗ 无法打开文件: %s\n", filename);
+        return false;
+    }
+    
+    // 读取 BMP 文件头 (54 字节)
+    uint8_t header[54];
+    if (readImageFile(bmpFile, header, 54) != 54) {
+        LOG_E("✗ 无法读取 BMP 文件头\n");
+        bmpFile.close();
+        return false;
+    }
+    
+    // 验证 BMP 签名 (前两个字节应该是 'BM')
+    if (header[0] != 'B' || header[1] != 'M') {
+        LOG_E("✗ 不是有效的 BMP 文件（签名错误）\n");
+        bmpFile.close();
+        return false;
+    }
+    
+    // 解析 BMP 文件头信息
+    uint32_t pixelDataOffset = readLE32(&header[10]);        // 像素数据偏移
+    uint32_t infoSize = readLE32(&header[14]);               // 信息头大小（40 / 108 / 124）
+    int32_t rawWidth = (int32_t)readLE32(&header[18]);       // 图片宽度
+    int32_t rawHeight = (int32_t)readLE32(&header[22]);      // 图片高度（负数表示自上而下）
+    uint16_t bitsPerPixel = header[28] | (header[29] << 8);  // 位深度
+    uint32_t compression = readLE32(&header[30]);            // 0: BI_RGB，3: BI_BITFIELDS
+    uint32_t colorsUsed = readLE32(&header[46]);             // 调色板项数（0 表示 2^位深）
+    
+    bool topDown = rawHeight < 0;
+    uint32_t width = (rawWidth > 0) ? (uint32_t)rawWidth : 0;
+    uint32_t height = topDown ? (uint32_t)(-(int64_t)rawHeight) : (uint32_t)rawHeight;
+    
+    LOG_D("BMP 信息 - 宽: %d, 高: %d, 位深: %d%s\n", width, height, bitsPerPixel,
+           topDown ? "（自上而下）" : "");
+    
+    // 检查分辨率（更大的图片按缩放模式缩小或裁剪）
+    if (width == 0 || height == 0 || width > 0xFFFF || height > 0xFFFF) {
+        LOG_E("✗ 不支持的分辨率: %d×%d\n", width, height);
+        bmpFile.close();
+        return false;
+    }
+    
+    // 确定像素格式；BI_BITFIELDS 的三个掩码紧跟在 40 字节信息头之后（V4/V5 信息头中也在同一位置）
+    BmpPixelFormat format;
+    uint32_t masks[3] = { 0, 0, 0 };
+    if (compression == 3) {
+        uint8_t maskBytes[12];
+        if (readImageFile(bmpFile, maskBytes, 12) != 12) {
+            LOG_E("✗ 无法读取 BMP 位域掩码\n");
+            bmpFile.close();
+            return false;
+        }
+        for (int i = 0; i < 3; i++) {
+            masks[i] = readLE32(&maskBytes[i * 4]);
+        }
+    }
+    
+    if (bitsPerPixel == 8 && compression == 0) {
+        format = BMP_PAL8;
+    } else if (bitsPerPixel == 16 && compression == 0) {
+        format = BMP_RGB555;
+    } else if (bitsPerPixel == 16 && compression == 3 &&
+               masks[0] == 0xF800 && masks[1] == 0x07E0 && masks[2] == 0x001F) {
+        format = BMP_RGB565;
+    } else if (bitsPerPixel == 16 && compression == 3 &&
+               masks[0] == 0x7C00 && masks[1] == 0x03E0 && masks[2] == 0x001F) {
+        format = BMP_RGB555;
+    } else if (bitsPerPixel == 24 && compression == 0) {
+        format = BMP_BGR888;
+    } else if (bitsPerPixel == 32 && (compression == 0 ||
+               (compression == 3 && masks[0] == 0xFF0000 && masks[1] == 0xFF00 && masks[2] == 0xFF))) {
+        format = BMP_BGRA8888;
+    } else {
+        LOG_E("✗ 不支持的 BMP 格式: %d 位，压缩方式 %d（支持 8/16/24/32 位未压缩）\n",
+               bitsPerPixel, compression);
+        bmpFile.close();
+        return false;
+    }
+    
+    // 8 位调色板：紧跟在信息头之后，每项 4 字节（B, G, R, 保留）
+    uint16_t* palette = nullptr;
+    if (format == BMP_PAL8) {
+        if (colorsUsed == 0 || colorsUsed > 256) {
+            colorsUsed = 256;
+        }
+        uint8_t* raw = (uint8_t*)malloc(colorsUsed * 4);
+        palette = (uint16_t*)malloc(256 * sizeof(uint16_t));
+        bool ok = raw != nullptr && palette != nullptr && bmpFile.seek(14 + infoSize) &&
+                  readImageFile(bmpFile, raw, colorsUsed * 4) == colorsUsed * 4;
+        if (ok) {
+            PixelConvert_BuildPalette(raw, colorsUsed, palette);
+        }
+        free(raw);
+        if (!ok) {
+            LOG_E("✗ 无法读取 BMP 调色板\n");
+            free(palette);
+            bmpFile.close();
+            return false;
+        }
+    }
+    
+    // 计算每行字节数（BMP 行对齐到 4 字节）
+    uint32_t rowSize = ((width * bitsPerPixel + 31) / 32) * 4;
+    if ((uint64_t)rowSize * height > 0xFFFFFFFFull) {
+        LOG_E("✗ 不支持的分辨率: %d×%d\n", width, height);
+        free(palette);
+        bmpFile.close();
+        return false;
+    }
+    uint32_t pixelDataSize = rowSize * height;
+    
+    LOG_D("像素数据大小: %d 字节 (%.2f KB)\n", pixelDataSize, pixelDataSize / 1024.0);
+    
+    // 🔧 【核心修复 7】：优先使用 PSRAM 分配像素数据缓冲区
+    uint8_t* pixelData = (uint8_t*)heap_caps_malloc(pixelDataSize, MALLOC_CAP_SPIRAM);
+    if (pixelData == nullptr) {
+        LOG_W("⚠️ PSRAM 分配失败，尝试使用内部 RAM\n");
+        pixelData = (uint8_t*)malloc(pixelDataSize);
+        if (pixelData == nullptr) {
+            LOG_E("✗ 无法分配像素数据缓冲区\n");
+            free(palette);
+            bmpFile.close();
+            return false;
+        }
+    }
     
-    if (rc == PNG_SUCCESS) {
-        Serial.printf("✓ PNG 文件打开成功\n");
-        Serial.printf("  图片信息 - 宽: %d, 高: %d, 位深: %d\n", 
-                     png.getWidth(), png.getHeight(), png.getBpp());
-        
-        // 开始解码
-        Serial.println("开始解码 PNG（文件回调方式）...");
-        rc = png.decode(NULL, 0);
+    // 读取所有像素数据
+    bmpFile.seek(pixelDataOffset);
+    size_t bytesRead = readImageFile(bmpFile, pixelData, pixelDataSize);
+    bmpFile.close(); // 🔧 【关键】立即关闭文件，释放 SD 卡总线
+    
+    if (bytesRead != pixelDataSize) {
+        LOG_E("✗ 像素数据读取失败 (期望 %d 字节, 实际 %u 字节)\n", pixelDataSize, (unsigned)bytesRead);
+        free(pixelData);
+        free(palette);
+        return false;
+    }
+    
+    LOG_D("✓ BMP 像素数据已完整读入内存，SD 卡总线已释放\n");
+    
+    // 分配行缓冲区（用于 RGB565 转换）
+    uint16_t* rowBuffer = (uint16_t*)malloc(width * 2);
+    if (rowBuffer == nullptr) {
+        LOG_E("✗ 无法分配行缓冲区\n");
+        free(pixelData);
+        free(palette);
+        return false;
+    }
+    
+    LOG_D("开始转换并显示 BMP...\n");
+    
+    bool composing = isComposing();
+    imageLayoutBegin(filename, width, height);
+    if (!imageOutputBegin(composing, width, height)) {
+        free(pixelData);
+        free(rowBuffer);
+        free(palette);
+        return false;
+    }
+    
+    // 合成模式且不需要缩放时直接转换到 imageBuffer 对应行
+    bool inPlace = composing && !g_scaling;
+    bool ok = true;
+    
+    // 逐行处理 BMP 数据
+    // 注意：BMP 文件中像素数据通常从下到上存储（高度为负时从上到下），
+    // 这里总是按从上到下的顺序取行（缩放器要求顺序输入）
+    const uint8_t* srcRow = topDown ? pixelData : pixelData + (height - 1) * rowSize;
+    int32_t srcStep = topDown ? (int32_t)rowSize : -(int32_t)rowSize;
+    for (uint32_t y = 0; y < height && ok; y++, srcRow += srcStep) {
+        if (isCancelled()) {
+            break;
+        }
+        uint16_t* outRow = inPlace
+            ? g_imageBuffer + (g_layout.offY + y) * g_bufferWidth + g_layout.offX
+            : rowBuffer;
         
-        png.close();
+        // 每行整体交给转换内核（行首 4 字节对齐，内核按字读取）
+        convertBmpRow(format, srcRow, palette, outRow, width);
         
-        if (rc == PNG_SUCCESS) {
-            Serial.println("✓ PNG 图片显示完成（文件回调方式）");
-            Serial.println("========================================\n");
-            return true;
-        } else {
-            Serial.printf("✗ PNG 解码失败（文件回调方式）\n");
-            Serial.printf("  错误码: %d\n", rc);
-            Serial.println("  尝试方法 2...");
+        if (!inPlace) {
+            ok = imageRowOut(y, width, rowBuffer);
         }
+    }
+    
+    ok = imageOutputEnd() && ok;
+    
+    // 释放内存
+    free(pixelData);
+    free(rowBuffer);
+    free(palette);
+    
+    if (isCancelled() || !ok) {
+        LOG_E("✗ BMP 输出失败或已取消\n");
+        return false;
+    }
+    
+    if (composing) {
+        composeEnd();
+    }
+    
+    LOG_D("✓ BMP 图片显示完成\n");
+    LOG_D("--- BMP 加载结束 ---\n\n");
+    return true;
+}
+
+// ============================================================================
+// R565 原始像素格式
+// ============================================================================
+
+static bool statImageFile(const char* filename, uint32_t* mtime, uint32_t* size);
+
+// 逐行读取状态（受 g_decodeMutex 保护）
+static R565Decoder g_r565Decoder;
+
+static size_t r565FileRead(void* user, uint8_t* buf, size_t len) {
+    return readImageFile(*(File*)user, buf, len);
+}
+
+bool getR565CachePath(const char* source, char* out, size_t len) {
+    if (source == nullptr) {
+        return false;
+    }
+    const char* slash = strrchr(source, '/');
+    int dirLen = slash ? (int)(slash - source) : 0;
+    const char* base = slash ? slash + 1 : source;
+    int n = snprintf(out, len, "%.*s/%s/%s.r565", dirLen, source, R565_CACHE_DIR_NAME, base);
+    return n > 0 && (size_t)n < len;
+}
+
+/**
+ * @brief 读取 .r565 文件头
+ */
+static bool readR565Header(const char* path, R565Header* hdr) {
+    File f = openImageFile(path);
+    if (!f) {
+        return false;
+    }
+    uint8_t buf[R565_HEADER_SIZE];
+    bool ok = readImageFile(f, buf, R565_HEADER_SIZE) == R565_HEADER_SIZE && R565_ParseHeader(buf, hdr);
+    f.close();
+    return ok;
+}
+
+/**
+ * @brief 转码缓存是否仍然有效：源文件未变、缩放模式与视角键相同、尺寸是该方向下的整屏
+ */
+static bool r565CacheValid(const R565Header* hdr, uint32_t mtime, uint32_t size, ImageScaleMode mode) {
+    bool swap = hdr->orient & IMAGE_ORIENT_MV;
+    return hdr->srcMtime == mtime && hdr->srcSize == size && hdr->scaleMode == mode &&
+           (hdr->orient & IMAGE_ORIENT_VIEW_MASK) == getImageViewKey() &&
+           hdr->width == (swap ? LCD_HEIGHT : LCD_WIDTH) && hdr->height == (swap ? LCD_WIDTH : LCD_HEIGHT);
+}
+
+/**
+ * @brief 显示一个已打开的 .r565 文件
+ * @details 未压缩且不需要缩放时，合成模式下像素直接从 SD 卡读进 imageBuffer，不经过任何转换；
+ *          整帧文件（宽度等于屏幕）只需要一次读卡
+ */
+static bool drawR565(const char* filename, File& file) {
+    uint32_t t0 = millis();
+    R565Decoder* dec = &g_r565Decoder;
+    R565Result r = R565_Open(dec, r565FileRead, &file);
+    if (r != R565_OK) {
+        LOG_E("✗ R565: %s\n", R565_ResultName(r));
+        return false;
+    }
+    uint16_t width = dec->hdr.width;
+    uint16_t height = dec->hdr.height;
+    LOG_D("R565 信息 - 宽: %d, 高: %d, %s\n", width, height,
+           dec->hdr.compression == R565_RLE ? "RLE" : "未压缩");
+    
+    bool composing = isComposing();
+    imageLayoutBegin(filename, width, height);
+    if (!imageOutputBegin(composing, width, height)) {
+        return false;
+    }
+    
+    bool inPlace = composing && !g_scaling;
+    bool ok = true;
+    if (inPlace && width == g_bufferWidth) {
+        // 整行宽度：所有行在 imageBuffer 中连续，一次读完
+        r = R565_ReadRows(dec, g_imageBuffer + g_layout.offY * g_bufferWidth, height, width);
+        ok = (r == R565_OK);
     } else {
-        Serial.printf("✗ PNG 文件打开失败（文件回调方式）\n");
-        Serial.printf("  错误码: %d\n", rc);
-        
-        // 打印详细的错误信息
-        switch (rc) {
-            case -1:
-                Serial.println("  原因: PNG_INVALID_FILE - 文件无效或不是 PNG 格式");
-                break;
-            case -2:
-                Serial.println("  原因: PNG_MEM_ERROR - 内存分配失败");
-                break;
-            case -3:
-                Serial.println("  原因: PNG_DECODE_ERROR - 解码错误");
-                break;
-            case -4:
-                Serial.println("  原因: PNG_UNSUPPORTED_FEATURE - 不支持的 PNG 特性");
-                break;
-            default:
-                Serial.printf("  原因: 未知错误码 %d\n", rc);
+        uint16_t* rowBuffer = inPlace ? nullptr : (uint16_t*)malloc(width * 2);
+        if (!inPlace && rowBuffer == nullptr) {
+            LOG_E("✗ 无法分配行缓冲区\n");
+            ok = false;
+        }
+        for (uint16_t y = 0; y < height && ok; y++) {
+            if (isCancelled()) {
+                ok = false;
                 break;
+            }
+            uint16_t* outRow = inPlace
+                ? g_imageBuffer + (g_layout.offY + y) * g_bufferWidth + g_layout.offX
+                : rowBuffer;
+            r = R565_ReadRows(dec, outRow, 1, width);
+            ok = (r == R565_OK);
+            if (ok && !inPlace) {
+                ok = imageRowOut(y, width, rowBuffer);
+            }
         }
-        
-        Serial.println("  尝试方法 2...");
+        free(rowBuffer);
     }
     
-    // ============================================================================
-    // 方法 2：使用内存方式（备用，内存占用大但更稳定）
-    // ============================================================================
-    Serial.println("\n--- 尝试方法 2：内存方式 ---");
+    ok = imageOutputEnd() && ok;
+    if (!ok || isCancelled()) {
+        if (r != R565_OK) {
+            LOG_E("✗ R565: %s\n", R565_ResultName(r));
+        }
+        return false;
+    }
     
-    // 打开文件
-    File pngFile = SD_MMC.open(filename, FILE_READ);
-    if (!pngFile) {
-        Serial.printf("✗ 无法打开文件: %s\n", filename);
-        Serial.println("========================================\n");
+    if (composing) {
+        composeEnd();
+    }
+    LOG_D("✓ R565 显示完成（%lu ms）\n", (unsigned long)(millis() - t0));
+    return true;
+}
+
+/**
+ * @brief 显示 .r565 图片
+ * @param filename 文件路径
+ * @return true 成功，false 失败
+ */
+bool displayR565(const char* filename) {
+    LOG_D("\n--- 开始加载 R565 图片 ---\n");
+    LOG_D("文件路径: %s\n", filename);
+    
+    File file = openImageFile(filename);
+    if (!file) {
+        LOG_E("✗ 无法打开文件: %s\n", filename);
         return false;
     }
+    bool ok = drawR565(filename, file);
+    file.close();
     
-    size_t fileSize = pngFile.size();
-    Serial.printf("文件大小: %d 字节 (%.2f KB)\n", fileSize, fileSize / 1024.0);
+    LOG_D("--- R565 加载结束 ---\n\n");
+    return ok;
+}
+
+/**
+ * @brief 源图片有有效的转码缓存时直接显示缓存
+ * @return false 没有缓存或缓存已过期（调用方照常解码）
+ * 
+ * @details 源文件未变、只是缩放模式或视角不同时，重新排队转码；
+ *          缓存是按保存的方向渲染好的整帧，直接沿用该方向
+ */
+static bool displayR565Cache(const char* filename) {
+    char cachePath[128];
+    uint32_t mtime, size;
+    R565Header hdr;
+    if (!getR565CachePath(filename, cachePath, sizeof(cachePath)) ||
+        !readR565Header(cachePath, &hdr) || !statImageFile(filename, &mtime, &size)) {
+        return false;
+    }
     
-    // 分配内存缓冲区（优先使用 PSRAM）
-    uint8_t* pngBuffer = (uint8_t*)heap_caps_malloc(fileSize, MALLOC_CAP_SPIRAM);
-    if (pngBuffer == nullptr) {
-        Serial.println("⚠️ PSRAM 分配失败，尝试使用内部 RAM");
-        pngBuffer = (uint8_t*)malloc(fileSize);
-        if (pngBuffer == nullptr) {
-            Serial.println("✗ 无法分配 PNG 文件缓冲区");
-            Serial.printf("  需要: %d 字节 (%.2f KB)\n", fileSize, fileSize / 1024.0);
-            pngFile.close();
-            Serial.println("========================================\n");
+    ImageScaleMode mode = resolveScaleMode(filename);
+    if (!r565CacheValid(&hdr, mtime, size, mode)) {
+        if (hdr.srcMtime == mtime && hdr.srcSize == size) {
+            Transcode_Request(filename);
+        }
+        return false;
+    }
+    
+    File file = openImageFile(cachePath);
+    if (!file) {
+        return false;
+    }
+    LOG_D("✓ 使用转码缓存: %s\n", cachePath);
+    g_orientPreset = hdr.orient;
+    bool ok = drawR565(filename, file);
+    g_orientPreset = -1;
+    file.close();
+    return ok;
+}
+
+/**
+ * @brief 把图片渲染成整帧并写成 .r565 转码缓存（调用方须持有 sdCardMutex）
+ * @param frame  临时帧（LCD_WIDTH × LCD_HEIGHT 像素，PSRAM）
+ * @param cancel 取消标志
+ * @return true 缓存已是最新或写入成功
+ */
+bool transcodeImageToR565(const char* filename, uint16_t* frame, volatile bool* cancel) {
+    char cachePath[128];
+    uint32_t mtime, size;
+    if (!getR565CachePath(filename, cachePath, sizeof(cachePath)) ||
+        !statImageFile(filename, &mtime, &size)) {
+        return false;
+    }
+    
+    ImageScaleMode mode = resolveScaleMode(filename);
+    R565Header hdr;
+    if (readR565Header(cachePath, &hdr) && r565CacheValid(&hdr, mtime, size, mode)) {
+        return true;
+    }
+    
+    uint32_t t0 = millis();
+    uint8_t orient = 0;
+    if (!decodeImageToFrame(filename, frame, cancel, &orient)) {
+        return false;
+    }
+    
+    // 帧按自己的方向存储（横屏时宽高互换）
+    bool swap = orient & IMAGE_ORIENT_MV;
+    uint16_t frameW = swap ? LCD_HEIGHT : LCD_WIDTH;
+    uint16_t frameH = swap ? LCD_WIDTH : LCD_HEIGHT;
+    size_t cap = R565_MaxFileSize(frameW, frameH);
+    uint8_t* out = (uint8_t*)heap_caps_malloc(cap, MALLOC_CAP_SPIRAM);
+    if (out == nullptr) {
+        out = (uint8_t*)malloc(cap);
+        if (out == nullptr) {
+            Serial.println("✗ 转码缓冲区分配失败");
             return false;
         }
+    }
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.compression = R565_RLE;
+    hdr.scaleMode = (uint8_t)mode;
+    hdr.orient = orient;
+    hdr.srcMtime = mtime;
+    hdr.srcSize = size;
+    size_t n = R565_Encode(frame, frameW, frameH, frameW, &hdr, out);
+    
+    // 先写临时文件再改名，写到一半断电也不会留下损坏的缓存
+    char dir[128];
+    const char* slash = strrchr(cachePath, '/');
+    snprintf(dir, sizeof(dir), "%.*s", (int)(slash - cachePath), cachePath);
+    if (!SD_MMC.exists(dir)) {
+        SD_MMC.mkdir(dir);
+    }
+    char tmpPath[136];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", cachePath);
+    File f = SD_MMC.open(tmpPath, FILE_WRITE);
+    bool ok = f && f.write(out, n) == n;
+    if (f) {
+        f.close();
+    }
+    free(out);
+    if (ok) {
+        SD_MMC.remove(cachePath);
+        ok = SD_MMC.rename(tmpPath, cachePath);
     } else {
-        Serial.println("✓ 已从 PSRAM 分配文件缓冲区");
+        SD_MMC.remove(tmpPath);
     }
     
-    // 读取整个文件到内存
-    size_t bytesRead = pngFile.read(pngBuffer, fileSize);
-    pngFile.close();
+    if (ok) {
+        Serial.printf("✓ 已转码: %s → %s（%s，%u 字节，%lu ms）\n", filename, cachePath,
+                      hdr.compression == R565_RLE ? "RLE" : "未压缩", (unsigned)n,
+                      (unsigned long)(millis() - t0));
+    } else {
+        Serial.printf("✗ 转码缓存写入失败: %s\n", cachePath);
+    }
+    return ok;
+}
+
+void removeR565Cache(const char* source) {
+    char cachePath[128];
+    if (getR565CachePath(source, cachePath, sizeof(cachePath)) && SD_MMC.exists(cachePath)) {
+        SD_MMC.remove(cachePath);
+    }
+}
+
+// ============================================================================
+// GIF 动画
+// ============================================================================
+
+// 播放状态（只在 loop 所在任务中访问：显示时建立，serviceImageAnimation 推进，
+// 下一次 loadAndDisplayImage 时释放）。写屏不经过 drawBlock / 条带流水线，
+// 后台预解码占用 g_decodeMutex 时动画照常播放
+typedef struct {
+    bool active;
+    GifDecoder* dec;
+    uint8_t* data;              // 整个文件（PSRAM）
+    ImageLayout layout;         // 第一帧时的摆放
+    bool scaling;
+    ImageScaler scaler;         // 独立的缩放器（g_scaler 属于正在进行的解码）
+    uint16_t* band;             // 写屏行缓冲，LCD_LONG_SIDE × GIF_UPLOAD_LINES
+    int32_t outY0, outY1;       // 缩放时本帧要写出的屏幕行范围
+    uint32_t dueMs;             // 下一帧的预定显示时间
+    uint32_t plays;             // 已播完的遍数
+    uint32_t startMs;
+    uint64_t frameUsTotal;
+    uint64_t dirtyTotal;
+} GifAnimation;
+
+static GifAnimation g_gifAnim = { false };
+static GifPlaybackStats g_gifStats = { false };
+
+static uint16_t gifBackground565() {
+    const uint8_t rgb[3] = { (GIF_BACKGROUND >> 16) & 0xFF, (GIF_BACKGROUND >> 8) & 0xFF, GIF_BACKGROUND & 0xFF };
+    return ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+}
+
+/**
+ * @brief 同步写出一块像素（先做色温处理，pixels 会被改写）
+ */
+static void gifWriteBand(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    if (currentColorTemp != COLOR_TEMP_DEFAULT) {
+        filterPixels(pixels, w * h);
+    }
+    LCD_addWindow(x, y, x + w - 1, y + h - 1, pixels);
+}
+
+/**
+ * @brief 不缩放：把画布上的变化矩形按行缓冲能装下的行数分批写屏
+ */
+static void gifUploadRect(const GifRect* r) {
+    GifAnimation& a = g_gifAnim;
+    const uint16_t* canvas = a.dec->canvas;
+    uint16_t stride = a.dec->width;
+    uint16_t batch = (LCD_LONG_SIDE * GIF_UPLOAD_LINES) / r->w;
+    
+    for (uint16_t y = 0; y < r->h; y += batch) {
+        uint16_t n = (r->h - y < batch) ? r->h - y : batch;
+        for (uint16_t k = 0; k < n; k++) {
+            memcpy(a.band + k * r->w, canvas + (size_t)(r->y + y + k) * stride + r->x, r->w * 2);
+        }
+        gifWriteBand(a.layout.offX + r->x, a.layout.offY + r->y + y, r->w, n, a.band);
+    }
+}
+
+/**
+ * @brief 缩放器输出回调：只写出落在本帧变化范围内的屏幕行
+ */
+static bool gifScaledOut(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    GifAnimation& a = g_gifAnim;
+    int32_t y0 = y > a.outY0 ? y : a.outY0;
+    int32_t y1 = (y + h < a.outY1) ? y + h : a.outY1;
+    if (y0 < y1) {
+        gifWriteBand(x, y0, w, y1 - y0, pixels + (y0 - y) * w);
+    }
+    return true;
+}
+
+/**
+ * @brief 需要缩放：重新缩放到变化矩形对应的最后一行为止，只写出对应的屏幕行
+ * @details 源行上下各多算一行（双线性插值会用到相邻行）；整行宽度写出
+ */
+static void gifUploadScaled(const GifRect* r) {
+    GifAnimation& a = g_gifAnim;
+    const ImageLayout& l = a.layout;
+    uint32_t srcH = a.dec->height;
+    
+    uint32_t sy0 = r->y > 0 ? r->y - 1 : 0;
+    uint32_t sy1 = (r->y + r->h + 1u < srcH) ? r->y + r->h + 1u : srcH;
+    int32_t dy0 = l.offY + (int32_t)((uint64_t)sy0 * l.dstH / srcH);
+    int32_t dy1 = l.offY + (int32_t)(((uint64_t)sy1 * l.dstH + srcH - 1) / srcH);
+    a.outY0 = dy0 > l.viewY ? dy0 : l.viewY;
+    a.outY1 = (dy1 < l.viewY + l.viewH) ? dy1 : l.viewY + l.viewH;
+    if (a.outY0 >= a.outY1) {
+        return;
+    }
     
-    if (bytesRead != fileSize) {
-        Serial.printf("✗ 文件读取失败 (期望 %d 字节, 实际 %d 字节)\n", fileSize, bytesRead);
-        free(pngBuffer);
-        Serial.println("========================================\n");
+    uint32_t rows = ((uint64_t)(a.outY1 - l.offY) * srcH + l.dstH - 1) / l.dstH + 2;
+    if (rows > srcH) {
+        rows = srcH;
+    }
+    ImageScaler_Rewind(&a.scaler);
+    ImageScaler_PushRows(&a.scaler, a.dec->canvas, rows, a.dec->width);
+    ImageScaler_Finish(&a.scaler);
+}
+
+static void gifAnimationStop() {
+    GifAnimation& a = g_gifAnim;
+    if (!a.active) {
+        return;
+    }
+    a.active = false;
+    
+    GifPlaybackStats& s = g_gifStats;
+    s.playing = false;
+    s.elapsedMs = millis() - a.startMs;
+    Serial.printf("⏱ GIF 播放: %lu 帧，%.1f fps，迟到 %lu 帧，每帧 %.2f ms（最长 %.2f ms）\n",
+                  (unsigned long)s.framesShown,
+                  s.elapsedMs > 0 ? s.framesShown * 1000.0f / s.elapsedMs : 0.0f,
+                  (unsigned long)s.lateFrames, s.avgFrameUs / 1000.0f, s.maxFrameUs / 1000.0f);
+    
+    if (a.scaling) {
+        ImageScaler_End(&a.scaler);
+    }
+    free(a.band);
+    GifCodec_Close(a.dec);
+    free(a.dec);
+    free(a.data);
+    a.band = nullptr;
+    a.dec = nullptr;
+    a.data = nullptr;
+}
+
+/**
+ * @brief 第一帧显示完成后开始播放（接管解码器与文件缓冲区）
+ * @return false 内存不足（调用方释放解码器，停在第一帧）
+ */
+static bool gifAnimationStart(GifDecoder* dec, uint8_t* data, uint32_t firstDelayMs) {
+    GifAnimation& a = g_gifAnim;
+    a.layout = g_layout;
+    a.scaling = !ImageScaler_IsPassthrough(&a.layout, dec->width, dec->height);
+    
+    a.band = (uint16_t*)heap_caps_malloc(LCD_LONG_SIDE * GIF_UPLOAD_LINES * 2, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (a.band == nullptr) {
+        a.band = (uint16_t*)malloc(LCD_LONG_SIDE * GIF_UPLOAD_LINES * 2);
+    }
+    if (a.band == nullptr ||
+        (a.scaling && !ImageScaler_Begin(&a.scaler, &a.layout, dec->width, dec->height, gifScaledOut))) {
+        free(a.band);
+        a.band = nullptr;
         return false;
     }
     
-    Serial.println("✓ PNG 文件已完整读入内存，SD 卡总线已释放");
+    a.dec = dec;
+    a.data = data;
+    a.plays = 0;
+    a.startMs = millis();
+    a.dueMs = a.startMs + firstDelayMs;
+    a.frameUsTotal = 0;
+    a.dirtyTotal = (uint64_t)dec->width * dec->height;
+    a.active = true;
+    
+    GifPlaybackStats& s = g_gifStats;
+    memset(&s, 0, sizeof(s));
+    s.valid = true;
+    s.playing = true;
+    s.width = dec->width;
+    s.height = dec->height;
+    s.frameCount = dec->frameCount;
+    s.loopCount = dec->loopCount;
+    s.framesShown = 1;
+    s.avgDirtyPixels = a.dirtyTotal;
+    return true;
+}
+
+void serviceImageAnimation() {
+    MjpegPlayer_Service();
+    if (isImageAnimating()) {
+        invalidateShownFrame();
+    }
     
-    // 从内存打开 PNG
-    Serial.println("开始解码 PNG（内存方式）...");
-    rc = png.openRAM(pngBuffer, fileSize, pngDrawCallback);
+    GifAnimation& a = g_gifAnim;
+    if (!a.active) {
+        return;
+    }
+    uint32_t now = millis();
+    int32_t lateMs = (int32_t)(now - a.dueMs);
+    if (lateMs < 0) {
+        return;
+    }
     
-    if (rc == PNG_SUCCESS) {
-        Serial.printf("✓ PNG 内存打开成功\n");
-        Serial.printf("  图片信息 - 宽: %d, 高: %d, 位深: %d\n", 
-                     png.getWidth(), png.getHeight(), png.getBpp());
-        
-        // 解码并显示
-        rc = png.decode(NULL, 0);
-        
-        png.close();
-        free(pngBuffer);
-        
-        if (rc == PNG_SUCCESS) {
-            Serial.println("✓ PNG 图片显示完成（内存方式）");
-            Serial.println("========================================\n");
-            return true;
-        } else {
-            Serial.printf("✗ PNG 解码失败（内存方式）\n");
-            Serial.printf("  错误码: %d\n", rc);
-            
-            // 打印详细的错误信息
-            switch (rc) {
-                case -1:
-                    Serial.println("  原因: PNG_INVALID_FILE - 文件无效或不是 PNG 格式");
-                    break;
-                case -2:
-                    Serial.println("  原因: PNG_MEM_ERROR - 内存分配失败");
-                    Serial.println("  建议: 检查 PSRAM 是否正常工作");
-                    break;
-                case -3:
-                    Serial.println("  原因: PNG_DECODE_ERROR - 解码错误");
-                    Serial.println("  建议: 检查 PNG 文件是否损坏");
-                    break;
-                case -4:
-                    Serial.println("  原因: PNG_UNSUPPORTED_FEATURE - 不支持的 PNG 特性");
-                    Serial.println("  建议: 尝试使用标准的 PNG 格式（RGB/RGBA）");
-                    break;
-                default:
-                    Serial.printf("  原因: 未知错误码 %d\n", rc);
-                    break;
-            }
-            
-            Serial.println("========================================\n");
-            return false;
+    uint32_t t0 = micros();
+    GifRect dirty;
+    uint32_t delayMs = 0;
+    GifResult r = GifCodec_NextFrame(a.dec, &dirty, &delayMs);
+    if (r == GIF_DONE) {
+        a.plays++;
+        int32_t loops = a.dec->loopCount;
+        if ((loops < 0 && a.plays >= 1) || (loops > 0 && a.plays >= (uint32_t)loops)) {
+            Serial.printf("✓ GIF 已播放 %lu 遍，停在最后一帧\n", (unsigned long)a.plays);
+            gifAnimationStop();
+            return;
         }
-    } else {
-        free(pngBuffer);
-        Serial.printf("✗ PNG 内存打开失败\n");
-        Serial.printf("  错误码: %d\n", rc);
-        
-        // 打印详细的错误信息
-        switch (rc) {
-            case -1:
-                Serial.println("  原因: PNG_INVALID_FILE - 数据无效或不是 PNG 格式");
-                Serial.println("  建议: 检查文件是否完整下载");
-                break;
-            case -2:
-                Serial.println("  原因: PNG_MEM_ERROR - 内存分配失败");
-                Serial.println("  建议: 减小图片尺寸或释放其他内存");
-                break;
-            default:
-                Serial.printf("  原因: 未知错误码 %d\n", rc);
-                break;
+        GifCodec_Rewind(a.dec);
+        r = GifCodec_NextFrame(a.dec, &dirty, &delayMs);
+    }
+    if (r != GIF_OK) {
+        Serial.printf("✗ GIF 第 %lu 帧: %s\n", (unsigned long)a.dec->frameIndex + 1, GifCodec_ResultName(r));
+        gifAnimationStop();
+        return;
+    }
+    
+    if (dirty.w > 0 && dirty.h > 0) {
+        if (a.scaling) {
+            gifUploadScaled(&dirty);
+        } else {
+            gifUploadRect(&dirty);
         }
-        
-        Serial.println("========================================\n");
-        return false;
+    }
+    uint32_t frameUs = micros() - t0;
+    
+    GifPlaybackStats& s = g_gifStats;
+    s.framesShown++;
+    if (lateMs > GIF_LATE_MS) {
+        s.lateFrames++;
+    }
+    a.frameUsTotal += frameUs;
+    a.dirtyTotal += (uint32_t)dirty.w * dirty.h;
+    s.avgFrameUs = a.frameUsTotal / (s.framesShown - 1);
+    s.avgDirtyPixels = a.dirtyTotal / s.framesShown;
+    if (frameUs > s.maxFrameUs) {
+        s.maxFrameUs = frameUs;
+    }
+    
+    // 按预定时间排下一帧；落后超过一帧时不再追赶，避免连续快进
+    a.dueMs += delayMs;
+    now = millis();
+    if ((int32_t)(now - a.dueMs) > (int32_t)delayMs) {
+        a.dueMs = now;
     }
 }
 
-// ============================================================================
-// BMP 解码相关函数
-// ============================================================================
+bool isImageAnimating() {
+    return g_gifAnim.active || MjpegPlayer_IsPlaying();
+}
+
+bool getGifPlaybackStats(GifPlaybackStats* stats) {
+    if (stats == nullptr || !g_gifStats.valid) {
+        return false;
+    }
+    *stats = g_gifStats;
+    if (g_gifAnim.active) {
+        stats->elapsedMs = millis() - g_gifAnim.startMs;
+    }
+    return true;
+}
 
 /**
- * @brief 显示 BMP 图片
+ * @brief 显示 GIF 图片
  * @param filename 文件路径
  * @return true 成功，false 失败
  * 
- * @details 
- * 1. 读取 BMP 文件头，解析图片信息
- * 2. 将像素数据读入内存
- * 3. 关闭文件，释放 SD 卡总线
- * 4. 逐行转换 BGR 到 RGB565 并显示
- * 5. 释放内存
- * 
- * 支持：24 位和 32 位 BMP 图片
+ * @details 整个文件读进 PSRAM 后解码第一帧，按普通图片输出（摆放、缩放、合成）；
+ *          多帧且是前台显示时继续由 serviceImageAnimation 播放
  */
-bool displayBMP(const char* filename) {
-    Serial.printf("\n--- 开始加载 BMP 图片 ---\n");
-    Serial.printf("文件路径: %s\n", filename);
-    
-    // 检查文件是否存在
-    if (!SD_MMC.exists(filename)) {
-        Serial.printf("✗ 文件不存在: %s\n", filename);
+bool displayGIF(const char* filename) {
+    LOG_D("\n--- 开始加载 GIF 图片 ---\n");
+    LOG_D("文件路径: %s\n", filename);
+    uint32_t t0 = millis();
+    
+    uint32_t mtime, fileSize;
+    if (!statImageFile(filename, &mtime, &fileSize)) {
+        LOG_E("✗ 无法打开文件: %s\n", filename);
         return false;
     }
-    
-    // 打开文件
-    File bmpFile = SD_MMC.open(filename, FILE_READ);
-    if (!bmpFile) {
-        Serial.printf("✗ 无法打开文件: %s\n", filename);
+    if (fileSize > GIF_MAX_FILE_BYTES) {
+        LOG_E("✗ GIF 文件过大 (%lu 字节，上限 %d)\n", (unsigned long)fileSize, GIF_MAX_FILE_BYTES);
         return false;
     }
+    // 帧缓存占满时 PSRAM 只剩保留的 1 MB，先淘汰缓存帧给整个文件腾出连续空间
+    FrameCache_Trim(fileSize);
     
-    // 读取 BMP 文件头 (54 字节)
-    uint8_t header[54];
-    if (bmpFile.read(header, 54) != 54) {
-        Serial.println("✗ 无法读取 BMP 文件头");
-        bmpFile.close();
+    size_t size = 0;
+    uint8_t* data = loadFileToBuffer(filename, &size);
+    if (data == nullptr) {
         return false;
     }
     
-    // 验证 BMP 签名 (前两个字节应该是 'BM')
-    if (header[0] != 'B' || header[1] != 'M') {
-        Serial.println("✗ 不是有效的 BMP 文件（签名错误）");
-        bmpFile.close();
+    GifDecoder* dec = (GifDecoder*)heap_caps_malloc(sizeof(GifDecoder), MALLOC_CAP_SPIRAM);
+    if (dec == nullptr) {
+        dec = (GifDecoder*)malloc(sizeof(GifDecoder));
+    }
+    if (dec == nullptr) {
+        LOG_E("✗ 无法分配 GIF 解码器\n");
+        free(data);
         return false;
     }
     
-    // 解析 BMP 文件头信息
-    uint32_t pixelDataOffset = *(uint32_t*)&header[10];  // 像素数据偏移
-    uint32_t width = *(uint32_t*)&header[18];            // 图片宽度
-    uint32_t height = *(uint32_t*)&header[22];           // 图片高度
-    uint16_t bitsPerPixel = *(uint16_t*)&header[28];     // 位深度
-    
-    Serial.printf("BMP 信息 - 宽: %d, 高: %d, 位深: %d\n", width, height, bitsPerPixel);
-    
-    // 检查是否为 24 位或 32 位 BMP
-    if (bitsPerPixel != 24 && bitsPerPixel != 32) {
-        Serial.printf("✗ 不支持的位深度: %d（仅支持 24 位或 32 位）\n", bitsPerPixel);
-        bmpFile.close();
+    GifRect dirty;
+    uint32_t delayMs = 0;
+    GifResult r = GifCodec_Open(dec, data, size, gifBackground565());
+    if (r == GIF_OK) {
+        r = GifCodec_NextFrame(dec, &dirty, &delayMs);
+    }
+    if (r != GIF_OK) {
+        LOG_E("✗ GIF: %s\n", GifCodec_ResultName(r));
+        GifCodec_Close(dec);
+        free(dec);
+        free(data);
         return false;
     }
     
-    // 检查分辨率
-    if (width > LCD_WIDTH || height > LCD_HEIGHT) {
-        Serial.printf("⚠️ 图片分辨率 (%d×%d) 超过屏幕 (%d×%d)，将被裁剪\n", 
-                     width, height, LCD_WIDTH, LCD_HEIGHT);
-    }
+    uint16_t width = dec->width;
+    uint16_t height = dec->height;
+    LOG_D("GIF 信息 - 宽: %d, 高: %d, %lu 帧, 循环: %ld\n", width, height,
+           (unsigned long)dec->frameCount, (long)dec->loopCount);
     
-    // 计算每行字节数（BMP 行对齐到 4 字节）
-    uint32_t bytesPerPixel = bitsPerPixel / 8;
-    uint32_t rowSize = ((width * bytesPerPixel + 3) / 4) * 4;  // 4 字节对齐
-    uint32_t pixelDataSize = rowSize * height;
+    bool composing = isComposing();
+    imageLayoutBegin(filename, width, height);
+    bool ok = imageOutputBegin(composing, width, height);
     
-    Serial.printf("像素数据大小: %d 字节 (%.2f KB)\n", pixelDataSize, pixelDataSize / 1024.0);
+    // 画布要留给后面的帧，逐行拷贝后再输出（直接写屏时色温会改写传入的像素）
+    uint16_t* line = ok ? (uint16_t*)malloc(width * 2) : nullptr;
+    if (ok && line == nullptr) {
+        LOG_E("✗ 无法分配行缓冲区\n");
+        ok = false;
+    }
+    for (uint16_t y = 0; y < height && ok; y++) {
+        memcpy(line, dec->canvas + (size_t)y * width, width * 2);
+        ok = imageRowOut(y, width, line);
+    }
+    free(line);
+    ok = imageOutputEnd() && ok;
     
-    // 🔧 【核心修复 7】：优先使用 PSRAM 分配像素数据缓冲区
-    uint8_t* pixelData = (uint8_t*)heap_caps_malloc(pixelDataSize, MALLOC_CAP_SPIRAM);
-    if (pixelData == nullptr) {
-        Serial.println("⚠️ PSRAM 分配失败，尝试使用内部 RAM");
-        pixelData = (uint8_t*)malloc(pixelDataSize);
-        if (pixelData == nullptr) {
-            Serial.println("✗ 无法分配像素数据缓冲区");
-            bmpFile.close();
-            return false;
+    if (ok && !isCancelled() && composing) {
+        // 多帧 GIF 不进帧缓存：命中时只会显示静止的第一帧
+        if (dec->frameCount > 1) {
+            g_cacheKeyValid = false;
         }
+        composeEnd();
     }
     
-    // 读取所有像素数据
-    bmpFile.seek(pixelDataOffset);
-    size_t bytesRead = bmpFile.read(pixelData, pixelDataSize);
-    bmpFile.close(); // 🔧 【关键】立即关闭文件，释放 SD 卡总线
+    bool animate = ok && dec->frameCount > 1 && g_presentOnEnd && g_cancel == nullptr;
+    if (animate && gifAnimationStart(dec, data, delayMs)) {
+        LOG_D("✓ GIF 第一帧显示完成（%lu ms），开始播放\n", (unsigned long)(millis() - t0));
+    } else {
+        if (animate) {
+            LOG_W("⚠️ 动画缓冲区分配失败，只显示第一帧\n");
+        }
+        GifCodec_Close(dec);
+        free(dec);
+        free(data);
+        if (ok) {
+            LOG_D("✓ GIF 显示完成（%lu ms）\n", (unsigned long)(millis() - t0));
+        }
+    }
     
-    if (bytesRead != pixelDataSize) {
-        Serial.printf("✗ 像素数据读取失败 (期望 %d 字节, 实际 %d 字节)\n", pixelDataSize, bytesRead);
-        free(pixelData);
+    LOG_D("--- GIF 加载结束 ---\n\n");
+    return ok && !isCancelled();
+}
+
+// ============================================================================
+// MJPEG 片段
+// ============================================================================
+
+/**
+ * @brief 显示 MJPEG 片段（.avi / .mjpeg / .mjpg）
+ * @param filename 文件路径
+ * @return true 第一帧显示成功并开始播放
+ * 
+ * @details 由 MJPEG_Player 直接写屏（自己的解码器、缩放器和两个解码缓冲区），
+ *          不经过合成缓冲区；只在前台显示时播放，没有可以放进帧缓存的静态画面
+ */
+bool displayMJPEG(const char* filename) {
+    if (!g_presentOnEnd || g_cancel != nullptr) {
         return false;
     }
     
-    Serial.println("✓ BMP 像素数据已完整读入内存，SD 卡总线已释放");
+    LOG_D("\n--- 开始播放 MJPEG 片段 ---\n");
+    LOG_D("文件路径: %s\n", filename);
+    uint32_t t0 = millis();
     
-    // 分配行缓冲区（用于 RGB565 转换）
-    uint16_t* rowBuffer = (uint16_t*)malloc(width * 2);
-    if (rowBuffer == nullptr) {
-        Serial.println("✗ 无法分配行缓冲区");
-        free(pixelData);
+    invalidateShownFrame();     // 片段直接写屏
+    bool ok = MjpegPlayer_Start(filename, resolveScaleMode(filename));
+    if (ok) {
+        LOG_D("✓ MJPEG 第一帧显示完成（%lu ms），开始播放\n", (unsigned long)(millis() - t0));
+    }
+    LOG_D("--- MJPEG 加载结束 ---\n\n");
+    return ok;
+}
+
+// ============================================================================
+// 解码后端
+// ============================================================================
+
+/**
+ * @brief 读取文件开头若干字节
+ * @return 实际读取的字节数（文件打不开时为 0）
+ */
+static size_t readFileHead(const char* filename, uint8_t* buf, size_t len) {
+    File f = openImageFile(filename);
+    if (!f) {
+        return 0;
+    }
+    size_t n = readImageFile(f, buf, len);
+    f.close();
+    return n;
+}
+
+static bool probeJPEG(const uint8_t* h, size_t len) {
+    return len >= 3 && h[0] == 0xFF && h[1] == 0xD8 && h[2] == 0xFF;
+}
+
+static bool probePNG(const uint8_t* h, size_t len) {
+    static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    return len >= 8 && memcmp(h, sig, 8) == 0;
+}
+
+static bool probeBMP(const uint8_t* h, size_t len) {
+    // "BM" 之后第 14 字节起是信息头大小：OS/2 为 12，Windows 为 40 及以上
+    if (len < 16 || h[0] != 'B' || h[1] != 'M') {
+        return false;
+    }
+    uint32_t infoSize = readLE32(h + 14);
+    return infoSize == 12 || (infoSize >= 40 && infoSize <= 124);
+}
+
+static bool probeR565(const uint8_t* h, size_t len) {
+    return len >= 5 && memcmp(h, "R565", 4) == 0 && h[4] == R565_VERSION;
+}
+
+static bool probeMJPEG(const uint8_t* h, size_t len) {
+    return (len >= 12 && memcmp(h, "RIFF", 4) == 0 && memcmp(h + 8, "AVI ", 4) == 0) || probeJPEG(h, len);
+}
+
+static bool probeQOI(const uint8_t* h, size_t len) {
+    return QoiCodec_Probe(h, len);
+}
+
+static bool probeGIF(const uint8_t* h, size_t len) {
+    return len >= 6 && (memcmp(h, "GIF87a", 6) == 0 || memcmp(h, "GIF89a", 6) == 0);
+}
+
+/**
+ * @brief JPEG 尺寸：逐个跳过标记段直到 SOFn
+ */
+static bool infoJPEG(const char* filename, ImageInfo* info) {
+    File f = SD_MMC.open(filename, FILE_READ);
+    if (!f) {
         return false;
     }
     
-    Serial.println("开始转换并显示 BMP...");
-    
-    // 逐行处理并显示 BMP 数据
-    // 注意：BMP 文件中像素数据从下到上存储，所以需要从下往上读取
-    for (int32_t y = height - 1; y >= 0; y--) {
-        // 计算当前行在缓冲区中的偏移
-        uint32_t rowOffset = (height - 1 - y) * rowSize;
-        
-        // 转换 BGR 到 RGB565
-        // BMP 使用 BGR 格式，需要转换为 RGB565
-        for (uint32_t x = 0; x < width; x++) {
-            uint32_t pixelOffset = rowOffset + x * bytesPerPixel;
-            uint8_t b = pixelData[pixelOffset + 0];
-            uint8_t g = pixelData[pixelOffset + 1];
-            uint8_t r = pixelData[pixelOffset + 2];
-            
-            // 转换为 RGB565 格式
-            // RGB565: RRRRRGGGGGGBBBBB (5 位红，6 位绿，5 位蓝)
-            rowBuffer[x] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | ((b & 0xF8) >> 3);
-        }
-        
-        // 🎨 应用色温滤镜（如果色温不为默认值）
-        if (currentColorTemp != COLOR_TEMP_DEFAULT) {
-            applyColorTemperature(rowBuffer, width);
+    uint8_t b[5];
+    bool ok = false;
+    if (f.read(b, 2) == 2 && b[0] == 0xFF && b[1] == 0xD8) {
+        while (f.read(b, 4) == 4 && b[0] == 0xFF) {
+            uint8_t marker = b[1];
+            uint16_t segLen = (b[2] << 8) | b[3];
+            // SOF0~SOF15，除去 DHT（C4）、JPG（C8）、DAC（CC）
+            if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+                if (f.read(b, 5) == 5) {
+                    info->height = (b[1] << 8) | b[2];
+                    info->width = (b[3] << 8) | b[4];
+                    ok = true;
+                }
+                break;
+            }
+            if (segLen < 2 || !f.seek(f.position() + segLen - 2)) {
+                break;
+            }
         }
-        
-        // 显示这一行
-        LCD_SetCursor(0, y, width - 1, y);
-        LCD_WriteData_nbyte((uint8_t*)rowBuffer, NULL, width * 2);
     }
-    
-    // 释放内存
-    free(pixelData);
-    free(rowBuffer);
-    
-    Serial.println("✓ BMP 图片显示完成");
-    Serial.println("--- BMP 加载结束 ---\n");
+    f.close();
+    return ok;
+}
+
+static bool infoPNG(const char* filename, ImageInfo* info) {
+    // 签名 8 字节 + IHDR 长度与类型 8 字节，然后是大端的宽、高
+    uint8_t h[24];
+    if (readFileHead(filename, h, sizeof(h)) != sizeof(h) || memcmp(h + 12, "IHDR", 4) != 0) {
+        return false;
+    }
+    uint32_t w = ((uint32_t)h[16] << 24) | (h[17] << 16) | (h[18] << 8) | h[19];
+    uint32_t ht = ((uint32_t)h[20] << 24) | (h[21] << 16) | (h[22] << 8) | h[23];
+    if (w == 0 || ht == 0 || w > 0xFFFF || ht > 0xFFFF) {
+        return false;
+    }
+    info->width = w;
+    info->height = ht;
+    return true;
+}
+
+static bool infoBMP(const char* filename, ImageInfo* info) {
+    uint8_t h[26];
+    if (readFileHead(filename, h, sizeof(h)) != sizeof(h)) {
+        return false;
+    }
+    int32_t w = (int32_t)readLE32(h + 18);
+    int32_t ht = (int32_t)readLE32(h + 22);
+    if (ht < 0) {
+        ht = -ht;
+    }
+    if (w <= 0 || ht <= 0 || w > 0xFFFF || ht > 0xFFFF) {
+        return false;
+    }
+    info->width = w;
+    info->height = ht;
+    return true;
+}
+
+static bool infoR565(const char* filename, ImageInfo* info) {
+    R565Header hdr;
+    if (!readR565Header(filename, &hdr)) {
+        return false;
+    }
+    info->width = hdr.width;
+    info->height = hdr.height;
+    return true;
+}
+
+static bool infoGIF(const char* filename, ImageInfo* info) {
+    // 逻辑屏幕宽高紧跟在 6 字节签名之后（小端）
+    uint8_t h[10];
+    if (readFileHead(filename, h, sizeof(h)) != sizeof(h)) {
+        return false;
+    }
+    info->width = h[6] | (h[7] << 8);
+    info->height = h[8] | (h[9] << 8);
+    return info->width > 0 && info->height > 0;
+}
+
+static size_t mjpegFileRead(void* user, uint8_t* buf, size_t len) {
+    return ((File*)user)->read(buf, len);
+}
+
+static bool mjpegFileSeek(void* user, uint32_t pos) {
+    return ((File*)user)->seek(pos);
+}
+
+static bool infoQOI(const char* filename, ImageInfo* info) {
+    // "qoif" 之后是大端的宽、高
+    uint8_t h[12];
+    if (readFileHead(filename, h, sizeof(h)) != sizeof(h) || !QoiCodec_Probe(h, sizeof(h))) {
+        return false;
+    }
+    uint32_t w = ((uint32_t)h[4] << 24) | (h[5] << 16) | (h[6] << 8) | h[7];
+    uint32_t ht = ((uint32_t)h[8] << 24) | (h[9] << 16) | (h[10] << 8) | h[11];
+    if (w == 0 || ht == 0 || w > 0xFFFF || ht > 0xFFFF) {
+        return false;
+    }
+    info->width = w;
+    info->height = ht;
     return true;
 }
 
+static bool infoMJPEG(const char* filename, ImageInfo* info) {
+    // 裸 MJPEG 以第一帧的尺寸为准
+    uint8_t h[12];
+    if (readFileHead(filename, h, sizeof(h)) != sizeof(h) || memcmp(h, "RIFF", 4) != 0) {
+        return infoJPEG(filename, info);
+    }
+    
+    File f = SD_MMC.open(filename, FILE_READ);
+    MjpegContainer* c = (MjpegContainer*)malloc(sizeof(MjpegContainer));
+    bool ok = f && c != nullptr &&
+              MjpegContainer_Open(c, mjpegFileRead, mjpegFileSeek, &f, f.size()) == MJPEG_OK;
+    if (ok) {
+        info->width = c->width;
+        info->height = c->height;
+    }
+    free(c);
+    if (f) {
+        f.close();
+    }
+    return ok && info->width > 0 && info->height > 0;
+}
+
+static const char* const g_jpegExt[] = { ".jpg", ".jpeg", nullptr };
+static const char* const g_pngExt[] = { ".png", nullptr };
+static const char* const g_bmpExt[] = { ".bmp", nullptr };
+static const char* const g_r565Ext[] = { ".r565", nullptr };
+static const char* const g_gifExt[] = { ".gif", nullptr };
+static const char* const g_mjpegExt[] = { ".avi", ".mjpeg", ".mjpg", nullptr };
+static const char* const g_qoiExt[] = { ".qoi", nullptr };
+
+static const ImageBackend g_jpegBackend = { "JPEG", IMG_JPEG, g_jpegExt, probeJPEG, infoJPEG, displayJPEG, false };
+static const ImageBackend g_pngBackend = { "PNG", IMG_PNG, g_pngExt, probePNG, infoPNG, displayPNG, false };
+static const ImageBackend g_bmpBackend = { "BMP", IMG_BMP, g_bmpExt, probeBMP, infoBMP, displayBMP, false };
+static const ImageBackend g_r565Backend = { "R565", IMG_R565, g_r565Ext, probeR565, infoR565, displayR565, false };
+static const ImageBackend g_gifBackend = { "GIF", IMG_GIF, g_gifExt, probeGIF, infoGIF, displayGIF, true };
+static const ImageBackend g_mjpegBackend = { "MJPEG", IMG_MJPEG, g_mjpegExt, probeMJPEG, infoMJPEG, displayMJPEG, true };
+static const ImageBackend g_qoiBackend = { "QOI", IMG_QOI, g_qoiExt, probeQOI, infoQOI, displayQOI, false };
+
+static void registerImageBackends() {
+    ImageRegistry_Register(&g_jpegBackend);
+    ImageRegistry_Register(&g_pngBackend);
+    ImageRegistry_Register(&g_bmpBackend);
+    ImageRegistry_Register(&g_r565Backend);
+    ImageRegistry_Register(&g_gifBackend);
+    ImageRegistry_Register(&g_mjpegBackend);
+    ImageRegistry_Register(&g_qoiBackend);
+}
+
+/**
+ * @brief 按内容选择后端
+ * @details 扩展名对应的后端认可这段内容时优先用它（.mjpeg 开头就是一帧 JPEG）；
+ *          否则按文件开头的魔数匹配；都不匹配时只接受没有 probe 的后端（按扩展名）
+ */
+static const ImageBackend* findImageBackend(const char* filename, const uint8_t* header, size_t len) {
+    const ImageBackend* byExt = ImageRegistry_FindByExtension(filename);
+    if (byExt != nullptr && byExt->probe != nullptr && byExt->probe(header, len)) {
+        return byExt;
+    }
+    const ImageBackend* backend = ImageRegistry_Probe(header, len);
+    if (backend != nullptr) {
+        return backend;
+    }
+    return (byExt != nullptr && byExt->probe == nullptr) ? byExt : nullptr;
+}
+
+/**
+ * @brief 读取图片尺寸与格式（按内容识别，不解码像素）
+ * @details 调用方须持有 sdCardMutex
+ */
+bool getImageInfo(const char* filename, ImageInfo* info) {
+    if (filename == nullptr || info == nullptr) {
+        return false;
+    }
+    uint8_t header[IMAGE_SNIFF_BYTES];
+    size_t len = readFileHead(filename, header, sizeof(header));
+    const ImageBackend* backend = findImageBackend(filename, header, len);
+    if (backend == nullptr || backend->info == nullptr) {
+        return false;
+    }
+    info->format = backend->format;
+    info->filename = filename;
+    return backend->info(filename, info);
+}
+
 // ============================================================================
 // 主入口函数
 // ============================================================================
 
+/**
+ * @brief 读取文件的修改时间与大小（帧缓存 / 预取的键）
+ */
+static bool statImageFile(const char* filename, uint32_t* mtime, uint32_t* size) {
+    File f = openImageFile(filename);
+    if (!f) {
+        return false;
+    }
+    *mtime = (uint32_t)f.getLastWrite();
+    *size = f.size();
+    f.close();
+    return true;
+}
+
+/**
+ * @brief 按扩展名判断是否为动画格式（不读卡，不打印日志）
+ */
+bool isAnimatedImageFile(const char* filename) {
+    const ImageBackend* backend = ImageRegistry_FindByExtension(filename);
+    return backend != nullptr && backend->animated;
+}
+
+/**
+ * @brief 按文件内容判断是否为动画格式（与 decodeImageFile 选择后端的方式相同，只读文件开头）
+ * @details 改了扩展名的动画（如命名为 .jpg 的 GIF）解码时仍走动画后端，预解码与帧缓存也必须按内容拦下；
+ *          调用方须持有 sdCardMutex
+ */
+static bool isAnimatedImageContent(const char* filename) {
+    uint8_t header[IMAGE_SNIFF_BYTES];
+    size_t len = readFileHead(filename, header, sizeof(header));
+    const ImageBackend* backend = findImageBackend(filename, header, len);
+    return backend != nullptr && backend->animated;
+}
+
+/**
+ * @brief 按文件内容选择后端并解码，记录该后端的耗时
+ * @details 扩展名与内容不符时以内容为准；有最新的 .r565 转码缓存时直接显示缓存
+ */
+static bool decodeImageFile(const char* filename) {
+    // 识别内容只需要 IMAGE_SNIFF_BYTES 字节，多读一些用来找 JPEG 的 EXIF 方向（同一次读卡）
+    static uint8_t header[IMG_EXIF_SCAN_BYTES];
+    size_t len = readFileHead(filename, header, sizeof(header));
+    if (len == 0) {
+        LOG_E("✗ 无法读取文件: %s\n", filename);
+        return false;
+    }
+    
+    const ImageBackend* backend = findImageBackend(filename, header, len);
+    if (backend == nullptr) {
+        LOG_E("✗ 无法识别的图片内容: %s\n", filename);
+        return false;
+    }
+    if (backend != ImageRegistry_FindByExtension(filename)) {
+        LOG_W("⚠️ 扩展名与内容不符，按 %s 解码: %s\n", backend->name, filename);
+    }
+    
+    uint16_t exif = backend->format == IMG_JPEG ? ImageOrient_ParseJpegExif(header, len) : 0;
+    g_exifXform = ImageOrient_FromExif(exif);
+    if (exif > 1) {
+        LOG_D("EXIF 方向: %u\n", exif);
+    }
+    
+    if (backend->format != IMG_R565 && !backend->animated && displayR565Cache(filename)) {
+        ImageMetrics_SetSource(IMAGE_SOURCE_R565_CACHE, backend->name);
+        return true;
+    }
+    
+    ImageMetrics_SetSource(IMAGE_SOURCE_DECODE, backend->name);
+    uint32_t startUs = micros();
+    bool ok = backend->decode(filename);
+    uint32_t elapsedUs = micros() - startUs;
+    ImageRegistry_Record(backend, elapsedUs, ok && !isCancelled());
+    LOG_D("⏱ %s 解码: %.1f ms%s\n", backend->name, elapsedUs / 1000.0f, ok ? "" : "（失败）");
+    return ok;
+}
+
 /**
  * @brief 加载并显示图片（主入口函数）
  * @param filename 文件路径
  * @return true 成功，false 失败
  * 
  * @details 
- * 1. 根据文件扩展名识别格式
- * 2. 调用对应的解码函数
- * 3. 返回结果
+ * 1. 合成模式下先取后台预解码好的帧（交换帧指针，零拷贝）
+ * 2. 再按 路径 + 修改时间 + 大小 + 视角键 查帧缓存，命中则直接整帧写屏
+ * 3. 都未命中时按文件内容选择解码后端（合成完成的帧会写入缓存）
+ * 4. 返回结果
+ * 
+ * 上一张图片的动画在这里停止；动画格式（按内容判断）跳过预解码与帧缓存
  */
 bool loadAndDisplayImage(const char* filename) {
     if (filename == nullptr) {
-        Serial.println("✗ 文件名为空");
+        LOG_E("✗ 文件名为空\n");
         return false;
     }
     
-    // 识别图片格式
-    ImageFormat format = getImageFormat(filename);
+    xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
     
-    // 根据格式调用对应的解码函数
-    switch (format) {
-        case IMG_JPEG:
-            return displayJPEG(filename);
+    gifAnimationStop();
+    MjpegPlayer_Stop();
+    ImageMetrics_Begin(filename);
+    
+    if (isComposing() && !isAnimatedImageContent(filename) &&
+        statImageFile(filename, &g_cacheMtime, &g_cacheSize)) {
+        const ImageBackend* byExt = ImageRegistry_FindByExtension(filename);
+        const char* format = byExt != nullptr ? byExt->name : nullptr;
         
-        case IMG_PNG:
-            return displayPNG(filename);
+        uint8_t view = getImageViewKey();
+        uint8_t orient = 0;
+        uint16_t* prefetched = Prefetch_Exchange(filename, g_cacheMtime, g_cacheSize, view, g_imageBuffer, &orient);
+        if (prefetched != nullptr) {
+            LOG_D("✓ 使用预解码帧: %s\n", filename);
+            imageBuffer = g_imageBuffer = prefetched;
+            setFrameOrientation(orient);
+            presentImageBuffer();
+            ImageMetrics_SetSource(IMAGE_SOURCE_PREFETCH, format);
+            ImageMetrics_End(true);
+            xSemaphoreGive(g_decodeMutex);
+            return true;
+        }
         
-        case IMG_BMP:
-            return displayBMP(filename);
+        if (FrameCache_Lookup(filename, g_cacheMtime, g_cacheSize, view, g_imageBuffer, &orient)) {
+            LOG_D("✓ 帧缓存命中: %s\n", filename);
+            setFrameOrientation(orient);
+            presentImageBuffer();
+            ImageMetrics_SetSource(IMAGE_SOURCE_FRAME_CACHE, format);
+            ImageMetrics_End(true);
+            xSemaphoreGive(g_decodeMutex);
+            return true;
+        }
         
-        default:
-            Serial.printf("✗ 不支持的图片格式: %s\n", filename);
-            return false;
+        g_cachePath = filename;
+        g_cacheKeyValid = true;
+    }
+    
+    bool result = decodeImageFile(filename);
+    
+    g_cacheKeyValid = false;
+    ImageMetrics_End(result);
+    xSemaphoreGive(g_decodeMutex);
+    return result;
+}
+
+/**
+ * @brief 把图片解码到指定帧（供后台预解码使用，不写屏）
+ * @param filename 文件路径
+ * @param frame    目标帧（LCD_WIDTH × LCD_HEIGHT 像素，PSRAM）
+ * @param cancel   取消标志，置为 true 时解码尽快返回 false
+ * @param orient   输出：该帧的方向标记（可为 nullptr）
+ * @return true 解码完成
+ * 
+ * @details 调用方须持有 sdCardMutex；解码期间临时把合成目标切换到 frame。
+ *          动画格式（按内容判断，扩展名不符也算）只在前台显示时解码，这里直接返回 false
+ */
+bool decodeImageToFrame(const char* filename, uint16_t* frame, volatile bool* cancel, uint8_t* orient) {
+    if (filename == nullptr || frame == nullptr || g_decodeMutex == nullptr || isAnimatedImageFile(filename) ||
+        isAnimatedImageContent(filename)) {
+        return false;
+    }
+    
+    xSemaphoreTake(g_decodeMutex, portMAX_DELAY);
+    
+    uint16_t* savedTarget = g_imageBuffer;
+    uint8_t savedOrient = g_orient;
+    ImageOutputMode savedMode = g_outputMode;
+    g_imageBuffer = frame;
+    g_outputMode = IMG_OUTPUT_COMPOSE;
+    g_presentOnEnd = false;
+    g_cancel = cancel;
+    
+    if (statImageFile(filename, &g_cacheMtime, &g_cacheSize)) {
+        g_cachePath = filename;
+        g_cacheKeyValid = true;
+    }
+    
+    bool result = decodeImageFile(filename) && !isCancelled();
+    if (orient != nullptr) {
+        *orient = g_orient;
+    }
+    
+    g_cacheKeyValid = false;
+    g_cancel = nullptr;
+    g_presentOnEnd = true;
+    g_outputMode = savedMode;
+    g_imageBuffer = savedTarget;
+    setFrameOrientation(savedOrient);
+    
+    xSemaphoreGive(g_decodeMutex);
+    return result;
+}
+
+/**
+ * @brief 动画拦截自检
+ * @return true 通过
+ * 
+ * @details 模拟轮播：后台预解码任务先解码下一张（动画须被拒绝，否则 Prefetch_Exchange 会显示静止帧），
+ *          然后显示两次（第二次相当于轮播回到它，须不命中帧缓存、继续播放）。
+ *          用改了扩展名的多帧 GIF（如 clip.gif → clip.jpg）检查按内容拦截
+ */
+bool checkAnimationGate(const char* filename, AnimationGateResult* result) {
+    AnimationGateResult r = { false };
+    uint32_t mtime, size;
+    if (filename == nullptr || !isComposing() || !statImageFile(filename, &mtime, &size)) {
+        Serial.println("✗ 动画拦截自检: 文件不可读或未启用合成模式");
+        return false;
+    }
+    Serial.printf("\n--- 动画拦截自检: %s ---\n", filename);
+    
+    r.contentAnimated = isAnimatedImageContent(filename);
+    
+    uint16_t* scratch = (uint16_t*)heap_caps_malloc(IMG_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    if (scratch == nullptr) {
+        Serial.println("✗ 内存不足");
+        return false;
+    }
+    volatile bool cancel = false;
+    r.prefetchRejected = !decodeImageToFrame(filename, scratch, &cancel, nullptr);
+    heap_caps_free(scratch);
+    
+    uint8_t view = getImageViewKey();
+    r.firstAnimating = loadAndDisplayImage(filename) && isImageAnimating();
+    r.cached = FrameCache_Contains(filename, mtime, size, view);
+    r.secondAnimating = loadAndDisplayImage(filename) && isImageAnimating();
+    r.cached = r.cached || FrameCache_Contains(filename, mtime, size, view);
+    
+    r.passed = r.contentAnimated && r.prefetchRejected && r.firstAnimating && r.secondAnimating && !r.cached;
+    r.valid = true;
+    
+    Serial.printf("按内容识别为动画: %s，预解码拒绝: %s，第一次播放: %s，再次播放: %s，进帧缓存: %s\n",
+                  r.contentAnimated ? "是" : "否", r.prefetchRejected ? "是" : "否",
+                  r.firstAnimating ? "是" : "否", r.secondAnimating ? "是" : "否", r.cached ? "是" : "否");
+    Serial.println(r.passed ? "✓ 动画拦截自检通过" : "✗ 动画拦截自检失败");
+    
+    g_lastAnimationGate = r;
+    if (result != nullptr) {
+        *result = r;
+    }
+    return r.passed;
+}
+
+bool getLastAnimationGate(AnimationGateResult* result) {
+    if (result == nullptr || !g_lastAnimationGate.valid) {
+        return false;
     }
+    *result = g_lastAnimationGate;
+    return true;
 }
 
 // ============================================================================
@@ -680,20 +3752,20 @@ bool loadAndDisplayImage(const char* filename) {
  * - 通过 pFileSize 返回文件大小
  */
 void* pngFileOpen(const char *szFilename, int32_t *pFileSize) {
-    Serial.printf("PNG 回调：打开文件 %s\n", szFilename);
+    LOG_D("PNG 回调：打开文件 %s\n", szFilename);
     
     // 打开文件
-    File* f = new File(SD_MMC.open(szFilename, FILE_READ));
+    File* f = new File(openImageFile(szFilename));
     
     if (!f || !(*f)) {
-        Serial.printf("✗ PNG 回调：无法打开文件 %s\n", szFilename);
+        LOG_E("✗ PNG 回调：无法打开文件 %s\n", szFilename);
         if (f) delete f;
         return nullptr;
     }
     
     // 获取文件大小
     *pFileSize = f->size();
-    Serial.printf("✓ PNG 回调：文件已打开，大小: %d 字节\n", *pFileSize);
+    LOG_D("✓ PNG 回调：文件已打开，大小: %d 字节\n", *pFileSize);
     
     return (void*)f;
 }
@@ -703,7 +3775,7 @@ void* pngFileOpen(const char *szFilename, int32_t *pFileSize) {
  * @param pHandle 文件句柄（File 对象指针）
  */
 void pngFileClose(void *pHandle) {
-    Serial.println("PNG 回调：关闭文件");
+    LOG_D("PNG 回调：关闭文件\n");
     
     if (pHandle) {
         File* f = (File*)pHandle;
@@ -721,16 +3793,16 @@ void pngFileClose(void *pHandle) {
  */
 int32_t pngFileRead(PNGFILE *pFile, uint8_t *pBuf, int32_t iLen) {
     if (!pFile->fHandle) {
-        Serial.println("✗ PNG 回调：文件句柄无效");
+        LOG_E("✗ PNG 回调：文件句柄无效\n");
         return 0;
     }
     
     File* f = (File*)pFile->fHandle;
-    int32_t bytesRead = f->read(pBuf, iLen);
+    int32_t bytesRead = readImageFile(*f, pBuf, iLen);
     
     // 只在读取失败时打印（避免日志过多）
     if (bytesRead != iLen) {
-        Serial.printf("⚠️ PNG 回调：读取 %d 字节，实际 %d 字节\n", iLen, bytesRead);
+        LOG_W("⚠️ PNG 回调：读取 %d 字节，实际 %d 字节\n", iLen, bytesRead);
     }
     
     return bytesRead;
@@ -744,7 +3816,7 @@ int32_t pngFileRead(PNGFILE *pFile, uint8_t *pBuf, int32_t iLen) {
  */
 int32_t pngFileSeek(PNGFILE *pFile, int32_t iPos) {
     if (!pFile->fHandle) {
-        Serial.println("✗ PNG 回调：文件句柄无效");
+        LOG_E("✗ PNG 回调：文件句柄无效\n");
         return 0;
     }
     
@@ -752,7 +3824,7 @@ int32_t pngFileSeek(PNGFILE *pFile, int32_t iPos) {
     bool success = f->seek(iPos);
     
     if (!success) {
-        Serial.printf("✗ PNG 回调：定位到 %d 失败\n", iPos);
+        LOG_E("✗ PNG 回调：定位到 %d 失败\n", iPos);
     }
     
     return success ? 1 : 0;
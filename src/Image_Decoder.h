@@ -6,15 +6,78 @@
 #include "Display_ST7789.h"
 #include <TJpg_Decoder.h>
 #include <PNGdec.h>
+#include "JPEG_Codec.h"
+#include "Image_Scaler.h"
+#include "Pixel_Convert.h"
+#include "GIF_Codec.h"
+#include "QOI_Codec.h"
+#include "Image_Orientation.h"
+#include "Image_Transition.h"
+#include "Frame_Diff.h"
 
 // 图片格式枚举
 enum ImageFormat {
     IMG_JPEG,
     IMG_PNG,
     IMG_BMP,
+    IMG_R565,       // 预转换的 RGB565（见 R565_Format.h）
+    IMG_GIF,        // GIF（多帧时在 loop 中逐帧播放）
+    IMG_MJPEG,      // MJPEG 片段（AVI 或首尾相接的 JPEG，见 MJPEG_Player.h）
+    IMG_QOI,        // QOI 无损格式（单遍解码，比 PNG 快，见 QOI_Codec.h）
     IMG_UNKNOWN
 };
 
+// 输出模式
+enum ImageOutputMode {
+    IMG_OUTPUT_DIRECT,      // 解码数据直接写屏（JPEG 走条带流水线）
+    IMG_OUTPUT_COMPOSE      // 先合成到 imageBuffer，整帧一次写屏（默认）
+};
+
+// 缩放模式：全局默认值与单张图片的设置都保存在 NVS（命名空间 "scale"）
+#define IMG_SCALE_MODE_DEFAULT  IMG_SCALE_FIT
+
+// 显示方向：用 ST7789 MADCTL 硬件旋转（见 Image_Orientation.h），写屏不做像素搬移。
+// 每张图片先按 EXIF 摆正，再按视角旋转；设置保存在 NVS（命名空间 "scale"）
+enum ImageRotationMode {
+    IMG_ROTATE_0 = 0,       // 固定方向：画面顺时针旋转 0 / 90 / 180 / 270°
+    IMG_ROTATE_90,
+    IMG_ROTATE_180,
+    IMG_ROTATE_270,
+    IMG_ROTATE_AUTO,        // 按图片（摆正后）的宽高比选择：竖图竖屏显示，横图转成横屏铺满（默认）
+    IMG_ROTATE_IMU          // 跟随加速度计：设备转到哪边，画面朝上
+};
+#define IMG_ROTATE_MODE_DEFAULT IMG_ROTATE_AUTO
+#define IMG_ROTATE_EXIF_DEFAULT true
+#define IMG_ROTATE_AUTO_TURNS   1       // 自动模式下横图顺时针转的次数（1 或 3：看习惯把设备往哪边转）
+#define IMG_EXIF_SCAN_BYTES     512     // 查找 JPEG EXIF 方向时读取的文件开头字节数
+#define IMG_IMU_POLL_MS         50      // 跟随加速度计时的采样间隔
+// 加速度计读数换算到屏幕坐标（屏幕向右为 +x、向下为 +y）；按板上 QMI8658 的贴装方向调整
+#define IMG_IMU_UP_X(a)         ((a).x)
+#define IMG_IMU_UP_Y(a)         (-(a).y)
+
+// 差异上传（见 Frame_Diff.h）：屏幕内容在 PSRAM 留一份副本，新帧合成后与它按块比较，只上传变化的块；
+// 变化的块超过 IMG_DIFF_FULL_PERCENT 或合并后的矩形超过 IMG_DIFF_MAX_RECTS 时整帧上传。
+// 省下的字节数记在加载耗时统计的 spi_saved_bytes 中
+#define IMG_DIFF_TILE           16      // 块尺寸（像素）
+#define IMG_DIFF_GAP_TILES      1       // 同一行中隔着这么多未变化块的两段合并成一个窗口
+#define IMG_DIFF_MAX_RECTS      32
+#define IMG_DIFF_FULL_PERCENT   75
+
+// 切换过渡（见 Image_Transition.h）：新帧合成后从屏幕内容副本逐步过渡写屏，
+// 每步借用空闲的 JPEG 条带缓冲区分批异步发送。设置保存在 NVS（命名空间 "scale"）。
+// 动画、渐进式预览或直接写屏之后，以及两帧方向不同时直接切换
+#define IMG_TRANSITION_DEFAULT      IMG_TRANSITION_FADE
+#define IMG_TRANSITION_MS_DEFAULT   400     // 过渡总时长
+#define IMG_TRANSITION_MS_MAX       3000
+#define IMG_TRANSITION_FPS          30      // 目标帧率；写屏带宽不够时自动减少步数，总时长不变
+
+// BMP 像素转换基准测试的数据量（源数据放 PSRAM）
+#define PIXEL_BENCH_WIDTH   320
+#define PIXEL_BENCH_ROWS    480
+
+// 转码缓存子目录（在源图片所在目录下）
+#define R565_CACHE_DIR_NAME ".r565"
+
 // 图片信息结构体
 typedef struct {
     uint16_t width;
@@ -27,14 +90,218 @@ typedef struct {
 #define IMG_BUFFER_SIZE (LCD_WIDTH * LCD_HEIGHT * 2)
 extern uint16_t* imageBuffer;
 
+// 解码/传输流水线
+// JPEG 的 MCU 块（PNG/BMP 为连续的整行）先拼成条带（内部 DMA 内存），整条交给后台 SPI 任务异步发送，
+// 解码器同时填充下一条，解码与 SPI 传输重叠。设为 0 恢复逐块同步写屏。
+#define JPEG_PIPELINE_STRIPS    2       // 乒乓条带数量（≥2 才有重叠效果）
+#define JPEG_STRIP_LINES        16      // 每条带最大行数（TJpgDec MCU 高度最大 16）
+
+// 调试：把 TJpgDec 的输出回调录制到 SD 卡（只录不缩放、直接写屏的解码），供 tools/strip_replay 离线回放。
+// 文件格式（小端）："JTR1"，uint16 帧宽、帧高、可见区域 x、可见区域宽；
+// 之后每次回调一条记录：int16 x、y，uint16 w、h，w × h 个 RGB565 像素
+#define JPEG_TRACE_RECORD       0
+#define JPEG_TRACE_PATH         "/jpeg_trace.jtr"
+
+// PNG 透明像素的背景色（0xRRGGBB）：RGBA、灰度 + alpha 和带 tRNS 的调色板图片与之混合
+#define PNG_ALPHA_BACKGROUND    0x000000
+#define QOI_ALPHA_BACKGROUND    PNG_ALPHA_BACKGROUND
+
+// GIF 动画
+// 整个文件读进 PSRAM，画布与 LZW 表也在 PSRAM；第一帧走普通的摆放 / 合成流程，
+// 之后每帧只把变化的矩形写屏（需要缩放时只写对应的屏幕行）。
+// 动画 GIF 不进帧缓存、不预解码、不转码（缓存的只能是第一帧）
+// 文件、画布与 LZW 表分配前 / 失败时淘汰帧缓存（FrameCache_Trim），不与缓存抢 PSRAM
+#define GIF_BACKGROUND          0x000000            // 画布初始色与处置方式 2 的填充色（0xRRGGBB）
+#define GIF_MAX_FILE_BYTES      (4 * 1024 * 1024)   // 超过此大小的 GIF 不播放
+#define GIF_UPLOAD_LINES        16                  // 变化区域每次写屏的行缓冲（按屏幕宽度计）
+#define GIF_LATE_MS             20                  // 比预定时间晚这么多才显示的帧计为迟到
+
+// JPEG 解码后端
+// 内置解码器输出与 TJpgDec 逐像素一致；遇到它不支持的文件时自动改用 TJpgDec
+#define JPEG_BACKEND_TJPGDEC    0       // Bodmer TJpg_Decoder
+#define JPEG_BACKEND_NATIVE     1       // JPEG_Codec：查表霍夫曼、跳零列 IDCT、整行 MCU 输出
+#define JPEG_DECODER_BACKEND    JPEG_BACKEND_NATIVE
+
+// JPEG 文件读取方式
+// 流式读取时读卡任务边读边交给内置解码器，读卡与解码重叠，不需要整文件大小的 PSRAM；
+// 整文件读取先把文件读进 PSRAM 并立即关闭（需要尽早关闭文件时使用，TJpgDec 后端也需要）
+enum JpegLoadMode {
+    JPEG_LOAD_WHOLE,        // 整文件读入 PSRAM 后解码
+    JPEG_LOAD_STREAM        // 环形缓冲区流式读取（默认）
+};
+#define JPEG_LOAD_MODE_DEFAULT  JPEG_LOAD_STREAM
+
+// 最近一次 displayJPEG 的耗时
+typedef struct {
+    bool valid;
+    JpegLoadMode mode;          // 实际使用的读取方式
+    uint32_t fileBytes;
+    uint32_t firstPixelUs;      // 从开始读文件到解码器交出第一块像素
+    uint32_t totalUs;           // 读文件 + 解码 + 输出
+    uint32_t stalls;            // 流式：解码器等数据的次数
+} JpegLoadTiming;
+
+// GIF 播放统计（正在播放或最近一次播放）
+typedef struct {
+    bool valid;
+    bool playing;
+    uint16_t width;
+    uint16_t height;
+    uint32_t frameCount;        // 文件中的帧数
+    int32_t loopCount;          // 0 无限循环，n 为总播放遍数，-1 播放一遍
+    uint32_t framesShown;       // 已显示的帧数（含第一帧）
+    uint32_t lateFrames;        // 迟到超过 GIF_LATE_MS 的帧
+    uint32_t elapsedMs;         // 从第一帧到现在（或停止时）
+    uint32_t avgFrameUs;        // 第二帧起每帧解码 + 写屏的平均耗时
+    uint32_t maxFrameUs;
+    uint32_t avgDirtyPixels;    // 每帧变化区域的画布像素数
+} GifPlaybackStats;
+
+// 动画拦截自检（checkAnimationGate）：动画文件在预解码和帧缓存之后仍然播放，与扩展名无关
+typedef struct {
+    bool valid;
+    bool contentAnimated;       // 按内容识别为动画格式
+    bool prefetchRejected;      // 预解码（decodeImageToFrame）拒绝解码
+    bool firstAnimating;        // 第一次显示后在播放
+    bool secondAnimating;       // 再次显示（轮播回到它）后仍在播放
+    bool cached;                // 第一帧进了帧缓存（不应发生）
+    bool passed;
+} AnimationGateResult;
+
+// 最近一次切换过渡的统计
+typedef struct {
+    bool valid;
+    uint8_t type;               // ImageTransitionType（带宽不够只安排一步时为 IMG_TRANSITION_CUT）
+    uint16_t durationMs;        // 设置的总时长
+    uint16_t plannedSteps;      // 按目标帧率与估计的写屏耗时规划的步数
+    uint16_t shownSteps;        // 实际写出的步数
+    uint16_t skippedSteps;      // 落后于计划而跳过的步数
+    uint32_t estStepUs;         // 规划时估计的每步写屏耗时
+    uint32_t elapsedUs;         // 第一步开始到最后一步写完
+    uint32_t bytes;             // 写屏字节数（整帧为 LCD_WIDTH × LCD_HEIGHT × 2）
+    uint16_t diffX, diffY, diffW, diffH;    // 两帧不同的区域
+} ImageTransitionStats;
+
+// PNG / QOI 基准测试结果（同一张图片的两种文件；解码时间为从 PSRAM 解码并转成 RGB565 的平均值，不含读卡、不写屏）
+typedef struct {
+    bool valid;
+    uint16_t width;
+    uint16_t height;
+    uint8_t iterations;
+    uint32_t pngBytes;
+    uint32_t qoiBytes;
+    uint32_t pngUs;
+    uint32_t qoiUs;
+    uint32_t pngReadUs;         // 读卡（整文件读进 PSRAM）
+    uint32_t qoiReadUs;
+} QoiBenchResult;
+
+// JPEG 基准测试结果（周期数均为每 MCU 平均值）
+typedef struct {
+    bool valid;
+    uint16_t width;
+    uint16_t height;
+    uint32_t mcus;              // 每次解码的 MCU 数
+    uint8_t iterations;
+    uint32_t nativeCycles;      // 内置解码器总计
+    uint32_t entropyCycles;     // 其中：霍夫曼解码 + 反量化
+    uint32_t idctCycles;        // 其中：IDCT
+    uint32_t colorCycles;       // 其中：色彩转换与输出
+    uint32_t tjpgdecCycles;     // TJpgDec 总计
+    // 两种读取方式下内置解码器的首像素时间与总时间（微秒，含读卡，不写屏）
+    uint32_t wholeFirstPixelUs;
+    uint32_t wholeTotalUs;
+    uint32_t streamFirstPixelUs;
+    uint32_t streamTotalUs;
+} JpegBenchResult;
+
 // 函数声明
-ImageFormat getImageFormat(const char* filename);
+ImageFormat getImageFormat(const char* filename);            // 按扩展名（解码时按内容分派，见 Image_Registry.h）
+bool isImageFileName(const char* filename);                   // 扩展名属于已注册的格式（不打印日志）
+bool isAnimatedImageFile(const char* filename);               // 扩展名属于动画格式（GIF / MJPEG），不读卡的预筛；
+                                                              // 显示与预解码时另按内容判断（改了扩展名的动画）
+bool getImageInfo(const char* filename, ImageInfo* info);     // 按内容识别格式并读取尺寸，须持有 sdCardMutex
 bool loadAndDisplayImage(const char* filename);
 bool displayJPEG(const char* filename);
 bool displayPNG(const char* filename);
 bool displayBMP(const char* filename);
+bool displayR565(const char* filename);
+bool displayGIF(const char* filename);
+bool displayMJPEG(const char* filename);
+bool displayQOI(const char* filename);
 void initImageDecoder();
 
+// 合成模式
+void setImageOutputMode(ImageOutputMode mode);
+ImageOutputMode getImageOutputMode();
+void presentImageBuffer();      // 对 imageBuffer 做后处理（色温），按帧的方向设置 MADCTL 后整帧写屏
+
+// 缩放模式（超出屏幕的图片按解码缩放 + 重采样适配，小图可放大）
+// 修改后相关的帧缓存会作废；调用方须先中止后台预解码
+void setImageScaleMode(ImageScaleMode mode);                            // 全局默认
+ImageScaleMode getImageScaleMode();
+void setImageScaleModeFor(const char* filename, ImageScaleMode mode);   // IMG_SCALE_DEFAULT 表示跟随全局
+ImageScaleMode getImageScaleModeFor(const char* filename);              // 单张图片的设置（未设置时返回 IMG_SCALE_DEFAULT）
+
+// 显示方向：缓存的帧带有渲染时的视角键，修改设置或设备转向后旧帧自动不再命中，不需要清空缓存
+void setImageRotationMode(ImageRotationMode mode);
+ImageRotationMode getImageRotationMode();
+void setImageExifOrientation(bool enabled);                             // 是否按 JPEG 的 EXIF 方向摆正
+bool getImageExifOrientation();
+const char* getImageRotationModeName(ImageRotationMode mode);           // "0" / "90" / "180" / "270" / "auto" / "imu"
+bool parseImageRotationMode(const char* name, ImageRotationMode* mode);
+uint8_t getImageDeviceTurns();                                          // 加速度计判断的设备方向（顺时针 90° 的次数）
+bool serviceImageOrientation();     // loop 中调用：跟随加速度计时采样，方向（防抖后）变化返回 true，调用方重新显示当前图片
+uint8_t getImageViewKey();          // 当前视角键（IMAGE_ORIENT_VIEW_MASK 部分）
+uint8_t resolveImageOrientation(uint16_t width, uint16_t height, uint8_t exifXform);    // 返回方向标记
+
+// 切换过渡（只在 loop 所在任务中修改）
+void setImageTransition(ImageTransitionType type, uint16_t durationMs);
+ImageTransitionType getImageTransitionType();
+uint16_t getImageTransitionMs();
+bool getImageTransitionStats(ImageTransitionStats* stats);     // 最近一次过渡
+void invalidateShownFrame();        // 屏幕被图片流程以外的输出（LVGL 等）改写后调用，下一张整帧上传、不做过渡
+
+// GIF 动画与 MJPEG 片段：loop 中每次循环调用 serviceImageAnimation，到时间就解码下一帧并写屏；
+// 显示下一张图片时自动停止。只在 loop 所在任务中使用
+void serviceImageAnimation();
+bool isImageAnimating();
+bool getGifPlaybackStats(GifPlaybackStats* stats);
+// 动画拦截自检：按预解码任务的方式解码一次（须被拒绝），再连续显示两次（都须在播放、不进帧缓存）。
+// 会显示该文件，须持有 sdCardMutex，只在 loop 所在任务中调用；结果打印到串口
+bool checkAnimationGate(const char* filename, AnimationGateResult* result);
+bool getLastAnimationGate(AnimationGateResult* result);
+
+// JPEG 文件读取方式（流式读取不可用时自动使用整文件读取）
+void setJpegLoadMode(JpegLoadMode mode);
+JpegLoadMode getJpegLoadMode();
+bool getLastJpegLoadTiming(JpegLoadTiming* timing);
+
+// .r565 转码缓存：源图片按当前缩放模式渲染成整帧，存在同目录的 R565_CACHE_DIR_NAME 子目录中
+// （/uploaded/a.jpg → /uploaded/.r565/a.jpg.r565）；源文件或缩放模式变化后自动失效
+bool getR565CachePath(const char* source, char* out, size_t len);
+bool transcodeImageToR565(const char* filename, uint16_t* frame, volatile bool* cancel);   // 须持有 sdCardMutex
+void removeR565Cache(const char* source);                                                   // 须持有 sdCardMutex
+
+// 后台预解码：解码到指定帧（不写屏），结果同时写入帧缓存
+// cancel 非空且被置为 true 时尽快中止解码；orient 返回该帧的方向标记（MV 置位时帧为 LCD_HEIGHT × LCD_WIDTH）
+bool decodeImageToFrame(const char* filename, uint16_t* frame, volatile bool* cancel, uint8_t* orient);
+
+// JPEG 基准测试：两个后端各解码 iterations 次，并比较两种读取方式的首像素时间（不写屏），结果打印到串口
+bool benchmarkJPEG(const char* filename, uint8_t iterations, JpegBenchResult* result);
+bool getLastJpegBenchmark(JpegBenchResult* result);     // 最近一次成功的结果
+
+// BMP 像素转换基准测试：各转换内核的 Mpixel/s，结果打印到串口
+bool benchmarkPixelConvert(PixelBenchResult* result);
+bool getLastPixelBenchmark(PixelBenchResult* result);   // 最近一次的结果
+
+// 写屏带宽测试：用当前屏幕内容测 DMA / SPI 的 MB/s（见 LCD_Benchmark），结束后恢复屏幕，结果打印到串口
+bool benchmarkLcdTransfer(uint8_t iterations, LCD_BenchResult* result);
+
+// PNG / QOI 基准测试：base 为不带扩展名的路径，比较 base.png 与 base.qoi 的大小和解码时间，须持有 sdCardMutex
+bool benchmarkQOI(const char* base, uint8_t iterations, QoiBenchResult* result);
+bool getLastQoiBenchmark(QoiBenchResult* result);       // 最近一次成功的结果
+
 // JPEG 回调函数
 bool jpegDrawCallback(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap);
 
@@ -0,0 +1,183 @@
+#include "Image_Metrics.h"
+#include "Display_ST7789.h"
+#include "Log_Ring.h"
+#include <esp_heap_caps.h>
+
+// ============================================================
+// 当前样本（只由开始样本的任务访问）
+// ============================================================
+static ImageMetricsSample current;
+static TaskHandle_t owner = nullptr;           // nullptr 表示没有进行中的样本
+static uint32_t startUs = 0;
+static LCD_TransferStats lcdStart;
+static uint32_t heapStart = 0, heapMin = 0;
+static uint32_t psramStart = 0, psramMin = 0;
+
+// 环形缓冲区（loop 写入，Web 任务读取）
+static ImageMetricsSample ring[IMAGE_METRICS_SAMPLES];
+static int ringNext = 0;
+static int ringCount = 0;
+static SemaphoreHandle_t ringMutex = nullptr;
+
+static inline bool isOwner() {
+    return owner != nullptr && owner == xTaskGetCurrentTaskHandle();
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+void ImageMetrics_Init(void) {
+    if (ringMutex == nullptr) {
+        ringMutex = xSemaphoreCreateMutex();
+    }
+}
+
+void ImageMetrics_Begin(const char* filename) {
+    memset(&current, 0, sizeof(current));
+    const char* slash = strrchr(filename, '/');
+    strncpy(current.name, slash ? slash + 1 : filename, sizeof(current.name) - 1);
+    current.timestampMs = millis();
+
+    heapStart = heapMin = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    psramStart = psramMin = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    LCD_GetTransferStats(&lcdStart);
+    owner = xTaskGetCurrentTaskHandle();
+    startUs = micros();
+}
+
+void ImageMetrics_SetSource(ImageLoadSource source, const char* format) {
+    if (isOwner()) {
+        current.source = source;
+        current.format = format;
+    }
+}
+
+void ImageMetrics_AddOpen(uint32_t us) {
+    if (isOwner()) {
+        current.openUs += us;
+    }
+}
+
+void ImageMetrics_AddRead(uint32_t bytes, uint32_t us, uint32_t waitUs) {
+    if (isOwner()) {
+        current.readBytes += bytes;
+        current.readUs += us;
+        current.readWaitUs += waitUs;
+        ImageMetrics_SampleHeap();
+    }
+}
+
+void ImageMetrics_AddSpiSaved(uint32_t bytes) {
+    if (isOwner()) {
+        current.spiSavedBytes += bytes;
+    }
+}
+
+void ImageMetrics_AddFilter(uint32_t us) {
+    if (isOwner()) {
+        current.filterUs += us;
+    }
+}
+
+void ImageMetrics_SampleHeap(void) {
+    if (!isOwner()) {
+        return;
+    }
+    uint32_t heap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    uint32_t psram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    heapMin = heap < heapMin ? heap : heapMin;
+    psramMin = psram < psramMin ? psram : psramMin;
+}
+
+void ImageMetrics_End(bool ok) {
+    if (!isOwner()) {
+        return;
+    }
+    ImageMetrics_SampleHeap();
+    owner = nullptr;
+
+    ImageMetricsSample* s = &current;
+    s->ok = ok;
+    s->totalUs = micros() - startUs;
+
+    LCD_TransferStats lcd;
+    LCD_GetTransferStats(&lcd);
+    s->spiBytes = lcd.bytes - lcdStart.bytes;
+    s->spiUs = lcd.busyUs - lcdStart.busyUs;
+    s->spiWaitUs = lcd.waitUs - lcdStart.waitUs;
+    s->spiWindows = lcd.windows - lcdStart.windows;
+    s->spiWindowsElided = lcd.windowsElided - lcdStart.windowsElided;
+
+    uint32_t accounted = s->openUs + s->readWaitUs + s->filterUs + s->spiWaitUs;
+    s->decodeUs = s->totalUs > accounted ? s->totalUs - accounted : 0;
+    s->heapPeak = heapStart - heapMin;
+    s->psramPeak = psramStart - psramMin;
+
+    LOG_I("⏱ %s 加载 %.1f ms（打开 %.1f，读卡 %.1f / %lu 字节，解码 %.1f，滤镜 %.1f，写屏 %.1f）\n",
+          s->name, s->totalUs / 1000.0f, s->openUs / 1000.0f, s->readWaitUs / 1000.0f,
+          (unsigned long)s->readBytes, s->decodeUs / 1000.0f, s->filterUs / 1000.0f,
+          s->spiWaitUs / 1000.0f);
+
+    if (ringMutex == nullptr) {
+        return;
+    }
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    ring[ringNext] = *s;
+    ringNext = (ringNext + 1) % IMAGE_METRICS_SAMPLES;
+    if (ringCount < IMAGE_METRICS_SAMPLES) {
+        ringCount++;
+    }
+    xSemaphoreGive(ringMutex);
+}
+
+int ImageMetrics_Snapshot(ImageMetricsSample* out, int max) {
+    if (ringMutex == nullptr || out == nullptr) {
+        return 0;
+    }
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    int n = ringCount < max ? ringCount : max;
+    for (int i = 0; i < n; i++) {
+        out[i] = ring[(ringNext - 1 - i + IMAGE_METRICS_SAMPLES) % IMAGE_METRICS_SAMPLES];
+    }
+    xSemaphoreGive(ringMutex);
+    return n;
+}
+
+bool ImageMetrics_Percentiles(const ImageMetricsSample* samples, int count, size_t offset,
+                              ImageMetricsPercentiles* out) {
+    if (count <= 0 || out == nullptr) {
+        return false;
+    }
+    if (count > IMAGE_METRICS_SAMPLES) {
+        count = IMAGE_METRICS_SAMPLES;
+    }
+
+    // 取出该字段后插入排序（最多 IMAGE_METRICS_SAMPLES 个）
+    uint32_t v[IMAGE_METRICS_SAMPLES];
+    for (int i = 0; i < count; i++) {
+        uint32_t x = *(const uint32_t*)((const uint8_t*)&samples[i] + offset);
+        int j = i;
+        while (j > 0 && v[j - 1] > x) {
+            v[j] = v[j - 1];
+            j--;
+        }
+        v[j] = x;
+    }
+
+    // 最近秩：第 ceil(p × n) 小的值
+    out->p50 = v[(count * 50 + 99) / 100 - 1];
+    out->p95 = v[(count * 95 + 99) / 100 - 1];
+    out->max = v[count - 1];
+    return true;
+}
+
+const char* ImageMetrics_SourceName(uint8_t source) {
+    switch (source) {
+        case IMAGE_SOURCE_DECODE:       return "decode";
+        case IMAGE_SOURCE_R565_CACHE:   return "r565";
+        case IMAGE_SOURCE_FRAME_CACHE:  return "cache";
+        case IMAGE_SOURCE_PREFETCH:     return "prefetch";
+        default:                        return "unknown";
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+
+// ============================================================
+// 图片加载耗时统计
+// loadAndDisplayImage 每调用一次记录一条样本：打开文件、读卡、解码、色温滤镜、写屏各花了多少时间，
+// 以及加载期间内部 RAM / PSRAM 的峰值占用。最近 IMAGE_METRICS_SAMPLES 条存在环形缓冲区中，
+// 查询时按字段计算 p50 / p95 / 最大值（GET /metrics）。
+// 读卡、滤镜的耗时由各处调用 ImageMetrics_Add* 累加，只计入开始样本的任务（后台预解码不算）；
+// 写屏取 Display_ST7789 传输计数的差值。
+// ============================================================
+#define IMAGE_METRICS_SAMPLES   32      // 环形缓冲区容量
+#define IMAGE_METRICS_NAME_LEN  32      // 样本中保存的文件名长度（不含目录，过长截断）
+
+// 图片从哪里来
+typedef enum {
+    IMAGE_SOURCE_DECODE = 0,    // 解码源文件
+    IMAGE_SOURCE_R565_CACHE,    // .r565 转码缓存
+    IMAGE_SOURCE_FRAME_CACHE,   // 帧缓存命中
+    IMAGE_SOURCE_PREFETCH       // 后台预解码好的帧
+} ImageLoadSource;
+
+typedef struct {
+    char name[IMAGE_METRICS_NAME_LEN];
+    const char* format;         // 解码后端名称（nullptr 表示未知）
+    uint8_t source;             // ImageLoadSource
+    bool ok;
+    uint32_t timestampMs;       // 开始加载的时间（millis）
+
+    uint32_t totalUs;           // loadAndDisplayImage 总耗时
+    uint32_t openUs;            // 打开文件 / 读取文件信息
+    uint32_t readBytes;
+    uint32_t readUs;            // 读卡耗时（流式读取时在后台任务中，与解码重叠）
+    uint32_t readWaitUs;        // 加载流程等 SD 卡的时间（同步读取 + 流式缓冲区读空）
+    uint32_t decodeUs;          // 其余时间：totalUs − openUs − readWaitUs − filterUs − spiWaitUs
+    uint32_t filterUs;          // 色温滤镜
+    uint32_t spiBytes;
+    uint32_t spiUs;             // 写屏传输耗时（异步传输与解码重叠）
+    uint32_t spiWaitUs;         // 加载流程等写屏的时间（同步写屏 + 等待异步传输）
+    uint32_t spiSavedBytes;     // 差异上传时与屏幕内容相同、没有发送的字节数
+    uint32_t spiWindows;        // 发送的窗口设置（CASET + RASET）
+    uint32_t spiWindowsElided;  // 与上一次绘制相接、省掉的窗口设置
+    uint32_t heapPeak;          // 内部 RAM 峰值占用（相对开始时，采样值）
+    uint32_t psramPeak;         // PSRAM 峰值占用（相对开始时，采样值）
+} ImageMetricsSample;
+
+typedef struct {
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t max;
+} ImageMetricsPercentiles;
+
+/**
+ * @brief 创建互斥锁（在 initImageDecoder 中调用）
+ */
+void ImageMetrics_Init(void);
+
+/**
+ * @brief 开始一条样本（loadAndDisplayImage 开头调用）
+ */
+void ImageMetrics_Begin(const char* filename);
+
+/**
+ * @brief 记录图片来源与解码后端
+ */
+void ImageMetrics_SetSource(ImageLoadSource source, const char* format);
+
+/**
+ * @brief 累加打开文件的耗时
+ */
+void ImageMetrics_AddOpen(uint32_t us);
+
+/**
+ * @brief 累加读卡
+ * @param us     读卡耗时
+ * @param waitUs 其中加载流程被阻塞的时间（同步读取时与 us 相同）
+ */
+void ImageMetrics_AddRead(uint32_t bytes, uint32_t us, uint32_t waitUs);
+
+/**
+ * @brief 累加差异上传省下的写屏字节数
+ */
+void ImageMetrics_AddSpiSaved(uint32_t bytes);
+
+/**
+ * @brief 累加色温滤镜耗时
+ */
+void ImageMetrics_AddFilter(uint32_t us);
+
+/**
+ * @brief 采样一次剩余内存，更新峰值占用（缓冲区分配完之后调用）
+ */
+void ImageMetrics_SampleHeap(void);
+
+/**
+ * @brief 结束样本并放进环形缓冲区，打印一行汇总
+ */
+void ImageMetrics_End(bool ok);
+
+/**
+ * @brief 复制最近的样本（最新的在前）
+ * @return 复制的条数
+ */
+int ImageMetrics_Snapshot(ImageMetricsSample* out, int max);
+
+/**
+ * @brief 计算某个 uint32_t 字段的 p50 / p95 / 最大值（最近秩法）
+ * @param offset 字段偏移，例如 offsetof(ImageMetricsSample, decodeUs)
+ * @return false 没有样本
+ */
+bool ImageMetrics_Percentiles(const ImageMetricsSample* samples, int count, size_t offset,
+                              ImageMetricsPercentiles* out);
+
+const char* ImageMetrics_SourceName(uint8_t source);
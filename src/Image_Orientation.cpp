@@ -0,0 +1,201 @@
+#include "Image_Orientation.h"
+#include <string.h>
+
+#define NO_CANDIDATE    0xFF
+
+// EXIF Orientation 1..8 对应的方向变换（先交换行列，再镜像）
+//   1 原样      2 水平镜像    3 旋转 180°   4 垂直镜像
+//   5 转置      6 顺时针 90°  7 反转置      8 逆时针 90°
+static const uint8_t exifXforms[9] = {
+    0,
+    0,
+    IMAGE_ORIENT_MX,
+    IMAGE_ORIENT_MX | IMAGE_ORIENT_MY,
+    IMAGE_ORIENT_MY,
+    IMAGE_ORIENT_MV,
+    IMAGE_ORIENT_MV | IMAGE_ORIENT_MX,
+    IMAGE_ORIENT_MV | IMAGE_ORIENT_MX | IMAGE_ORIENT_MY,
+    IMAGE_ORIENT_MV | IMAGE_ORIENT_MY,
+};
+
+// ============================================================
+// 方向变换
+// ============================================================
+
+uint8_t ImageOrient_FromExif(uint16_t exifOrientation) {
+    return exifOrientation <= 8 ? exifXforms[exifOrientation] : 0;
+}
+
+uint8_t ImageOrient_FromTurns(uint8_t turns) {
+    static const uint8_t xforms[4] = {
+        0,
+        IMAGE_ORIENT_MV | IMAGE_ORIENT_MX,
+        IMAGE_ORIENT_MX | IMAGE_ORIENT_MY,
+        IMAGE_ORIENT_MV | IMAGE_ORIENT_MY,
+    };
+    return xforms[turns & 3];
+}
+
+uint8_t ImageOrient_Compose(uint8_t first, uint8_t then) {
+    bool fx = first & IMAGE_ORIENT_MX;
+    bool fy = first & IMAGE_ORIENT_MY;
+    // 后一步交换行列时，前一步的两个镜像方向随之互换
+    if (then & IMAGE_ORIENT_MV) {
+        bool t = fx;
+        fx = fy;
+        fy = t;
+    }
+    uint8_t out = (first ^ then) & IMAGE_ORIENT_MV;
+    if (fx != (bool)(then & IMAGE_ORIENT_MX)) {
+        out |= IMAGE_ORIENT_MX;
+    }
+    if (fy != (bool)(then & IMAGE_ORIENT_MY)) {
+        out |= IMAGE_ORIENT_MY;
+    }
+    return out;
+}
+
+// ============================================================
+// EXIF
+// ============================================================
+
+static inline uint16_t rd16(const uint8_t* p, bool le) {
+    return le ? (uint16_t)(p[0] | (p[1] << 8)) : (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t rd32(const uint8_t* p, bool le) {
+    return le ? ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24))
+              : (((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]);
+}
+
+/**
+ * @brief 在 TIFF 结构（Exif 段 "Exif\0\0" 之后）的 IFD0 中查找 Orientation（0x0112）
+ */
+static uint16_t parseTiffOrientation(const uint8_t* tiff, size_t len) {
+    if (len < 8) {
+        return 0;
+    }
+    bool le;
+    if (tiff[0] == 'I' && tiff[1] == 'I') {
+        le = true;
+    } else if (tiff[0] == 'M' && tiff[1] == 'M') {
+        le = false;
+    } else {
+        return 0;
+    }
+    if (rd16(tiff + 2, le) != 42) {
+        return 0;
+    }
+
+    uint32_t ifd = rd32(tiff + 4, le);
+    if (ifd > len - 2) {
+        return 0;
+    }
+    uint16_t count = rd16(tiff + ifd, le);
+    const uint8_t* e = tiff + ifd + 2;
+    for (uint16_t i = 0; i < count; i++, e += 12) {
+        if ((size_t)(e + 12 - tiff) > len) {
+            break;
+        }
+        // SHORT（类型 3），值在条目内的前 2 字节
+        if (rd16(e, le) == 0x0112 && rd16(e + 2, le) == 3) {
+            uint16_t v = rd16(e + 8, le);
+            return (v >= 1 && v <= 8) ? v : 0;
+        }
+    }
+    return 0;
+}
+
+uint16_t ImageOrient_ParseJpegExif(const uint8_t* data, size_t len) {
+    if (len < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return 0;
+    }
+
+    // 只看 SOI 之后连续的 APPn / COM 段，遇到其他段（DQT、SOF、SOS…）就停止
+    size_t pos = 2;
+    while (pos + 4 <= len) {
+        if (data[pos] != 0xFF) {
+            return 0;
+        }
+        uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            pos++;          // 填充字节
+            continue;
+        }
+        if (!((marker >= 0xE0 && marker <= 0xEF) || marker == 0xFE)) {
+            return 0;
+        }
+        size_t segLen = ((size_t)data[pos + 2] << 8) | data[pos + 3];
+        if (segLen < 2) {
+            return 0;
+        }
+        const uint8_t* body = data + pos + 4;
+        size_t avail = len - pos - 4;
+        size_t bodyLen = segLen - 2 < avail ? segLen - 2 : avail;
+        if (marker == 0xE1 && bodyLen >= 6 && memcmp(body, "Exif\0\0", 6) == 0) {
+            return parseTiffOrientation(body + 6, bodyLen - 6);
+        }
+        pos += 2 + segLen;
+    }
+    return 0;
+}
+
+// ============================================================
+// 加速度计
+// ============================================================
+
+/**
+ * @brief 由屏幕平面内的重力方向判断画面应旋转的次数，平放或斜放时返回 NO_CANDIDATE
+ */
+static uint8_t classify(float upX, float upY) {
+    if (upX * upX + upY * upY < IMAGE_ORIENT_MIN_TILT * IMAGE_ORIENT_MIN_TILT) {
+        return NO_CANDIDATE;
+    }
+    float ax = upX < 0 ? -upX : upX;
+    float ay = upY < 0 ? -upY : upY;
+    if (ay >= ax * IMAGE_ORIENT_AXIS_RATIO) {
+        return upY < 0 ? 0 : 2;         // 屏幕上边 / 下边朝上
+    }
+    if (ax >= ay * IMAGE_ORIENT_AXIS_RATIO) {
+        return upX > 0 ? 1 : 3;         // 屏幕右边朝上：画面顺时针转 90°
+    }
+    return NO_CANDIDATE;
+}
+
+void ImageOrient_TrackerInit(ImageOrientTracker* t, uint8_t turns) {
+    t->turns = turns & 3;
+    t->candidate = NO_CANDIDATE;
+    t->sinceMs = 0;
+}
+
+bool ImageOrient_TrackGravity(ImageOrientTracker* t, float upX, float upY, uint32_t nowMs) {
+    uint8_t c = classify(upX, upY);
+    if (c == NO_CANDIDATE || c == t->turns) {
+        t->candidate = NO_CANDIDATE;
+        return false;
+    }
+    if (c != t->candidate) {
+        t->candidate = c;
+        t->sinceMs = nowMs;
+        return false;
+    }
+    if (nowMs - t->sinceMs < IMAGE_ORIENT_DEBOUNCE_MS) {
+        return false;
+    }
+    t->turns = c;
+    t->candidate = NO_CANDIDATE;
+    return true;
+}
+
+const char* ImageOrient_Name(uint8_t xform) {
+    switch (xform & IMAGE_ORIENT_XFORM_MASK) {
+        case 0:                                                     return "none";
+        case IMAGE_ORIENT_MX:                                       return "flipx";
+        case IMAGE_ORIENT_MY:                                       return "flipy";
+        case IMAGE_ORIENT_MX | IMAGE_ORIENT_MY:                     return "rot180";
+        case IMAGE_ORIENT_MV:                                       return "transpose";
+        case IMAGE_ORIENT_MV | IMAGE_ORIENT_MX:                     return "rot90";
+        case IMAGE_ORIENT_MV | IMAGE_ORIENT_MY:                     return "rot270";
+        default:                                                    return "transverse";
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// 显示方向
+// 方向变换用 ST7789 MADCTL（0x36）的三个位表示：MV 交换行列，MX / MY 镜像列 / 行。
+// 写屏时像素按逻辑坐标送出，由面板控制器完成旋转 / 镜像，CPU 不搬移任何像素；
+// MV 置位时逻辑屏幕为横屏（宽高互换）。三个位的 8 种组合正好覆盖 EXIF 的 8 种方向。
+// 不依赖 Arduino，可直接在 x86 Linux 上编译。
+//
+// 方向标记（1 字节，帧缓存、预解码帧与 .r565 转码缓存随帧保存）：
+//   高 3 位  写屏时的方向变换（IMAGE_ORIENT_XFORM_MASK）
+//   低 5 位  渲染时的视角键（IMAGE_ORIENT_VIEW_MASK）：固定 / 跟随加速度计时的旋转次数、
+//            是否按宽高比自动选择、是否应用 EXIF。视角键相同则同一文件渲染出的帧相同，缓存可直接使用
+// ============================================================
+#define IMAGE_ORIENT_MV             0x20    // 行列交换
+#define IMAGE_ORIENT_MX             0x40    // 列地址镜像（交换之后的 x）
+#define IMAGE_ORIENT_MY             0x80    // 行地址镜像（交换之后的 y）
+#define IMAGE_ORIENT_XFORM_MASK     0xE0
+
+#define IMAGE_ORIENT_VIEW_TURNS     0x03    // 顺时针 90° 的次数
+#define IMAGE_ORIENT_VIEW_AUTO      0x04    // 按图片宽高比选择竖屏 / 横屏
+#define IMAGE_ORIENT_VIEW_EXIF      0x08    // 应用 EXIF 方向
+#define IMAGE_ORIENT_VIEW_MASK      0x1F
+
+// 加速度计方向判断
+#define IMAGE_ORIENT_MIN_TILT       0.5f    // 屏幕平面内的重力分量低于此值（g）视为平放，保持当前方向
+#define IMAGE_ORIENT_AXIS_RATIO     1.5f    // 主轴分量须超过另一轴的倍数（约 56°），斜放时保持当前方向
+#define IMAGE_ORIENT_DEBOUNCE_MS    600     // 新方向持续这么久才切换
+
+// 加速度计方向跟踪（调用方分配，先 ImageOrient_TrackerInit）
+typedef struct {
+    uint8_t turns;          // 当前生效的方向（顺时针 90° 的次数）
+    uint8_t candidate;      // 正在计时的新方向（0xFF 表示没有）
+    uint32_t sinceMs;       // candidate 开始出现的时间
+} ImageOrientTracker;
+
+/**
+ * @brief EXIF Orientation（1..8）→ 方向变换：把存储的像素摆正；其他值返回 0（不变换）
+ */
+uint8_t ImageOrient_FromExif(uint16_t exifOrientation);
+
+/**
+ * @brief 画面顺时针旋转 turns × 90° 的方向变换
+ */
+uint8_t ImageOrient_FromTurns(uint8_t turns);
+
+/**
+ * @brief 先做 first、再做 then 的组合变换
+ */
+uint8_t ImageOrient_Compose(uint8_t first, uint8_t then);
+
+/**
+ * @brief 从 JPEG 文件开头查找 APP1 Exif 段中 IFD0 的 Orientation 标签
+ * @param data JPEG 文件开头（通常 512 字节足够，标签在缓冲区之外时视为没有）
+ * @return 1..8，没有 EXIF 或没有该标签时返回 0
+ */
+uint16_t ImageOrient_ParseJpegExif(const uint8_t* data, size_t len);
+
+void ImageOrient_TrackerInit(ImageOrientTracker* t, uint8_t turns);
+
+/**
+ * @brief 输入一次加速度读数，防抖后方向变化时返回 true（新方向见 t->turns）
+ * @param upX,upY 加速度计读数换算到屏幕坐标（屏幕向右为 +x、向下为 +y，单位 g）：
+ *                静止时读数指向上方，竖直握持（屏幕上边朝上）时 upY ≈ -1
+ */
+bool ImageOrient_TrackGravity(ImageOrientTracker* t, float upX, float upY, uint32_t nowMs);
+
+/**
+ * @brief 方向变换的名称（日志与 /rotation 使用），例如 "rot90"、"flipx"
+ */
+const char* ImageOrient_Name(uint8_t xform);
@@ -0,0 +1,205 @@
+#include "Image_Prefetch.h"
+#include "Image_Decoder.h"
+#include "Frame_Cache.h"
+#include "WebServer_Driver.h"
+#include <esp_heap_caps.h>
+
+// ============================================================
+// 运行时状态（受 slotMutex 保护）
+// ============================================================
+
+static TaskHandle_t prefetchTask = nullptr;
+static SemaphoreHandle_t slotMutex = nullptr;
+
+// 待处理的请求
+static char requestPath[100] = "";
+static volatile uint32_t generation = 0;       // 每次请求/取消递增，用来丢弃过期结果
+static volatile bool cancelFlag = false;
+
+// 预取帧槽位
+static uint16_t* spareFrame = nullptr;
+static bool slotReady = false;
+static char slotPath[100] = "";
+static uint32_t slotMtime = 0;
+static uint32_t slotSize = 0;
+static uint8_t slotOrient = 0;          // 方向标记（低 5 位为渲染时的视角键）
+
+static PrefetchStats stats = { 0 };
+
+// ============================================================
+// 预取任务
+// ============================================================
+
+/**
+ * 获取 sdCardMutex：每次只等待很短时间，拿不到就退避，
+ * 期间有新请求或取消则放弃
+ */
+static bool acquireSdCard(uint32_t gen) {
+    while (gen == generation) {
+        if (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(PREFETCH_LOCK_WAIT_MS)) == pdTRUE) {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(PREFETCH_BACKOFF_MS));
+    }
+    return false;
+}
+
+static void PrefetchTask(void *parameter) {
+    char path[100];
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(slotMutex, portMAX_DELAY);
+        strncpy(path, requestPath, sizeof(path));
+        requestPath[0] = '\0';
+        uint32_t gen = generation;
+        cancelFlag = false;
+        xSemaphoreGive(slotMutex);
+
+        if (path[0] == '\0' || !acquireSdCard(gen)) {
+            continue;
+        }
+
+        File f = SD_MMC.open(path, FILE_READ);
+        if (!f) {
+            xSemaphoreGive(sdCardMutex);
+            continue;
+        }
+        uint32_t mtime = (uint32_t)f.getLastWrite();
+        uint32_t size = f.size();
+        f.close();
+        uint8_t view = getImageViewKey();
+
+        // 已在槽位或帧缓存中就不必重复解码
+        xSemaphoreTake(slotMutex, portMAX_DELAY);
+        bool alreadyReady = slotReady && slotMtime == mtime && slotSize == size &&
+                            (slotOrient & IMAGE_ORIENT_VIEW_MASK) == view && strcmp(slotPath, path) == 0;
+        if (!alreadyReady) {
+            slotReady = false;      // 即将改写 spareFrame
+        }
+        xSemaphoreGive(slotMutex);
+
+        if (alreadyReady || FrameCache_Contains(path, mtime, size, view)) {
+            xSemaphoreGive(sdCardMutex);
+            continue;
+        }
+
+        uint8_t orient = 0;
+        bool ok = decodeImageToFrame(path, spareFrame, &cancelFlag, &orient);
+        xSemaphoreGive(sdCardMutex);
+
+        xSemaphoreTake(slotMutex, portMAX_DELAY);
+        if (ok && gen == generation) {
+            strncpy(slotPath, path, sizeof(slotPath));
+            slotMtime = mtime;
+            slotSize = size;
+            slotOrient = orient;
+            slotReady = true;
+            stats.prepared++;
+        } else {
+            stats.cancelled++;
+        }
+        xSemaphoreGive(slotMutex);
+    }
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+void Prefetch_Init(void) {
+    if (prefetchTask != nullptr) {
+        return;
+    }
+
+    spareFrame = (uint16_t*)heap_caps_malloc(IMG_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    slotMutex = xSemaphoreCreateMutex();
+    if (spareFrame == nullptr || slotMutex == nullptr || sdCardMutex == NULL) {
+        Serial.println("⚠️ 预取备用帧分配失败，后台预解码已禁用");
+        return;
+    }
+
+    xTaskCreatePinnedToCore(PrefetchTask, "Prefetch", PREFETCH_TASK_STACK, NULL,
+                            PREFETCH_TASK_PRIO, &prefetchTask, PREFETCH_TASK_CORE);
+    Serial.println("✓ 后台预解码任务已启动");
+}
+
+void Prefetch_Request(const char* path) {
+    if (prefetchTask == nullptr || path == nullptr || strlen(path) >= sizeof(requestPath)) {
+        return;
+    }
+    if (isAnimatedImageFile(path)) {
+        return;     // 动画在显示时才解码
+    }
+
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    strncpy(requestPath, path, sizeof(requestPath));
+    generation++;
+    cancelFlag = true;      // 中止旧请求，任务取到新请求时会清除
+    xSemaphoreGive(slotMutex);
+
+    xTaskNotifyGive(prefetchTask);
+}
+
+void Prefetch_Cancel(void) {
+    if (prefetchTask == nullptr) {
+        return;
+    }
+
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    requestPath[0] = '\0';
+    generation++;
+    cancelFlag = true;
+    xSemaphoreGive(slotMutex);
+}
+
+void Prefetch_Discard(void) {
+    if (prefetchTask == nullptr) {
+        return;
+    }
+
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    requestPath[0] = '\0';
+    generation++;
+    cancelFlag = true;
+    slotReady = false;
+    xSemaphoreGive(slotMutex);
+}
+
+uint16_t* Prefetch_Exchange(const char* path, uint32_t mtime, uint32_t size, uint8_t view,
+                            uint16_t* current, uint8_t* orient) {
+    if (prefetchTask == nullptr || path == nullptr || current == nullptr) {
+        return nullptr;
+    }
+
+    uint16_t* frame = nullptr;
+
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    if (slotReady && slotMtime == mtime && slotSize == size &&
+        (slotOrient & IMAGE_ORIENT_VIEW_MASK) == view && strcmp(slotPath, path) == 0) {
+        frame = spareFrame;
+        if (orient != nullptr) {
+            *orient = slotOrient;
+        }
+        spareFrame = current;
+        slotReady = false;
+        stats.used++;
+    }
+    xSemaphoreGive(slotMutex);
+
+    return frame;
+}
+
+void Prefetch_GetStats(PrefetchStats* out) {
+    if (out == nullptr) {
+        return;
+    }
+    if (slotMutex != nullptr) {
+        xSemaphoreTake(slotMutex, portMAX_DELAY);
+    }
+    *out = stats;
+    if (slotMutex != nullptr) {
+        xSemaphoreGive(slotMutex);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================
+// 轮播下一张图片的后台预解码（核心 0）
+// 停留期间把下一张图片解码到备用 PSRAM 帧，切换时只需交换帧指针并整帧写屏。
+// 与 loop 共用 sdCardMutex：拿不到锁就退避重试，不会饿死上传。
+// ============================================================
+#define PREFETCH_TASK_CORE      0
+#define PREFETCH_TASK_PRIO      1       // 低于 DriverTask 和 SPI 任务
+#define PREFETCH_TASK_STACK     8192
+#define PREFETCH_LOCK_WAIT_MS   20      // 单次尝试获取 sdCardMutex 的等待时间
+#define PREFETCH_BACKOFF_MS     100     // 拿不到锁时的退避时间
+
+// 预取统计
+typedef struct {
+    uint32_t prepared;      // 解码完成的帧数
+    uint32_t used;          // 被 loop 直接使用的帧数
+    uint32_t cancelled;     // 被取消的预取数
+} PrefetchStats;
+
+/**
+ * @brief 分配备用帧并创建预取任务（须在 WebServer_Init 创建 sdCardMutex 之后调用）
+ */
+void Prefetch_Init(void);
+
+/**
+ * @brief 请求预解码某个文件，会中止正在进行的旧请求
+ */
+void Prefetch_Request(const char* path);
+
+/**
+ * @brief 中止正在进行的预解码（已完成的预取帧保留）
+ */
+void Prefetch_Cancel(void);
+
+/**
+ * @brief 中止预解码并丢弃已完成的预取帧（缩放模式等渲染参数变化后调用）
+ */
+void Prefetch_Discard(void);
+
+/**
+ * @brief 取走预取帧
+ * @param path    文件路径
+ * @param mtime   文件修改时间
+ * @param size    文件大小
+ * @param view    当前视角键（预取后设备转向或方向设置变化时不命中）
+ * @param current 调用方当前的帧缓冲区，交换后成为新的备用帧
+ * @param orient  输出：预取帧的方向标记
+ * @return 命中时返回已解码完成的帧，未命中返回 nullptr
+ */
+uint16_t* Prefetch_Exchange(const char* path, uint32_t mtime, uint32_t size, uint8_t view,
+                            uint16_t* current, uint8_t* orient);
+
+/**
+ * @brief 读取统计信息
+ */
+void Prefetch_GetStats(PrefetchStats* stats);
@@ -0,0 +1,101 @@
+#include "Image_Registry.h"
+
+// ============================================================
+// 注册表
+// ============================================================
+
+static const ImageBackend* backends[IMAGE_REGISTRY_MAX] = { nullptr };
+static ImageBackendStats backendStats[IMAGE_REGISTRY_MAX];
+static int backendCount = 0;
+
+static int indexOf(const ImageBackend* backend) {
+    for (int i = 0; i < backendCount; i++) {
+        if (backends[i] == backend) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool ImageRegistry_Register(const ImageBackend* backend) {
+    if (backend == nullptr || backend->decode == nullptr || indexOf(backend) >= 0) {
+        return false;
+    }
+    if (backendCount >= IMAGE_REGISTRY_MAX) {
+        Serial.printf("✗ 解码后端注册表已满，无法注册 %s\n", backend->name);
+        return false;
+    }
+
+    memset(&backendStats[backendCount], 0, sizeof(ImageBackendStats));
+    backends[backendCount++] = backend;
+    return true;
+}
+
+// ============================================================
+// 查找
+// ============================================================
+
+const ImageBackend* ImageRegistry_Probe(const uint8_t* header, size_t len) {
+    if (header == nullptr || len == 0) {
+        return nullptr;
+    }
+    for (int i = 0; i < backendCount; i++) {
+        if (backends[i]->probe != nullptr && backends[i]->probe(header, len)) {
+            return backends[i];
+        }
+    }
+    return nullptr;
+}
+
+const ImageBackend* ImageRegistry_FindByExtension(const char* filename) {
+    const char* ext = (filename != nullptr) ? strrchr(filename, '.') : nullptr;
+    if (ext == nullptr) {
+        return nullptr;
+    }
+    for (int i = 0; i < backendCount; i++) {
+        for (const char* const* e = backends[i]->extensions; e != nullptr && *e != nullptr; e++) {
+            if (strcasecmp(ext, *e) == 0) {
+                return backends[i];
+            }
+        }
+    }
+    return nullptr;
+}
+
+int ImageRegistry_Count(void) {
+    return backendCount;
+}
+
+const ImageBackend* ImageRegistry_Get(int index) {
+    return (index >= 0 && index < backendCount) ? backends[index] : nullptr;
+}
+
+// ============================================================
+// 统计
+// ============================================================
+
+void ImageRegistry_Record(const ImageBackend* backend, uint32_t us, bool ok) {
+    int i = indexOf(backend);
+    if (i < 0) {
+        return;
+    }
+    ImageBackendStats& s = backendStats[i];
+    s.decodes++;
+    s.lastUs = us;
+    if (!ok) {
+        s.failures++;
+        return;
+    }
+    s.totalUs += us;
+    if (us > s.maxUs) {
+        s.maxUs = us;
+    }
+}
+
+bool ImageRegistry_GetStats(int index, ImageBackendStats* stats) {
+    if (index < 0 || index >= backendCount || stats == nullptr) {
+        return false;
+    }
+    *stats = backendStats[index];
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Image_Decoder.h"
+
+// ============================================================
+// 图片解码后端注册表
+// 每种格式一个后端：probe 按文件开头的 IMAGE_SNIFF_BYTES 字节识别内容，
+// info 读取尺寸，decode 解码并输出（走 Image_Decoder 的摆放 / 合成 / 写屏流程）。
+// loadAndDisplayImage 按内容分派，扩展名只用于文件列表和没有魔数的格式；
+// 新格式只需在 initImageDecoder 之后注册一个后端，分派代码不用改。
+// 注册表与统计由 g_decodeMutex 保护（注册在启动时完成）。
+// ============================================================
+#define IMAGE_REGISTRY_MAX      8       // 最多注册的后端数
+#define IMAGE_SNIFF_BYTES       16      // 用于识别内容的文件开头字节数
+
+typedef struct {
+    const char* name;                   // 日志与 /decoders 中显示的名称
+    ImageFormat format;
+    const char* const* extensions;      // 以 nullptr 结尾的扩展名列表（含点号，不区分大小写）
+
+    /**
+     * @brief 按文件开头识别内容（len 可能小于 IMAGE_SNIFF_BYTES）；为 nullptr 时只按扩展名匹配
+     */
+    bool (*probe)(const uint8_t* header, size_t len);
+
+    /**
+     * @brief 读取图片尺寸（不解码像素），调用方须持有 sdCardMutex
+     */
+    bool (*info)(const char* filename, ImageInfo* info);
+
+    /**
+     * @brief 解码并按当前输出模式输出，调用方须持有 sdCardMutex 与 g_decodeMutex
+     */
+    bool (*decode)(const char* filename);
+
+    bool animated;                      // 多帧格式：不进帧缓存、不预解码、不转码
+} ImageBackend;
+
+// 每个后端的解码统计（耗时含读卡，不含转码缓存命中）
+typedef struct {
+    uint32_t decodes;
+    uint32_t failures;          // 包括被取消的解码
+    uint32_t lastUs;
+    uint32_t maxUs;
+    uint64_t totalUs;           // 成功解码的总耗时
+} ImageBackendStats;
+
+/**
+ * @brief 注册后端（按注册顺序探测，先注册的优先）
+ * @return false 注册表已满或参数无效
+ */
+bool ImageRegistry_Register(const ImageBackend* backend);
+
+/**
+ * @brief 按内容查找后端
+ * @return 第一个 probe 返回 true 的后端，没有则返回 nullptr
+ */
+const ImageBackend* ImageRegistry_Probe(const uint8_t* header, size_t len);
+
+/**
+ * @brief 按扩展名查找后端（不打印日志）
+ */
+const ImageBackend* ImageRegistry_FindByExtension(const char* filename);
+
+/**
+ * @brief 枚举已注册的后端
+ */
+int ImageRegistry_Count(void);
+const ImageBackend* ImageRegistry_Get(int index);
+
+/**
+ * @brief 记录一次解码耗时 / 读取统计
+ */
+void ImageRegistry_Record(const ImageBackend* backend, uint32_t us, bool ok);
+bool ImageRegistry_GetStats(int index, ImageBackendStats* stats);
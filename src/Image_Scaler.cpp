@@ -0,0 +1,463 @@
+#include "Image_Scaler.h"
+#include <string.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
+
+// ============================================================
+// 内存分配：行缓冲区都很小，优先内部 RAM；拼行缓冲区可能较大，放不下时用 PSRAM
+// ============================================================
+static void* scalerAlloc(size_t n) {
+#ifdef ESP_PLATFORM
+    void* p = nullptr;
+    if (n <= 16 * 1024) {
+        p = heap_caps_malloc(n, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (p == nullptr) {
+        p = heap_caps_malloc(n, MALLOC_CAP_SPIRAM);
+    }
+    if (p == nullptr) {
+        p = malloc(n);
+    }
+    return p;
+#else
+    return malloc(n);
+#endif
+}
+
+// ============================================================
+// 摆放与映射
+// ============================================================
+
+void ImageScaler_Layout(uint32_t imgW, uint32_t imgH, uint16_t screenW, uint16_t screenH,
+                        ImageScaleMode mode, ImageLayout* layout) {
+    memset(layout, 0, sizeof(*layout));
+    if (imgW == 0 || imgH == 0 || screenW == 0 || screenH == 0) {
+        return;
+    }
+
+    if (mode == IMG_SCALE_CENTER) {
+        layout->dstW = imgW;
+        layout->dstH = imgH;
+    } else {
+        // 图片比屏幕更宽时，适应模式以宽度为准，填充模式以高度为准
+        bool wider = (uint64_t)imgW * screenH >= (uint64_t)imgH * screenW;
+        bool matchWidth = (mode == IMG_SCALE_FILL) ? !wider : wider;
+        if (matchWidth) {
+            layout->dstW = screenW;
+            layout->dstH = (uint32_t)(((uint64_t)imgH * screenW + imgW / 2) / imgW);
+        } else {
+            layout->dstH = screenH;
+            layout->dstW = (uint32_t)(((uint64_t)imgW * screenH + imgH / 2) / imgH);
+        }
+        if (layout->dstW == 0) {
+            layout->dstW = 1;
+        }
+        if (layout->dstH == 0) {
+            layout->dstH = 1;
+        }
+    }
+
+    layout->offX = ((int32_t)screenW - (int32_t)layout->dstW) / 2;
+    layout->offY = ((int32_t)screenH - (int32_t)layout->dstH) / 2;
+
+    int32_t x0 = layout->offX > 0 ? layout->offX : 0;
+    int32_t y0 = layout->offY > 0 ? layout->offY : 0;
+    int64_t x1 = (int64_t)layout->offX + layout->dstW;
+    int64_t y1 = (int64_t)layout->offY + layout->dstH;
+    if (x1 > screenW) {
+        x1 = screenW;
+    }
+    if (y1 > screenH) {
+        y1 = screenH;
+    }
+    layout->viewX = (uint16_t)x0;
+    layout->viewY = (uint16_t)y0;
+    layout->viewW = (uint16_t)(x1 - x0);
+    layout->viewH = (uint16_t)(y1 - y0);
+}
+
+uint8_t ImageScaler_PickJpegScale(uint32_t imgW, uint32_t imgH, const ImageLayout* layout) {
+    for (uint8_t s = 3; s > 0; s--) {
+        if ((imgW >> s) >= layout->dstW && (imgH >> s) >= layout->dstH) {
+            return s;
+        }
+    }
+    return 0;
+}
+
+bool ImageScaler_IsPassthrough(const ImageLayout* layout, uint16_t srcW, uint16_t srcH) {
+    return srcW == layout->dstW && srcH == layout->dstH &&
+           layout->viewW == layout->dstW && layout->viewH == layout->dstH;
+}
+
+/**
+ * @brief 盒式滤波：缩放后第 v 行/列对应的第一个源行/列
+ */
+static inline uint32_t boxStart(uint32_t v, uint32_t src, uint32_t dst) {
+    uint64_t s = (uint64_t)v * src / dst;
+    return s > src ? src : (uint32_t)s;
+}
+
+/**
+ * @brief 双线性：缩放后第 v 行/列的中心映射到源坐标（1/256 精度，像素中心对齐）
+ */
+static inline void bilinearPos(uint32_t v, uint32_t src, uint32_t dst, uint32_t* index, uint8_t* frac) {
+    int64_t p = ((int64_t)(2 * (uint64_t)v + 1) * src * 128) / dst - 128;
+    if (p < 0) {
+        p = 0;
+    }
+    uint32_t i = (uint32_t)(p >> 8);
+    uint8_t f = (uint8_t)(p & 0xFF);
+    if (i >= src - 1) {
+        i = src - 1;
+        f = 0;
+    }
+    *index = i;
+    *frac = f;
+}
+
+// ============================================================
+// 行处理
+// ============================================================
+
+/**
+ * @brief 水平方向：一行源像素 → 每个可见列的 R/G/B 分量和
+ * @param add true 时累加到 dst（盒式垂直累加）
+ */
+static void horizontalPass(const ImageScaler* sc, const uint16_t* src, uint32_t* dst, bool add) {
+    if (sc->boxX) {
+        const uint16_t* xi = sc->xIndex;
+        for (uint16_t i = 0; i < sc->viewW; i++, dst += 3) {
+            uint32_t r = 0, g = 0, b = 0;
+            for (uint32_t k = xi[i]; k < xi[i + 1]; k++) {
+                uint16_t p = src[k];
+                r += p >> 11;
+                g += (p >> 5) & 0x3F;
+                b += p & 0x1F;
+            }
+            if (add) {
+                dst[0] += r;
+                dst[1] += g;
+                dst[2] += b;
+            } else {
+                dst[0] = r;
+                dst[1] = g;
+                dst[2] = b;
+            }
+        }
+        return;
+    }
+
+    uint16_t last = sc->srcW - 1;
+    for (uint16_t i = 0; i < sc->viewW; i++, dst += 3) {
+        uint16_t x = sc->xIndex[i];
+        uint16_t p0 = src[x];
+        uint16_t p1 = src[x < last ? x + 1 : last];
+        uint32_t f = sc->xFrac[i];
+        uint32_t nf = 256 - f;
+        uint32_t r = (p0 >> 11) * nf + (p1 >> 11) * f;
+        uint32_t g = ((p0 >> 5) & 0x3F) * nf + ((p1 >> 5) & 0x3F) * f;
+        uint32_t b = (p0 & 0x1F) * nf + (p1 & 0x1F) * f;
+        if (add) {
+            dst[0] += r;
+            dst[1] += g;
+            dst[2] += b;
+        } else {
+            dst[0] = r;
+            dst[1] = g;
+            dst[2] = b;
+        }
+    }
+}
+
+static void flushOutput(ImageScaler* sc) {
+    if (sc->outLines == 0) {
+        return;
+    }
+    if (!sc->failed && !sc->out(sc->viewX, sc->outY, sc->viewW, sc->outLines, sc->outBuf)) {
+        sc->failed = true;
+    }
+    sc->outY += sc->outLines;
+    sc->outLines = 0;
+}
+
+static inline uint16_t* nextOutputLine(ImageScaler* sc) {
+    return sc->outBuf + (uint32_t)sc->outLines * sc->viewW;
+}
+
+static inline void commitOutputLine(ImageScaler* sc) {
+    if (++sc->outLines == IMAGE_SCALER_OUT_LINES) {
+        flushOutput(sc);
+    }
+}
+
+/**
+ * @brief 分量和 → 一行 RGB565 输出
+ * @param a,b   b 为空时输出 a / vDiv；否则按 b 的权重 fb（/256）在两行间插值
+ */
+static void emitRow(ImageScaler* sc, const uint32_t* a, const uint32_t* b, uint32_t fb, uint32_t vDiv) {
+    uint16_t* line = nextOutputLine(sc);
+    uint32_t na = 256 - fb;
+    if (b != nullptr) {
+        vDiv = 256;
+    }
+
+    for (uint16_t i = 0; i < sc->viewW; i++, a += 3) {
+        uint32_t div = (sc->boxX ? (uint32_t)(sc->xIndex[i + 1] - sc->xIndex[i]) : 256u) * vDiv;
+        uint32_t half = div >> 1;
+        uint32_t r, g, bl;
+        if (b != nullptr) {
+            r = a[0] * na + b[0] * fb;
+            g = a[1] * na + b[1] * fb;
+            bl = a[2] * na + b[2] * fb;
+            b += 3;
+        } else {
+            r = a[0];
+            g = a[1];
+            bl = a[2];
+        }
+        line[i] = (uint16_t)((((r + half) / div) << 11) | (((g + half) / div) << 5) | ((bl + half) / div));
+    }
+    commitOutputLine(sc);
+}
+
+static void pushRow(ImageScaler* sc, const uint16_t* row) {
+    uint32_t r = sc->srcRow++;
+    uint32_t vEnd = sc->v0 + sc->viewH;
+    if (r >= sc->srcH || sc->vNext >= vEnd) {
+        return;
+    }
+
+    // 1:1 只裁剪
+    if (sc->copyMode) {
+        if (r >= sc->v0) {
+            memcpy(nextOutputLine(sc), row + sc->u0, sc->viewW * 2);
+            commitOutputLine(sc);
+            sc->vNext++;
+        }
+        return;
+    }
+
+    // 垂直缩小：落在同一输出行的源行累加到 rowB，凑齐后输出平均值
+    if (sc->boxY) {
+        if (r < sc->yStart) {
+            return;     // 填充模式裁掉的上边
+        }
+        horizontalPass(sc, row, sc->rowB, sc->accRows > 0);
+        sc->accRows++;
+        if (r + 1 >= sc->yEnd) {
+            emitRow(sc, sc->rowB, nullptr, 0, sc->accRows);
+            sc->accRows = 0;
+            sc->vNext++;
+            sc->yStart = sc->yEnd;
+            sc->yEnd = boxStart(sc->vNext + 1, sc->srcH, sc->dstH);
+        }
+        return;
+    }
+
+    // 垂直放大：rowA 为上一源行，rowB 为当前源行，输出所有已经凑齐两行的目标行
+    uint32_t* t = sc->rowA;
+    sc->rowA = sc->rowB;
+    sc->rowB = t;
+    horizontalPass(sc, row, sc->rowB, false);
+
+    while (sc->vNext < vEnd) {
+        uint32_t iy;
+        uint8_t f;
+        bilinearPos(sc->vNext, sc->srcH, sc->dstH, &iy, &f);
+        uint32_t need = f ? iy + 1 : iy;
+        if (need > r) {
+            break;
+        }
+        if (f == 0) {
+            emitRow(sc, iy == r ? sc->rowB : sc->rowA, nullptr, 0, 1);
+        } else {
+            emitRow(sc, sc->rowA, sc->rowB, f, 0);
+        }
+        sc->vNext++;
+    }
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+bool ImageScaler_Begin(ImageScaler* sc, const ImageLayout* layout, uint16_t srcW, uint16_t srcH,
+                       ImageScalerOutputFunc out) {
+    memset(sc, 0, sizeof(*sc));
+    sc->bandY = -1;
+    if (srcW == 0 || srcH == 0 || layout->viewW == 0 || layout->viewH == 0 || out == nullptr) {
+        return false;
+    }
+
+    sc->srcW = srcW;
+    sc->srcH = srcH;
+    sc->dstW = layout->dstW;
+    sc->dstH = layout->dstH;
+    sc->u0 = (uint32_t)(layout->viewX - layout->offX);
+    sc->v0 = (uint32_t)(layout->viewY - layout->offY);
+    sc->viewX = layout->viewX;
+    sc->viewY = layout->viewY;
+    sc->viewW = layout->viewW;
+    sc->viewH = layout->viewH;
+    sc->out = out;
+    sc->copyMode = (srcW == sc->dstW && srcH == sc->dstH);
+    sc->boxX = srcW >= sc->dstW;
+    sc->boxY = srcH >= sc->dstH;
+    sc->vNext = sc->v0;
+    sc->outY = sc->viewY;
+
+    sc->outBuf = (uint16_t*)scalerAlloc((size_t)sc->viewW * IMAGE_SCALER_OUT_LINES * 2);
+    if (sc->outBuf == nullptr) {
+        ImageScaler_End(sc);
+        return false;
+    }
+    if (sc->copyMode) {
+        return true;
+    }
+
+    sc->rowA = (uint32_t*)scalerAlloc((size_t)sc->viewW * 3 * sizeof(uint32_t));
+    sc->rowB = (uint32_t*)scalerAlloc((size_t)sc->viewW * 3 * sizeof(uint32_t));
+    sc->xIndex = (uint16_t*)scalerAlloc((size_t)(sc->viewW + 1) * sizeof(uint16_t));
+    if (!sc->boxX) {
+        sc->xFrac = (uint8_t*)scalerAlloc(sc->viewW);
+    }
+    if (sc->rowA == nullptr || sc->rowB == nullptr || sc->xIndex == nullptr ||
+        (!sc->boxX && sc->xFrac == nullptr)) {
+        ImageScaler_End(sc);
+        return false;
+    }
+
+    for (uint16_t i = 0; i <= sc->viewW; i++) {
+        if (sc->boxX) {
+            sc->xIndex[i] = (uint16_t)boxStart(sc->u0 + i, srcW, sc->dstW);
+        } else if (i < sc->viewW) {
+            uint32_t x;
+            bilinearPos(sc->u0 + i, srcW, sc->dstW, &x, &sc->xFrac[i]);
+            sc->xIndex[i] = (uint16_t)x;
+        }
+    }
+
+    if (sc->boxY) {
+        sc->yStart = boxStart(sc->v0, srcH, sc->dstH);
+        sc->yEnd = boxStart(sc->v0 + 1, srcH, sc->dstH);
+    }
+    return true;
+}
+
+bool ImageScaler_PushRows(ImageScaler* sc, const uint16_t* pixels, uint16_t rows, uint16_t stride) {
+    for (uint16_t i = 0; i < rows && !sc->failed; i++) {
+        pushRow(sc, pixels);
+        pixels += stride;
+    }
+    return !sc->failed;
+}
+
+static bool flushBand(ImageScaler* sc) {
+    if (sc->bandY < 0) {
+        return !sc->failed;
+    }
+    sc->bandY = -1;
+    return ImageScaler_PushRows(sc, sc->band, sc->bandH, sc->srcW);
+}
+
+bool ImageScaler_PushBlock(ImageScaler* sc, int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) {
+    if (sc->failed) {
+        return false;
+    }
+
+    // 整行宽度的块（内置解码器、PNG/BMP 的行）不用拼
+    if (x == 0 && w >= sc->srcW && sc->bandY < 0) {
+        return ImageScaler_PushRows(sc, pixels, h, w);
+    }
+
+    if (sc->bandY >= 0 && y != sc->bandY && !flushBand(sc)) {
+        return false;
+    }
+    if (x < 0 || x >= sc->srcW) {
+        return true;
+    }
+    if (sc->band == nullptr) {
+        sc->band = (uint16_t*)scalerAlloc((size_t)sc->srcW * IMAGE_SCALER_BAND_LINES * 2);
+        if (sc->band == nullptr) {
+            sc->failed = true;
+            return false;
+        }
+    }
+
+    if (h > IMAGE_SCALER_BAND_LINES) {
+        h = IMAGE_SCALER_BAND_LINES;
+    }
+    uint16_t cw = (x + w > sc->srcW) ? sc->srcW - x : w;
+    uint16_t* dst = sc->band + x;
+    for (uint16_t row = 0; row < h; row++) {
+        memcpy(dst, pixels, cw * 2);
+        dst += sc->srcW;
+        pixels += w;
+    }
+    sc->bandY = y;
+    sc->bandH = h;
+    return true;
+}
+
+bool ImageScaler_Finish(ImageScaler* sc) {
+    flushBand(sc);
+    flushOutput(sc);
+    return !sc->failed;
+}
+
+void ImageScaler_Rewind(ImageScaler* sc) {
+    sc->srcRow = 0;
+    sc->accRows = 0;
+    sc->vNext = sc->v0;
+    sc->outLines = 0;
+    sc->outY = sc->viewY;
+    sc->bandY = -1;
+    if (sc->boxY) {
+        sc->yStart = boxStart(sc->v0, sc->srcH, sc->dstH);
+        sc->yEnd = boxStart(sc->v0 + 1, sc->srcH, sc->dstH);
+    }
+}
+
+void ImageScaler_End(ImageScaler* sc) {
+    free(sc->outBuf);
+    free(sc->rowA);
+    free(sc->rowB);
+    free(sc->xIndex);
+    free(sc->xFrac);
+    free(sc->band);
+    sc->outBuf = nullptr;
+    sc->rowA = sc->rowB = nullptr;
+    sc->xIndex = nullptr;
+    sc->xFrac = nullptr;
+    sc->band = nullptr;
+}
+
+const char* ImageScaler_ModeName(ImageScaleMode mode) {
+    switch (mode) {
+        case IMG_SCALE_FIT:     return "fit";
+        case IMG_SCALE_FILL:    return "fill";
+        case IMG_SCALE_CENTER:  return "center";
+        default:                return "default";
+    }
+}
+
+bool ImageScaler_ParseMode(const char* name, ImageScaleMode* mode) {
+    static const ImageScaleMode modes[] = {
+        IMG_SCALE_FIT, IMG_SCALE_FILL, IMG_SCALE_CENTER, IMG_SCALE_DEFAULT
+    };
+    if (name == nullptr) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (strcasecmp(name, ImageScaler_ModeName(modes[i])) == 0) {
+            *mode = modes[i];
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// 图片缩放与摆放（适应 / 填充 / 居中）
+// - 按行流式输入 RGB565，不需要整幅源图常驻内存
+// - 缩小用定点盒式滤波（面积平均），放大用双线性插值，两个方向各自选择
+// - 只计算屏幕上可见的部分：填充模式裁掉的行列不参与运算
+// - 输出按 IMAGE_SCALER_OUT_LINES 行一块回调，与 JPEG 条带流水线的行数一致
+// 不依赖 Arduino，可直接在 x86 Linux 上编译。
+// ============================================================
+#define IMAGE_SCALER_OUT_LINES  16      // 每次输出回调的最大行数
+#define IMAGE_SCALER_BAND_LINES 16      // 拼行缓冲区行数（TJpgDec 的 MCU 高度最大 16）
+
+// 缩放模式
+enum ImageScaleMode {
+    IMG_SCALE_FIT = 0,      // 适应：整幅图片放进屏幕，保持比例，四周留黑边（默认）
+    IMG_SCALE_FILL,         // 填充：铺满屏幕，保持比例，裁掉超出部分
+    IMG_SCALE_CENTER,       // 居中：不缩放，超出屏幕的部分裁掉
+    IMG_SCALE_DEFAULT = 0xFF    // 单张图片未单独设置，跟随全局模式
+};
+
+// 图片在屏幕上的摆放结果
+typedef struct {
+    uint32_t dstW, dstH;    // 缩放后的整图尺寸
+    int32_t offX, offY;     // 整图左上角的屏幕坐标（填充/居中时可能为负）
+    uint16_t viewX, viewY;  // 屏幕上实际可见的矩形
+    uint16_t viewW, viewH;
+} ImageLayout;
+
+/**
+ * @brief 输出回调：一块 RGB565 像素（行距等于 w），返回 false 中止
+ * @details 与 JpegOutputFunc / jpegDrawCallback 的参数一致
+ */
+typedef bool (*ImageScalerOutputFunc)(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* pixels);
+
+// 缩放器状态（调用方分配，缓冲区由 Begin/End 管理）
+typedef struct {
+    uint16_t srcW, srcH;        // 输入尺寸
+    uint32_t dstW, dstH;        // 缩放后的整图尺寸
+    uint32_t u0, v0;            // 第一个可见像素在缩放后整图中的坐标
+    uint16_t viewX, viewY, viewW, viewH;
+    ImageScalerOutputFunc out;
+
+    bool copyMode;              // 1:1，只做裁剪
+    bool boxX, boxY;            // true 盒式滤波，false 双线性
+
+    // 水平方向映射表（每个可见列一项）
+    uint16_t* xIndex;           // 盒式：起始源列（viewW + 1 项）；双线性：左侧源列
+    uint8_t* xFrac;             // 双线性：右侧源列权重（/256）
+    uint16_t hDiv;              // 盒式时为 0（除数按列取跨度），双线性时为 256
+
+    // 垂直方向
+    uint32_t* rowA;             // 水平处理后的分量和（每列 R、G、B 三项）
+    uint32_t* rowB;             // 双线性时保存下一行；盒式时作为累加器
+    uint16_t rowAY;             // rowA 对应的源行
+    uint16_t accRows;           // 盒式：已累加的行数
+    uint32_t vNext;             // 下一个待输出的行（缩放后整图坐标）
+    uint32_t yStart, yEnd;      // 盒式：vNext 对应的源行范围
+    uint16_t srcRow;            // 下一个输入行
+
+    // 输出
+    uint16_t* outBuf;           // viewW × IMAGE_SCALER_OUT_LINES
+    uint16_t outLines;          // outBuf 中已填行数
+    uint16_t outY;              // outBuf 第一行的屏幕坐标
+
+    // 按块输入时的拼行缓冲区（TJpgDec 逐个 MCU 回调）
+    uint16_t* band;
+    int32_t bandY;              // -1 表示为空
+    uint16_t bandH;
+
+    bool failed;                // 输出回调返回过 false
+} ImageScaler;
+
+/**
+ * @brief 计算图片在屏幕上的摆放
+ * @param imgW,imgH        原图尺寸
+ * @param screenW,screenH  屏幕（或合成缓冲区）尺寸
+ * @param mode             IMG_SCALE_FIT / FILL / CENTER
+ */
+void ImageScaler_Layout(uint32_t imgW, uint32_t imgH, uint16_t screenW, uint16_t screenH,
+                        ImageScaleMode mode, ImageLayout* layout);
+
+/**
+ * @brief 选择 JPEG 解码缩放（0..3 → 1/1..1/8）
+ * @details 取解码后仍不小于目标尺寸的最大缩放，剩下的比例交给缩放器缩小，
+ *          因此 4000×3000 的照片只需按 500×375 的代价解码
+ */
+uint8_t ImageScaler_PickJpegScale(uint32_t imgW, uint32_t imgH, const ImageLayout* layout);
+
+/**
+ * @brief 解码器输出与摆放完全重合（不缩放、不裁剪），可以跳过缩放器直接写出
+ */
+bool ImageScaler_IsPassthrough(const ImageLayout* layout, uint16_t srcW, uint16_t srcH);
+
+/**
+ * @brief 开始一幅图片
+ * @param srcW,srcH 实际输入尺寸（JPEG 为解码缩放后的尺寸）
+ * @return false 内存不足或尺寸无效
+ */
+bool ImageScaler_Begin(ImageScaler* sc, const ImageLayout* layout, uint16_t srcW, uint16_t srcH,
+                       ImageScalerOutputFunc out);
+
+/**
+ * @brief 按顺序输入若干整行（自上而下）
+ * @param stride 行距（像素）
+ * @return false 输出回调要求中止
+ */
+bool ImageScaler_PushRows(ImageScaler* sc, const uint16_t* pixels, uint16_t rows, uint16_t stride);
+
+/**
+ * @brief 输入一块像素（块按光栅顺序到达，同一行块的 y 相同）
+ * @details 整行宽度的块直接处理，其余先拼进拼行缓冲区，y 变化时整条送出
+ */
+bool ImageScaler_PushBlock(ImageScaler* sc, int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels);
+
+/**
+ * @brief 送出拼行缓冲区与未满的输出块
+ */
+bool ImageScaler_Finish(ImageScaler* sc);
+
+/**
+ * @brief 回到第一行，重新输入同一幅图（渐进式 JPEG 预览之后的最终输出）
+ * @details 映射表与缓冲区保留，调用前先 ImageScaler_Finish
+ */
+void ImageScaler_Rewind(ImageScaler* sc);
+
+/**
+ * @brief 释放缓冲区
+ */
+void ImageScaler_End(ImageScaler* sc);
+
+/**
+ * @brief 模式名称（"fit" / "fill" / "center" / "default"）与解析
+ */
+const char* ImageScaler_ModeName(ImageScaleMode mode);
+bool ImageScaler_ParseMode(const char* name, ImageScaleMode* mode);
@@ -0,0 +1,61 @@
+#include "Image_Strip.h"
+#include <string.h>
+
+void ImageStrip_Begin(ImageStrip* s, uint16_t* const* bufs, uint8_t count, uint16_t lines,
+                      const ImageStripSink* sink, uint16_t x, uint16_t width) {
+    if (count > IMAGE_STRIP_MAX_BUFS) {
+        count = IMAGE_STRIP_MAX_BUFS;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        s->bufs[i] = bufs[i];
+    }
+    s->count = count;
+    s->lines = lines;
+    s->sink = sink;
+    s->index = 0;
+    s->y = -1;
+    s->h = 0;
+    s->x = x;
+    s->w = width;
+}
+
+void ImageStrip_Flush(ImageStrip* s) {
+    if (s->y < 0) {
+        return;
+    }
+    const ImageStripSink* k = s->sink;
+    k->submit(k->user, s->x, s->y, s->w, s->h, s->bufs[s->index]);
+    s->index = (s->index + 1) % s->count;
+    s->y = -1;
+
+    if (k->pending(k->user) >= s->count) {
+        k->waitOne(k->user);
+    }
+}
+
+bool ImageStrip_Put(ImageStrip* s, int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) {
+    x -= s->x;
+    if (h > s->lines || x < 0 || x + w > s->w) {
+        return false;
+    }
+
+    uint16_t row0 = 0;
+    bool append = s->y >= 0 && y == s->y + s->h && x == 0 && w == s->w && s->h + h <= s->lines;
+    if (append) {
+        row0 = s->h;
+        s->h += h;
+    } else if (y != s->y) {
+        // 新的一行 MCU（或条带已满）：上一条带已经完整
+        ImageStrip_Flush(s);
+        s->y = y;
+        s->h = h;
+    }
+
+    uint16_t* dst = s->bufs[s->index] + row0 * s->w + x;
+    for (uint16_t row = 0; row < h; row++) {
+        memcpy(dst, pixels, w * 2);
+        dst += s->w;
+        pixels += w;
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================
+// 条带拼接与解码 / 传输重叠
+// - JPEG 的 MCU 块按起始行归入同一条带；PNG/BMP 和缩放器输出的整行紧接在条带末尾时追加进去，
+//   攒满 lines 行才交给输出端（一次窗口）
+// - 条带缓冲区轮流使用：交出一条后，在途数量达到缓冲区数时等待最早一笔，
+//   这一笔正好占用着下一块要填充的缓冲区（输出端按提交顺序完成）
+// 输出端由调用方提供（设备上是 LCD_addWindow_Async / LCD_Async_WaitOne）。
+// 不依赖 Arduino，可直接在 x86 Linux 上编译（tools/strip_replay.cpp 用录制的回调序列回放）。
+// ============================================================
+#define IMAGE_STRIP_MAX_BUFS    4
+
+// 输出端：submit 交出一条（可就地处理 pixels，如色温滤镜；对应传输完成前不可再改写），
+// pending 为在途数，waitOne 等最早一笔完成
+typedef struct {
+    void* user;
+    void (*submit)(void* user, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t* pixels);
+    uint32_t (*pending)(void* user);
+    void (*waitOne)(void* user);
+} ImageStripSink;
+
+typedef struct {
+    uint16_t* bufs[IMAGE_STRIP_MAX_BUFS];   // 每块 width × lines 像素
+    uint8_t count;
+    uint16_t lines;             // 每条带最大行数
+    const ImageStripSink* sink;
+
+    uint8_t index;              // 正在填充的条带
+    int16_t y;                  // 当前条带起始行，-1 表示条带为空
+    uint16_t h;                 // 当前条带行数
+    uint16_t x;                 // 条带左边缘的屏幕坐标
+    uint16_t w;                 // 条带宽度（= 图片显示宽度）
+} ImageStrip;
+
+/**
+ * @brief 开始一次拼接
+ * @param bufs  count 块条带缓冲区（每块至少 width × lines 像素）
+ * @param x     图片可见区域左边缘的屏幕坐标
+ * @param width 可见区域宽度
+ */
+void ImageStrip_Begin(ImageStrip* s, uint16_t* const* bufs, uint8_t count, uint16_t lines,
+                      const ImageStripSink* sink, uint16_t x, uint16_t width);
+
+/**
+ * @brief 把一个 MCU 块或若干整行拷贝到当前条带
+ * @return true 已暂存，false 该块无法放进条带（调用方先 Flush 并等待全部传输，再另行写屏）
+ */
+bool ImageStrip_Put(ImageStrip* s, int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels);
+
+/**
+ * @brief 交出当前条带（为空时不做任何事），并确保下一块条带缓冲区已空闲
+ */
+void ImageStrip_Flush(ImageStrip* s);
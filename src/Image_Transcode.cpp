@@ -0,0 +1,102 @@
+#include "Image_Transcode.h"
+#include "Image_Decoder.h"
+#include "WebServer_Driver.h"
+#include <esp_heap_caps.h>
+
+// ============================================================
+// 运行时状态
+// ============================================================
+
+static TaskHandle_t transcodeTask = nullptr;
+static QueueHandle_t requestQueue = nullptr;
+static uint16_t* frame = nullptr;
+
+static volatile bool yieldFlag = false;
+static char currentPath[100] = "";          // 正在转码的文件（去重用）
+
+static TranscodeStats stats = { 0 };
+
+// ============================================================
+// 转码任务
+// ============================================================
+
+static void TranscodeTask(void *parameter) {
+    char path[100];
+
+    while (1) {
+        xQueueReceive(requestQueue, path, portMAX_DELAY);
+        strncpy(currentPath, path, sizeof(currentPath));
+
+        while (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(TRANSCODE_LOCK_WAIT_MS)) != pdTRUE) {
+            vTaskDelay(pdMS_TO_TICKS(TRANSCODE_BACKOFF_MS));
+        }
+        yieldFlag = false;
+        bool ok = transcodeImageToR565(path, frame, &yieldFlag);
+        bool interrupted = !ok && yieldFlag;
+        xSemaphoreGive(sdCardMutex);
+
+        if (ok) {
+            stats.done++;
+        } else if (interrupted) {
+            // loop 需要 SD 卡：稍后再试
+            stats.yielded++;
+            vTaskDelay(pdMS_TO_TICKS(TRANSCODE_RETRY_MS));
+            if (xQueueSendToBack(requestQueue, path, 0) != pdTRUE) {
+                stats.dropped++;
+            }
+        } else {
+            stats.failed++;
+        }
+        currentPath[0] = '\0';
+    }
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+void Transcode_Init(void) {
+    if (transcodeTask != nullptr) {
+        return;
+    }
+
+    frame = (uint16_t*)heap_caps_malloc(IMG_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    requestQueue = xQueueCreate(TRANSCODE_QUEUE_LEN, sizeof(currentPath));
+    if (frame == nullptr || requestQueue == nullptr || sdCardMutex == NULL) {
+        Serial.println("⚠️ 转码帧分配失败，后台转码已禁用");
+        return;
+    }
+
+    xTaskCreatePinnedToCore(TranscodeTask, "Transcode", TRANSCODE_TASK_STACK, NULL,
+                            TRANSCODE_TASK_PRIO, &transcodeTask, TRANSCODE_TASK_CORE);
+    Serial.println("✓ 后台转码任务已启动");
+}
+
+void Transcode_Request(const char* path) {
+    if (transcodeTask == nullptr || path == nullptr || strlen(path) >= sizeof(currentPath)) {
+        return;
+    }
+    ImageFormat format = getImageFormat(path);
+    if (format == IMG_R565 || format == IMG_UNKNOWN || isAnimatedImageFile(path) || strcmp(path, currentPath) == 0) {
+        return;
+    }
+
+    char item[sizeof(currentPath)];
+    strncpy(item, path, sizeof(item));
+    if (xQueueSendToBack(requestQueue, item, 0) != pdTRUE) {
+        stats.dropped++;
+        Serial.printf("⚠️ 转码队列已满，跳过: %s\n", path);
+    }
+}
+
+void Transcode_Yield(void) {
+    if (transcodeTask != nullptr) {
+        yieldFlag = true;
+    }
+}
+
+void Transcode_GetStats(TranscodeStats* out) {
+    if (out != nullptr) {
+        *out = stats;
+    }
+}
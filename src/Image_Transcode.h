@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================
+// 后台转码为 .r565（核心 0）
+// 上传完成的 JPEG/PNG/BMP 按当前缩放模式渲染成整帧，写成转码缓存；
+// 之后显示这张图片时直接读缓存，不再解码（见 Image_Decoder.h 中的 R565 转码缓存）。
+// 与 loop 共用 sdCardMutex：拿不到锁就退避重试；loop 需要 SD 卡时调用 Transcode_Yield，
+// 被打断的任务稍后重新排队。
+// ============================================================
+#define R565_TRANSCODE_ON_UPLOAD    1       // 上传完成后自动转码
+
+#define TRANSCODE_TASK_CORE         0
+#define TRANSCODE_TASK_PRIO         1       // 与预取任务相同，低于 DriverTask 和 SPI 任务
+#define TRANSCODE_TASK_STACK        8192
+#define TRANSCODE_QUEUE_LEN         8       // 最多排队的文件数
+#define TRANSCODE_LOCK_WAIT_MS      20      // 单次尝试获取 sdCardMutex 的等待时间
+#define TRANSCODE_BACKOFF_MS        200     // 拿不到锁时的退避时间
+#define TRANSCODE_RETRY_MS          2000    // 被打断后重新排队前的等待时间
+
+// 转码统计
+typedef struct {
+    uint32_t done;          // 写入（或已是最新）的缓存数
+    uint32_t failed;        // 解码或写入失败
+    uint32_t yielded;       // 被 loop 打断后重新排队的次数
+    uint32_t dropped;       // 队列已满被丢弃的请求
+} TranscodeStats;
+
+/**
+ * @brief 分配临时帧并创建转码任务（须在 WebServer_Init 创建 sdCardMutex 之后调用）
+ */
+void Transcode_Init(void);
+
+/**
+ * @brief 请求转码（只排队，立即返回；不支持的格式和 .r565 文件本身会被忽略）
+ */
+void Transcode_Request(const char* path);
+
+/**
+ * @brief 让正在进行的转码尽快释放 SD 卡（稍后自动重试）
+ */
+void Transcode_Yield(void);
+
+/**
+ * @brief 读取统计信息
+ */
+void Transcode_GetStats(TranscodeStats* stats);
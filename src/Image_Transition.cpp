@@ -0,0 +1,208 @@
+#include "Image_Transition.h"
+#include <string.h>
+#include <strings.h>
+
+#define DEFAULT_BYTES_PER_MS    10000   // SPI 80 MHz 的理论带宽
+#define STEP_OVERHEAD_US        200     // 每步的固定开销（窗口命令、分批提交）
+
+// ============================================================
+// 混合
+// ============================================================
+
+// RGB565 展开成 00000GGGGGG00000RRRRR000000BBBBB：三个通道之间各留出 5 位，
+// 乘以不超过 32 的系数后互不进位
+#define SPREAD_MASK     0x07E0F81Fu
+
+static inline uint32_t spread565(uint16_t p) {
+    return (p | ((uint32_t)p << 16)) & SPREAD_MASK;
+}
+
+void ImageTransition_Blend565(const uint16_t* from, const uint16_t* to, uint16_t* dst, int n, uint8_t alpha) {
+    if (alpha == 0) {
+        memmove(dst, from, n * 2);
+        return;
+    }
+    if (alpha >= IMG_TRANSITION_ALPHA_MAX) {
+        memmove(dst, to, n * 2);
+        return;
+    }
+    uint32_t inv = IMG_TRANSITION_ALPHA_MAX - alpha;
+    for (int i = 0; i < n; i++) {
+        uint16_t a = from[i];
+        uint16_t b = to[i];
+        if (a == b) {
+            dst[i] = a;
+            continue;
+        }
+        uint32_t v = ((spread565(a) * inv + spread565(b) * alpha) >> 5) & SPREAD_MASK;
+        dst[i] = (uint16_t)(v | (v >> 16));
+    }
+}
+
+// ============================================================
+// 规划
+// ============================================================
+
+/**
+ * @brief 两帧不同的最小矩形：先从上下两端找第一行不同的行，再在这些行里从左右两端找不同的列
+ * @return false 两帧完全相同
+ */
+static bool findDiff(const uint16_t* a, const uint16_t* b, uint16_t w, uint16_t h, ImageTransitionRect* r) {
+    size_t rowBytes = (size_t)w * 2;
+    int32_t top = 0;
+    while (top < h && memcmp(a + (size_t)top * w, b + (size_t)top * w, rowBytes) == 0) {
+        top++;
+    }
+    if (top == h) {
+        return false;
+    }
+    int32_t bottom = h - 1;
+    while (bottom > top && memcmp(a + (size_t)bottom * w, b + (size_t)bottom * w, rowBytes) == 0) {
+        bottom--;
+    }
+
+    int32_t left = w, right = -1;
+    for (int32_t y = top; y <= bottom; y++) {
+        const uint16_t* ra = a + (size_t)y * w;
+        const uint16_t* rb = b + (size_t)y * w;
+        int32_t x = 0;
+        while (x < left && ra[x] == rb[x]) {
+            x++;
+        }
+        if (x < left) {
+            left = x;
+        }
+        x = w - 1;
+        while (x > right && ra[x] == rb[x]) {
+            x--;
+        }
+        if (x > right) {
+            right = x;
+        }
+    }
+
+    r->x = left;
+    r->y = top;
+    r->w = right - left + 1;
+    r->h = bottom - top + 1;
+    return true;
+}
+
+bool ImageTransition_Plan(ImageTransition* t, ImageTransitionType type, const uint16_t* from,
+                          const uint16_t* to, uint16_t width, uint16_t height, uint16_t durationMs,
+                          uint16_t fps, uint32_t bytesPerMs) {
+    memset(t, 0, sizeof(*t));
+    t->type = type;
+    t->from = from;
+    t->to = to;
+    t->width = width;
+    t->height = height;
+    if (!findDiff(from, to, width, height, &t->diff)) {
+        return false;
+    }
+
+    uint32_t durationUs = (uint32_t)durationMs * 1000;
+    uint32_t nominal = (uint32_t)durationMs * fps / 1000;
+    if (type == IMG_TRANSITION_CUT || nominal <= 1) {
+        t->type = IMG_TRANSITION_CUT;
+        t->steps = 1;
+        t->estStepUs = STEP_OVERHEAD_US + (uint32_t)((uint64_t)t->diff.w * t->diff.h * 2 * 1000 /
+                                                     (bytesPerMs ? bytesPerMs : DEFAULT_BYTES_PER_MS));
+        return true;
+    }
+
+    // 每步要写的字节数：淡入淡出每步改写整个差异区域，推移改写差异区域所在的整行，擦除平均分摊
+    uint64_t bytes = (uint64_t)t->diff.h * 2;
+    switch (type) {
+        case IMG_TRANSITION_FADE:   bytes *= t->diff.w; break;
+        case IMG_TRANSITION_SLIDE:  bytes *= width; break;
+        default:                    bytes = bytes * t->diff.w / nominal; break;
+    }
+    if (bytesPerMs == 0) {
+        bytesPerMs = DEFAULT_BYTES_PER_MS;
+    }
+    t->estStepUs = STEP_OVERHEAD_US + (uint32_t)(bytes * 1000 / bytesPerMs);
+
+    // 帧时间预算：估计耗时超过目标帧间隔时按实际能达到的帧率减少步数
+    uint32_t frameUs = 1000000 / (fps ? fps : 1);
+    uint32_t steps = nominal;
+    if (t->estStepUs > frameUs) {
+        steps = durationUs / t->estStepUs;
+        if (steps < 1) {
+            steps = 1;
+        }
+    }
+    t->steps = steps > 0xFFFF ? 0xFFFF : steps;
+    t->stepUs = durationUs / t->steps;
+    return true;
+}
+
+// ============================================================
+// 逐步输出
+// ============================================================
+
+bool ImageTransition_Region(const ImageTransition* t, uint16_t prevStep, uint16_t step,
+                            ImageTransitionRect* r) {
+    if (step <= prevStep || step > t->steps) {
+        return false;
+    }
+    *r = t->diff;
+    if (t->type == IMG_TRANSITION_WIPE) {
+        uint16_t x0 = t->diff.x + (uint32_t)t->diff.w * prevStep / t->steps;
+        uint16_t x1 = t->diff.x + (uint32_t)t->diff.w * step / t->steps;
+        r->x = x0;
+        r->w = x1 - x0;
+    } else if (t->type == IMG_TRANSITION_SLIDE) {
+        // 整行平移；两帧相同的行保持不动
+        r->x = 0;
+        r->w = t->width;
+    }
+    return r->w > 0 && r->h > 0;
+}
+
+void ImageTransition_RenderRows(const ImageTransition* t, uint16_t step, const ImageTransitionRect* r,
+                                uint16_t row, uint16_t rows, uint16_t* dst) {
+    for (uint16_t k = 0; k < rows; k++, dst += r->w) {
+        size_t line = (size_t)(r->y + row + k) * t->width;
+        const uint16_t* a = t->from + line;
+        const uint16_t* b = t->to + line;
+
+        switch (t->type) {
+            case IMG_TRANSITION_FADE: {
+                uint8_t alpha = (uint8_t)(((uint32_t)step * IMG_TRANSITION_ALPHA_MAX + t->steps / 2) / t->steps);
+                ImageTransition_Blend565(a + r->x, b + r->x, dst, r->w, alpha);
+                break;
+            }
+            case IMG_TRANSITION_SLIDE: {
+                // 旧帧左移 shift 列，新帧从右侧露出 shift 列（r 覆盖整行）
+                uint16_t shift = (uint32_t)t->width * step / t->steps;
+                memcpy(dst, a + shift, (size_t)(t->width - shift) * 2);
+                memcpy(dst + (t->width - shift), b, (size_t)shift * 2);
+                break;
+            }
+            default:
+                memcpy(dst, b + r->x, (size_t)r->w * 2);
+                break;
+        }
+    }
+}
+
+// ============================================================
+// 名称
+// ============================================================
+
+static const char* const typeNames[] = { "cut", "fade", "wipe", "slide" };
+
+const char* ImageTransition_Name(uint8_t type) {
+    return type <= IMG_TRANSITION_SLIDE ? typeNames[type] : "unknown";
+}
+
+bool ImageTransition_Parse(const char* name, ImageTransitionType* type) {
+    for (uint8_t i = 0; i <= IMG_TRANSITION_SLIDE; i++) {
+        if (strcasecmp(name, typeNames[i]) == 0) {
+            *type = (ImageTransitionType)i;
+            return true;
+        }
+    }
+    return false;
+}
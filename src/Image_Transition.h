@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// 切换图片的过渡效果（淡入淡出 / 擦除 / 推移）
+// 输入是两张整帧 RGB565（上一张已显示的帧和新合成的帧，尺寸与方向相同），按步计算每一步
+// 屏幕上需要改写的矩形及其像素，调用方按行取出后写屏：
+// - 只发送变化的区域：两帧相同的范围（例如相同的黑边）从不发送；擦除每一步只发送新露出的几列
+// - 步数由帧时间预算决定：按 SPI 实测带宽估算每步写屏耗时，超过目标帧间隔时减少步数，
+//   保持过渡总时长不变
+// 不依赖 Arduino，可直接在 x86 Linux 上编译。
+// ============================================================
+
+enum ImageTransitionType {
+    IMG_TRANSITION_CUT = 0,     // 直接切换（整帧一次写屏）
+    IMG_TRANSITION_FADE,        // 淡入淡出
+    IMG_TRANSITION_WIPE,        // 新图从左向右擦除旧图
+    IMG_TRANSITION_SLIDE        // 新图从右侧推入，旧图向左移出
+};
+
+#define IMG_TRANSITION_ALPHA_MAX    32      // 混合系数的范围 0..32（RGB565 的 5 位通道精度）
+
+typedef struct {
+    uint16_t x, y, w, h;
+} ImageTransitionRect;
+
+typedef struct {
+    ImageTransitionType type;
+    const uint16_t* from;       // 旧帧
+    const uint16_t* to;         // 新帧
+    uint16_t width, height;     // 两帧的逻辑尺寸
+    ImageTransitionRect diff;   // 两帧不同的最小矩形
+    uint16_t steps;             // 总步数（最后一步与新帧完全相同）
+    uint32_t stepUs;            // 相邻两步的间隔（总时长 / 步数）
+    uint32_t estStepUs;         // 估计的每步写屏耗时
+} ImageTransition;
+
+/**
+ * @brief 比较两帧并规划步数
+ * @param durationMs 过渡总时长
+ * @param fps        目标帧率（每秒步数上限）
+ * @param bytesPerMs 写屏带宽（字节 / 毫秒），0 按 SPI 80 MHz 估算
+ * @return false 两帧完全相同，不需要写屏
+ */
+bool ImageTransition_Plan(ImageTransition* t, ImageTransitionType type, const uint16_t* from,
+                          const uint16_t* to, uint16_t width, uint16_t height, uint16_t durationMs,
+                          uint16_t fps, uint32_t bytesPerMs);
+
+/**
+ * @brief 从第 prevStep 步（0 表示还没有开始）直接到第 step 步时屏幕上要改写的矩形
+ * @details 落后于计划时调用方可以跳过中间的步，擦除的矩形会覆盖跳过的列
+ * @return false 没有需要改写的像素
+ */
+bool ImageTransition_Region(const ImageTransition* t, uint16_t prevStep, uint16_t step,
+                            ImageTransitionRect* r);
+
+/**
+ * @brief 计算第 step 步时矩形 r 中第 row 行起的 rows 行像素
+ * @param dst 输出 r->w × rows 个连续像素
+ */
+void ImageTransition_RenderRows(const ImageTransition* t, uint16_t step, const ImageTransitionRect* r,
+                                uint16_t row, uint16_t rows, uint16_t* dst);
+
+/**
+ * @brief RGB565 逐像素混合：dst = from × (32 − alpha) / 32 + to × alpha / 32
+ * @details 三个通道分开放进一个 32 位字，一次乘法同时处理三个通道；alpha 为 0 / 32 时直接复制。
+ *          dst 可以与 from 或 to 相同
+ */
+void ImageTransition_Blend565(const uint16_t* from, const uint16_t* to, uint16_t* dst, int n, uint8_t alpha);
+
+/**
+ * @brief 名称与解析（cut / fade / wipe / slide）
+ */
+const char* ImageTransition_Name(uint8_t type);
+bool ImageTransition_Parse(const char* name, ImageTransitionType* type);
@@ -0,0 +1,1346 @@
+#include "JPEG_Codec.h"
+#include "JPEG_Kernels.h"
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#include <esp_cpu.h>
+#define JPEG_CYCLES()   ((uint32_t)esp_cpu_get_cycle_count())
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define JPEG_CYCLES()   ((uint32_t)__rdtsc())
+#else
+#define JPEG_CYCLES()   0u
+#endif
+
+#if JPEG_PROFILE
+#define PROFILE_MARK(var)           uint32_t var = JPEG_CYCLES()
+#define PROFILE_ADD(field, since)   (dec->profile.field += (uint32_t)(JPEG_CYCLES() - (since)))
+#else
+#define PROFILE_MARK(var)
+#define PROFILE_ADD(field, since)
+#endif
+
+// 一个 MCU 最多 4 个亮度块 + 2 个色度块
+#define MAX_MCU_BLOCKS  6
+
+// ============================================================
+// 内存分配：小块优先内部 RAM，大块放 PSRAM
+// 失败时请回收回调腾出空间（帧缓存与系数平面共用 PSRAM），再试一次
+// ============================================================
+static JpegReclaimFunc g_reclaim = nullptr;
+
+static void* jpegAllocOnce(size_t n) {
+#ifdef ESP_PLATFORM
+    void* p = nullptr;
+    if (n <= 16 * 1024) {
+        p = heap_caps_malloc(n, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (p == nullptr) {
+        p = heap_caps_malloc(n, MALLOC_CAP_SPIRAM);
+    }
+    if (p == nullptr) {
+        p = malloc(n);
+    }
+    return p;
+#else
+    return malloc(n);
+#endif
+}
+
+static void* jpegAlloc(size_t n) {
+    void* p = jpegAllocOnce(n);
+    if (p == nullptr && g_reclaim != nullptr && g_reclaim(n)) {
+        p = jpegAllocOnce(n);
+    }
+    return p;
+}
+
+static void jpegFree(void* p) {
+    free(p);    // heap_caps_malloc 的内存同样可以用 free 释放
+}
+
+// ============================================================
+// 输入
+// ============================================================
+
+static bool fillInput(JpegDecoder* dec) {
+    if (dec->read == nullptr || dec->inEnd) {
+        return false;
+    }
+    size_t n = dec->read(dec->readUser, dec->inBuf, JPEG_INPUT_BUF_SIZE);
+    if (n == 0) {
+        dec->inEnd = true;
+        return false;
+    }
+    dec->in = dec->inBuf;
+    dec->inLen = n;
+    dec->inPos = 0;
+    return true;
+}
+
+static inline int readByte(JpegDecoder* dec) {
+    if (dec->inPos >= dec->inLen && !fillInput(dec)) {
+        return -1;
+    }
+    return dec->in[dec->inPos++];
+}
+
+static int readWord(JpegDecoder* dec) {
+    int hi = readByte(dec);
+    int lo = readByte(dec);
+    if (hi < 0 || lo < 0) {
+        return -1;
+    }
+    return (hi << 8) | lo;
+}
+
+static bool readBytes(JpegDecoder* dec, uint8_t* dst, size_t n) {
+    while (n > 0) {
+        if (dec->inPos >= dec->inLen && !fillInput(dec)) {
+            return false;
+        }
+        size_t avail = dec->inLen - dec->inPos;
+        size_t chunk = n < avail ? n : avail;
+        if (dst != nullptr) {
+            memcpy(dst, dec->in + dec->inPos, chunk);
+            dst += chunk;
+        }
+        dec->inPos += chunk;
+        n -= chunk;
+    }
+    return true;
+}
+
+// ============================================================
+// 熵解码位读取
+// ============================================================
+
+/**
+ * 位缓冲补到至少 25 位。遇到标记后不再前进，补 0 位；
+ * 文件提前结束时记下 truncated，解码结束后报错
+ */
+static void fillBits(JpegDecoder* dec) {
+    while (dec->bitCnt <= 24) {
+        uint32_t b = 0;
+        if (dec->marker == 0) {
+            int c = readByte(dec);
+            if (c < 0) {
+                dec->marker = 0xD9;     // 当作 EOI
+                dec->truncated = true;
+            } else if (c == 0xFF) {
+                int c2 = readByte(dec);
+                while (c2 == 0xFF) {
+                    c2 = readByte(dec);
+                }
+                if (c2 == 0) {
+                    b = 0xFF;
+                } else {
+                    dec->marker = (c2 < 0) ? 0xD9 : (uint8_t)c2;
+                    dec->truncated = (c2 < 0);
+                }
+            } else {
+                b = (uint32_t)c;
+            }
+        }
+        if (dec->marker != 0) {
+            dec->stuffedBits += 8;
+        }
+        dec->bitBuf |= b << (24 - dec->bitCnt);
+        dec->bitCnt += 8;
+    }
+}
+
+static inline void consumeBits(JpegDecoder* dec, int n) {
+    dec->bitBuf <<= n;
+    dec->bitCnt -= n;
+}
+
+static inline int getBits(JpegDecoder* dec, int n) {
+    if (dec->bitCnt < n) {
+        fillBits(dec);
+    }
+    int v = (int)(dec->bitBuf >> (32 - n));
+    consumeBits(dec, n);
+    return v;
+}
+
+/**
+ * 读取 n 位差值并恢复符号（JPEG 的 EXTEND 过程）
+ */
+static inline int receiveExtend(JpegDecoder* dec, int n) {
+    int v = getBits(dec, n);
+    if (v < (1 << (n - 1))) {
+        v -= (1 << n) - 1;
+    }
+    return v;
+}
+
+static inline int huffDecode(JpegDecoder* dec, const JpegHuffTable* t) {
+    if (dec->bitCnt < 16) {
+        fillBits(dec);
+    }
+
+    uint32_t look = dec->bitBuf >> (32 - JPEG_HUFF_LOOKAHEAD);
+    int len = t->lookLen[look];
+    if (len != 0) {
+        consumeBits(dec, len);
+        return t->lookVal[look];
+    }
+
+    // 长码字逐位比较
+    for (len = JPEG_HUFF_LOOKAHEAD + 1; len <= 16; len++) {
+        int32_t code = (int32_t)(dec->bitBuf >> (32 - len));
+        if (code <= t->maxCode[len]) {
+            consumeBits(dec, len);
+            return t->values[code + t->valOffset[len]];
+        }
+    }
+    return -1;
+}
+
+static void resetBits(JpegDecoder* dec) {
+    dec->bitBuf = 0;
+    dec->bitCnt = 0;
+    dec->stuffedBits = 0;
+}
+
+/**
+ * 处理 RST 标记：丢弃剩余位，跳到下一个 RSTn，清零 DC 预测
+ */
+static JpegResult processRestart(JpegDecoder* dec) {
+    if (dec->marker == 0) {
+        // 标记还没被位读取碰到，手动找
+        int c;
+        do {
+            c = readByte(dec);
+            while (c >= 0 && c != 0xFF) {
+                c = readByte(dec);
+            }
+            while (c == 0xFF) {
+                c = readByte(dec);
+            }
+        } while (c == 0);
+        if (c < 0) {
+            return JPEG_ERR_INPUT;
+        }
+        dec->marker = (uint8_t)c;
+    }
+
+    if (dec->marker < 0xD0 || dec->marker > 0xD7) {
+        return JPEG_ERR_FORMAT;
+    }
+
+    dec->marker = 0;
+    resetBits(dec);
+    for (int i = 0; i < dec->ncomp; i++) {
+        dec->comp[i].dcPred = 0;
+    }
+    dec->eobRun = 0;
+    return JPEG_OK;
+}
+
+// ============================================================
+// 头部解析
+// ============================================================
+
+static bool buildHuffTable(JpegHuffTable* t, const uint8_t* counts, const uint8_t* values, int total) {
+    memset(t->lookLen, 0, sizeof(t->lookLen));
+    memcpy(t->values, values, total);
+
+    int32_t code = 0;
+    int k = 0;
+    for (int len = 1; len <= 16; len++) {
+        int n = counts[len - 1];
+        t->valOffset[len] = k - code;
+        t->maxCode[len] = n ? code + n - 1 : -1;
+
+        for (int i = 0; i < n; i++, code++, k++) {
+            if (code >= (1 << len)) {
+                return false;   // 码字溢出，表损坏
+            }
+            if (len <= JPEG_HUFF_LOOKAHEAD) {
+                int shift = JPEG_HUFF_LOOKAHEAD - len;
+                int first = code << shift;
+                for (int j = 0; j < (1 << shift); j++) {
+                    t->lookLen[first + j] = (uint8_t)len;
+                    t->lookVal[first + j] = values[k];
+                }
+            }
+        }
+        code <<= 1;
+    }
+    t->maxCode[17] = 0x7FFFFFFF;
+    t->present = true;
+    return true;
+}
+
+static JpegResult parseDHT(JpegDecoder* dec, int len) {
+    uint8_t counts[16];
+    uint8_t values[256];
+
+    while (len > 0) {
+        int tc = readByte(dec);
+        if (tc < 0 || !readBytes(dec, counts, 16)) {
+            return JPEG_ERR_INPUT;
+        }
+        int total = 0;
+        for (int i = 0; i < 16; i++) {
+            total += counts[i];
+        }
+        if ((tc & 0xEC) != 0 || total > 256 || 17 + total > len) {
+            return JPEG_ERR_FORMAT;
+        }
+        if (!readBytes(dec, values, total)) {
+            return JPEG_ERR_INPUT;
+        }
+
+        JpegHuffTable* t = (tc >> 4) ? &dec->acTable[tc & 3] : &dec->dcTable[tc & 3];
+        if (!buildHuffTable(t, counts, values, total)) {
+            return JPEG_ERR_FORMAT;
+        }
+        len -= 17 + total;
+    }
+    return JPEG_OK;
+}
+
+static JpegResult parseDQT(JpegDecoder* dec, int len) {
+    uint8_t q[64];
+
+    while (len > 0) {
+        int pq = readByte(dec);
+        if (pq < 0) {
+            return JPEG_ERR_INPUT;
+        }
+        if (pq & 0xF0) {
+            return JPEG_ERR_UNSUPPORTED;    // 16 位量化表只出现在 12 位 JPEG 中
+        }
+        if (len < 65) {
+            return JPEG_ERR_FORMAT;
+        }
+        if (!readBytes(dec, q, 64)) {
+            return JPEG_ERR_INPUT;
+        }
+        JpegKernel_BuildQuantTable(q, dec->qt[pq & 3]);
+        dec->qtPresent[pq & 3] = true;
+        len -= 65;
+    }
+    return JPEG_OK;
+}
+
+static JpegResult parseSOF(JpegDecoder* dec, int len) {
+    uint8_t seg[6 + 3 * 4];
+    if (len < 6 || len > (int)sizeof(seg)) {
+        return (len > (int)sizeof(seg)) ? JPEG_ERR_UNSUPPORTED : JPEG_ERR_FORMAT;
+    }
+    if (!readBytes(dec, seg, len)) {
+        return JPEG_ERR_INPUT;
+    }
+
+    if (seg[0] != 8) {
+        return JPEG_ERR_UNSUPPORTED;        // 只支持 8 位精度
+    }
+    dec->height = (seg[1] << 8) | seg[2];
+    dec->width = (seg[3] << 8) | seg[4];
+    dec->ncomp = seg[5];
+    if (dec->width == 0 || dec->height == 0) {
+        return JPEG_ERR_FORMAT;             // 高度为 0 表示 DNL，几乎没人用
+    }
+    if (dec->ncomp != 1 && dec->ncomp != 3) {
+        return JPEG_ERR_UNSUPPORTED;
+    }
+    if (len < 6 + 3 * dec->ncomp) {
+        return JPEG_ERR_FORMAT;
+    }
+
+    for (int i = 0; i < dec->ncomp; i++) {
+        JpegComponent* c = &dec->comp[i];
+        c->id = seg[6 + 3 * i];
+        c->h = seg[7 + 3 * i] >> 4;
+        c->v = seg[7 + 3 * i] & 15;
+        c->tq = seg[8 + 3 * i] & 3;
+    }
+
+    // 单分量扫描的 MCU 总是一个块，采样因子无意义
+    if (dec->ncomp == 1) {
+        dec->comp[0].h = dec->comp[0].v = 1;
+    }
+
+    // 亮度 1~2 倍采样，色度不再下采样
+    JpegComponent* y = &dec->comp[0];
+    if (y->h < 1 || y->h > 2 || y->v < 1 || y->v > 2) {
+        return JPEG_ERR_UNSUPPORTED;
+    }
+    for (int i = 1; i < dec->ncomp; i++) {
+        if (dec->comp[i].h != 1 || dec->comp[i].v != 1) {
+            return JPEG_ERR_UNSUPPORTED;
+        }
+    }
+
+    dec->hmax = y->h;
+    dec->vmax = y->v;
+    dec->mcusX = (dec->width + dec->hmax * 8 - 1) / (dec->hmax * 8);
+    dec->mcusY = (dec->height + dec->vmax * 8 - 1) / (dec->vmax * 8);
+    return JPEG_OK;
+}
+
+static JpegResult parseSOS(JpegDecoder* dec, int len) {
+    uint8_t seg[1 + 2 * JPEG_MAX_COMPONENTS + 3];
+    if (len > (int)sizeof(seg) || len < 6) {
+        return JPEG_ERR_FORMAT;
+    }
+    if (!readBytes(dec, seg, len)) {
+        return JPEG_ERR_INPUT;
+    }
+
+    int ns = seg[0];
+    if (dec->ncomp == 0) {
+        return JPEG_ERR_FORMAT;             // SOS 在 SOF 之前
+    }
+    if (ns < 1 || ns > dec->ncomp || len != 4 + 2 * ns) {
+        return JPEG_ERR_FORMAT;
+    }
+    if (!dec->progressive && ns != dec->ncomp) {
+        return JPEG_ERR_UNSUPPORTED;        // 基线模式只支持交错扫描
+    }
+
+    const uint8_t* sp = seg + 1 + 2 * ns;
+    dec->ss = sp[0];
+    dec->se = sp[1];
+    dec->ah = sp[2] >> 4;
+    dec->al = sp[2] & 15;
+    if (dec->progressive) {
+        // DC 与 AC 分开扫描，AC 扫描只含一个分量
+        bool dcScan = (dec->ss == 0);
+        if (dec->se > 63 || dec->ss > dec->se || (dcScan && dec->se != 0) || (!dcScan && ns != 1) ||
+            dec->ah > 13 || dec->al > 13) {
+            return JPEG_ERR_FORMAT;
+        }
+    }
+
+    for (int i = 0; i < ns; i++) {
+        int ci = 0;
+        while (ci < dec->ncomp && dec->comp[ci].id != seg[1 + 2 * i]) {
+            ci++;
+        }
+        if (ci == dec->ncomp) {
+            return JPEG_ERR_FORMAT;
+        }
+        if (!dec->progressive && ci != i) {
+            return JPEG_ERR_UNSUPPORTED;
+        }
+
+        JpegComponent* c = &dec->comp[ci];
+        c->td = seg[2 + 2 * i] >> 4 & 3;
+        c->ta = seg[2 + 2 * i] & 3;
+        bool needDC = !dec->progressive || (dec->ss == 0 && dec->ah == 0);
+        bool needAC = !dec->progressive || dec->ss != 0;
+        if ((needDC && !dec->dcTable[c->td].present) || (needAC && !dec->acTable[c->ta].present)) {
+            return JPEG_ERR_FORMAT;
+        }
+        if (!dec->progressive && !dec->qtPresent[c->tq]) {
+            return JPEG_ERR_FORMAT;         // 渐进式的量化表可以晚于第一个扫描，输出时再检查
+        }
+        c->dcPred = 0;
+        dec->scanComp[i] = (uint8_t)ci;
+    }
+    dec->scanNs = (uint8_t)ns;
+    dec->eobRun = 0;
+    return JPEG_OK;
+}
+
+/**
+ * 处理标记段，直到 SOS（已解析扫描头）或 EOI（*eoi 置 true）
+ * @param m 已读到的第一个标记，0 表示从输入中找
+ */
+static JpegResult parseSegments(JpegDecoder* dec, uint8_t m, bool* eoi) {
+    *eoi = false;
+    for (;; m = 0) {
+        if (m == 0) {
+            int c = readByte(dec);
+            while (c >= 0 && c != 0xFF) {
+                c = readByte(dec);          // 跳过段之间的垃圾字节
+            }
+            while (c == 0xFF) {
+                c = readByte(dec);
+            }
+            if (c < 0) {
+                return JPEG_ERR_INPUT;
+            }
+            m = (uint8_t)c;
+        }
+
+        if (m == 0x01 || (m >= 0xD0 && m <= 0xD7)) {
+            continue;                       // 无长度字段
+        }
+        if (m == 0xD9) {
+            *eoi = true;
+            return JPEG_OK;
+        }
+
+        int len = readWord(dec);
+        if (len < 2) {
+            return (len < 0) ? JPEG_ERR_INPUT : JPEG_ERR_FORMAT;
+        }
+        len -= 2;
+
+        JpegResult r = JPEG_OK;
+        switch (m) {
+            case 0xC0:  // SOF0 基线
+            case 0xC1:  // SOF1 扩展顺序（8 位时与基线相同）
+            case 0xC2:  // SOF2 渐进式
+                if (dec->ncomp != 0) {
+                    return JPEG_ERR_FORMAT;     // 重复的 SOF
+                }
+                dec->progressive = (m == 0xC2);
+                r = parseSOF(dec, len);
+                break;
+            case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+            case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+                return JPEG_ERR_UNSUPPORTED;
+            case 0xC4:
+                r = parseDHT(dec, len);
+                break;
+            case 0xDB:
+                r = parseDQT(dec, len);
+                break;
+            case 0xDD: {
+                int ri = readWord(dec);
+                if (ri < 0) {
+                    return JPEG_ERR_INPUT;
+                }
+                dec->restartInterval = (uint16_t)ri;
+                if (len > 2 && !readBytes(dec, nullptr, len - 2)) {
+                    return JPEG_ERR_INPUT;
+                }
+                break;
+            }
+            case 0xDA:
+                return parseSOS(dec, len);
+            default:    // APPn、COM 等
+                if (!readBytes(dec, nullptr, len)) {
+                    return JPEG_ERR_INPUT;
+                }
+                break;
+        }
+        if (r != JPEG_OK) {
+            return r;
+        }
+    }
+}
+
+/**
+ * 读到第一个 SOS 为止
+ */
+static JpegResult parseHeaders(JpegDecoder* dec) {
+    // 找 SOI（允许前面有垃圾数据，与 TJpgDec 一致）
+    int prev = 0;
+    for (;;) {
+        int c = readByte(dec);
+        if (c < 0) {
+            return JPEG_ERR_INPUT;
+        }
+        if (prev == 0xFF && c == 0xD8) {
+            break;
+        }
+        prev = c;
+    }
+
+    bool eoi;
+    JpegResult r = parseSegments(dec, 0, &eoi);
+    if (r == JPEG_OK && eoi) {
+        r = JPEG_ERR_FORMAT;                // SOS 之前就结束了
+    }
+    return r;
+}
+
+static JpegResult openCommon(JpegDecoder* dec) {
+    JpegResult r = parseHeaders(dec);
+    if (r != JPEG_OK) {
+        return r;
+    }
+    resetBits(dec);
+    return JPEG_OK;
+}
+
+static void resetDecoder(JpegDecoder* dec) {
+    // 霍夫曼表很大且会在 DHT 中整体重建，只清标志
+    dec->in = nullptr;
+    dec->inLen = dec->inPos = 0;
+    dec->read = nullptr;
+    dec->readUser = nullptr;
+    dec->inEnd = false;
+    dec->marker = 0;
+    dec->truncated = false;
+    dec->width = dec->height = 0;
+    dec->ncomp = 0;
+    dec->restartInterval = 0;
+    dec->progressive = false;
+    for (int i = 0; i < 4; i++) {
+        dec->qtPresent[i] = false;
+        dec->dcTable[i].present = false;
+        dec->acTable[i].present = false;
+    }
+    dec->scale = 0;
+    dec->outWidth = dec->outHeight = 0;
+    dec->rowBuf = nullptr;
+    dec->work = nullptr;
+    dec->scanNs = 0;
+    for (int i = 0; i < JPEG_MAX_COMPONENTS; i++) {
+        dec->coef[i] = nullptr;
+        dec->nzMask[i] = nullptr;
+    }
+    dec->eobRun = 0;
+    dec->passDone = nullptr;
+    memset(&dec->profile, 0, sizeof(dec->profile));
+    resetBits(dec);
+}
+
+// ============================================================
+// 块解码与 MCU 输出
+// ============================================================
+
+/**
+ * 解码一个 8×8 块并变换成样本
+ */
+static JpegResult decodeBlock(JpegDecoder* dec, JpegComponent* c, int16_t* out) {
+    int32_t tmp[64];
+    const int32_t* qt = dec->qt[c->tq];
+
+    PROFILE_MARK(t0);
+
+    int s = huffDecode(dec, &dec->dcTable[c->td]);
+    if (s < 0 || s > 11) {
+        return JPEG_ERR_FORMAT;
+    }
+    int d = c->dcPred;
+    if (s) {
+        d += receiveExtend(dec, s);
+        c->dcPred = (int16_t)d;
+    }
+    tmp[0] = d * qt[0] >> 8;
+
+    const JpegHuffTable* ac = &dec->acTable[c->ta];
+
+    // 1/8 缩放只用 DC：AC 系数只跳过位，不反量化、不填整块（outputMcu 只读 out[0]）
+    if (dec->scale == 3) {
+        for (int z = 1; z < 64; z++) {
+            int rs = huffDecode(dec, ac);
+            if (rs == 0) {
+                break;
+            }
+            if (rs < 0) {
+                return JPEG_ERR_FORMAT;
+            }
+            z += rs >> 4;
+            if (z >= 64) {
+                return JPEG_ERR_FORMAT;
+            }
+            if (rs & 15) {
+                getBits(dec, rs & 15);
+            }
+        }
+        out[0] = (int16_t)(tmp[0] / 256 + 128);     // 与 JpegKernel_FillDC 相同的截断除法
+        PROFILE_ADD(entropy, t0);
+        return JPEG_OK;
+    }
+
+    memset(&tmp[1], 0, 63 * sizeof(int32_t));
+    uint8_t colMask = 0x01;
+    int z = 1;
+    do {
+        int rs = huffDecode(dec, ac);
+        if (rs == 0) {
+            break;      // EOB
+        }
+        if (rs < 0) {
+            return JPEG_ERR_FORMAT;
+        }
+        z += rs >> 4;
+        if (z >= 64) {
+            return JPEG_ERR_FORMAT;
+        }
+        if (rs & 15) {
+            int v = receiveExtend(dec, rs & 15);
+            int i = JpegKernel_Zigzag[z];
+            tmp[i] = v * qt[i] >> 8;
+            colMask |= 1 << (i & 7);
+        }
+    } while (++z < 64);
+
+    PROFILE_ADD(entropy, t0);
+    PROFILE_MARK(t1);
+
+    // 没有 AC 系数或 1/8 缩放时只用 DC
+    if (z == 1 || dec->scale == 3) {
+        JpegKernel_FillDC(tmp[0], out);
+    } else {
+        JpegKernel_IDCT(tmp, out, colMask);
+    }
+
+    PROFILE_ADD(idct, t1);
+    return JPEG_OK;
+}
+
+/**
+ * 把 MCU（blocks：亮度块按行排列，随后 Cb、Cr）转换成像素写入 rowBuf
+ */
+static void outputMcu(JpegDecoder* dec, const int16_t* blocks, int mcuX, int mcuY) {
+    const int mx = dec->hmax * 8;
+    const int my = dec->vmax * 8;
+    const int s = dec->scale;
+    const int nY = dec->hmax * dec->vmax;
+    const bool gray = (dec->ncomp == 1);
+    const int hShift = dec->hmax - 1;
+
+    int rx = dec->width - mcuX * mx;
+    int ry = dec->height - mcuY * my;
+    rx = (rx > mx ? mx : rx) >> s;
+    ry = (ry > my ? my : ry) >> s;
+    if (rx <= 0 || ry <= 0) {
+        return;
+    }
+
+    uint16_t* dst = dec->rowBuf + mcuX * (mx >> s);
+    const int stride = dec->outWidth;
+    const int16_t* cbBlk = blocks + nY * 64;
+    const int16_t* crBlk = cbBlk + 64;
+
+    if (s == 0) {
+        // 1:1：直接逐行转换，只转换可见部分
+        for (int iy = 0; iy < ry; iy++) {
+            const int16_t* yRow = blocks + (iy >> 3) * dec->hmax * 64 + (iy & 7) * 8;
+            int cy = (dec->vmax == 2) ? (iy >> 1) : iy;
+            uint16_t* out = dst + iy * stride;
+            for (int bx = 0; bx < dec->hmax; bx++) {
+                int n = rx - bx * 8;
+                if (n <= 0) {
+                    break;
+                }
+                if (n > 8) {
+                    n = 8;
+                }
+                if (gray) {
+                    JpegKernel_GrayToRGB565(yRow + bx * 64, out + bx * 8, n);
+                } else {
+                    int cx = bx * (8 >> hShift);
+                    JpegKernel_YCCToRGB565(yRow + bx * 64, cbBlk + cy * 8 + cx, crBlk + cy * 8 + cx,
+                                           out + bx * 8, n, hShift);
+                }
+            }
+        }
+        return;
+    }
+
+    if (s == 3) {
+        // 1/8：每个亮度块一个像素（块已被填成 DC 值）
+        int cb = gray ? 0 : cbBlk[0] - 128;
+        int cr = gray ? 0 : crBlk[0] - 128;
+        uint8_t rgb[3];
+        for (int by = 0; by < ry; by++) {
+            for (int bx = 0; bx < rx; bx++) {
+                JpegKernel_YCCPixel(blocks[(by * dec->hmax + bx) * 64], cb, cr, rgb);
+                dst[by * stride + bx] = JpegKernel_Pack565(rgb[0], rgb[1], rgb[2]);
+            }
+        }
+        return;
+    }
+
+    // 1/2、1/4：先转成 RGB888，再按 w×w 方块求平均
+    uint8_t* rgb = dec->work;
+    for (int iy = 0; iy < my; iy++) {
+        const int16_t* yRow = blocks + (iy >> 3) * dec->hmax * 64 + (iy & 7) * 8;
+        int cy = (dec->vmax == 2) ? (iy >> 1) : iy;
+        uint8_t* out = rgb + iy * mx * 3;
+        for (int bx = 0; bx < dec->hmax; bx++) {
+            if (gray) {
+                JpegKernel_GrayToRGB888(yRow + bx * 64, out + bx * 24, 8);
+            } else {
+                int cx = bx * (8 >> hShift);
+                JpegKernel_YCCToRGB888(yRow + bx * 64, cbBlk + cy * 8 + cx, crBlk + cy * 8 + cx,
+                                       out + bx * 24, 8, hShift);
+            }
+        }
+    }
+
+    const int w = 1 << s;
+    const int shift = s * 2;
+    for (int oy = 0; oy < ry; oy++) {
+        for (int ox = 0; ox < rx; ox++) {
+            unsigned r = 0, g = 0, b = 0;
+            const uint8_t* p = rgb + ((oy * w) * mx + ox * w) * 3;
+            for (int y = 0; y < w; y++, p += mx * 3) {
+                for (int x = 0; x < w; x++) {
+                    r += p[x * 3];
+                    g += p[x * 3 + 1];
+                    b += p[x * 3 + 2];
+                }
+            }
+            dst[oy * stride + ox] = JpegKernel_Pack565((uint8_t)(r >> shift), (uint8_t)(g >> shift),
+                                                       (uint8_t)(b >> shift));
+        }
+    }
+}
+
+// ============================================================
+// 渐进式：各扫描解码到系数平面，全部扫描结束后统一变换输出
+// ============================================================
+
+static inline int16_t* coefAt(JpegDecoder* dec, int ci, int bx, int by) {
+    size_t idx = (size_t)by * dec->blocksW[ci] + bx;
+    return dec->coef[ci] + idx * dec->coefK * dec->coefK;
+}
+
+static inline uint64_t* maskAt(JpegDecoder* dec, int ci, int bx, int by) {
+    if (dec->nzMask[ci] == nullptr) {
+        return nullptr;     // 全部系数都保存时用不到
+    }
+    return dec->nzMask[ci] + (size_t)by * dec->blocksW[ci] + bx;
+}
+
+static inline bool coefNonzero(const JpegDecoder* dec, const int16_t* co, const uint64_t* nz, int z) {
+    int slot = dec->coefSlot[z];
+    return (slot >= 0) ? (co[slot] != 0) : ((*nz >> z) & 1) != 0;
+}
+
+static inline void coefSet(const JpegDecoder* dec, int16_t* co, uint64_t* nz, int z, int v) {
+    int slot = dec->coefSlot[z];
+    if (slot >= 0) {
+        co[slot] = (int16_t)v;
+    } else if (v != 0) {
+        *nz |= (uint64_t)1 << z;
+    }
+}
+
+static inline void coefRefine(const JpegDecoder* dec, int16_t* co, int z, int p1) {
+    int slot = dec->coefSlot[z];
+    if (slot >= 0 && (co[slot] & p1) == 0) {
+        co[slot] = (int16_t)(co[slot] + (co[slot] >= 0 ? p1 : -p1));
+    }
+}
+
+/**
+ * 解码一个块在当前扫描中的数据（DC 首次/细化、AC 首次/细化）
+ * @param nz 丢弃系数的非零标记，全部系数都保存时为 nullptr
+ */
+static JpegResult decodeProgBlock(JpegDecoder* dec, JpegComponent* c, int16_t* co, uint64_t* nz) {
+    if (dec->ss == 0) {
+        if (dec->ah == 0) {
+            int s = huffDecode(dec, &dec->dcTable[c->td]);
+            if (s < 0 || s > 11) {
+                return JPEG_ERR_FORMAT;
+            }
+            if (s) {
+                c->dcPred = (int16_t)(c->dcPred + receiveExtend(dec, s));
+            }
+            co[0] = (int16_t)(c->dcPred * (1 << dec->al));
+        } else if (getBits(dec, 1)) {
+            co[0] = (int16_t)(co[0] | (1 << dec->al));
+        }
+        return JPEG_OK;
+    }
+
+    const JpegHuffTable* ac = &dec->acTable[c->ta];
+    int z = dec->ss;
+
+    if (dec->ah == 0) {
+        // AC 首次扫描：EOBRUN 表示连续若干个块在本频段内全为零
+        if (dec->eobRun > 0) {
+            dec->eobRun--;
+            return JPEG_OK;
+        }
+        for (; z <= dec->se; z++) {
+            int rs = huffDecode(dec, ac);
+            if (rs < 0) {
+                return JPEG_ERR_FORMAT;
+            }
+            int r = rs >> 4;
+            if ((rs & 15) == 0) {
+                if (r < 15) {
+                    dec->eobRun = (1u << r) - 1;
+                    if (r) {
+                        dec->eobRun += getBits(dec, r);
+                    }
+                    break;
+                }
+                z += 15;    // ZRL：16 个零
+                continue;
+            }
+            z += r;
+            if (z > dec->se) {
+                return JPEG_ERR_FORMAT;
+            }
+            coefSet(dec, co, nz, z, receiveExtend(dec, rs & 15) * (1 << dec->al));
+        }
+        return JPEG_OK;
+    }
+
+    // AC 细化扫描（与 libjpeg 的 decode_mcu_AC_refine 相同）：
+    // 已非零的系数每经过一个读一位修正，新出现的非零系数只能是 ±1 << al
+    const int p1 = 1 << dec->al;
+    if (dec->eobRun == 0) {
+        for (; z <= dec->se; z++) {
+            int rs = huffDecode(dec, ac);
+            if (rs < 0) {
+                return JPEG_ERR_FORMAT;
+            }
+            int r = rs >> 4;
+            int v = 0;
+            if (rs & 15) {
+                v = getBits(dec, 1) ? p1 : -p1;     // 大小只能是 1，其他值 libjpeg 也按 1 处理
+            } else if (r != 15) {
+                dec->eobRun = 1u << r;
+                if (r) {
+                    dec->eobRun += getBits(dec, r);
+                }
+                break;      // 本块剩余部分按 EOB 处理
+            }
+
+            // 跳过 r 个仍为零的系数，途中的非零系数各带一位修正
+            do {
+                if (coefNonzero(dec, co, nz, z)) {
+                    if (getBits(dec, 1)) {
+                        coefRefine(dec, co, z, p1);
+                    }
+                } else if (--r < 0) {
+                    break;
+                }
+                z++;
+            } while (z <= dec->se);
+
+            if (v != 0 && z <= dec->se) {
+                coefSet(dec, co, nz, z, v);
+            }
+        }
+    }
+    if (dec->eobRun > 0) {
+        for (; z <= dec->se; z++) {
+            if (coefNonzero(dec, co, nz, z) && getBits(dec, 1)) {
+                coefRefine(dec, co, z, p1);
+            }
+        }
+        dec->eobRun--;
+    }
+    return JPEG_OK;
+}
+
+/**
+ * 解码一个扫描的熵数据
+ */
+static JpegResult decodeScan(JpegDecoder* dec) {
+    PROFILE_MARK(t0);
+    uint32_t restartCount = 0;
+    JpegResult r = JPEG_OK;
+
+    if (dec->scanNs == 1) {
+        // 非交错扫描按分量自身的块数，不含 MCU 对齐补出的块；重启间隔按块计
+        int ci = dec->scanComp[0];
+        JpegComponent* c = &dec->comp[ci];
+        int cw = ((dec->width * c->h + dec->hmax - 1) / dec->hmax + 7) / 8;
+        int ch = ((dec->height * c->v + dec->vmax - 1) / dec->vmax + 7) / 8;
+        for (int by = 0; by < ch && r == JPEG_OK; by++) {
+            for (int bx = 0; bx < cw; bx++) {
+                if (dec->restartInterval && restartCount == dec->restartInterval) {
+                    r = processRestart(dec);
+                    if (r != JPEG_OK) {
+                        break;
+                    }
+                    restartCount = 0;
+                }
+                restartCount++;
+
+                r = decodeProgBlock(dec, c, coefAt(dec, ci, bx, by), maskAt(dec, ci, bx, by));
+                if (r != JPEG_OK) {
+                    break;
+                }
+            }
+        }
+    } else {
+        // 交错扫描（只有 DC）按 MCU
+        for (int mcuY = 0; mcuY < dec->mcusY && r == JPEG_OK; mcuY++) {
+            for (int mcuX = 0; mcuX < dec->mcusX && r == JPEG_OK; mcuX++) {
+                if (dec->restartInterval && restartCount == dec->restartInterval) {
+                    r = processRestart(dec);
+                    if (r != JPEG_OK) {
+                        break;
+                    }
+                    restartCount = 0;
+                }
+                restartCount++;
+
+                for (int i = 0; i < dec->scanNs && r == JPEG_OK; i++) {
+                    int ci = dec->scanComp[i];
+                    JpegComponent* c = &dec->comp[ci];
+                    for (int v = 0; v < c->v && r == JPEG_OK; v++) {
+                        for (int h = 0; h < c->h && r == JPEG_OK; h++) {
+                            int bx = mcuX * c->h + h;
+                            int by = mcuY * c->v + v;
+                            r = decodeProgBlock(dec, c, coefAt(dec, ci, bx, by), maskAt(dec, ci, bx, by));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    PROFILE_ADD(entropy, t0);
+    return r;
+}
+
+/**
+ * 系数反量化并变换成样本
+ */
+static void reconstructBlock(JpegDecoder* dec, const JpegComponent* c, const int16_t* co, int16_t* out) {
+    const int32_t* qt = dec->qt[c->tq];
+    const int k = dec->coefK;
+    int32_t dc = co[0] * qt[0] >> 8;
+
+    if (dec->scale == 3) {
+        out[0] = (int16_t)(dc / 256 + 128);     // outputMcu 只读 out[0]
+        return;
+    }
+
+    int32_t tmp[64];
+    memset(tmp, 0, sizeof(tmp));
+    tmp[0] = dc;
+    uint8_t colMask = 0x01;
+    bool hasAC = false;
+    for (int row = 0; row < k; row++) {
+        for (int col = 0; col < k; col++) {
+            int v = co[row * k + col];
+            if (v != 0 && (row | col) != 0) {
+                int i = row * 8 + col;
+                tmp[i] = v * qt[i] >> 8;
+                colMask |= 1 << col;
+                hasAC = true;
+            }
+        }
+    }
+
+    if (hasAC) {
+        JpegKernel_IDCT(tmp, out, colMask);
+    } else {
+        JpegKernel_FillDC(tmp[0], out);
+    }
+}
+
+/**
+ * 用当前系数输出整幅图（预览与最终结果共用）
+ */
+static JpegResult outputProgressive(JpegDecoder* dec, int16_t x0, int16_t y0, JpegOutputFunc out) {
+    for (int i = 0; i < dec->ncomp; i++) {
+        if (!dec->qtPresent[dec->comp[i].tq]) {
+            return JPEG_ERR_FORMAT;
+        }
+    }
+
+    int16_t blocks[MAX_MCU_BLOCKS * 64];
+    const int my = dec->vmax * 8;
+    const int rowH = my >> dec->scale;
+
+    for (int mcuY = 0; mcuY < dec->mcusY; mcuY++) {
+        for (int mcuX = 0; mcuX < dec->mcusX; mcuX++) {
+            PROFILE_MARK(t0);
+            int b = 0;
+            for (int ci = 0; ci < dec->ncomp; ci++) {
+                const JpegComponent* c = &dec->comp[ci];
+                for (int v = 0; v < c->v; v++) {
+                    for (int h = 0; h < c->h; h++, b++) {
+                        reconstructBlock(dec, c, coefAt(dec, ci, mcuX * c->h + h, mcuY * c->v + v), blocks + b * 64);
+                    }
+                }
+            }
+            PROFILE_ADD(idct, t0);
+
+            PROFILE_MARK(t1);
+            outputMcu(dec, blocks, mcuX, mcuY);
+            PROFILE_ADD(color, t1);
+            dec->profile.mcus++;
+        }
+
+        int h = dec->height - mcuY * my;
+        h = (h > my ? my : h) >> dec->scale;
+        if (h > 0) {
+            PROFILE_MARK(t2);
+            bool ok = out(x0, y0 + mcuY * rowH, dec->outWidth, h, dec->rowBuf);
+            PROFILE_ADD(color, t2);
+            if (!ok) {
+                return JPEG_ERR_ABORTED;
+            }
+        }
+    }
+    return JPEG_OK;
+}
+
+static JpegResult decodeProgressive(JpegDecoder* dec, int16_t x0, int16_t y0, JpegOutputFunc out) {
+    if (JpegCodec_ProgressiveBytes(dec, dec->scale) > JPEG_PROGRESSIVE_MAX_BYTES) {
+        return JPEG_ERR_MEMORY;
+    }
+
+    // 只保存缩放后用得到的 k×k 个低频系数
+    const int k = 8 >> dec->scale;
+    dec->coefK = (uint8_t)k;
+    for (int z = 0; z < 64; z++) {
+        int i = JpegKernel_Zigzag[z];
+        int row = i >> 3;
+        int col = i & 7;
+        dec->coefSlot[z] = (int8_t)((row < k && col < k) ? row * k + col : -1);
+    }
+
+    for (int ci = 0; ci < dec->ncomp; ci++) {
+        dec->blocksW[ci] = (uint16_t)(dec->mcusX * dec->comp[ci].h);
+        dec->blocksH[ci] = (uint16_t)(dec->mcusY * dec->comp[ci].v);
+        size_t n = (size_t)dec->blocksW[ci] * dec->blocksH[ci];
+        dec->coef[ci] = (int16_t*)jpegAlloc(n * k * k * sizeof(int16_t));
+        if (dec->coef[ci] == nullptr) {
+            return JPEG_ERR_MEMORY;
+        }
+        memset(dec->coef[ci], 0, n * k * k * sizeof(int16_t));
+        if (k < 8) {
+            dec->nzMask[ci] = (uint64_t*)jpegAlloc(n * sizeof(uint64_t));
+            if (dec->nzMask[ci] == nullptr) {
+                return JPEG_ERR_MEMORY;
+            }
+            memset(dec->nzMask[ci], 0, n * sizeof(uint64_t));
+        }
+    }
+
+    // 所有分量的首次 DC 扫描完成后画面已有 1/8 分辨率的轮廓，先输出一遍；
+    // 1/8 缩放本来就只用 DC，不需要预览；没有设置 passDone 说明调用方不需要预览
+    const uint8_t allDC = (uint8_t)((1 << dec->ncomp) - 1);
+    uint8_t dcDone = 0;
+    bool previewed = !JPEG_PROGRESSIVE_PREVIEW || dec->scale == 3 || dec->passDone == nullptr;
+    bool cut = false;
+    JpegResult r = JPEG_OK;
+
+    for (;;) {
+        if (!previewed && dcDone == allDC) {
+            previewed = true;
+            r = outputProgressive(dec, x0, y0, out);
+            if (r != JPEG_OK) {
+                return r;
+            }
+            if (!dec->passDone()) {
+                return JPEG_ERR_ABORTED;
+            }
+        }
+
+        r = decodeScan(dec);
+        if (r != JPEG_OK) {
+            return r;
+        }
+        if (dec->ss == 0 && dec->ah == 0) {
+            for (int i = 0; i < dec->scanNs; i++) {
+                dcDone |= (uint8_t)(1 << dec->scanComp[i]);
+            }
+        }
+
+        // 文件不完整时用已读到的扫描输出，仍然报错
+        if (dec->truncated && dec->stuffedBits > dec->bitCnt) {
+            cut = true;
+            break;
+        }
+
+        // 扫描之间可能有新的 DHT / DQT / DRI
+        uint8_t m = dec->marker;
+        dec->marker = 0;
+        resetBits(dec);
+        bool eoi;
+        r = parseSegments(dec, m, &eoi);
+        if (r != JPEG_OK) {
+            return r;
+        }
+        if (eoi) {
+            break;
+        }
+    }
+
+    r = outputProgressive(dec, x0, y0, out);
+    return (r == JPEG_OK && cut) ? JPEG_ERR_INPUT : r;
+}
+
+/**
+ * 基线：边解码边输出，每行 MCU 回调一次
+ */
+static JpegResult decodeBaseline(JpegDecoder* dec, int16_t x0, int16_t y0, JpegOutputFunc out) {
+    int16_t blocks[MAX_MCU_BLOCKS * 64];
+    const int my = dec->vmax * 8;
+    const int rowH = my >> dec->scale;
+    const int nY = dec->hmax * dec->vmax;
+    uint32_t restartCount = 0;
+    JpegResult r = JPEG_OK;
+
+    for (int mcuY = 0; mcuY < dec->mcusY && r == JPEG_OK; mcuY++) {
+        for (int mcuX = 0; mcuX < dec->mcusX; mcuX++) {
+            if (dec->restartInterval && restartCount == dec->restartInterval) {
+                r = processRestart(dec);
+                if (r != JPEG_OK) {
+                    break;
+                }
+                restartCount = 0;
+            }
+            restartCount++;
+
+            for (int b = 0; b < nY && r == JPEG_OK; b++) {
+                r = decodeBlock(dec, &dec->comp[0], blocks + b * 64);
+            }
+            for (int c = 1; c < dec->ncomp && r == JPEG_OK; c++) {
+                r = decodeBlock(dec, &dec->comp[c], blocks + (nY + c - 1) * 64);
+            }
+            if (r != JPEG_OK) {
+                break;
+            }
+
+            PROFILE_MARK(t0);
+            outputMcu(dec, blocks, mcuX, mcuY);
+            PROFILE_ADD(color, t0);
+            dec->profile.mcus++;
+        }
+        if (r != JPEG_OK) {
+            break;
+        }
+
+        int h = dec->height - mcuY * my;
+        h = (h > my ? my : h) >> dec->scale;
+        if (h > 0) {
+            PROFILE_MARK(t1);
+            bool ok = out(x0, y0 + mcuY * rowH, dec->outWidth, h, dec->rowBuf);
+            PROFILE_ADD(color, t1);
+            if (!ok) {
+                r = JPEG_ERR_ABORTED;
+            }
+        }
+    }
+
+    // 用到了文件结束后补的假数据：文件不完整
+    if (r == JPEG_OK && dec->truncated && dec->stuffedBits > dec->bitCnt) {
+        r = JPEG_ERR_INPUT;
+    }
+    return r;
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+JpegResult JpegCodec_OpenMemory(JpegDecoder* dec, const uint8_t* data, size_t size) {
+    if (dec == nullptr || data == nullptr) {
+        return JPEG_ERR_INPUT;
+    }
+    resetDecoder(dec);
+    dec->in = data;
+    dec->inLen = size;
+    return openCommon(dec);
+}
+
+JpegResult JpegCodec_OpenStream(JpegDecoder* dec, JpegReadFunc read, void* user) {
+    if (dec == nullptr || read == nullptr) {
+        return JPEG_ERR_INPUT;
+    }
+    resetDecoder(dec);
+    dec->read = read;
+    dec->readUser = user;
+    return openCommon(dec);
+}
+
+void JpegCodec_ScaledSize(const JpegDecoder* dec, uint8_t scale, uint16_t* w, uint16_t* h) {
+    int mx = dec->hmax * 8;
+    int my = dec->vmax * 8;
+    if (w != nullptr) {
+        *w = (uint16_t)((dec->width / mx) * (mx >> scale) + ((dec->width % mx) >> scale));
+    }
+    if (h != nullptr) {
+        *h = (uint16_t)((dec->height / my) * (my >> scale) + ((dec->height % my) >> scale));
+    }
+}
+
+JpegResult JpegCodec_Decode(JpegDecoder* dec, uint8_t scale, int16_t x0, int16_t y0, JpegOutputFunc out) {
+    if (dec == nullptr || out == nullptr || dec->ncomp == 0 || scale > 3) {
+        return JPEG_ERR_FORMAT;
+    }
+
+    dec->scale = scale;
+    JpegCodec_ScaledSize(dec, scale, &dec->outWidth, &dec->outHeight);
+
+    // 输出回调的坐标是 int16_t
+    if (x0 + dec->outWidth > INT16_MAX || y0 + dec->outHeight > INT16_MAX) {
+        return JPEG_ERR_UNSUPPORTED;
+    }
+
+    const int my = dec->vmax * 8;
+    const int rowH = my >> scale;
+    const int mx = dec->hmax * 8;
+
+    // 行缓冲宽度按整 MCU 对齐，最后一个 MCU 可能只写一部分
+    size_t rowPixels = (size_t)dec->outWidth * rowH;
+    if (rowPixels == 0) {
+        return JPEG_OK;
+    }
+    dec->rowBuf = (uint16_t*)jpegAlloc(rowPixels * 2);
+    if (scale == 1 || scale == 2) {
+        dec->work = (uint8_t*)jpegAlloc(mx * my * 3);
+    }
+    if (dec->rowBuf == nullptr || ((scale == 1 || scale == 2) && dec->work == nullptr)) {
+        JpegCodec_Close(dec);
+        return JPEG_ERR_MEMORY;
+    }
+
+    JpegResult r = dec->progressive ? decodeProgressive(dec, x0, y0, out) : decodeBaseline(dec, x0, y0, out);
+
+    JpegCodec_Close(dec);
+    return r;
+}
+
+void JpegCodec_Close(JpegDecoder* dec) {
+    if (dec == nullptr) {
+        return;
+    }
+    if (dec->rowBuf != nullptr) {
+        jpegFree(dec->rowBuf);
+        dec->rowBuf = nullptr;
+    }
+    if (dec->work != nullptr) {
+        jpegFree(dec->work);
+        dec->work = nullptr;
+    }
+    for (int i = 0; i < JPEG_MAX_COMPONENTS; i++) {
+        if (dec->coef[i] != nullptr) {
+            jpegFree(dec->coef[i]);
+            dec->coef[i] = nullptr;
+        }
+        if (dec->nzMask[i] != nullptr) {
+            jpegFree(dec->nzMask[i]);
+            dec->nzMask[i] = nullptr;
+        }
+    }
+}
+
+size_t JpegCodec_ProgressiveBytes(const JpegDecoder* dec, uint8_t scale) {
+    if (dec == nullptr || !dec->progressive || dec->ncomp == 0 || scale > 3) {
+        return 0;
+    }
+    int k = 8 >> scale;
+    size_t perBlock = (size_t)k * k * sizeof(int16_t) + (k < 8 ? sizeof(uint64_t) : 0);
+    size_t blocks = 0;
+    for (int i = 0; i < dec->ncomp; i++) {
+        blocks += (size_t)dec->mcusX * dec->comp[i].h * dec->mcusY * dec->comp[i].v;
+    }
+    return blocks * perBlock;
+}
+
+void JpegCodec_SetReclaim(JpegReclaimFunc reclaim) {
+    g_reclaim = reclaim;
+}
+
+const char* JpegCodec_ResultName(JpegResult r) {
+    switch (r) {
+        case JPEG_OK:               return "OK";
+        case JPEG_ERR_INPUT:        return "输入错误";
+        case JPEG_ERR_FORMAT:       return "格式错误";
+        case JPEG_ERR_UNSUPPORTED:  return "不支持的 JPEG 特性";
+        case JPEG_ERR_MEMORY:       return "内存不足";
+        case JPEG_ERR_ABORTED:      return "已中止";
+    }
+    return "未知错误";
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// 内置 JPEG 解码器（TJpgDec 的替代后端）
+// - 基线（SOF0/SOF1）与渐进式（SOF2）霍夫曼 JPEG，灰度或 YCbCr，亮度采样 1×1 / 2×1 / 1×2 / 2×2
+// - 按 MCU 行输出 RGB565 条带，一整行只回调一次
+// - 1/2、1/4、1/8 缩放，结果与 TJpgDec.setJpgScale 相同
+// - 霍夫曼查表解码（9 位前瞻），IDCT 跳过全零列
+// - 渐进式：系数平面放 PSRAM，只保留缩放后用得到的低频系数（见 JpegCodec_ProgressiveBytes）
+// 不依赖 Arduino，可直接在 x86 Linux 上编译。
+// ============================================================
+#define JPEG_HUFF_LOOKAHEAD     9       // 霍夫曼快速查表位数
+#define JPEG_INPUT_BUF_SIZE     1024    // 流式输入缓冲区大小
+#define JPEG_MAX_COMPONENTS     3
+
+// 渐进式 JPEG
+// 每个 8×8 块保存 k×k 个低频系数（k = 8 >> scale，int16）；k < 8 时另加 8 字节
+// 非零标记，用来让丢弃的高频系数在 AC 细化扫描中保持位流同步。
+// 每块字节数：1/1 = 128，1/2 = 40，1/4 = 16，1/8 = 10；
+// 块数 = 整 MCU 对齐后的亮度块数 + 色度块数（4:2:0 约为像素数 × 1.5 / 64）。
+// 例：4000×3000 4:2:0 在 1/8 时约 2.8 MB，在 1/1 时需要 36 MB（超出上限）。
+// 帧缓存（最多 6 MB）占满 PSRAM 时系数平面分配会失败，由回收回调淘汰缓存帧后重试（见 JpegCodec_SetReclaim）。
+#define JPEG_PROGRESSIVE_MAX_BYTES  (4 * 1024 * 1024)   // 系数平面上限，超出返回 JPEG_ERR_MEMORY
+#define JPEG_PROGRESSIVE_PREVIEW    1                   // DC 扫描结束后先输出一遍低质量预览
+
+// 解码结果
+enum JpegResult {
+    JPEG_OK = 0,
+    JPEG_ERR_INPUT,         // 读取失败或数据提前结束
+    JPEG_ERR_FORMAT,        // 不是 JPEG 或数据损坏
+    JPEG_ERR_UNSUPPORTED,   // 不支持的特性（算术编码、12 位精度、CMYK 等）
+    JPEG_ERR_MEMORY,        // 内存不足
+    JPEG_ERR_ABORTED        // 输出回调要求中止
+};
+
+/**
+ * @brief 输入回调：最多读取 len 字节到 buf，返回实际读取数，0 表示结束
+ */
+typedef size_t (*JpegReadFunc)(void* user, uint8_t* buf, size_t len);
+
+/**
+ * @brief 输出回调：一块 RGB565 像素（行距等于 w），返回 false 中止解码
+ * @details 与 TJpgDec 的回调参数一致，可直接复用 jpegDrawCallback
+ */
+typedef bool (*JpegOutputFunc)(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* pixels);
+
+/**
+ * @brief 渐进式预览输出完毕（整幅图已通过 JpegOutputFunc 输出一遍），返回 false 中止解码
+ * @details 之后会从第一行开始再输出一遍最终结果
+ */
+typedef bool (*JpegPassFunc)(void);
+
+// 霍夫曼表
+typedef struct {
+    uint8_t lookLen[1 << JPEG_HUFF_LOOKAHEAD];  // 0 表示码长超过前瞻位数
+    uint8_t lookVal[1 << JPEG_HUFF_LOOKAHEAD];
+    int32_t maxCode[18];                        // 各码长最大码字，-1 表示无
+    int32_t valOffset[17];                      // 码字 → values 下标的偏移
+    uint8_t values[256];
+    bool present;
+} JpegHuffTable;
+
+// 图像分量
+typedef struct {
+    uint8_t id;
+    uint8_t h, v;           // 采样因子
+    uint8_t tq;             // 量化表号
+    uint8_t td, ta;         // 本次扫描使用的 DC/AC 霍夫曼表号
+    int16_t dcPred;         // DC 预测值
+} JpegComponent;
+
+// 各阶段耗时（CPU 周期，仅在 JPEG_PROFILE 打开时统计）
+typedef struct {
+    uint32_t mcus;          // 已解码的 MCU 数
+    uint64_t entropy;       // 霍夫曼解码 + 反量化
+    uint64_t idct;          // IDCT
+    uint64_t color;         // 色彩转换、缩放和输出回调
+} JpegProfile;
+
+#ifndef JPEG_PROFILE
+#define JPEG_PROFILE    1
+#endif
+
+// 解码器状态（约 12 KB，调用方负责分配，建议放内部 RAM）
+typedef struct {
+    // 输入
+    const uint8_t* in;      // 当前输入数据
+    size_t inLen;
+    size_t inPos;
+    JpegReadFunc read;      // 为 nullptr 时 in 指向整个文件
+    void* readUser;
+    uint8_t inBuf[JPEG_INPUT_BUF_SIZE];
+    bool inEnd;
+    bool truncated;         // 熵数据没读完文件就结束了
+
+    // 熵解码位缓冲（高位对齐）
+    uint32_t bitBuf;
+    int bitCnt;
+    uint8_t marker;         // 熵数据中遇到的标记（0 表示无）
+    int stuffedBits;        // 遇到标记后补进位缓冲的 0 位数
+
+    // 帧参数
+    uint16_t width, height;
+    uint8_t ncomp;
+    JpegComponent comp[JPEG_MAX_COMPONENTS];
+    uint8_t hmax, vmax;     // MCU 的亮度块数（横/纵）
+    uint16_t mcusX, mcusY;
+    uint16_t restartInterval;
+    bool progressive;
+
+    // 当前扫描
+    uint8_t scanNs;                             // 本次扫描的分量数
+    uint8_t scanComp[JPEG_MAX_COMPONENTS];      // 本次扫描的分量下标
+    uint8_t ss, se, ah, al;                     // 渐进式：频谱范围与逐次逼近位
+
+    // 渐进式系数平面（PSRAM）
+    int16_t* coef[JPEG_MAX_COMPONENTS];         // 每块 coefK × coefK 个量化后的系数
+    uint64_t* nzMask[JPEG_MAX_COMPONENTS];      // 每块一个 64 位非零标记（按 zigzag 序号，只用于丢弃的系数）
+    uint16_t blocksW[JPEG_MAX_COMPONENTS];      // 系数平面尺寸（块，按整 MCU 对齐）
+    uint16_t blocksH[JPEG_MAX_COMPONENTS];
+    uint8_t coefK;
+    int8_t coefSlot[64];                        // zigzag 序号 → 块内保存位置，-1 表示丢弃
+    uint32_t eobRun;
+    JpegPassFunc passDone;                      // 预览输出完毕回调（nullptr 表示不输出预览）
+
+    // 表
+    int32_t qt[4][64];
+    bool qtPresent[4];
+    JpegHuffTable dcTable[4];
+    JpegHuffTable acTable[4];
+
+    // 输出
+    uint8_t scale;          // 0..3 → 1/1、1/2、1/4、1/8
+    uint16_t outWidth, outHeight;
+    uint16_t* rowBuf;       // 一行 MCU 的 RGB565 输出（outWidth × MCU 高度）
+    uint8_t* work;          // 1/2、1/4 缩放时一个 MCU 的 RGB888 暂存
+
+    JpegProfile profile;
+} JpegDecoder;
+
+/**
+ * @brief 从内存解析 JPEG 头（不解码像素）
+ */
+JpegResult JpegCodec_OpenMemory(JpegDecoder* dec, const uint8_t* data, size_t size);
+
+/**
+ * @brief 从回调流解析 JPEG 头
+ */
+JpegResult JpegCodec_OpenStream(JpegDecoder* dec, JpegReadFunc read, void* user);
+
+/**
+ * @brief 解码并逐行输出
+ * @param scale  0..3 → 1/1、1/2、1/4、1/8
+ * @param x0,y0  输出坐标偏移
+ * @details 渐进式图片先读完全部扫描再输出；打开 JPEG_PROGRESSIVE_PREVIEW 且设置了
+ *          dec->passDone（Open 之后设置）时，DC 扫描结束后先输出一遍预览并调用 passDone
+ */
+JpegResult JpegCodec_Decode(JpegDecoder* dec, uint8_t scale, int16_t x0, int16_t y0, JpegOutputFunc out);
+
+/**
+ * @brief 释放解码过程中分配的缓冲区（解码器结构体本身由调用方释放）
+ */
+void JpegCodec_Close(JpegDecoder* dec);
+
+/**
+ * @brief 缩放后的输出尺寸（与 TJpgDec 在相同缩放下的输出一致）
+ */
+void JpegCodec_ScaledSize(const JpegDecoder* dec, uint8_t scale, uint16_t* w, uint16_t* h);
+
+/**
+ * @brief 渐进式图片在给定缩放下系数平面所需字节数（基线图片返回 0）
+ * @details 与 JPEG_PROGRESSIVE_MAX_BYTES 比较，可用来选择能放得下的缩放
+ */
+size_t JpegCodec_ProgressiveBytes(const JpegDecoder* dec, uint8_t scale);
+
+/**
+ * @brief 内存回收回调：腾出 bytes 字节的连续空间（如淘汰帧缓存），返回 true 表示值得重试分配
+ */
+typedef bool (*JpegReclaimFunc)(size_t bytes);
+
+/**
+ * @brief 设置内存回收回调（全局，nullptr 取消）
+ * @details 渐进式系数平面等缓冲区分配失败时调用一次，成功则重试该次分配
+ */
+void JpegCodec_SetReclaim(JpegReclaimFunc reclaim);
+
+/**
+ * @brief 错误码说明
+ */
+const char* JpegCodec_ResultName(JpegResult r);
@@ -0,0 +1,273 @@
+#include "JPEG_Kernels.h"
+
+// ============================================================
+// 常量表
+// ============================================================
+
+const uint8_t JpegKernel_Zigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+// Arai 算法输入比例因子（放大 2^13），与 tjpgd 的 Ipsf 表取值相同
+#define IPSF(v) ((uint16_t)((v) * 8192))
+static const uint16_t Ipsf[64] = {
+    IPSF(1.00000), IPSF(1.38704), IPSF(1.30656), IPSF(1.17588), IPSF(1.00000), IPSF(0.78570), IPSF(0.54120), IPSF(0.27590),
+    IPSF(1.38704), IPSF(1.92388), IPSF(1.81226), IPSF(1.63099), IPSF(1.38704), IPSF(1.08979), IPSF(0.75066), IPSF(0.38268),
+    IPSF(1.30656), IPSF(1.81226), IPSF(1.70711), IPSF(1.53636), IPSF(1.30656), IPSF(1.02656), IPSF(0.70711), IPSF(0.36048),
+    IPSF(1.17588), IPSF(1.63099), IPSF(1.53636), IPSF(1.38268), IPSF(1.17588), IPSF(0.92388), IPSF(0.63638), IPSF(0.32442),
+    IPSF(1.00000), IPSF(1.38704), IPSF(1.30656), IPSF(1.17588), IPSF(1.00000), IPSF(0.78570), IPSF(0.54120), IPSF(0.27590),
+    IPSF(0.78570), IPSF(1.08979), IPSF(1.02656), IPSF(0.92388), IPSF(0.78570), IPSF(0.61732), IPSF(0.42522), IPSF(0.21677),
+    IPSF(0.54120), IPSF(0.75066), IPSF(0.70711), IPSF(0.63638), IPSF(0.54120), IPSF(0.42522), IPSF(0.29290), IPSF(0.14932),
+    IPSF(0.27590), IPSF(0.38268), IPSF(0.36048), IPSF(0.32442), IPSF(0.27590), IPSF(0.21678), IPSF(0.14932), IPSF(0.07612)
+};
+#undef IPSF
+
+// IDCT 旋转系数（放大 2^12）
+#define M13 ((int32_t)(1.41421 * 4096))
+#define M2  ((int32_t)(1.08239 * 4096))
+#define M4  ((int32_t)(2.61313 * 4096))
+#define M5  ((int32_t)(1.84776 * 4096))
+
+// 色彩转换系数（CVACC = 1024）
+#define CV_R_CR     ((int)(1.402 * 1024))
+#define CV_G_CB     ((int)(0.344 * 1024))
+#define CV_G_CR     ((int)(0.714 * 1024))
+#define CV_B_CB     ((int)(1.772 * 1024))
+
+// 限幅查表：覆盖 [-CLIP_OFFSET, 767]，超出部分走比较分支
+#define CLIP_OFFSET 512
+static uint8_t clipTable[CLIP_OFFSET + 256 + 512];
+static bool clipReady = false;
+
+static void initClipTable() {
+    for (int i = 0; i < (int)sizeof(clipTable); i++) {
+        int v = i - CLIP_OFFSET;
+        clipTable[i] = (v < 0) ? 0 : (v > 255) ? 255 : (uint8_t)v;
+    }
+    clipReady = true;
+}
+
+static inline uint8_t clip8(int v) {
+    if ((unsigned)(v + CLIP_OFFSET) < sizeof(clipTable)) {
+        return clipTable[v + CLIP_OFFSET];
+    }
+    return (v < 0) ? 0 : 255;
+}
+
+// ============================================================
+// 反量化表
+// ============================================================
+
+void JpegKernel_BuildQuantTable(const uint8_t* zigzagQ, int32_t* table) {
+    if (!clipReady) {
+        initClipTable();    // 每张图都会先解析 DQT，顺便建好限幅表
+    }
+    for (int i = 0; i < 64; i++) {
+        uint8_t zi = JpegKernel_Zigzag[i];
+        table[zi] = (int32_t)((uint32_t)zigzagQ[i] * Ipsf[zi]);
+    }
+}
+
+// ============================================================
+// IDCT（AAN，先列后行）
+// ============================================================
+
+void JpegKernel_IDCT(int32_t* src, int16_t* dst, uint8_t colMask) {
+    int32_t v0, v1, v2, v3, v4, v5, v6, v7;
+    int32_t t10, t11, t12, t13;
+
+    // 列变换：全零列变换后仍为零，跳过
+    for (int i = 0; i < 8; i++) {
+        int32_t* s = src + i;
+        if (!(colMask & (1 << i))) {
+            continue;
+        }
+
+        v0 = s[8 * 0];
+        v1 = s[8 * 2];
+        v2 = s[8 * 4];
+        v3 = s[8 * 6];
+
+        t10 = v0 + v2;
+        t12 = v0 - v2;
+        t11 = (v1 - v3) * M13 >> 12;
+        v3 += v1;
+        t11 -= v3;
+        v0 = t10 + v3;
+        v3 = t10 - v3;
+        v1 = t11 + t12;
+        v2 = t12 - t11;
+
+        v4 = s[8 * 7];
+        v5 = s[8 * 1];
+        v6 = s[8 * 5];
+        v7 = s[8 * 3];
+
+        t10 = v5 - v4;
+        t11 = v5 + v4;
+        t12 = v6 - v7;
+        v7 += v6;
+        v5 = (t11 - v7) * M13 >> 12;
+        v7 += t11;
+        t13 = (t10 + t12) * M5 >> 12;
+        v4 = t13 - (t10 * M2 >> 12);
+        v6 = t13 - (t12 * M4 >> 12) - v7;
+        v5 -= v6;
+        v4 -= v5;
+
+        s[8 * 0] = v0 + v7;
+        s[8 * 7] = v0 - v7;
+        s[8 * 1] = v1 + v6;
+        s[8 * 6] = v1 - v6;
+        s[8 * 2] = v2 + v5;
+        s[8 * 5] = v2 - v5;
+        s[8 * 3] = v3 + v4;
+        s[8 * 4] = v3 - v4;
+    }
+
+    // 行变换：只有第 0 列非零时每行都是常数
+    for (int i = 0; i < 8; i++, src += 8, dst += 8) {
+        if (colMask == 0x01) {
+            int16_t d = (int16_t)((src[0] + (128L << 8)) >> 8);
+            for (int k = 0; k < 8; k++) {
+                dst[k] = d;
+            }
+            continue;
+        }
+
+        v0 = src[0] + (128L << 8);      // 在这里加回 128 电平偏移
+        v1 = src[2];
+        v2 = src[4];
+        v3 = src[6];
+
+        t10 = v0 + v2;
+        t12 = v0 - v2;
+        t11 = (v1 - v3) * M13 >> 12;
+        v3 += v1;
+        t11 -= v3;
+        v0 = t10 + v3;
+        v3 = t10 - v3;
+        v1 = t11 + t12;
+        v2 = t12 - t11;
+
+        v4 = src[7];
+        v5 = src[1];
+        v6 = src[5];
+        v7 = src[3];
+
+        t10 = v5 - v4;
+        t11 = v5 + v4;
+        t12 = v6 - v7;
+        v7 += v6;
+        v5 = (t11 - v7) * M13 >> 12;
+        v7 += t11;
+        t13 = (t10 + t12) * M5 >> 12;
+        v4 = t13 - (t10 * M2 >> 12);
+        v6 = t13 - (t12 * M4 >> 12) - v7;
+        v5 -= v6;
+        v4 -= v5;
+
+        dst[0] = (int16_t)((v0 + v7) >> 8);
+        dst[7] = (int16_t)((v0 - v7) >> 8);
+        dst[1] = (int16_t)((v1 + v6) >> 8);
+        dst[6] = (int16_t)((v1 - v6) >> 8);
+        dst[2] = (int16_t)((v2 + v5) >> 8);
+        dst[5] = (int16_t)((v2 - v5) >> 8);
+        dst[3] = (int16_t)((v3 + v4) >> 8);
+        dst[4] = (int16_t)((v3 - v4) >> 8);
+    }
+}
+
+void JpegKernel_FillDC(int32_t dc, int16_t* out) {
+    // 注意是截断除法（向零取整），与列/行变换的算术右移结果不同
+    int16_t d = (int16_t)(dc / 256 + 128);
+    for (int i = 0; i < 64; i++) {
+        out[i] = d;
+    }
+}
+
+// ============================================================
+// 色彩转换
+// ============================================================
+
+void JpegKernel_YCCPixel(int yy, int cb, int cr, uint8_t* rgb) {
+    rgb[0] = clip8(yy + (CV_R_CR * cr) / 1024);
+    rgb[1] = clip8(yy - (CV_G_CB * cb + CV_G_CR * cr) / 1024);
+    rgb[2] = clip8(yy + (CV_B_CB * cb) / 1024);
+}
+
+void JpegKernel_YCCToRGB565(const int16_t* y, const int16_t* cb, const int16_t* cr,
+                            uint16_t* dst, int n, int hShift) {
+    // 色度共享的两个像素一起算，色度项只算一次
+    if (hShift == 1) {
+        int i = 0;
+        for (; i + 1 < n; i += 2) {
+            int vb = *cb++ - 128;
+            int vr = *cr++ - 128;
+            int dr = (CV_R_CR * vr) / 1024;
+            int dg = (CV_G_CB * vb + CV_G_CR * vr) / 1024;
+            int db = (CV_B_CB * vb) / 1024;
+            int y0 = y[i];
+            int y1 = y[i + 1];
+            dst[i] = JpegKernel_Pack565(clip8(y0 + dr), clip8(y0 - dg), clip8(y0 + db));
+            dst[i + 1] = JpegKernel_Pack565(clip8(y1 + dr), clip8(y1 - dg), clip8(y1 + db));
+        }
+        if (i < n) {
+            int vb = *cb - 128;
+            int vr = *cr - 128;
+            int yy = y[i];
+            dst[i] = JpegKernel_Pack565(clip8(yy + (CV_R_CR * vr) / 1024),
+                                        clip8(yy - (CV_G_CB * vb + CV_G_CR * vr) / 1024),
+                                        clip8(yy + (CV_B_CB * vb) / 1024));
+        }
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int vb = cb[i] - 128;
+        int vr = cr[i] - 128;
+        int yy = y[i];
+        dst[i] = JpegKernel_Pack565(clip8(yy + (CV_R_CR * vr) / 1024),
+                                    clip8(yy - (CV_G_CB * vb + CV_G_CR * vr) / 1024),
+                                    clip8(yy + (CV_B_CB * vb) / 1024));
+    }
+}
+
+void JpegKernel_YCCToRGB888(const int16_t* y, const int16_t* cb, const int16_t* cr,
+                            uint8_t* dst, int n, int hShift) {
+    int step = 1 << hShift;
+    for (int i = 0; i < n; i += step) {
+        int c = i >> hShift;
+        int vb = cb[c] - 128;
+        int vr = cr[c] - 128;
+        int dr = (CV_R_CR * vr) / 1024;
+        int dg = (CV_G_CB * vb + CV_G_CR * vr) / 1024;
+        int db = (CV_B_CB * vb) / 1024;
+
+        for (int k = 0; k < step && i + k < n; k++) {
+            int yy = y[i + k];
+            *dst++ = clip8(yy + dr);
+            *dst++ = clip8(yy - dg);
+            *dst++ = clip8(yy + db);
+        }
+    }
+}
+
+void JpegKernel_GrayToRGB565(const int16_t* y, uint16_t* dst, int n) {
+    for (int i = 0; i < n; i++) {
+        uint8_t v = clip8(y[i]);
+        dst[i] = JpegKernel_Pack565(v, v, v);
+    }
+}
+
+void JpegKernel_GrayToRGB888(const int16_t* y, uint8_t* dst, int n) {
+    for (int i = 0; i < n; i++) {
+        uint8_t v = clip8(y[i]);
+        *dst++ = v;
+        *dst++ = v;
+        *dst++ = v;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// JPEG 计算内核（反量化表、IDCT、YCbCr→RGB 转换）
+// 不依赖 Arduino，可在 x86 Linux 上直接编译，便于与 TJpgDec 逐像素对比。
+// 数学上与 TJpgDec（tjpgd R0.03，JD_FASTDECODE ≥ 1）一致：
+//   - AAN IDCT，反量化表预乘 Arai 比例因子
+//   - CVACC = 1024 的整数色彩转换
+// 只有溢出限幅不同：tjpgd 的 JD_TBLCLIP 查表在 |v| ≥ 512 时会回绕，这里是真正的饱和。
+//
+// 热点全部集中在这几个函数，替换成 PIE 向量实现时解码器本身不用改。
+// ============================================================
+
+/**
+ * @brief 由 DQT 段生成反量化表（之字形顺序 → 光栅顺序，并预乘 Arai 比例因子）
+ * @param zigzagQ DQT 中的 64 个 8-bit 量化值
+ * @param table   输出 64 个 int32
+ */
+void JpegKernel_BuildQuantTable(const uint8_t* zigzagQ, int32_t* table);
+
+/**
+ * @brief 之字形下标 → 光栅下标
+ */
+extern const uint8_t JpegKernel_Zigzag[64];
+
+/**
+ * @brief 8×8 IDCT
+ * @param coef   反量化后的系数（光栅顺序，计算时会被改写）
+ * @param out    输出 64 个样本（已加 128 电平偏移，未限幅）
+ * @param colMask 第 i 位为 1 表示第 i 列有非零系数；全零列的列变换结果仍为零，可直接跳过
+ */
+void JpegKernel_IDCT(int32_t* coef, int16_t* out, uint8_t colMask);
+
+/**
+ * @brief 只有 DC 系数的块：整块填充同一个值（与 tjpgd 的 DC 捷径一致）
+ */
+void JpegKernel_FillDC(int32_t dc, int16_t* out);
+
+/**
+ * @brief 一行 YCbCr → RGB565
+ * @param y      亮度样本
+ * @param cb     蓝色差样本
+ * @param cr     红色差样本
+ * @param dst    输出像素
+ * @param n      像素数
+ * @param hShift 色度水平下采样位移（0: 4:4:4，1: 4:2:x）
+ */
+void JpegKernel_YCCToRGB565(const int16_t* y, const int16_t* cb, const int16_t* cr,
+                            uint16_t* dst, int n, int hShift);
+
+/**
+ * @brief 一行 YCbCr → RGB888（缩放平均前的中间格式）
+ */
+void JpegKernel_YCCToRGB888(const int16_t* y, const int16_t* cb, const int16_t* cr,
+                            uint8_t* dst, int n, int hShift);
+
+/**
+ * @brief 灰度 → RGB565 / RGB888
+ */
+void JpegKernel_GrayToRGB565(const int16_t* y, uint16_t* dst, int n);
+void JpegKernel_GrayToRGB888(const int16_t* y, uint8_t* dst, int n);
+
+/**
+ * @brief 单个像素 YCbCr → RGB888（1/8 缩放的 DC 路径使用）
+ */
+void JpegKernel_YCCPixel(int yy, int cb, int cr, uint8_t* rgb);
+
+/**
+ * @brief RGB888 → RGB565
+ */
+static inline uint16_t JpegKernel_Pack565(uint8_t r, uint8_t g, uint8_t b) {
+    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
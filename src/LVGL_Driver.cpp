@@ -7,11 +7,16 @@
 #include "LVGL_Driver.h"
 
 static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf1[ LVGL_BUF_LEN ];
-static lv_color_t buf2[ LVGL_BUF_LEN ];
-// static lv_color_t* buf1 = (lv_color_t*) heap_caps_malloc(LVGL_BUF_LEN, MALLOC_CAP_SPIRAM);
-// static lv_color_t* buf2 = (lv_color_t*) heap_caps_malloc(LVGL_BUF_LEN, MALLOC_CAP_SPIRAM);
-    
+static lv_color_t* buf1 = NULL;
+static lv_color_t* buf2 = NULL;
+static lv_disp_drv_t disp_drv;
+static bool flushAsync = LVGL_FLUSH_ASYNC;
+static SemaphoreHandle_t flushDoneSem = NULL;   // 每次 flush 完成时释放，wait_cb 在上面等待
+static uint32_t flushWaitUs = 0;                // wait_cb 中阻塞的累计时间
+static uint32_t refreshCount = 0;               // monitor_cb：完成的刷新次数
+static uint32_t refreshPixels = 0;              // monitor_cb：渲染的像素数
+static LvglBenchResult lastBench = { false };
+static LvglFpsResult lastFps = { false };
 
 
 /* Serial debugging */
@@ -24,12 +29,39 @@ void Lvgl_print(const char * buf)
 /*  Display flushing 
     Displays LVGL content on the LCD
     This function implements associating LVGL data to the LCD screen
+    局部刷新：LVGL 只重绘失效区域，flush 把这块区域交给 DMA 后立即返回，
+    LVGL 在另一块缓冲区中继续渲染；传输完成时在中断中调用 lv_disp_flush_ready
+    （两者都在 IRAM，见 lv_conf.h 的 LV_ATTRIBUTE_FLUSH_READY；disp_drv / draw_buf 是内部 RAM 中的静态变量）
 */
+static void IRAM_ATTR Lvgl_FlushDone(void *arg)
+{
+  lv_disp_flush_ready((lv_disp_drv_t *)arg);
+}
+
 void Lvgl_Display_LCD( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p )
 {
+  if (flushAsync) {
+    LCD_addWindow_Callback(area->x1, area->y1, area->x2, area->y2, ( uint16_t *)&color_p->full,
+                           Lvgl_FlushDone, disp_drv, flushDoneSem);
+    return;
+  }
   LCD_addWindow(area->x1, area->y1, area->x2, area->y2, ( uint16_t *)&color_p->full);
   lv_disp_flush_ready( disp_drv );
 }
+
+/*  两块缓冲区都在发送时 LVGL 反复调用 wait_cb：阻塞在信号量上让出 CPU，而不是空转 */
+static void Lvgl_WaitFlush( lv_disp_drv_t *disp_drv )
+{
+  uint32_t t0 = micros();
+  xSemaphoreTake(flushDoneSem, pdMS_TO_TICKS(10));
+  flushWaitUs += micros() - t0;
+}
+
+static void Lvgl_Monitor( lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px )
+{
+  refreshCount++;
+  refreshPixels += px;
+}
 /*Read the touchpad*/
 void Lvgl_Touchpad_Read( lv_indev_drv_t * indev_drv, lv_indev_data_t * data )
 {
@@ -50,19 +82,42 @@ void example_increase_lvgl_tick(void *arg)
     /* Tell LVGL how many milliseconds has elapsed */
     lv_tick_inc(EXAMPLE_LVGL_TICK_PERIOD_MS);
 }
+/*  绘制缓冲区放在内部 DMA 内存（DMA 直接读取）；内部 RAM 不足时放到 PSRAM（写屏经中转缓冲区） */
+static lv_color_t* Lvgl_AllocBuf(void)
+{
+  size_t bytes = LVGL_BUF_LEN * sizeof(lv_color_t);
+  lv_color_t* buf = (lv_color_t*)heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  if (buf == NULL) {
+    printf("LVGL: internal DMA buffer allocation failed, using PSRAM\r\n");
+    buf = (lv_color_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+  }
+  return buf;
+}
+
 void Lvgl_Init(void)
 {
   lv_init();
+  buf1 = Lvgl_AllocBuf();
+  buf2 = Lvgl_AllocBuf();
+  if (buf1 == NULL) {
+    printf("LVGL: draw buffer allocation failed\r\n");
+    return;
+  }
+  if (buf2 == NULL) {
+    printf("LVGL: second draw buffer allocation failed, single buffering\r\n");
+  }
   lv_disp_draw_buf_init( &draw_buf, buf1, buf2, LVGL_BUF_LEN);
+  flushDoneSem = xSemaphoreCreateBinary();
 
   /*Initialize the display*/
-  static lv_disp_drv_t disp_drv;
   lv_disp_drv_init( &disp_drv );
   /*Change the following line to your display resolution*/
   disp_drv.hor_res = LVGL_WIDTH;
   disp_drv.ver_res = LVGL_HEIGHT;
   disp_drv.flush_cb = Lvgl_Display_LCD;
-  disp_drv.full_refresh = 1;                    /**< 1: Always make the whole screen redrawn*/
+  disp_drv.wait_cb = Lvgl_WaitFlush;
+  disp_drv.monitor_cb = Lvgl_Monitor;
+  disp_drv.full_refresh = 0;                    /**< 局部刷新：整屏重绘需要整屏大小的缓冲区*/
   disp_drv.draw_buf = &draw_buf;
   lv_disp_drv_register( &disp_drv );
 
@@ -91,3 +146,145 @@ void Lvgl_Loop(void)
 {
   lv_timer_handler(); /* let the GUI do its work */
 }
+
+/*  刷新测试
+    full 为 true 时每次调用前使整个屏幕失效（相当于整屏刷新），否则只刷新失效区域。
+    CPU 占用 = lv_timer_handler 中除等待 DMA 以外的时间 / 总时间
+*/
+static void Lvgl_BenchMode( bool full, uint32_t durationMs, LvglBenchMode *m )
+{
+  // 上一种模式的最后一次 flush 可能还在发送
+  while (draw_buf.flushing) {
+    Lvgl_WaitFlush(&disp_drv);
+  }
+  lv_obj_invalidate(lv_scr_act());
+  lv_refr_now(NULL);
+  while (draw_buf.flushing) {
+    Lvgl_WaitFlush(&disp_drv);
+  }
+
+  LCD_TransferStats lcd0, lcd1;
+  LCD_GetTransferStats(&lcd0);
+  uint32_t refresh0 = refreshCount;
+  uint32_t pixels0 = refreshPixels;
+  uint32_t busyUs = 0;
+  flushWaitUs = 0;
+
+  uint32_t start = millis();
+  uint32_t t0 = micros();
+  while (millis() - start < durationMs) {
+    if (full) {
+      lv_obj_invalidate(lv_scr_act());
+    }
+    uint32_t h0 = micros();
+    lv_timer_handler();
+    busyUs += micros() - h0;
+    vTaskDelay(1);
+  }
+  while (draw_buf.flushing) {
+    Lvgl_WaitFlush(&disp_drv);
+  }
+  uint32_t elapsedUs = micros() - t0;
+  LCD_GetTransferStats(&lcd1);
+
+  m->refreshes = refreshCount - refresh0;
+  m->pixels = refreshPixels - pixels0;
+  m->spiBytes = lcd1.bytes - lcd0.bytes;
+  m->bytesPerSec = elapsedUs > 0 ? (float)m->spiBytes * 1000000.0f / elapsedUs : 0.0f;
+  uint32_t cpuUs = busyUs > flushWaitUs ? busyUs - flushWaitUs : 0;
+  m->cpuPercent = elapsedUs > 0 ? cpuUs * 100.0f / elapsedUs : 0.0f;
+}
+
+bool Lvgl_Benchmark( uint32_t durationMs, LvglBenchResult *result )
+{
+  // LVGL 按方向 0 绘制
+  LCD_SetOrientation(0);
+
+  LvglBenchResult r = {};
+  r.durationMs = durationMs;
+  Lvgl_BenchMode(true, durationMs, &r.full);
+  Lvgl_BenchMode(false, durationMs, &r.partial);
+  r.valid = true;
+
+  printf("LVGL bench (%lu ms each, backend %s):\r\n", (unsigned long)durationMs, LCD_BackendName());
+  printf("  full   : %lu refreshes, %lu px, %.1f KB/s SPI, CPU %.1f%%\r\n", (unsigned long)r.full.refreshes,
+         (unsigned long)r.full.pixels, r.full.bytesPerSec / 1024, r.full.cpuPercent);
+  printf("  partial: %lu refreshes, %lu px, %.1f KB/s SPI, CPU %.1f%%\r\n", (unsigned long)r.partial.refreshes,
+         (unsigned long)r.partial.pixels, r.partial.bytesPerSec / 1024, r.partial.cpuPercent);
+
+  lastBench = r;
+  if (result != NULL) {
+    *result = r;
+  }
+  return true;
+}
+
+bool Lvgl_GetLastBenchmark( LvglBenchResult *result )
+{
+  if (result != NULL) {
+    *result = lastBench;
+  }
+  return lastBench.valid;
+}
+
+void Lvgl_SetFlushAsync( bool async )
+{
+  while (draw_buf.flushing) {
+    Lvgl_WaitFlush(&disp_drv);
+  }
+  flushAsync = async;
+}
+
+/*  帧率测试：每帧使整个屏幕失效后立即重绘（不等刷新周期），渲染与写屏都跑满 */
+static float Lvgl_FpsRun( bool async, uint32_t durationMs, uint32_t *frames )
+{
+  bool saved = flushAsync;
+  Lvgl_SetFlushAsync(async);
+
+  uint32_t n = 0;
+  uint32_t start = millis();
+  uint32_t t0 = micros();
+  while (millis() - start < durationMs) {
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    n++;
+  }
+  while (draw_buf.flushing) {
+    Lvgl_WaitFlush(&disp_drv);
+  }
+  uint32_t elapsedUs = micros() - t0;
+
+  Lvgl_SetFlushAsync(saved);
+  *frames = n;
+  return elapsedUs > 0 ? n * 1000000.0f / elapsedUs : 0.0f;
+}
+
+bool Lvgl_MeasureFps( uint32_t durationMs, LvglFpsResult *result )
+{
+  LCD_SetOrientation(0);
+
+  LvglFpsResult r = {};
+  r.durationMs = durationMs;
+  r.bufLines = LVGL_BUF_LINES;
+  r.buffers = buf2 != NULL ? 2 : 1;
+  r.syncFps = Lvgl_FpsRun(false, durationMs, &r.syncFrames);
+  r.asyncFps = Lvgl_FpsRun(true, durationMs, &r.asyncFrames);
+  r.valid = true;
+
+  printf("LVGL fps (%u x %u-line buffers): sync flush %.1f, async flush %.1f\r\n",
+         r.buffers, r.bufLines, r.syncFps, r.asyncFps);
+
+  lastFps = r;
+  if (result != NULL) {
+    *result = r;
+  }
+  return true;
+}
+
+bool Lvgl_GetLastFps( LvglFpsResult *result )
+{
+  if (result != NULL) {
+    *result = lastFps;
+  }
+  return lastFps.valid;
+}
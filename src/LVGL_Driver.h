@@ -9,10 +9,28 @@
 
 #define LVGL_WIDTH     LCD_WIDTH
 #define LVGL_HEIGHT    LCD_HEIGHT
-#define LVGL_BUF_LEN  (LVGL_WIDTH * LVGL_HEIGHT / 20)
+#define LVGL_BUF_LINES 32                          // 每块绘制缓冲区的行数（两块，内部 DMA 内存）
+#define LVGL_BUF_LEN  (LVGL_WIDTH * LVGL_BUF_LINES)
+#define LVGL_FLUSH_ASYNC 1                          // 1: flush 交给 DMA 后立即返回，完成中断中通知 LVGL
 
 #define EXAMPLE_LVGL_TICK_PERIOD_MS  2
 
+// 刷新测试：同一界面分别按整屏重绘和局部刷新运行 durationMs，比较 SPI 字节率与 CPU 占用
+typedef struct {
+  uint32_t refreshes;       // 完成的刷新次数
+  uint32_t pixels;          // 渲染的像素数
+  uint32_t spiBytes;        // 写屏字节数
+  float bytesPerSec;
+  float cpuPercent;         // lv_timer_handler 中除等待 DMA 以外的时间占比
+} LvglBenchMode;
+
+typedef struct {
+  bool valid;
+  uint32_t durationMs;
+  LvglBenchMode full;
+  LvglBenchMode partial;
+} LvglBenchResult;
+
 
 void Lvgl_print(const char * buf);
 void Lvgl_Display_LCD( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p ); // Displays LVGL content on the LCD.    This function implements associating LVGL data to the LCD screen
@@ -21,3 +39,21 @@ void example_increase_lvgl_tick(void *arg);
 
 void Lvgl_Init(void);
 void Lvgl_Loop(void);
+bool Lvgl_Benchmark( uint32_t durationMs, LvglBenchResult *result );   // 在当前界面上测试（会改写屏幕），结果打印到串口
+bool Lvgl_GetLastBenchmark( LvglBenchResult *result );
+
+// 帧率测试：当前界面每帧整屏重绘，分别用同步 flush（发送完才通知 LVGL）和异步 flush 各跑 durationMs
+typedef struct {
+  bool valid;
+  uint32_t durationMs;
+  uint16_t bufLines;
+  uint8_t buffers;
+  uint32_t syncFrames;
+  uint32_t asyncFrames;
+  float syncFps;
+  float asyncFps;
+} LvglFpsResult;
+
+void Lvgl_SetFlushAsync( bool async );
+bool Lvgl_MeasureFps( uint32_t durationMs, LvglFpsResult *result );      // 结果打印到串口
+bool Lvgl_GetLastFps( LvglFpsResult *result );
@@ -140,13 +140,24 @@ void Lvgl_Example1(void){
   // color_changer_create(tv);
 }
 
+void Lvgl_Example1_SelectPage(uint32_t page)
+{
+  lv_tabview_set_act(tv, page, LV_ANIM_OFF);
+}
+
 void Lvgl_Example1_close(void)
 {
   /*Delete all animation*/
   lv_anim_del(NULL, NULL);
 
-  lv_timer_del(meter2_timer);
-  meter2_timer = NULL;
+  if (meter2_timer != NULL) {
+    lv_timer_del(meter2_timer);
+    meter2_timer = NULL;
+  }
+  if (auto_step_timer != NULL) {
+    lv_timer_del(auto_step_timer);
+    auto_step_timer = NULL;
+  }
 
   lv_obj_clean(lv_scr_act());
 
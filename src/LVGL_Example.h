@@ -18,4 +18,6 @@ extern size_t Simulated_panel1_Size;
 void Backlight_adjustment_event_cb(lv_event_t * e);
 
 void Lvgl_Example1(void);
+void Lvgl_Example1_close(void);
+void Lvgl_Example1_SelectPage(uint32_t page);     // 0: Onboard，1: music
 void LVGL_Backlight_adjustment(uint8_t Backlight);
@@ -0,0 +1,138 @@
+#include "Log_Ring.h"
+#include <esp_heap_caps.h>
+#include <stdarg.h>
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS 必须是 2 的幂");
+
+volatile uint8_t g_logLevel = LOG_LEVEL_DEFAULT;
+
+// ============================================================
+// 环形缓冲区
+//   head：下一个要预留的序号（生产者 CAS 递增）
+//   tail：下一个要输出的序号（只由输出任务写）
+//   槽位 ready 置 1 后才可输出，输出后清 0 再推进 tail；
+//   生产者只在 head − tail < LOG_RING_SLOTS 时预留，因此不会写到尚未输出的槽位
+// ============================================================
+typedef struct {
+    volatile uint32_t ready;
+    char text[LOG_LINE_MAX];
+} LogSlot;
+
+static LogSlot* slots = nullptr;
+static uint32_t head = 0;
+static uint32_t tail = 0;
+static LogStats stats = { 0, 0, 0 };
+
+static void LogTask(void *parameter) {
+    uint32_t reportedDrops = 0;
+    while (1) {
+        LogSlot* s = &slots[tail & (LOG_RING_SLOTS - 1)];
+        if (!__atomic_load_n(&s->ready, __ATOMIC_ACQUIRE)) {
+            uint32_t drops = __atomic_load_n(&stats.dropped, __ATOMIC_RELAXED);
+            if (drops != reportedDrops) {
+                Serial.printf("⚠️ 日志缓冲区已满，丢弃 %lu 行\n", (unsigned long)(drops - reportedDrops));
+                reportedDrops = drops;
+            }
+            vTaskDelay(pdMS_TO_TICKS(LOG_IDLE_MS));
+            continue;
+        }
+
+        Serial.print(s->text);
+        stats.written++;
+        __atomic_store_n(&s->ready, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&tail, tail + 1, __ATOMIC_RELEASE);
+    }
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+bool Log_Init(void) {
+    if (slots != nullptr) {
+        return true;
+    }
+    size_t bytes = sizeof(LogSlot) * LOG_RING_SLOTS;
+    LogSlot* buf = (LogSlot*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (buf == nullptr) {
+        buf = (LogSlot*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    }
+    if (buf == nullptr) {
+        Serial.println("✗ 日志缓冲区分配失败，日志直接写串口");
+        return false;
+    }
+    memset(buf, 0, bytes);
+
+    TaskHandle_t task = NULL;
+    slots = buf;
+    xTaskCreatePinnedToCore(LogTask, "Log", LOG_TASK_STACK, NULL, LOG_TASK_PRIO, &task, LOG_TASK_CORE);
+    if (task == NULL) {
+        slots = nullptr;
+        free(buf);
+        Serial.println("✗ 日志任务创建失败，日志直接写串口");
+        return false;
+    }
+    return true;
+}
+
+void Log_Write(uint8_t level, const char* fmt, ...) {
+    va_list ap;
+    if (slots == nullptr) {
+        char line[LOG_LINE_MAX];
+        va_start(ap, fmt);
+        vsnprintf(line, sizeof(line), fmt, ap);
+        va_end(ap);
+        Serial.print(line);
+        return;
+    }
+
+    // 预留一个槽位；缓冲区满时丢弃，不等待输出任务
+    uint32_t seq = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    do {
+        if (seq - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) >= LOG_RING_SLOTS) {
+            __atomic_fetch_add(&stats.dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&head, &seq, seq + 1, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    LogSlot* s = &slots[seq & (LOG_RING_SLOTS - 1)];
+    va_start(ap, fmt);
+    int n = vsnprintf(s->text, LOG_LINE_MAX, fmt, ap);
+    va_end(ap);
+    if (n >= LOG_LINE_MAX) {
+        // 截断的行保留换行，不和下一行粘在一起
+        s->text[LOG_LINE_MAX - 2] = '\n';
+        __atomic_fetch_add(&stats.truncated, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&s->ready, 1, __ATOMIC_RELEASE);
+}
+
+void Log_SetLevel(uint8_t level) {
+    g_logLevel = level > LOG_LEVEL_DEBUG ? LOG_LEVEL_DEBUG : level;
+}
+
+uint8_t Log_GetLevel(void) {
+    return g_logLevel;
+}
+
+static const char* const levelNames[] = { "none", "error", "warn", "info", "debug" };
+
+const char* Log_LevelName(uint8_t level) {
+    return level <= LOG_LEVEL_DEBUG ? levelNames[level] : "unknown";
+}
+
+bool Log_ParseLevel(const char* name, uint8_t* level) {
+    for (uint8_t i = 0; i <= LOG_LEVEL_DEBUG; i++) {
+        if (strcasecmp(name, levelNames[i]) == 0) {
+            *level = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Log_GetStats(LogStats* out) {
+    if (out != nullptr) {
+        *out = stats;
+    }
+}
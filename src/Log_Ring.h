@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================
+// 分级日志（环形缓冲区 + 后台输出任务）
+// - 编译期：级别高于 LOG_LEVEL_COMPILE 的 LOG_x 宏展开为空语句，参数不求值，不占代码空间
+// - 运行期：Log_SetLevel 进一步过滤（GET /loglevel）
+// - 调用方只把格式化好的一行放进环形缓冲区：CAS 预留槽位，不加锁、不等串口；
+//   后台任务按顺序写串口，串口阻塞不再落在解码 / 上传路径上
+// - 缓冲区满时丢弃新日志并计数（输出任务会补一行提示），调用方从不阻塞
+// Log_Init 之前直接写串口。未改用 LOG_x 的 Serial 输出不经过缓冲区，两者的先后顺序可能交错
+// ============================================================
+#define LOG_LEVEL_NONE      0
+#define LOG_LEVEL_ERROR     1
+#define LOG_LEVEL_WARN      2
+#define LOG_LEVEL_INFO      3
+#define LOG_LEVEL_DEBUG     4
+
+#ifndef LOG_LEVEL_COMPILE
+#define LOG_LEVEL_COMPILE   LOG_LEVEL_DEBUG     // 发布版本可在 build_flags 中 -DLOG_LEVEL_COMPILE=1
+#endif
+#define LOG_LEVEL_DEFAULT   LOG_LEVEL_INFO      // 启动时的运行期级别
+
+#define LOG_RING_SLOTS      64                  // 环形缓冲区行数（2 的幂）
+#define LOG_LINE_MAX        128                 // 每行最多字节数（含结尾 0，超出截断）
+#define LOG_TASK_CORE       0
+#define LOG_TASK_PRIO       1                   // 最低优先级：有空时才写串口
+#define LOG_TASK_STACK      3072
+#define LOG_IDLE_MS         20                  // 缓冲区为空时的轮询间隔
+
+extern volatile uint8_t g_logLevel;
+
+void Log_Write(uint8_t level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+#define LOG_AT(level, fmt, ...)                                     \
+    do {                                                            \
+        if ((level) <= LOG_LEVEL_COMPILE && (level) <= g_logLevel) { \
+            Log_Write((level), fmt, ##__VA_ARGS__);                 \
+        }                                                           \
+    } while (0)
+
+#define LOG_E(fmt, ...)     LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_W(fmt, ...)     LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_I(fmt, ...)     LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_D(fmt, ...)     LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+// 日志统计
+typedef struct {
+    uint32_t written;       // 已写到串口的行数
+    uint32_t dropped;       // 缓冲区满时丢弃的行数
+    uint32_t truncated;     // 超过 LOG_LINE_MAX 被截断的行数
+} LogStats;
+
+/**
+ * @brief 分配环形缓冲区并创建输出任务（setup 开头调用）
+ * @return false 内存不足（之后的日志直接写串口）
+ */
+bool Log_Init(void);
+
+void Log_SetLevel(uint8_t level);
+uint8_t Log_GetLevel(void);
+
+/**
+ * @brief 级别名称与解析（none / error / warn / info / debug）
+ */
+const char* Log_LevelName(uint8_t level);
+bool Log_ParseLevel(const char* name, uint8_t* level);
+
+void Log_GetStats(LogStats* stats);
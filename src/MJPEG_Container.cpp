@@ -0,0 +1,378 @@
+#include "MJPEG_Container.h"
+#include <string.h>
+
+// ============================================================
+// 输入
+// ============================================================
+
+static inline uint32_t le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief 从文件的 pos 处读取 n 字节（位置不连续时先定位）
+ */
+static bool readAt(MjpegContainer* c, uint32_t pos, uint8_t* buf, size_t n) {
+    if (c->filePos != pos) {
+        if (!c->seek(c->user, pos)) {
+            return false;
+        }
+        c->filePos = pos;
+    }
+    size_t got = 0;
+    while (got < n) {
+        size_t r = c->read(c->user, buf + got, n - got);
+        if (r == 0) {
+            break;
+        }
+        got += r;
+    }
+    c->filePos += got;
+    return got == n;
+}
+
+// ============================================================
+// AVI
+// ============================================================
+
+static bool isVideoChunk(const MjpegContainer* c, const uint8_t* id) {
+    return id[0] == c->videoStream[0] && id[1] == c->videoStream[1] &&
+           (memcmp(id + 2, "dc", 2) == 0 || memcmp(id + 2, "db", 2) == 0);
+}
+
+/**
+ * @brief 解析 LIST 'hdrl'：avih 给出帧间隔与尺寸，第一个 'vids' 流的 strh 给出更准确的帧率
+ */
+static void parseHdrl(MjpegContainer* c, uint32_t pos, uint32_t end) {
+    uint8_t h[56];
+    int streamNo = 0;
+    bool haveVideo = false;
+
+    while (pos + 8 <= end && readAt(c, pos, h, 8)) {
+        uint32_t size = le32(h + 4);
+        uint64_t next = (uint64_t)pos + 8 + size + (size & 1);
+
+        if (memcmp(h, "avih", 4) == 0 && size >= 40 && readAt(c, pos + 8, h, 40)) {
+            c->frameUs = le32(h);
+            c->totalFrames = le32(h + 16);
+            c->width = (uint16_t)le32(h + 32);
+            c->height = (uint16_t)le32(h + 36);
+        } else if (memcmp(h, "LIST", 4) == 0 && readAt(c, pos + 8, h, 4) && memcmp(h, "strl", 4) == 0) {
+            // strl 的第一个子块是 strh
+            if (readAt(c, pos + 12, h, 8) && memcmp(h, "strh", 4) == 0 && le32(h + 4) >= 32 &&
+                readAt(c, pos + 20, h, 32) && memcmp(h, "vids", 4) == 0 && !haveVideo) {
+                uint32_t scale = le32(h + 20);
+                uint32_t rate = le32(h + 24);
+                if (scale > 0 && rate > 0) {
+                    c->frameUs = (uint32_t)((uint64_t)scale * 1000000 / rate);
+                }
+                c->videoStream[0] = '0' + (streamNo / 10) % 10;
+                c->videoStream[1] = '0' + streamNo % 10;
+                haveVideo = true;
+            }
+            streamNo++;
+        }
+        if (next > end) {
+            break;
+        }
+        pos = (uint32_t)next;
+    }
+}
+
+static MjpegResult openAvi(MjpegContainer* c, uint32_t riffEnd) {
+    uint8_t h[12];
+    uint32_t pos = 12;
+
+    while (pos + 12 <= riffEnd && readAt(c, pos, h, 12)) {
+        uint32_t size = le32(h + 4);
+        if (memcmp(h, "LIST", 4) == 0) {
+            uint64_t listEnd = (uint64_t)pos + 8 + size;
+            uint32_t end = listEnd < riffEnd ? (uint32_t)listEnd : riffEnd;
+            if (memcmp(h + 8, "hdrl", 4) == 0) {
+                parseHdrl(c, pos + 12, end);
+            } else if (memcmp(h + 8, "movi", 4) == 0) {
+                c->moviStart = pos + 12;
+                c->moviEnd = end;
+                c->pos = c->moviStart;
+                return MJPEG_OK;
+            }
+        }
+        uint64_t next = (uint64_t)pos + 8 + size + (size & 1);
+        if (next > riffEnd) {
+            break;
+        }
+        pos = (uint32_t)next;
+    }
+    return MJPEG_ERR_FORMAT;
+}
+
+static MjpegResult readAviFrame(MjpegContainer* c, uint8_t* buf, size_t cap, size_t* len) {
+    uint8_t h[8];
+    while (c->pos + 8 <= c->moviEnd) {
+        if (!readAt(c, c->pos, h, 8)) {
+            return MJPEG_ERR_INPUT;
+        }
+        uint32_t size = le32(h + 4);
+        if (memcmp(h, "LIST", 4) == 0) {
+            c->pos += 12;               // LIST 'rec '：子块紧随其后，按顺序读即可
+            continue;
+        }
+        if ((uint64_t)c->pos + 8 + size > c->moviEnd) {
+            return MJPEG_DONE;          // 最后一个块不完整（录制被中断）
+        }
+        uint32_t next = c->pos + 8 + size + (size & 1);
+
+        if (isVideoChunk(c, h)) {
+            c->frameIndex++;
+            if (size > cap) {
+                c->pos = next;
+                return MJPEG_ERR_TOO_BIG;
+            }
+            if (size > 0 && !readAt(c, c->pos + 8, buf, size)) {
+                return MJPEG_ERR_INPUT;
+            }
+            *len = size;
+            c->pos = next;
+            return MJPEG_OK;
+        }
+        c->pos = next;                  // 音频、JUNK、ix## 等
+    }
+    return MJPEG_DONE;
+}
+
+// ============================================================
+// 裸 MJPEG
+// ============================================================
+
+// 输出位置：超出 cap 的部分只计数
+typedef struct {
+    uint8_t* buf;
+    size_t cap;
+    size_t len;
+} FrameOut;
+
+static inline void emit(FrameOut* o, uint8_t b) {
+    if (o->len < o->cap) {
+        o->buf[o->len] = b;
+    }
+    o->len++;
+}
+
+static void emitBytes(FrameOut* o, const uint8_t* p, size_t n) {
+    if (o->len < o->cap) {
+        size_t room = o->cap - o->len;
+        memcpy(o->buf + o->len, p, n < room ? n : room);
+    }
+    o->len += n;
+}
+
+static bool refill(MjpegContainer* c) {
+    if (c->scanEnd) {
+        return false;
+    }
+    size_t n = c->read(c->user, c->scan, MJPEG_SCAN_BUF_SIZE);
+    c->scanPos = 0;
+    c->scanLen = (uint16_t)n;
+    if (n == 0) {
+        c->scanEnd = true;
+        return false;
+    }
+    return true;
+}
+
+static inline int nextByte(MjpegContainer* c) {
+    if (c->scanPos >= c->scanLen && !refill(c)) {
+        return -1;
+    }
+    return c->scan[c->scanPos++];
+}
+
+static bool copyBytes(MjpegContainer* c, FrameOut* o, size_t n) {
+    while (n > 0) {
+        if (c->scanPos >= c->scanLen && !refill(c)) {
+            return false;
+        }
+        size_t chunk = c->scanLen - c->scanPos;
+        if (chunk > n) {
+            chunk = n;
+        }
+        emitBytes(o, c->scan + c->scanPos, chunk);
+        c->scanPos += chunk;
+        n -= chunk;
+    }
+    return true;
+}
+
+/**
+ * @brief 读取一个标记（跳过填充的 0xFF），输出 FF xx
+ * @return 标记码，-1 数据结束，-2 不是标记
+ */
+static int readMarker(MjpegContainer* c, FrameOut* o) {
+    int b = nextByte(c);
+    if (b != 0xFF) {
+        return b < 0 ? -1 : -2;
+    }
+    do {
+        b = nextByte(c);
+    } while (b == 0xFF);
+    if (b < 0) {
+        return -1;
+    }
+    emit(o, 0xFF);
+    emit(o, (uint8_t)b);
+    return b;
+}
+
+/**
+ * @brief 复制熵编码数据，直到遇到 RSTn 以外的标记
+ * @return 该标记码（已输出），-1 数据结束
+ */
+static int scanEntropy(MjpegContainer* c, FrameOut* o) {
+    while (true) {
+        if (c->scanPos >= c->scanLen && !refill(c)) {
+            return -1;
+        }
+        const uint8_t* p = c->scan + c->scanPos;
+        size_t avail = c->scanLen - c->scanPos;
+        const uint8_t* ff = (const uint8_t*)memchr(p, 0xFF, avail);
+        if (ff == nullptr) {
+            emitBytes(o, p, avail);
+            c->scanPos = c->scanLen;
+            continue;
+        }
+        emitBytes(o, p, ff - p + 1);
+        c->scanPos += (uint16_t)(ff - p + 1);
+
+        int n;
+        do {
+            n = nextByte(c);
+        } while (n == 0xFF);
+        if (n < 0) {
+            return -1;
+        }
+        emit(o, (uint8_t)n);
+        if (n != 0x00 && (n < 0xD0 || n > 0xD7)) {
+            return n;
+        }
+    }
+}
+
+static MjpegResult readRawFrame(MjpegContainer* c, uint8_t* buf, size_t cap, size_t* len) {
+    // 找 SOI（帧之间可能有填充）
+    int prev = -1;
+    while (true) {
+        int b = nextByte(c);
+        if (b < 0) {
+            return MJPEG_DONE;
+        }
+        if (prev == 0xFF && b == 0xD8) {
+            break;
+        }
+        prev = b;
+    }
+
+    FrameOut o = { buf, cap, 0 };
+    emit(&o, 0xFF);
+    emit(&o, 0xD8);
+
+    int m = readMarker(c, &o);
+    while (m != 0xD9) {
+        if (m == -1) {
+            return MJPEG_ERR_INPUT;
+        }
+        if (m == -2) {
+            return MJPEG_ERR_FORMAT;
+        }
+        if (m == 0x01 || (m >= 0xD0 && m <= 0xD7)) {
+            m = readMarker(c, &o);
+            continue;
+        }
+
+        // 带长度的标记段
+        int hi = nextByte(c);
+        int lo = nextByte(c);
+        if (lo < 0) {
+            return MJPEG_ERR_INPUT;
+        }
+        uint16_t segLen = (uint16_t)((hi << 8) | lo);
+        if (segLen < 2) {
+            return MJPEG_ERR_FORMAT;
+        }
+        emit(&o, (uint8_t)hi);
+        emit(&o, (uint8_t)lo);
+        if (!copyBytes(c, &o, segLen - 2)) {
+            return MJPEG_ERR_INPUT;
+        }
+        m = (m == 0xDA) ? scanEntropy(c, &o) : readMarker(c, &o);
+    }
+
+    c->frameIndex++;
+    if (o.len > cap) {
+        return MJPEG_ERR_TOO_BIG;
+    }
+    *len = o.len;
+    return MJPEG_OK;
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+MjpegResult MjpegContainer_Open(MjpegContainer* c, MjpegReadFunc read, MjpegSeekFunc seek, void* user,
+                                uint32_t fileSize) {
+    memset(c, 0, sizeof(*c));
+    c->read = read;
+    c->seek = seek;
+    c->user = user;
+    c->fileSize = fileSize;
+    c->videoStream[0] = '0';
+    c->videoStream[1] = '0';
+    c->filePos = 0xFFFFFFFF;
+
+    uint8_t h[12];
+    if (!readAt(c, 0, h, sizeof(h))) {
+        return MJPEG_ERR_INPUT;
+    }
+    if (memcmp(h, "RIFF", 4) == 0 && memcmp(h + 8, "AVI ", 4) == 0) {
+        c->type = MJPEG_CONTAINER_AVI;
+        uint32_t riffEnd = 8 + le32(h + 4);
+        return openAvi(c, riffEnd < fileSize ? riffEnd : fileSize);
+    }
+    if (h[0] == 0xFF && h[1] == 0xD8 && h[2] == 0xFF) {
+        c->type = MJPEG_CONTAINER_RAW;
+        return MjpegContainer_Rewind(c);
+    }
+    return MJPEG_ERR_FORMAT;
+}
+
+MjpegResult MjpegContainer_ReadFrame(MjpegContainer* c, uint8_t* buf, size_t cap, size_t* len) {
+    *len = 0;
+    return (c->type == MJPEG_CONTAINER_AVI) ? readAviFrame(c, buf, cap, len) : readRawFrame(c, buf, cap, len);
+}
+
+MjpegResult MjpegContainer_Rewind(MjpegContainer* c) {
+    c->frameIndex = 0;
+    if (c->type == MJPEG_CONTAINER_AVI) {
+        c->pos = c->moviStart;
+        return MJPEG_OK;
+    }
+    if (!c->seek(c->user, 0)) {
+        return MJPEG_ERR_INPUT;
+    }
+    c->filePos = 0;
+    c->scanPos = 0;
+    c->scanLen = 0;
+    c->scanEnd = false;
+    return MJPEG_OK;
+}
+
+const char* MjpegContainer_ResultName(MjpegResult r) {
+    switch (r) {
+        case MJPEG_OK:          return "成功";
+        case MJPEG_DONE:        return "已到结尾";
+        case MJPEG_ERR_FORMAT:  return "不是 AVI / MJPEG 或结构损坏";
+        case MJPEG_ERR_INPUT:   return "读取失败或数据不完整";
+        case MJPEG_ERR_TOO_BIG: return "帧超过缓冲区";
+        default:                return "未知错误";
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// MJPEG 片段容器：按顺序取出每一帧的 JPEG 数据
+// - AVI（RIFF 'AVI '）：从 avih / strh 读帧间隔和尺寸，顺序读取 movi 中视频流的 ##dc / ##db 块，
+//   音频、JUNK、索引等块直接跳过；LIST 'rec ' 展开处理。不支持 OpenDML（AVIX，超过 1 GB）
+// - 裸 MJPEG（.mjpeg / .mjpg，多个 JPEG 首尾相接）：按标记段解析每帧，熵编码数据中只找 EOI，
+//   不会被 EXIF 缩略图里的 FFD9 截断；没有帧率信息
+// 输入为读 / 定位回调，只需要一个帧大小的输出缓冲区。
+// 不依赖 Arduino，可直接在 x86 Linux 上编译。
+// ============================================================
+#define MJPEG_SCAN_BUF_SIZE     2048    // 裸 MJPEG 扫描缓冲区
+
+enum MjpegResult {
+    MJPEG_OK = 0,
+    MJPEG_DONE,             // 没有更多帧（MjpegContainer_Rewind 后可以重新读取）
+    MJPEG_ERR_FORMAT,       // 不是 AVI / MJPEG，或结构损坏
+    MJPEG_ERR_INPUT,        // 读取失败或数据提前结束
+    MJPEG_ERR_TOO_BIG       // 这一帧超过输出缓冲区（已跳过，可以继续读下一帧）
+};
+
+enum MjpegContainerType {
+    MJPEG_CONTAINER_RAW,
+    MJPEG_CONTAINER_AVI
+};
+
+/**
+ * @brief 读回调：最多读取 len 字节，返回实际读取数，0 表示结束（与 JpegReadFunc 相同）
+ */
+typedef size_t (*MjpegReadFunc)(void* user, uint8_t* buf, size_t len);
+
+/**
+ * @brief 定位回调：移动到文件中的绝对位置
+ */
+typedef bool (*MjpegSeekFunc)(void* user, uint32_t pos);
+
+typedef struct {
+    MjpegReadFunc read;
+    MjpegSeekFunc seek;
+    void* user;
+    uint32_t fileSize;
+
+    MjpegContainerType type;
+    uint32_t frameUs;           // 帧间隔（微秒），0 表示未知（裸 MJPEG）
+    uint16_t width, height;     // AVI 头中的尺寸（裸 MJPEG 为 0，以帧本身为准）
+    uint32_t totalFrames;       // AVI 头中的帧数（裸 MJPEG 为 0）
+    uint32_t frameIndex;        // 下一帧的序号
+
+    // AVI
+    uint32_t pos;               // 下一个块的文件位置
+    uint32_t filePos;           // 文件当前的读取位置（相同时不必定位）
+    uint32_t moviStart, moviEnd;
+    char videoStream[2];        // 视频流编号（"00"）
+
+    // 裸 MJPEG
+    uint8_t scan[MJPEG_SCAN_BUF_SIZE];
+    uint16_t scanPos, scanLen;
+    bool scanEnd;
+} MjpegContainer;
+
+/**
+ * @brief 识别格式并解析文件头（AVI 定位到 movi 的第一个块）
+ * @param fileSize 文件大小（AVI 用于检查块边界）
+ */
+MjpegResult MjpegContainer_Open(MjpegContainer* c, MjpegReadFunc read, MjpegSeekFunc seek, void* user,
+                                uint32_t fileSize);
+
+/**
+ * @brief 读取下一帧的 JPEG 数据
+ * @param len 实际字节数；AVI 中大小为 0 的帧（表示重复上一帧）返回 MJPEG_OK 且 len = 0
+ * @return MJPEG_DONE 已到结尾；MJPEG_ERR_TOO_BIG 这一帧放不下（已跳过）
+ */
+MjpegResult MjpegContainer_ReadFrame(MjpegContainer* c, uint8_t* buf, size_t cap, size_t* len);
+
+/**
+ * @brief 回到第一帧（循环播放）
+ */
+MjpegResult MjpegContainer_Rewind(MjpegContainer* c);
+
+const char* MjpegContainer_ResultName(MjpegResult r);
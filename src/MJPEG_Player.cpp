@@ -0,0 +1,538 @@
+#include "MJPEG_Player.h"
+#include "MJPEG_Container.h"
+#include "MJPEG_Scheduler.h"
+#include "JPEG_Codec.h"
+#include "Display_ST7789.h"
+#include "ColorTemp_Filter.h"
+#include "WebServer_Driver.h"
+#include "Image_Decoder.h"
+#include "Log_Ring.h"
+#include <FS.h>
+#include <SD_MMC.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+// ============================================================
+// 运行时状态
+// 读取任务只访问 container / file / slots 与两个队列；其余只在 loop 所在任务中访问
+// ============================================================
+
+#define MJPEG_SLOT_END  0xFF        // 读取任务发出的结束标记（读取失败）
+
+typedef struct {
+    uint8_t slot;
+    uint32_t len;
+} MjpegFrameItem;
+
+typedef struct {
+    bool active;
+    File file;
+    MjpegContainer* container;
+    uint8_t* slots[MJPEG_READ_SLOTS];
+
+    // 解码
+    JpegDecoder* dec;
+    ImageScaleMode mode;
+    uint16_t srcW, srcH;            // 当前几何设置对应的帧尺寸
+    uint8_t scale;                  // JPEG 解码缩放
+    ImageLayout layout;
+    bool scaling;
+    ImageScaler scaler;
+    uint16_t* frames[2];            // 解码缓冲区（viewW × viewH，PSRAM），轮流交给异步写屏
+    uint8_t next;                   // 下一帧解码到哪个缓冲区
+    uint16_t* target;               // 正在解码的缓冲区
+
+    MjpegScheduler sched;
+    uint64_t nextDueUs;             // Service 在此之前直接返回
+    uint64_t decodeUsTotal;
+    uint32_t decodes;
+} MjpegPlayer;
+
+static MjpegPlayer g_player = { false };
+static MjpegPlaybackStats g_stats = { false };
+
+static TaskHandle_t readerTask = nullptr;
+static SemaphoreHandle_t readerDone = nullptr;
+static QueueHandle_t freeQueue = nullptr;       // 空槽位序号
+static QueueHandle_t fullQueue = nullptr;       // MjpegFrameItem，按帧顺序
+static volatile bool readerStop = false;
+static volatile bool readerRunning = false;
+static volatile uint32_t readerLoops = 0;
+static volatile uint32_t readerOversize = 0;
+
+// ============================================================
+// 文件回调
+// ============================================================
+
+static size_t fileRead(void* user, uint8_t* buf, size_t len) {
+    return ((File*)user)->read(buf, len);
+}
+
+static bool fileSeek(void* user, uint32_t pos) {
+    return ((File*)user)->seek(pos);
+}
+
+// ============================================================
+// 读取任务
+// ============================================================
+
+static bool acquireSdCard() {
+    while (!readerStop) {
+        if (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(MJPEG_LOCK_WAIT_MS)) == pdTRUE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 读一帧；到结尾时回到开头继续（片段循环播放）
+ */
+static MjpegResult readNextFrame(MjpegContainer* c, uint8_t* buf, size_t* len) {
+    MjpegResult r = MjpegContainer_ReadFrame(c, buf, MJPEG_MAX_FRAME_BYTES, len);
+    if (r == MJPEG_DONE && c->frameIndex > 0) {
+        readerLoops++;
+        r = MjpegContainer_Rewind(c);
+        if (r == MJPEG_OK) {
+            r = MjpegContainer_ReadFrame(c, buf, MJPEG_MAX_FRAME_BYTES, len);
+        }
+    }
+    return r;
+}
+
+static void readClip() {
+    MjpegContainer* c = g_player.container;
+    uint8_t slot;
+
+    while (!readerStop) {
+        if (xQueueReceive(freeQueue, &slot, pdMS_TO_TICKS(MJPEG_LOCK_WAIT_MS)) != pdTRUE) {
+            continue;
+        }
+        if (!acquireSdCard()) {
+            break;
+        }
+        size_t len = 0;
+        MjpegResult r = readNextFrame(c, g_player.slots[slot], &len);
+        xSemaphoreGive(sdCardMutex);
+
+        if (r == MJPEG_ERR_TOO_BIG) {
+            readerOversize++;
+            xQueueSendToBack(freeQueue, &slot, 0);
+            continue;
+        }
+        MjpegFrameItem item = { slot, (uint32_t)len };
+        if (r != MJPEG_OK) {
+            LOG_E("✗ MJPEG 第 %lu 帧: %s\n", (unsigned long)c->frameIndex + 1, MjpegContainer_ResultName(r));
+            item.slot = MJPEG_SLOT_END;
+        }
+        xQueueSendToBack(fullQueue, &item, portMAX_DELAY);      // 槽位数与队列长度相同，不会阻塞
+        if (item.slot == MJPEG_SLOT_END) {
+            break;
+        }
+    }
+}
+
+static void ReaderTask(void* parameter) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        readClip();
+        xSemaphoreGive(readerDone);
+    }
+}
+
+void MjpegPlayer_Init(void) {
+    if (readerTask != nullptr) {
+        return;
+    }
+    readerDone = xSemaphoreCreateBinary();
+    freeQueue = xQueueCreate(MJPEG_READ_SLOTS, sizeof(uint8_t));
+    fullQueue = xQueueCreate(MJPEG_READ_SLOTS + 1, sizeof(MjpegFrameItem));
+    if (readerDone == nullptr || freeQueue == nullptr || fullQueue == nullptr || sdCardMutex == NULL) {
+        LOG_E("✗ MJPEG 播放初始化失败\n");
+        return;
+    }
+    xTaskCreatePinnedToCore(ReaderTask, "MJPEG_Read", MJPEG_READER_STACK, NULL,
+                            MJPEG_READER_PRIO, &readerTask, MJPEG_READER_CORE);
+    LOG_I("✓ MJPEG 读取任务已启动\n");
+}
+
+// ============================================================
+// 解码与写屏
+// ============================================================
+
+/**
+ * @brief 把一块像素（屏幕坐标）裁剪到可见区域后拷进当前解码缓冲区
+ */
+static bool storeBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    MjpegPlayer& p = g_player;
+    const ImageLayout& l = p.layout;
+    int32_t x0 = x > l.viewX ? x : l.viewX;
+    int32_t x1 = (x + w < l.viewX + l.viewW) ? x + w : l.viewX + l.viewW;
+    int32_t y0 = y > l.viewY ? y : l.viewY;
+    int32_t y1 = (y + h < l.viewY + l.viewH) ? y + h : l.viewY + l.viewH;
+    for (int32_t row = y0; row < y1; row++) {
+        memcpy(p.target + (size_t)(row - l.viewY) * l.viewW + (x0 - l.viewX),
+               pixels + (size_t)(row - y) * w + (x0 - x), (x1 - x0) * 2);
+    }
+    return true;
+}
+
+static bool scalerIn(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    return ImageScaler_PushBlock(&g_player.scaler, x, y, w, h, pixels);
+}
+
+/**
+ * @brief 直接写屏时把可见区域以外清成黑色（几何设置变化时调用一次）
+ */
+static void clearOutside(const ImageLayout& l) {
+    static uint16_t blackLine[LCD_LONG_SIDE] = { 0 };
+    uint16_t screenW = LCD_GetWidth();
+    uint16_t screenH = LCD_GetHeight();
+    uint16_t right = l.viewX + l.viewW;
+    uint16_t bottom = l.viewY + l.viewH;
+    
+    // 按区域（上、下、左、右）逐行记录：同一区域的各行列范围相同、上下相接，每个区域只设置一次窗口
+    LCD_CmdList list;
+    LCD_CmdList_Reset(&list);
+    for (uint16_t y = 0; y < l.viewY; y++) {
+        LCD_CmdList_Add(&list, 0, y, screenW - 1, y, blackLine);
+    }
+    for (uint16_t y = bottom; y < screenH; y++) {
+        LCD_CmdList_Add(&list, 0, y, screenW - 1, y, blackLine);
+    }
+    for (uint16_t y = l.viewY; y < bottom && l.viewX > 0; y++) {
+        LCD_CmdList_Add(&list, 0, y, l.viewX - 1, y, blackLine);
+    }
+    for (uint16_t y = l.viewY; y < bottom && right < screenW; y++) {
+        LCD_CmdList_Add(&list, right, y, screenW - 1, y, blackLine);
+    }
+    LCD_CmdList_Submit(&list);
+}
+
+/**
+ * @brief 按帧尺寸确定显示方向，计算摆放、解码缩放与缩放器（第一帧与尺寸变化时）
+ */
+static bool setupGeometry(uint16_t width, uint16_t height) {
+    MjpegPlayer& p = g_player;
+    LCD_Async_WaitAll();
+    if (p.scaling) {
+        ImageScaler_End(&p.scaler);
+        p.scaling = false;
+    }
+
+    // 与静态图片相同的方向规则（片段没有 EXIF）；MADCTL 完成旋转，帧按逻辑坐标写出
+    LCD_SetOrientation(resolveImageOrientation(width, height, 0) & IMAGE_ORIENT_XFORM_MASK);
+    uint16_t screenW = LCD_GetWidth();
+    uint16_t screenH = LCD_GetHeight();
+    ImageScaler_Layout(width, height, screenW, screenH, p.mode, &p.layout);
+    p.scale = ImageScaler_PickJpegScale(width, height, &p.layout);
+    uint16_t outW = 0, outH = 0;
+    JpegCodec_ScaledSize(p.dec, p.scale, &outW, &outH);
+    p.scaling = !ImageScaler_IsPassthrough(&p.layout, outW, outH);
+    if (p.scaling && !ImageScaler_Begin(&p.scaler, &p.layout, outW, outH, storeBlock)) {
+        LOG_E("✗ 缩放缓冲区分配失败\n");
+        p.scaling = false;
+        p.srcW = p.srcH = 0;
+        return false;
+    }
+    p.srcW = width;
+    p.srcH = height;
+
+    if (p.layout.viewW < screenW || p.layout.viewH < screenH) {
+        clearOutside(p.layout);
+    }
+    LOG_D("MJPEG 帧 %u×%u → 显示 %u×%u（解码缩放 1/%d）\n", width, height,
+          p.layout.viewW, p.layout.viewH, 1 << p.scale);
+    return true;
+}
+
+/**
+ * @brief 解码一帧到空闲的解码缓冲区并提交异步写屏
+ */
+static bool decodeFrame(const uint8_t* data, size_t len) {
+    MjpegPlayer& p = g_player;
+    uint64_t t0 = esp_timer_get_time();
+
+    JpegResult r = JpegCodec_OpenMemory(p.dec, data, len);
+    if (r == JPEG_OK && (p.dec->width != p.srcW || p.dec->height != p.srcH) &&
+        !setupGeometry(p.dec->width, p.dec->height)) {
+        r = JPEG_ERR_MEMORY;
+    }
+    if (r == JPEG_OK) {
+        // 这个缓冲区两帧前交给了 SPI 任务，等它写完
+        while (LCD_Async_Pending() > 1) {
+            LCD_Async_WaitOne();
+        }
+        p.target = p.frames[p.next];
+        int16_t x0 = p.scaling ? 0 : p.layout.offX;
+        int16_t y0 = p.scaling ? 0 : p.layout.offY;
+        r = JpegCodec_Decode(p.dec, p.scale, x0, y0, p.scaling ? scalerIn : storeBlock);
+        if (p.scaling) {
+            ImageScaler_Finish(&p.scaler);
+            ImageScaler_Rewind(&p.scaler);
+        }
+    }
+    JpegCodec_Close(p.dec);
+    if (r != JPEG_OK) {
+        if (g_stats.framesBad++ == 0) {
+            LOG_W("⚠️ MJPEG 帧解码失败: %s\n", JpegCodec_ResultName(r));
+        }
+        return false;
+    }
+
+    const ImageLayout& l = p.layout;
+    if (currentColorTemp != COLOR_TEMP_DEFAULT) {
+        applyColorTemperature(p.target, (uint32_t)l.viewW * l.viewH);
+    }
+    if (LCD_Vsync_Enabled()) {
+        // 垂直同步：等上一帧写完，这一帧从不会撕裂的扫描位置开始（放弃与上一帧传输的重叠）
+        LCD_Async_WaitAll();
+        LCD_Vsync_WaitForWindow((uint32_t)l.viewW * l.viewH * 2);
+    }
+    LCD_addWindow_Async(l.viewX, l.viewY, l.viewX + l.viewW - 1, l.viewY + l.viewH - 1, p.target);
+    p.next ^= 1;
+
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    p.decodeUsTotal += us;
+    p.decodes++;
+    if (us > g_stats.maxDecodeUs) {
+        g_stats.maxDecodeUs = us;
+    }
+    return true;
+}
+
+// ============================================================
+// 节拍回调
+// ============================================================
+
+static uint64_t clockNow(void* user) {
+    return esp_timer_get_time();
+}
+
+static MjpegSinkResult takeFrame(MjpegFrameItem* item) {
+    if (xQueueReceive(fullQueue, item, 0) != pdTRUE) {
+        return MJPEG_SINK_NOT_READY;
+    }
+    return (item->slot == MJPEG_SLOT_END) ? MJPEG_SINK_END : MJPEG_SINK_OK;
+}
+
+static MjpegSinkResult sinkPresent(void* user, uint32_t frame) {
+    MjpegFrameItem item;
+    MjpegSinkResult r = takeFrame(&item);
+    if (r != MJPEG_SINK_OK) {
+        return r;
+    }
+    // 大小为 0 的 AVI 帧表示重复上一帧，屏幕不变
+    if (item.len > 0) {
+        decodeFrame(g_player.slots[item.slot], item.len);
+    }
+    xQueueSendToBack(freeQueue, &item.slot, 0);
+    return MJPEG_SINK_OK;
+}
+
+static MjpegSinkResult sinkSkip(void* user, uint32_t frame) {
+    MjpegFrameItem item;
+    MjpegSinkResult r = takeFrame(&item);
+    if (r == MJPEG_SINK_OK) {
+        xQueueSendToBack(freeQueue, &item.slot, 0);
+    }
+    return r;
+}
+
+static const MjpegSink g_sink = { sinkPresent, sinkSkip, nullptr };
+
+static void updateStats() {
+    const MjpegScheduler& s = g_player.sched;
+    g_stats.framesShown = s.stats.shown;
+    g_stats.framesDropped = s.stats.dropped;
+    g_stats.stalls = s.stats.stalls;
+    g_stats.resyncs = s.stats.resyncs;
+    g_stats.loops = readerLoops;
+    g_stats.elapsedMs = (uint32_t)(s.stats.elapsedUs / 1000);
+    g_stats.fps = MjpegScheduler_Fps(&s);
+    g_stats.avgDecodeUs = g_player.decodes ? (uint32_t)(g_player.decodeUsTotal / g_player.decodes) : 0;
+    g_stats.avgLateUs = s.stats.shown ? (uint32_t)(s.stats.totalLateUs / s.stats.shown) : 0;
+    g_stats.maxLateUs = s.stats.maxLateUs;
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+static void freeSession() {
+    MjpegPlayer& p = g_player;
+    if (p.scaling) {
+        ImageScaler_End(&p.scaler);
+        p.scaling = false;
+    }
+    for (int i = 0; i < 2; i++) {
+        free(p.frames[i]);
+        p.frames[i] = nullptr;
+    }
+    for (int i = 0; i < MJPEG_READ_SLOTS; i++) {
+        free(p.slots[i]);
+        p.slots[i] = nullptr;
+    }
+    free(p.dec);
+    free(p.container);
+    p.dec = nullptr;
+    p.container = nullptr;
+    if (p.file) {
+        p.file.close();
+    }
+}
+
+static void* allocPsram(size_t size) {
+    void* ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    return ptr != nullptr ? ptr : malloc(size);
+}
+
+bool MjpegPlayer_Start(const char* path, ImageScaleMode mode) {
+    MjpegPlayer_Stop();
+    if (readerTask == nullptr) {
+        LOG_E("✗ MJPEG 读取任务未启动\n");
+        return false;
+    }
+    MjpegPlayer& p = g_player;
+
+    p.dec = (JpegDecoder*)heap_caps_malloc(sizeof(JpegDecoder), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (p.dec == nullptr) {
+        p.dec = (JpegDecoder*)heap_caps_malloc(sizeof(JpegDecoder), MALLOC_CAP_SPIRAM);
+    }
+    p.container = (MjpegContainer*)allocPsram(sizeof(MjpegContainer));
+    bool ok = p.dec != nullptr && p.container != nullptr;
+    for (int i = 0; i < 2 && ok; i++) {
+        p.frames[i] = (uint16_t*)allocPsram(LCD_WIDTH * LCD_HEIGHT * 2);
+        ok = p.frames[i] != nullptr;
+    }
+    for (int i = 0; i < MJPEG_READ_SLOTS && ok; i++) {
+        p.slots[i] = (uint8_t*)allocPsram(MJPEG_MAX_FRAME_BYTES);
+        ok = p.slots[i] != nullptr;
+    }
+    if (!ok) {
+        LOG_E("✗ MJPEG 缓冲区分配失败\n");
+        freeSession();
+        return false;
+    }
+
+    p.file = SD_MMC.open(path, FILE_READ);
+    MjpegResult r = p.file ? MjpegContainer_Open(p.container, fileRead, fileSeek, &p.file, p.file.size())
+                           : MJPEG_ERR_INPUT;
+    if (r != MJPEG_OK) {
+        LOG_E("✗ MJPEG: %s\n", MjpegContainer_ResultName(r));
+        freeSession();
+        return false;
+    }
+    const MjpegContainer* c = p.container;
+    uint32_t frameUs = c->frameUs;
+    if (frameUs < 1000000 / MJPEG_MAX_FPS) {
+        frameUs = (frameUs == 0) ? 1000000 / MJPEG_DEFAULT_FPS : 1000000 / MJPEG_MAX_FPS;
+    }
+    LOG_D("MJPEG 信息 - %s, %.2f fps, %lu 帧\n", c->type == MJPEG_CONTAINER_AVI ? "AVI" : "裸 MJPEG",
+          1000000.0f / frameUs, (unsigned long)c->totalFrames);
+
+    // 第一帧在这里读出（调用方持有 sdCardMutex），显示失败就不开始播放
+    size_t len = 0;
+    do {
+        r = MjpegContainer_ReadFrame(p.container, p.slots[0], MJPEG_MAX_FRAME_BYTES, &len);
+    } while (r == MJPEG_ERR_TOO_BIG || (r == MJPEG_OK && len == 0));
+    if (r != MJPEG_OK) {
+        LOG_E("✗ MJPEG 第一帧: %s\n", MjpegContainer_ResultName(r == MJPEG_DONE ? MJPEG_ERR_FORMAT : r));
+        freeSession();
+        return false;
+    }
+
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.valid = true;
+    g_stats.avi = c->type == MJPEG_CONTAINER_AVI;
+    g_stats.frameUs = frameUs;
+    p.mode = mode;
+    p.srcW = p.srcH = 0;
+    p.next = 0;
+    p.decodeUsTotal = 0;
+    p.decodes = 0;
+    p.nextDueUs = 0;
+
+    xQueueReset(freeQueue);
+    xQueueReset(fullQueue);
+    MjpegFrameItem first = { 0, (uint32_t)len };
+    xQueueSendToBack(fullQueue, &first, 0);
+    for (uint8_t i = 1; i < MJPEG_READ_SLOTS; i++) {
+        xQueueSendToBack(freeQueue, &i, 0);
+    }
+
+    MjpegScheduler_Init(&p.sched, clockNow, nullptr, frameUs, MJPEG_MAX_DROP_RUN);
+    uint32_t waitUs = 0;
+    MjpegScheduler_Step(&p.sched, &g_sink, &waitUs);
+    if (p.decodes == 0) {
+        LCD_Async_WaitAll();
+        freeSession();
+        return false;
+    }
+    g_stats.width = p.srcW;
+    g_stats.height = p.srcH;
+    g_stats.playing = true;
+    updateStats();
+
+    readerLoops = 0;
+    readerOversize = 0;
+    readerStop = false;
+    readerRunning = true;
+    p.active = true;
+    xTaskNotifyGive(readerTask);
+    return true;
+}
+
+void MjpegPlayer_Stop(void) {
+    MjpegPlayer& p = g_player;
+    if (!p.active) {
+        return;
+    }
+    p.active = false;
+
+    if (readerRunning) {
+        readerStop = true;
+        xSemaphoreTake(readerDone, portMAX_DELAY);
+        readerRunning = false;
+    }
+    LCD_Async_WaitAll();
+
+    updateStats();
+    g_stats.framesBad += readerOversize;
+    g_stats.playing = false;
+    LOG_I("⏱ MJPEG 播放: %lu 帧，%.1f fps，丢帧 %lu，卡顿 %lu，解码平均 %.2f ms（最长 %.2f ms）\n",
+          (unsigned long)g_stats.framesShown, g_stats.fps, (unsigned long)g_stats.framesDropped,
+          (unsigned long)g_stats.stalls, g_stats.avgDecodeUs / 1000.0f, g_stats.maxDecodeUs / 1000.0f);
+    freeSession();
+}
+
+void MjpegPlayer_Service(void) {
+    MjpegPlayer& p = g_player;
+    if (!p.active || (uint64_t)esp_timer_get_time() < p.nextDueUs) {
+        return;
+    }
+    uint32_t waitUs = 0;
+    MjpegStepResult r = MjpegScheduler_Step(&p.sched, &g_sink, &waitUs);
+    if (r == MJPEG_STEP_END) {
+        LOG_E("✗ MJPEG 读取中断，停在当前帧\n");
+        MjpegPlayer_Stop();
+        return;
+    }
+    p.nextDueUs = (r == MJPEG_STEP_WAIT || r == MJPEG_STEP_STALLED) ? esp_timer_get_time() + waitUs : 0;
+    updateStats();
+}
+
+bool MjpegPlayer_IsPlaying(void) {
+    return g_player.active;
+}
+
+bool MjpegPlayer_GetStats(MjpegPlaybackStats* stats) {
+    if (stats == nullptr || !g_stats.valid) {
+        return false;
+    }
+    *stats = g_stats;
+    if (g_player.active) {
+        stats->framesBad += readerOversize;
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Image_Scaler.h"
+
+// ============================================================
+// MJPEG 片段播放（.avi / .mjpeg / .mjpg）
+// - 读取任务（核心 0）顺序读出压缩帧，放进 MJPEG_READ_SLOTS 个 PSRAM 槽位，提前读几帧；
+//   每读一帧获取一次 sdCardMutex，上传和预解码可以穿插进来
+// - loop 中的 MjpegPlayer_Service 按 esp_timer 计时（MJPEG_Scheduler），到时间就解码一帧，
+//   落后时丢帧（只归还槽位，不解码）
+// - 两个解码缓冲区轮流使用：一个交给 SPI 任务异步写屏时，另一个解码下一帧
+// - 片段播完自动从头循环，直到显示下一张图片
+// 与 GIF 动画一样只在前台显示时播放；后台预解码 / 转码 / 帧缓存都跳过
+// ============================================================
+#define MJPEG_DEFAULT_FPS       25                  // 裸 MJPEG（没有帧率信息）的播放帧率
+#define MJPEG_MAX_FPS           60                  // AVI 头中的帧率超过此值时按此值播放
+#define MJPEG_MAX_DROP_RUN      3                   // 最多连续丢弃的帧数
+#define MJPEG_MAX_FRAME_BYTES   (128 * 1024)        // 单帧压缩数据上限（更大的帧跳过）
+#define MJPEG_READ_SLOTS        4                   // 预读的压缩帧数（PSRAM）
+
+#define MJPEG_READER_CORE       0
+#define MJPEG_READER_PRIO       2                   // 高于预取 / 转码，低于 SD_Stream 与 SPI 任务
+#define MJPEG_READER_STACK      4096
+#define MJPEG_LOCK_WAIT_MS      20                  // 单次尝试获取 sdCardMutex / 空槽位的等待时间
+
+// 播放统计（正在播放或最近一次播放）
+typedef struct {
+    bool valid;
+    bool playing;
+    bool avi;                   // 容器类型（false 为裸 MJPEG）
+    uint16_t width;             // 帧尺寸（第一帧）
+    uint16_t height;
+    uint32_t frameUs;           // 标称帧间隔
+    uint32_t framesShown;
+    uint32_t framesDropped;     // 落后时丢弃的帧
+    uint32_t framesBad;         // 解码失败或超过 MJPEG_MAX_FRAME_BYTES 的帧
+    uint32_t stalls;            // 到时间时读取任务还没读到数据的次数
+    uint32_t resyncs;           // 落后太多、重新计时的次数
+    uint32_t loops;             // 已播完的遍数
+    uint32_t elapsedMs;
+    float fps;                  // 实际显示帧率
+    uint32_t avgDecodeUs;       // 每帧解码 + 缩放的平均耗时（不含等待写屏）
+    uint32_t maxDecodeUs;
+    uint32_t avgLateUs;         // 显示时间相对预定时间的平均延迟
+    uint32_t maxLateUs;
+} MjpegPlaybackStats;
+
+/**
+ * @brief 创建读取任务（须在 WebServer_Init 创建 sdCardMutex 之后调用）
+ */
+void MjpegPlayer_Init(void);
+
+/**
+ * @brief 打开片段、显示第一帧并开始播放（调用方须持有 sdCardMutex）
+ * @param path 文件路径
+ * @param mode 缩放模式（与静态图片相同的摆放规则）
+ * @return false 文件无法识别、第一帧解码失败或内存不足
+ */
+bool MjpegPlayer_Start(const char* path, ImageScaleMode mode);
+
+/**
+ * @brief 停止播放并释放缓冲区（等待读取任务退出与异步写屏完成）
+ */
+void MjpegPlayer_Stop(void);
+
+/**
+ * @brief 在 loop 中反复调用：到时间就显示或丢弃一帧
+ */
+void MjpegPlayer_Service(void);
+
+bool MjpegPlayer_IsPlaying(void);
+bool MjpegPlayer_GetStats(MjpegPlaybackStats* stats);
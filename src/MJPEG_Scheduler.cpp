@@ -0,0 +1,75 @@
+#include "MJPEG_Scheduler.h"
+#include <string.h>
+
+void MjpegScheduler_Init(MjpegScheduler* s, MjpegClockFunc clock, void* clockUser, uint32_t frameUs,
+                         uint8_t maxDropRun) {
+    memset(s, 0, sizeof(*s));
+    s->clock = clock;
+    s->clockUser = clockUser;
+    s->frameUs = frameUs > 0 ? frameUs : 40000;
+    s->maxDropRun = maxDropRun;
+}
+
+MjpegStepResult MjpegScheduler_Step(MjpegScheduler* s, const MjpegSink* sink, uint32_t* waitUs) {
+    uint64_t now = s->clock(s->clockUser);
+    *waitUs = 0;
+    if (!s->started) {
+        s->started = true;
+        s->firstUs = now;
+        s->baseUs = now;
+        s->baseFrame = 0;
+    }
+    s->stats.elapsedUs = now - s->firstUs;
+
+    uint64_t due = s->baseUs + (uint64_t)(s->frame - s->baseFrame) * s->frameUs;
+    if (now < due) {
+        *waitUs = (uint32_t)(due - now);
+        return MJPEG_STEP_WAIT;
+    }
+    uint64_t late = now - due;
+
+    // 落后一整帧：丢掉这一帧去追下一帧，但不能一直丢
+    bool drop = late >= s->frameUs && s->dropRun < s->maxDropRun;
+    MjpegSinkResult r = drop ? sink->skip(sink->user, s->frame) : sink->present(sink->user, s->frame);
+    if (r == MJPEG_SINK_END) {
+        return MJPEG_STEP_END;
+    }
+    if (r == MJPEG_SINK_NOT_READY) {
+        if (!s->stalled) {
+            s->stalled = true;
+            s->stats.stalls++;
+        }
+        *waitUs = MJPEG_STALL_RETRY_US;
+        return MJPEG_STEP_STALLED;
+    }
+    s->stalled = false;
+    s->frame++;
+
+    if (drop) {
+        s->dropRun++;
+        s->stats.dropped++;
+        return MJPEG_STEP_DROPPED;
+    }
+
+    s->dropRun = 0;
+    s->stats.shown++;
+    s->stats.totalLateUs += late;
+    if (late > s->stats.maxLateUs) {
+        s->stats.maxLateUs = (uint32_t)late;
+    }
+
+    // 丢帧也追不回来（数据长时间未就绪）：从现在重新计时，避免之后连续快进
+    if (late > (uint64_t)(s->maxDropRun + 1) * s->frameUs) {
+        s->baseUs = now;
+        s->baseFrame = s->frame - 1;
+        s->stats.resyncs++;
+    }
+    return MJPEG_STEP_SHOWN;
+}
+
+float MjpegScheduler_Fps(const MjpegScheduler* s) {
+    if (s->stats.elapsedUs == 0) {
+        return 0.0f;
+    }
+    return s->stats.shown * 1000000.0f / s->stats.elapsedUs;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// MJPEG 播放节拍：按帧间隔决定何时显示下一帧、何时丢帧
+// - 第 n 帧的预定时间为 起点 + n × 帧间隔；未到时间返回需要等待的微秒数
+// - 落后一整帧及以上时丢弃该帧（只取出数据不解码），连续丢帧不超过 maxDropRun，
+//   保证解码跟不上时画面仍在更新
+// - 落后超过 (maxDropRun + 1) 帧时不再追赶，以当前时间为新起点（读卡被长时间占用后）
+// 时钟与显示都通过回调注入，不依赖 Arduino，可以在 x86 Linux 上用假时钟测试。
+// ============================================================
+
+/**
+ * @brief 时钟回调：单调递增的微秒时间（设备上为 esp_timer_get_time）
+ */
+typedef uint64_t (*MjpegClockFunc)(void* user);
+
+enum MjpegSinkResult {
+    MJPEG_SINK_OK = 0,
+    MJPEG_SINK_NOT_READY,       // 下一帧的数据还没读到（读取线程落后）
+    MJPEG_SINK_END              // 没有更多帧（读取失败），停止播放
+};
+
+// 显示端：present 解码并显示下一帧，skip 取出下一帧直接丢弃
+typedef struct {
+    MjpegSinkResult (*present)(void* user, uint32_t frame);
+    MjpegSinkResult (*skip)(void* user, uint32_t frame);
+    void* user;
+} MjpegSink;
+
+enum MjpegStepResult {
+    MJPEG_STEP_WAIT = 0,        // 下一帧还没到时间（waitUs 给出剩余时间）
+    MJPEG_STEP_SHOWN,           // 显示了一帧
+    MJPEG_STEP_DROPPED,         // 丢弃了一帧
+    MJPEG_STEP_STALLED,         // 到时间了但数据未就绪（waitUs 为建议的重试间隔）
+    MJPEG_STEP_END              // 显示端要求停止
+};
+
+#define MJPEG_STALL_RETRY_US    1000    // 数据未就绪时的重试间隔
+
+typedef struct {
+    uint32_t shown;             // 显示的帧数
+    uint32_t dropped;           // 因落后丢弃的帧数
+    uint32_t stalls;            // 到时间时数据未就绪的次数（连续等待只计一次）
+    uint32_t resyncs;           // 落后太多、重新对齐起点的次数
+    uint32_t maxLateUs;         // 显示帧相对预定时间的最大延迟
+    uint64_t totalLateUs;       // 显示帧的延迟总和（求平均用）
+    uint64_t elapsedUs;         // 从第一次 Step 到最近一次 Step
+} MjpegSchedulerStats;
+
+typedef struct {
+    MjpegClockFunc clock;
+    void* clockUser;
+    uint32_t frameUs;
+    uint8_t maxDropRun;
+
+    bool started;
+    uint64_t firstUs;           // 第一次 Step 的时间
+    uint64_t baseUs;            // 时间基准（起点或最近一次重新对齐）
+    uint32_t baseFrame;         // baseUs 对应的帧序号
+    uint32_t frame;             // 下一帧的序号（含丢弃的帧）
+    uint8_t dropRun;            // 连续丢弃的帧数
+    bool stalled;
+
+    MjpegSchedulerStats stats;
+} MjpegScheduler;
+
+/**
+ * @brief 初始化（第一次 Step 时开始计时）
+ * @param frameUs    帧间隔（微秒），0 按 40000（25 fps）处理
+ * @param maxDropRun 最多连续丢弃的帧数
+ */
+void MjpegScheduler_Init(MjpegScheduler* s, MjpegClockFunc clock, void* clockUser, uint32_t frameUs,
+                         uint8_t maxDropRun);
+
+/**
+ * @brief 推进一步：到时间就显示或丢弃一帧
+ * @param waitUs 返回 WAIT / STALLED 时下一次调用前建议等待的时间
+ */
+MjpegStepResult MjpegScheduler_Step(MjpegScheduler* s, const MjpegSink* sink, uint32_t* waitUs);
+
+/**
+ * @brief 实际显示帧率（帧/秒）
+ */
+float MjpegScheduler_Fps(const MjpegScheduler* s);
@@ -0,0 +1,361 @@
+#include "Pixel_Convert.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define IS_ALIGNED4(p) ((((uintptr_t)(p)) & 3) == 0)
+
+static inline uint16_t pack565(uint32_t r, uint32_t g, uint32_t b) {
+    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+// ============================================================
+// 24 / 32 位
+// ============================================================
+
+void PixelConvert_BGR888ToRGB565(const uint8_t* src, uint16_t* dst, int n) {
+    int i = 0;
+    if (IS_ALIGNED4(src)) {
+        // 4 个像素正好 3 个字：B0G0R0B1 | G1R1B2G2 | R2B3G3R3（小端，低字节在前）
+        const uint32_t* w = (const uint32_t*)src;
+        for (; i + 8 <= n; i += 8, w += 6, dst += 8) {
+            uint32_t w0 = w[0], w1 = w[1], w2 = w[2];
+            uint32_t w3 = w[3], w4 = w[4], w5 = w[5];
+            dst[0] = pack565((w0 >> 16) & 0xFF, (w0 >> 8) & 0xFF, w0 & 0xFF);
+            dst[1] = pack565((w1 >> 8) & 0xFF, w1 & 0xFF, w0 >> 24);
+            dst[2] = pack565(w2 & 0xFF, w1 >> 24, (w1 >> 16) & 0xFF);
+            dst[3] = pack565(w2 >> 24, (w2 >> 16) & 0xFF, (w2 >> 8) & 0xFF);
+            dst[4] = pack565((w3 >> 16) & 0xFF, (w3 >> 8) & 0xFF, w3 & 0xFF);
+            dst[5] = pack565((w4 >> 8) & 0xFF, w4 & 0xFF, w3 >> 24);
+            dst[6] = pack565(w5 & 0xFF, w4 >> 24, (w4 >> 16) & 0xFF);
+            dst[7] = pack565(w5 >> 24, (w5 >> 16) & 0xFF, (w5 >> 8) & 0xFF);
+        }
+        src = (const uint8_t*)w;
+    }
+    for (; i < n; i++, src += 3) {
+        *dst++ = pack565(src[2], src[1], src[0]);
+    }
+}
+
+void PixelConvert_BGRA8888ToRGB565(const uint8_t* src, uint16_t* dst, int n) {
+    int i = 0;
+    if (IS_ALIGNED4(src)) {
+        // 一个字一个像素，移位掩码直接拼出 RGB565
+        const uint32_t* w = (const uint32_t*)src;
+        for (; i + 8 <= n; i += 8, w += 8, dst += 8) {
+            for (int k = 0; k < 8; k++) {
+                uint32_t p = w[k];
+                dst[k] = (uint16_t)(((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F));
+            }
+        }
+        src = (const uint8_t*)w;
+    }
+    for (; i < n; i++, src += 4) {
+        *dst++ = pack565(src[2], src[1], src[0]);
+    }
+}
+
+// ============================================================
+// 16 位
+// ============================================================
+
+void PixelConvert_RGB555ToRGB565(const uint8_t* src, uint16_t* dst, int n) {
+    int i = 0;
+    if (IS_ALIGNED4(src)) {
+        // 一个字两个像素：R、G 左移一位，G 的最高位补到新的最低位
+        const uint32_t* w = (const uint32_t*)src;
+        for (; i + 8 <= n; i += 8, w += 4, dst += 8) {
+            for (int k = 0; k < 4; k++) {
+                uint32_t p = w[k];
+                uint32_t q = ((p & 0x7FE07FE0) << 1) | ((p >> 4) & 0x00200020) | (p & 0x001F001F);
+                dst[2 * k] = (uint16_t)q;
+                dst[2 * k + 1] = (uint16_t)(q >> 16);
+            }
+        }
+        src = (const uint8_t*)w;
+    }
+    for (; i < n; i++, src += 2) {
+        uint32_t p = src[0] | (src[1] << 8);
+        *dst++ = (uint16_t)(((p & 0x7FE0) << 1) | ((p >> 4) & 0x0020) | (p & 0x001F));
+    }
+}
+
+void PixelConvert_RGB565Copy(const uint8_t* src, uint16_t* dst, int n) {
+    memcpy(dst, src, (size_t)n * 2);
+}
+
+// ============================================================
+// 8 位调色板
+// ============================================================
+
+void PixelConvert_BuildPalette(const uint8_t* bgrx, int count, uint16_t* palette) {
+    if (count > 256) {
+        count = 256;
+    }
+    for (int i = 0; i < count; i++) {
+        palette[i] = pack565(bgrx[4 * i + 2], bgrx[4 * i + 1], bgrx[4 * i]);
+    }
+    for (int i = (count < 0 ? 0 : count); i < 256; i++) {
+        palette[i] = 0;
+    }
+}
+
+void PixelConvert_Pal8ToRGB565(const uint8_t* src, const uint16_t* palette, uint16_t* dst, int n) {
+    int i = 0;
+    if (IS_ALIGNED4(src)) {
+        const uint32_t* w = (const uint32_t*)src;
+        for (; i + 8 <= n; i += 8, w += 2, dst += 8) {
+            uint32_t a = w[0], b = w[1];
+            dst[0] = palette[a & 0xFF];
+            dst[1] = palette[(a >> 8) & 0xFF];
+            dst[2] = palette[(a >> 16) & 0xFF];
+            dst[3] = palette[a >> 24];
+            dst[4] = palette[b & 0xFF];
+            dst[5] = palette[(b >> 8) & 0xFF];
+            dst[6] = palette[(b >> 16) & 0xFF];
+            dst[7] = palette[b >> 24];
+        }
+        src = (const uint8_t*)w;
+    }
+    for (; i < n; i++) {
+        *dst++ = palette[*src++];
+    }
+}
+
+// ============================================================
+// PNG 行（PNGdec 输出的原始行）
+// ============================================================
+
+// x / 255 四舍五入，x ≤ 255 × 255
+static inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint16_t blend565(uint32_t r, uint32_t g, uint32_t b, uint32_t a, uint32_t bg) {
+    uint32_t ia = 255 - a;
+    return pack565(div255(r * a + ((bg >> 16) & 0xFF) * ia),
+                   div255(g * a + ((bg >> 8) & 0xFF) * ia),
+                   div255(b * a + (bg & 0xFF) * ia));
+}
+
+void PixelConvert_RGB888ToRGB565(const uint8_t* src, uint16_t* dst, int n) {
+    int i = 0;
+    if (IS_ALIGNED4(src)) {
+        // 4 个像素正好 3 个字：R0G0B0R1 | G1B1R2G2 | B2R3G3B3
+        const uint32_t* w = (const uint32_t*)src;
+        for (; i + 8 <= n; i += 8, w += 6, dst += 8) {
+            for (int k = 0; k < 2; k++) {
+                uint32_t w0 = w[3 * k], w1 = w[3 * k + 1], w2 = w[3 * k + 2];
+                uint16_t* d = dst + 4 * k;
+                d[0] = pack565(w0 & 0xFF, (w0 >> 8) & 0xFF, (w0 >> 16) & 0xFF);
+                d[1] = pack565(w0 >> 24, w1 & 0xFF, (w1 >> 8) & 0xFF);
+                d[2] = pack565((w1 >> 16) & 0xFF, w1 >> 24, w2 & 0xFF);
+                d[3] = pack565((w2 >> 8) & 0xFF, (w2 >> 16) & 0xFF, w2 >> 24);
+            }
+        }
+        src = (const uint8_t*)w;
+    }
+    for (; i < n; i++, src += 3) {
+        *dst++ = pack565(src[0], src[1], src[2]);
+    }
+}
+
+void PixelConvert_RGBA8888BlendRGB565(const uint8_t* src, uint16_t* dst, int n, uint32_t bg) {
+    uint16_t bg565 = pack565((bg >> 16) & 0xFF, (bg >> 8) & 0xFF, bg & 0xFF);
+    int i = 0;
+    if (IS_ALIGNED4(src)) {
+        // 不透明 / 全透明的像素不做乘法，照片和图标里几乎都是这两种
+        const uint32_t* w = (const uint32_t*)src;
+        for (; i < n; i++) {
+            uint32_t p = *w++;
+            uint32_t a = p >> 24;
+            if (a == 0xFF) {
+                *dst++ = (uint16_t)(((p << 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 19) & 0x001F));
+            } else if (a == 0) {
+                *dst++ = bg565;
+            } else {
+                *dst++ = blend565(p & 0xFF, (p >> 8) & 0xFF, (p >> 16) & 0xFF, a, bg);
+            }
+        }
+        return;
+    }
+    for (; i < n; i++, src += 4) {
+        uint32_t a = src[3];
+        if (a == 0xFF) {
+            *dst++ = pack565(src[0], src[1], src[2]);
+        } else if (a == 0) {
+            *dst++ = bg565;
+        } else {
+            *dst++ = blend565(src[0], src[1], src[2], a, bg);
+        }
+    }
+}
+
+void PixelConvert_GrayAlphaBlendRGB565(const uint8_t* src, uint16_t* dst, int n, uint32_t bg) {
+    for (int i = 0; i < n; i++, src += 2) {
+        uint32_t v = src[0];
+        dst[i] = blend565(v, v, v, src[1], bg);
+    }
+}
+
+void PixelConvert_PackedToRGB565(const uint8_t* src, int bits, const uint16_t* palette, uint16_t* dst, int n) {
+    if (bits == 8) {
+        PixelConvert_Pal8ToRGB565(src, palette, dst, n);
+        return;
+    }
+    // 高位在前，一个字节 8 / bits 个像素
+    int perByte = 8 / bits;
+    uint8_t mask = (uint8_t)((1 << bits) - 1);
+    int i = 0;
+    for (; i + perByte <= n; i += perByte) {
+        uint8_t b = *src++;
+        for (int k = perByte - 1; k >= 0; k--) {
+            *dst++ = palette[(b >> (k * bits)) & mask];
+        }
+    }
+    if (i < n) {
+        uint8_t b = *src;
+        for (int shift = 8 - bits; i < n; i++, shift -= bits) {
+            *dst++ = palette[(b >> shift) & mask];
+        }
+    }
+}
+
+void PixelConvert_Narrow16(const uint8_t* src, uint8_t* dst, int samples) {
+    // 16 位样本为大端，高字节在前
+    for (int i = 0; i < samples; i++) {
+        dst[i] = src[2 * i];
+    }
+}
+
+void PixelConvert_BuildPngPalette(const uint8_t* rgb, const uint8_t* alpha, int count, uint32_t bg,
+                                  uint16_t* palette) {
+    if (count > 256) {
+        count = 256;
+    }
+    for (int i = 0; i < count; i++) {
+        uint32_t a = (alpha != nullptr) ? alpha[i] : 0xFF;
+        palette[i] = blend565(rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2], a, bg);
+    }
+    for (int i = (count < 0 ? 0 : count); i < 256; i++) {
+        palette[i] = 0;
+    }
+}
+
+void PixelConvert_BuildGrayPalette(int bits, uint16_t* palette) {
+    int levels = 1 << bits;
+    for (int i = 0; i < levels; i++) {
+        uint32_t v = (uint32_t)i * 255 / (levels - 1);
+        palette[i] = pack565(v, v, v);
+    }
+}
+
+// ============================================================
+// 微基准测试
+// ============================================================
+
+// 逐像素参考实现：与改动前 displayBMP 的内循环相同（每个像素一次乘法算偏移、三次字节读取）
+static void referenceConvert(const uint8_t* row, uint32_t bytesPerPixel, uint16_t* dst, int n) {
+    for (int x = 0; x < n; x++) {
+        uint32_t pixelOffset = x * bytesPerPixel;
+        uint8_t b = row[pixelOffset + 0];
+        uint8_t g = row[pixelOffset + 1];
+        uint8_t r = row[pixelOffset + 2];
+        dst[x] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | ((b & 0xF8) >> 3);
+    }
+}
+
+static volatile uint32_t benchSink;
+
+enum { BENCH_BGR888, BENCH_SCALAR, BENCH_BGRA8888, BENCH_RGB555, BENCH_RGB565, BENCH_PAL8 };
+
+static void benchRow(int kind, const uint8_t* row, const uint16_t* palette, uint16_t* dst, int n) {
+    switch (kind) {
+        case BENCH_BGR888:   PixelConvert_BGR888ToRGB565(row, dst, n); break;
+        case BENCH_SCALAR:   referenceConvert(row, 3, dst, n); break;
+        case BENCH_BGRA8888: PixelConvert_BGRA8888ToRGB565(row, dst, n); break;
+        case BENCH_RGB555:   PixelConvert_RGB555ToRGB565(row, dst, n); break;
+        case BENCH_RGB565:   PixelConvert_RGB565Copy(row, dst, n); break;
+        case BENCH_PAL8:     PixelConvert_Pal8ToRGB565(row, palette, dst, n); break;
+    }
+}
+
+// 逐像素的期望值
+static uint16_t expectedPixel(int kind, const uint8_t* row, const uint16_t* palette, int x) {
+    switch (kind) {
+        case BENCH_BGR888:
+        case BENCH_SCALAR:
+            return pack565(row[3 * x + 2], row[3 * x + 1], row[3 * x]);
+        case BENCH_BGRA8888:
+            return pack565(row[4 * x + 2], row[4 * x + 1], row[4 * x]);
+        case BENCH_RGB555: {
+            uint32_t p = row[2 * x] | (row[2 * x + 1] << 8);
+            uint32_t r = (p >> 10) & 0x1F, g = (p >> 5) & 0x1F, b = p & 0x1F;
+            return (uint16_t)((r << 11) | (g << 6) | ((g >> 4) << 5) | b);
+        }
+        case BENCH_RGB565:
+            return (uint16_t)(row[2 * x] | (row[2 * x + 1] << 8));
+        default:
+            return palette[row[x]];
+    }
+}
+
+bool PixelConvert_Benchmark(uint32_t (*clockUs)(void), int width, int rows, PixelBenchResult* result) {
+    static const uint8_t bytesPerPixel[] = { 3, 3, 4, 2, 2, 1 };
+
+    // 源数据按 BMP 的 4 字节行对齐排布，大小按 32 位计算，所有内核共用
+    uint32_t stride = ((uint32_t)width * 4 + 3) & ~3u;
+    uint8_t* src = (uint8_t*)malloc((size_t)stride * rows);
+    uint16_t* dst = (uint16_t*)malloc((size_t)width * 2);
+    uint16_t* palette = (uint16_t*)malloc(256 * 2);
+    if (src == nullptr || dst == nullptr || palette == nullptr) {
+        free(src);
+        free(dst);
+        free(palette);
+        return false;
+    }
+
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < (size_t)stride * rows; i++) {
+        seed = seed * 1103515245 + 12345;
+        src[i] = (uint8_t)(seed >> 16);
+    }
+    PixelConvert_BuildPalette(src, 256, palette);
+
+    PixelBenchResult r;
+    memset(&r, 0, sizeof(r));
+    r.ok = true;
+    r.pixels = (uint32_t)width * rows;
+    float* rates[] = { &r.bgr888, &r.bgr888Scalar, &r.bgra8888, &r.rgb555, &r.rgb565, &r.pal8 };
+
+    for (int kind = 0; kind <= BENCH_PAL8; kind++) {
+        uint32_t rowBytes = ((uint32_t)width * bytesPerPixel[kind] + 3) & ~3u;
+
+        // 第一行先和参考值比对（包括行尾不足 8 个像素的部分）
+        benchRow(kind, src, palette, dst, width);
+        for (int x = 0; x < width; x++) {
+            if (dst[x] != expectedPixel(kind, src, palette, x)) {
+                r.ok = false;
+                break;
+            }
+        }
+
+        // 累加每行最后一个像素，防止编译器把结果从未被读取的转换整个优化掉
+        uint32_t t0 = clockUs();
+        for (int y = 0; y < rows; y++) {
+            benchRow(kind, src + (size_t)y * rowBytes, palette, dst, width);
+            benchSink += dst[width - 1];
+        }
+        uint32_t us = clockUs() - t0;
+        *rates[kind] = (us > 0) ? (float)r.pixels / us : 0.0f;
+    }
+
+    free(src);
+    free(dst);
+    free(palette);
+
+    if (result != nullptr) {
+        *result = r;
+    }
+    return true;
+}
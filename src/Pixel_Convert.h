@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// 像素格式转换内核（BMP / PNG 行 → RGB565）
+// 不依赖 Arduino，可在 x86 Linux 上直接编译和测速（tools/pixel_bench.cpp）。
+// 源地址 4 字节对齐时按 32 位字读取，每次处理 8 个像素；不对齐时逐字节处理，结果相同。
+// BMP 的每一行都按 4 字节对齐，只要整个像素缓冲区是 malloc 得到的，行首总是对齐的。
+// 只支持小端（ESP32-S3 与 x86 都是小端）。
+//
+// 热点全部集中在这几个函数，替换成 PIE 向量实现时调用方不用改。
+// ============================================================
+
+/**
+ * @brief BGR888（24 位 BMP）→ RGB565
+ */
+void PixelConvert_BGR888ToRGB565(const uint8_t* src, uint16_t* dst, int n);
+
+/**
+ * @brief BGRA8888 / BGRX8888（32 位 BMP）→ RGB565，忽略 alpha
+ */
+void PixelConvert_BGRA8888ToRGB565(const uint8_t* src, uint16_t* dst, int n);
+
+/**
+ * @brief X1R5G5B5（16 位 BMP 的默认格式）→ RGB565，绿色最低位复制最高位
+ */
+void PixelConvert_RGB555ToRGB565(const uint8_t* src, uint16_t* dst, int n);
+
+/**
+ * @brief RGB565（16 位 BI_BITFIELDS BMP）→ RGB565，直接复制
+ */
+void PixelConvert_RGB565Copy(const uint8_t* src, uint16_t* dst, int n);
+
+/**
+ * @brief 8 位调色板索引 → RGB565
+ * @param palette 256 项 RGB565 调色板（由 PixelConvert_BuildPalette 生成）
+ */
+void PixelConvert_Pal8ToRGB565(const uint8_t* src, const uint16_t* palette, uint16_t* dst, int n);
+
+/**
+ * @brief BMP 调色板（每项 B, G, R, 保留）→ RGB565 调色板
+ * @param count 文件中的调色板项数；不足 256 项时其余填黑色
+ */
+void PixelConvert_BuildPalette(const uint8_t* bgrx, int count, uint16_t* palette);
+
+// ------------------------------------------------------------
+// PNG（PNGdec 输出的原始行，8 位样本；16 位样本先用 PixelConvert_Narrow16 取高字节）
+// 带 alpha 的像素与背景色 bg（0xRRGGBB）混合
+// ------------------------------------------------------------
+
+/**
+ * @brief RGB888（R, G, B 顺序）→ RGB565
+ */
+void PixelConvert_RGB888ToRGB565(const uint8_t* src, uint16_t* dst, int n);
+
+/**
+ * @brief RGBA8888 → RGB565，与背景色混合（完全不透明 / 完全透明的像素不做乘法）
+ */
+void PixelConvert_RGBA8888BlendRGB565(const uint8_t* src, uint16_t* dst, int n, uint32_t bg);
+
+/**
+ * @brief 灰度 + alpha → RGB565，与背景色混合
+ */
+void PixelConvert_GrayAlphaBlendRGB565(const uint8_t* src, uint16_t* dst, int n, uint32_t bg);
+
+/**
+ * @brief 1 / 2 / 4 / 8 位索引（高位在前）→ RGB565，调色板或灰度都通过查表
+ */
+void PixelConvert_PackedToRGB565(const uint8_t* src, int bits, const uint16_t* palette, uint16_t* dst, int n);
+
+/**
+ * @brief 16 位样本（大端）→ 8 位样本，可以原地进行
+ */
+void PixelConvert_Narrow16(const uint8_t* src, uint8_t* dst, int samples);
+
+/**
+ * @brief PNG 调色板（每项 R, G, B）→ RGB565 调色板，tRNS 的 alpha 预先与背景色混合
+ * @param alpha 每项的 alpha（没有 tRNS 时传 nullptr）
+ */
+void PixelConvert_BuildPngPalette(const uint8_t* rgb, const uint8_t* alpha, int count, uint32_t bg,
+                                  uint16_t* palette);
+
+/**
+ * @brief bits 位灰度的查找表（2^bits 项）
+ */
+void PixelConvert_BuildGrayPalette(int bits, uint16_t* palette);
+
+// 微基准测试结果（Mpixel/s；ok 为 false 表示某个内核的结果与逐像素参考实现不一致）
+typedef struct {
+    bool ok;
+    uint32_t pixels;            // 每个内核转换的像素总数
+    float bgr888;
+    float bgr888Scalar;         // 旧版逐像素实现（对照）
+    float bgra8888;
+    float rgb555;
+    float rgb565;
+    float pal8;
+} PixelBenchResult;
+
+/**
+ * @brief 各内核的吞吐量测试（同时与逐像素参考实现逐项比对）
+ * @param clockUs 微秒时钟（目标板传 micros，x86 传 clock_gettime 包装）
+ * @param width   每行像素数
+ * @param rows    行数
+ * @return false 内存不足
+ */
+bool PixelConvert_Benchmark(uint32_t (*clockUs)(void), int width, int rows, PixelBenchResult* result);
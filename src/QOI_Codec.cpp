@@ -0,0 +1,221 @@
+#include "QOI_Codec.h"
+#include <string.h>
+
+#define QOI_HEADER_SIZE     14
+
+#define QOI_OP_INDEX        0x00    // 00xxxxxx
+#define QOI_OP_DIFF         0x40    // 01xxxxxx
+#define QOI_OP_LUMA         0x80    // 10xxxxxx
+#define QOI_OP_RUN          0xC0    // 11xxxxxx
+#define QOI_OP_RGB          0xFE
+#define QOI_OP_RGBA         0xFF
+#define QOI_OP_MAX_BYTES    5       // 最长的操作（QOI_OP_RGBA）
+
+// ============================================================
+// 输入
+// ============================================================
+
+/**
+ * @brief 流式：把未读完的字节移到缓冲区开头，再尽量读满
+ * @return false 没有读到新数据（内存模式总是 false）
+ */
+static bool refill(QoiDecoder* dec) {
+    if (dec->read == nullptr) {
+        return false;
+    }
+    size_t left = dec->inLen - dec->inPos;
+    memmove(dec->inBuf, dec->inBuf + dec->inPos, left);
+    dec->inPos = 0;
+    dec->inLen = left;
+
+    bool got = false;
+    while (dec->inLen < QOI_INPUT_BUF_SIZE) {
+        size_t n = dec->read(dec->user, dec->inBuf + dec->inLen, QOI_INPUT_BUF_SIZE - dec->inLen);
+        if (n == 0) {
+            break;
+        }
+        dec->inLen += n;
+        got = true;
+    }
+    return got;
+}
+
+static inline uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static QoiResult parseHeader(QoiDecoder* dec) {
+    if (dec->inLen - dec->inPos < QOI_HEADER_SIZE) {
+        return QOI_ERR_INPUT;
+    }
+    const uint8_t* h = dec->in + dec->inPos;
+    if (!QoiCodec_Probe(h, QOI_HEADER_SIZE)) {
+        return QOI_ERR_FORMAT;
+    }
+    dec->width = be32(h + 4);
+    dec->height = be32(h + 8);
+    dec->channels = h[12];
+    dec->colorspace = h[13];
+    dec->inPos += QOI_HEADER_SIZE;
+
+    if (dec->width == 0 || dec->height == 0 || dec->width > QOI_MAX_DIMENSION ||
+        dec->height > QOI_MAX_DIMENSION || (dec->channels != 3 && dec->channels != 4) || dec->colorspace > 1) {
+        return QOI_ERR_FORMAT;
+    }
+    return QOI_OK;
+}
+
+// ============================================================
+// 像素
+// ============================================================
+
+/**
+ * @brief RGBA → RGB565（alpha 不为 255 时与背景混合）
+ */
+static inline uint16_t toRgb565(uint8_t r, uint8_t g, uint8_t b, uint8_t a, uint32_t background) {
+    if (a != 255) {
+        uint32_t ia = 255 - a;
+        r = (r * a + ((background >> 16) & 0xFF) * ia + 127) / 255;
+        g = (g * a + ((background >> 8) & 0xFF) * ia + 127) / 255;
+        b = (b * a + (background & 0xFF) * ia + 127) / 255;
+    }
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+QoiResult QoiCodec_OpenMemory(QoiDecoder* dec, const uint8_t* data, size_t size, uint32_t background) {
+    dec->read = nullptr;
+    dec->user = nullptr;
+    dec->in = data;
+    dec->inLen = size;
+    dec->inPos = 0;
+    dec->background = background;
+    return parseHeader(dec);
+}
+
+QoiResult QoiCodec_OpenStream(QoiDecoder* dec, QoiReadFunc read, void* user, uint32_t background) {
+    dec->read = read;
+    dec->user = user;
+    dec->in = dec->inBuf;
+    dec->inLen = 0;
+    dec->inPos = 0;
+    dec->background = background;
+    refill(dec);
+    return parseHeader(dec);
+}
+
+QoiResult QoiCodec_Decode(QoiDecoder* dec, uint16_t* line, QoiRowFunc out) {
+    uint32_t index[64];
+    memset(index, 0, sizeof(index));
+
+    uint8_t r = 0, g = 0, b = 0, a = 255;
+    uint16_t color = toRgb565(r, g, b, a, dec->background);
+    uint32_t run = 0;
+    const uint32_t width = dec->width;
+    const uint32_t background = dec->background;
+
+    for (uint32_t y = 0; y < dec->height; y++) {
+        uint32_t x = 0;
+        while (x < width) {
+            // 游程可以跨行，一次填满本行能放下的部分
+            if (run > 0) {
+                uint32_t n = (run < width - x) ? run : width - x;
+                for (uint32_t k = 0; k < n; k++) {
+                    line[x + k] = color;
+                }
+                x += n;
+                run -= n;
+                continue;
+            }
+
+            if (dec->inLen - dec->inPos < QOI_OP_MAX_BYTES) {
+                refill(dec);
+                if (dec->inPos >= dec->inLen) {
+                    return QOI_ERR_INPUT;
+                }
+            }
+            const uint8_t* p = dec->in + dec->inPos;
+            size_t avail = dec->inLen - dec->inPos;
+            uint8_t op = p[0];
+
+            if (op == QOI_OP_RGB) {
+                if (avail < 4) {
+                    return QOI_ERR_INPUT;
+                }
+                r = p[1];
+                g = p[2];
+                b = p[3];
+                dec->inPos += 4;
+            } else if (op == QOI_OP_RGBA) {
+                if (avail < 5) {
+                    return QOI_ERR_INPUT;
+                }
+                r = p[1];
+                g = p[2];
+                b = p[3];
+                a = p[4];
+                dec->inPos += 5;
+            } else {
+                switch (op & 0xC0) {
+                    case QOI_OP_INDEX: {
+                        uint32_t v = index[op];
+                        r = v;
+                        g = v >> 8;
+                        b = v >> 16;
+                        a = v >> 24;
+                        dec->inPos += 1;
+                        break;
+                    }
+                    case QOI_OP_DIFF:
+                        r += ((op >> 4) & 3) - 2;
+                        g += ((op >> 2) & 3) - 2;
+                        b += (op & 3) - 2;
+                        dec->inPos += 1;
+                        break;
+                    case QOI_OP_LUMA: {
+                        if (avail < 2) {
+                            return QOI_ERR_INPUT;
+                        }
+                        int vg = (op & 0x3F) - 32;
+                        r += vg - 8 + ((p[1] >> 4) & 0x0F);
+                        g += vg;
+                        b += vg - 8 + (p[1] & 0x0F);
+                        dec->inPos += 2;
+                        break;
+                    }
+                    default:
+                        // 游程：重复上一个像素（它已经在颜色缓存里）
+                        run = (op & 0x3F) + 1;
+                        dec->inPos += 1;
+                        continue;
+                }
+            }
+
+            index[(r * 3 + g * 5 + b * 7 + a * 11) & 63] = r | (g << 8) | (b << 16) | ((uint32_t)a << 24);
+            color = toRgb565(r, g, b, a, background);
+            line[x++] = color;
+        }
+
+        if (!out((uint16_t)y, (uint16_t)width, line)) {
+            return QOI_ERR_ABORTED;
+        }
+    }
+    return QOI_OK;
+}
+
+bool QoiCodec_Probe(const uint8_t* header, size_t len) {
+    return len >= 4 && memcmp(header, "qoif", 4) == 0;
+}
+
+const char* QoiCodec_ResultName(QoiResult r) {
+    switch (r) {
+        case QOI_OK:            return "成功";
+        case QOI_ERR_INPUT:     return "读取失败或数据不完整";
+        case QOI_ERR_FORMAT:    return "不是 QOI 或文件头无效";
+        case QOI_ERR_ABORTED:   return "已中止";
+        default:                return "未知错误";
+    }
+}
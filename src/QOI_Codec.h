@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// QOI（Quite OK Image）解码器
+// - 单遍解码：64 项颜色缓存 + 上一个像素，没有哈夫曼表、没有 zlib 窗口
+// - 直接输出 RGB565 行；连续相同的像素（游程、缓存命中）只转换一次颜色
+// - 输入可以是整块内存，也可以是读回调（QOI_INPUT_BUF_SIZE 字节的输入缓冲区）
+// - 带 alpha 的像素与背景色混合
+// 除调用方提供的一行输出缓冲区外不分配内存；不依赖 Arduino，可直接在 x86 Linux 上编译。
+// ============================================================
+#define QOI_INPUT_BUF_SIZE      1024    // 流式输入缓冲区大小
+#define QOI_MAX_DIMENSION       8192    // 宽或高超过此值视为格式错误
+
+enum QoiResult {
+    QOI_OK = 0,
+    QOI_ERR_INPUT,          // 读取失败或数据提前结束
+    QOI_ERR_FORMAT,         // 不是 QOI 或文件头无效
+    QOI_ERR_ABORTED         // 输出回调要求中止
+};
+
+/**
+ * @brief 读回调：最多读取 len 字节，返回实际读取数，0 表示结束（与 JpegReadFunc 相同）
+ */
+typedef size_t (*QoiReadFunc)(void* user, uint8_t* buf, size_t len);
+
+/**
+ * @brief 行输出回调：第 y 行的 w 个 RGB565 像素，返回 false 中止
+ */
+typedef bool (*QoiRowFunc)(uint16_t y, uint16_t w, uint16_t* pixels);
+
+typedef struct {
+    // 输入
+    QoiReadFunc read;           // nullptr 表示内存模式
+    void* user;
+    const uint8_t* in;          // 当前输入窗口（内存模式为整块数据，流式为 inBuf）
+    size_t inLen;
+    size_t inPos;
+    uint8_t inBuf[QOI_INPUT_BUF_SIZE];
+
+    // 文件头
+    uint32_t width;
+    uint32_t height;
+    uint8_t channels;           // 3 = RGB，4 = RGBA
+    uint8_t colorspace;         // 0 = sRGB，1 = 线性（都按 sRGB 显示）
+
+    uint32_t background;        // alpha 混合的背景色（0xRRGGBB）
+} QoiDecoder;
+
+/**
+ * @brief 从内存打开（解码期间 data 必须有效）
+ */
+QoiResult QoiCodec_OpenMemory(QoiDecoder* dec, const uint8_t* data, size_t size, uint32_t background);
+
+/**
+ * @brief 从读回调打开
+ */
+QoiResult QoiCodec_OpenStream(QoiDecoder* dec, QoiReadFunc read, void* user, uint32_t background);
+
+/**
+ * @brief 自上而下解码全部像素
+ * @param line 一行的输出缓冲区（width 个像素）；回调返回后即被下一行覆盖
+ */
+QoiResult QoiCodec_Decode(QoiDecoder* dec, uint16_t* line, QoiRowFunc out);
+
+/**
+ * @brief 按文件开头识别（"qoif" 魔数）
+ */
+bool QoiCodec_Probe(const uint8_t* header, size_t len);
+
+const char* QoiCodec_ResultName(QoiResult r);
@@ -0,0 +1,272 @@
+#include "R565_Format.h"
+#include <string.h>
+
+// ============================================================
+// 文件头
+// ============================================================
+
+static inline uint16_t get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+bool R565_ParseHeader(const uint8_t* buf, R565Header* hdr) {
+    if (memcmp(buf, "R565", 4) != 0 || buf[4] != R565_VERSION) {
+        return false;
+    }
+    hdr->compression = buf[5];
+    hdr->scaleMode = buf[6];
+    hdr->orient = buf[7];
+    hdr->width = get16(buf + 8);
+    hdr->height = get16(buf + 10);
+    hdr->payloadSize = get32(buf + 12);
+    hdr->srcMtime = get32(buf + 16);
+    hdr->srcSize = get32(buf + 20);
+
+    if (hdr->width == 0 || hdr->height == 0 || hdr->compression > R565_RLE) {
+        return false;
+    }
+    if (hdr->compression == R565_RAW && hdr->payloadSize != (uint32_t)hdr->width * hdr->height * 2) {
+        return false;
+    }
+    return true;
+}
+
+void R565_WriteHeader(const R565Header* hdr, uint8_t* buf) {
+    memcpy(buf, "R565", 4);
+    buf[4] = R565_VERSION;
+    buf[5] = hdr->compression;
+    buf[6] = hdr->scaleMode;
+    buf[7] = hdr->orient;
+    put16(buf + 8, hdr->width);
+    put16(buf + 10, hdr->height);
+    put32(buf + 12, hdr->payloadSize);
+    put32(buf + 16, hdr->srcMtime);
+    put32(buf + 20, hdr->srcSize);
+}
+
+// ============================================================
+// 解码
+// ============================================================
+
+R565Result R565_Open(R565Decoder* dec, R565ReadFunc read, void* user) {
+    memset(dec, 0, sizeof(*dec));
+    dec->read = read;
+    dec->user = user;
+
+    uint8_t buf[R565_HEADER_SIZE];
+    size_t got = 0;
+    while (got < R565_HEADER_SIZE) {
+        size_t n = read(user, buf + got, R565_HEADER_SIZE - got);
+        if (n == 0) {
+            return R565_ERR_INPUT;
+        }
+        got += n;
+    }
+    return R565_ParseHeader(buf, &dec->hdr) ? R565_OK : R565_ERR_FORMAT;
+}
+
+/**
+ * 从输入缓冲区（不够时直接从回调）取 len 字节；大块数据绕过缓冲区直接读到 dst
+ */
+static bool readBytes(R565Decoder* dec, uint8_t* dst, size_t len) {
+    size_t avail = dec->inLen - dec->inPos;
+    size_t n = (len < avail) ? len : avail;
+    memcpy(dst, dec->in + dec->inPos, n);
+    dec->inPos += n;
+    dst += n;
+    len -= n;
+
+    while (len >= R565_READ_BUF_SIZE) {
+        size_t got = dec->read(dec->user, dst, len);
+        if (got == 0) {
+            return false;
+        }
+        dst += got;
+        len -= got;
+    }
+    while (len > 0) {
+        dec->inLen = dec->read(dec->user, dec->in, R565_READ_BUF_SIZE);
+        dec->inPos = 0;
+        if (dec->inLen == 0) {
+            return false;
+        }
+        n = (len < dec->inLen) ? len : dec->inLen;
+        memcpy(dst, dec->in, n);
+        dec->inPos = n;
+        dst += n;
+        len -= n;
+    }
+    return true;
+}
+
+static R565Result decodeRowRLE(R565Decoder* dec, uint16_t* dst) {
+    uint16_t w = dec->hdr.width;
+    uint16_t x = 0;
+    while (x < w) {
+        uint8_t c;
+        if (!readBytes(dec, &c, 1)) {
+            return R565_ERR_INPUT;
+        }
+        if (c < 0x80) {
+            uint16_t n = c + 1;
+            if (x + n > w) {
+                return R565_ERR_DATA;
+            }
+            if (!readBytes(dec, (uint8_t*)(dst + x), n * 2)) {
+                return R565_ERR_INPUT;
+            }
+            x += n;
+        } else {
+            uint16_t n = (c & 0x7F) + 2;
+            uint8_t p[2];
+            if (x + n > w) {
+                return R565_ERR_DATA;
+            }
+            if (!readBytes(dec, p, 2)) {
+                return R565_ERR_INPUT;
+            }
+            uint16_t v = get16(p);
+            for (uint16_t i = 0; i < n; i++) {
+                dst[x + i] = v;
+            }
+            x += n;
+        }
+    }
+    return R565_OK;
+}
+
+R565Result R565_ReadRows(R565Decoder* dec, uint16_t* dst, uint16_t rows, uint16_t stride) {
+    if (dec->row + rows > dec->hdr.height) {
+        return R565_ERR_INPUT;
+    }
+
+    uint16_t w = dec->hdr.width;
+    if (dec->hdr.compression == R565_RAW && stride == w) {
+        // 行连续：一次读完
+        if (!readBytes(dec, (uint8_t*)dst, (size_t)w * rows * 2)) {
+            return R565_ERR_INPUT;
+        }
+        dec->row += rows;
+        return R565_OK;
+    }
+
+    for (uint16_t r = 0; r < rows; r++, dst += stride) {
+        if (dec->hdr.compression == R565_RAW) {
+            if (!readBytes(dec, (uint8_t*)dst, (size_t)w * 2)) {
+                return R565_ERR_INPUT;
+            }
+        } else {
+            R565Result res = decodeRowRLE(dec, dst);
+            if (res != R565_OK) {
+                return res;
+            }
+        }
+        dec->row++;
+    }
+    return R565_OK;
+}
+
+// ============================================================
+// 编码
+// ============================================================
+
+size_t R565_EncodeRowRLE(const uint16_t* pixels, uint16_t w, uint8_t* out) {
+    uint8_t* p = out;
+    uint16_t x = 0;
+    uint16_t litStart = 0;
+
+    while (x < w) {
+        // 当前位置开始的重复长度
+        uint16_t run = 1;
+        while (x + run < w && run < 129 && pixels[x + run] == pixels[x]) {
+            run++;
+        }
+
+        // 3 个以上才值得单独成包：更短的重复放进原样包更省
+        bool emitRun = run >= 3;
+        if (emitRun || x + 1 == w || x + 1 - litStart == 128) {
+            uint16_t litEnd = emitRun ? x : x + 1;
+            while (litStart < litEnd) {
+                uint16_t n = litEnd - litStart;
+                if (n > 128) {
+                    n = 128;
+                }
+                *p++ = (uint8_t)(n - 1);
+                for (uint16_t i = 0; i < n; i++) {
+                    put16(p, pixels[litStart + i]);
+                    p += 2;
+                }
+                litStart += n;
+            }
+            if (emitRun) {
+                *p++ = (uint8_t)(0x80 | (run - 2));
+                put16(p, pixels[x]);
+                p += 2;
+                x += run;
+                litStart = x;
+                continue;
+            }
+        }
+        x++;
+    }
+    return p - out;
+}
+
+size_t R565_MaxFileSize(uint16_t w, uint16_t h) {
+    return R565_HEADER_SIZE + R565_RLE_ROW_MAX(w) * h;
+}
+
+size_t R565_Encode(const uint16_t* pixels, uint16_t w, uint16_t h, uint16_t stride,
+                   R565Header* hdr, uint8_t* out) {
+    size_t rawSize = (size_t)w * h * 2;
+    uint8_t* payload = out + R565_HEADER_SIZE;
+    hdr->width = w;
+    hdr->height = h;
+
+    size_t size = 0;
+    if (hdr->compression == R565_RLE) {
+        for (uint16_t y = 0; y < h; y++) {
+            size += R565_EncodeRowRLE(pixels + (size_t)y * stride, w, payload + size);
+        }
+        if (size >= rawSize) {
+            hdr->compression = R565_RAW;
+        }
+    }
+    if (hdr->compression != R565_RLE) {
+        hdr->compression = R565_RAW;
+        for (uint16_t y = 0; y < h; y++) {
+            memcpy(payload + (size_t)y * w * 2, pixels + (size_t)y * stride, (size_t)w * 2);
+        }
+        size = rawSize;
+    }
+
+    hdr->payloadSize = (uint32_t)size;
+    R565_WriteHeader(hdr, out);
+    return R565_HEADER_SIZE + size;
+}
+
+const char* R565_ResultName(R565Result r) {
+    switch (r) {
+        case R565_OK:           return "成功";
+        case R565_ERR_INPUT:    return "读取失败";
+        case R565_ERR_FORMAT:   return "文件头无效";
+        case R565_ERR_DATA:     return "RLE 数据损坏";
+        default:                return "未知错误";
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================
+// .r565 原始像素格式
+// 24 字节文件头 + RGB565 像素（小端，即面板的字节顺序：ST7789 的 RAMCTRL 已设为小端），
+// 按行自上而下存储，可选逐行 RLE 压缩。未压缩时显示只需一次读卡，不需要任何解码。
+// 不依赖 Arduino，x86 上的转换工具（tools/r565_convert.cpp）使用同一份代码。
+//
+// 文件头（小端）：
+//   0  "R565"
+//   4  uint8  版本（R565_VERSION）
+//   5  uint8  压缩方式（R565Compression）
+//   6  uint8  渲染时的缩放模式（ImageScaleMode；0xFF 表示原图尺寸，不是渲染好的整帧）
+//   7  uint8  渲染时的方向标记（见 Image_Orientation.h；转码缓存用于判断视角是否变化，独立文件为 0）
+//   8  uint16 宽
+//   10 uint16 高
+//   12 uint32 像素数据字节数
+//   16 uint32 源文件修改时间（转码缓存用于判断是否过期，独立文件为 0）
+//   20 uint32 源文件大小
+//
+// RLE：每行独立编码，包不跨行。控制字节 c：
+//   c < 0x80   后面 c + 1 个像素原样存储
+//   c >= 0x80  后面一个像素重复 (c & 0x7F) + 2 次
+// ============================================================
+#define R565_VERSION            1
+#define R565_HEADER_SIZE        24
+#define R565_NOT_RENDERED       0xFF    // scaleMode：原图尺寸
+#define R565_READ_BUF_SIZE      512     // RLE 解码的输入缓冲区
+
+// RLE 编码一行的最大字节数（全部为原样包时）
+#define R565_RLE_ROW_MAX(w)     ((size_t)(w) * 2 + ((size_t)(w) + 127) / 128)
+
+enum R565Compression {
+    R565_RAW = 0,
+    R565_RLE = 1
+};
+
+enum R565Result {
+    R565_OK = 0,
+    R565_ERR_INPUT,         // 读取失败或数据提前结束
+    R565_ERR_FORMAT,        // 不是 .r565 或文件头无效
+    R565_ERR_DATA           // RLE 数据损坏（超出行宽）
+};
+
+typedef struct {
+    uint8_t compression;
+    uint8_t scaleMode;
+    uint8_t orient;
+    uint16_t width;
+    uint16_t height;
+    uint32_t payloadSize;
+    uint32_t srcMtime;
+    uint32_t srcSize;
+} R565Header;
+
+/**
+ * @brief 输入回调：最多读取 len 字节到 buf，返回实际读取数（与 JpegReadFunc 相同）
+ */
+typedef size_t (*R565ReadFunc)(void* user, uint8_t* buf, size_t len);
+
+// 解码器状态（调用方分配）
+typedef struct {
+    R565Header hdr;
+    R565ReadFunc read;
+    void* user;
+    uint8_t in[R565_READ_BUF_SIZE];
+    size_t inPos, inLen;
+    uint16_t row;           // 下一个待读的行
+} R565Decoder;
+
+/**
+ * @brief 解析 / 生成文件头
+ */
+bool R565_ParseHeader(const uint8_t* buf, R565Header* hdr);
+void R565_WriteHeader(const R565Header* hdr, uint8_t* buf);
+
+/**
+ * @brief 读取文件头，准备逐行读取
+ * @details 文件头按 24 字节精确读取，未压缩时像素数据由 R565_ReadRows 直接读进目标缓冲区
+ */
+R565Result R565_Open(R565Decoder* dec, R565ReadFunc read, void* user);
+
+/**
+ * @brief 按顺序读取若干行
+ * @param stride 目标行距（像素）
+ */
+R565Result R565_ReadRows(R565Decoder* dec, uint16_t* dst, uint16_t rows, uint16_t stride);
+
+/**
+ * @brief RLE 编码一行
+ * @param out 至少 R565_RLE_ROW_MAX(w) 字节
+ * @return 编码后的字节数
+ */
+size_t R565_EncodeRowRLE(const uint16_t* pixels, uint16_t w, uint8_t* out);
+
+/**
+ * @brief 整幅编码（文件头 + 像素数据）的最大字节数
+ */
+size_t R565_MaxFileSize(uint16_t w, uint16_t h);
+
+/**
+ * @brief 编码整幅图片
+ * @param hdr 输入 compression / scaleMode / srcMtime / srcSize；
+ *            compression 为 R565_RLE 时若压缩后不比原始数据小则改存原始数据
+ * @param out 至少 R565_MaxFileSize(w, h) 字节
+ * @return 文件总字节数
+ */
+size_t R565_Encode(const uint16_t* pixels, uint16_t w, uint16_t h, uint16_t stride,
+                   R565Header* hdr, uint8_t* out);
+
+const char* R565_ResultName(R565Result r);
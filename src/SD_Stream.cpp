@@ -0,0 +1,191 @@
+#include "SD_Stream.h"
+#include "Image_Metrics.h"
+#include <FS.h>
+#include <SD_MMC.h>
+#include <esp_heap_caps.h>
+
+// 环形缓冲区：读卡任务写、解码任务读，两个计数信号量交接块的所有权
+static uint8_t* chunkBuf[SD_STREAM_CHUNKS] = { nullptr };
+static size_t chunkLen[SD_STREAM_CHUNKS];          // 0 表示文件结束
+static SemaphoreHandle_t freeSem = NULL;           // 空闲块数
+static SemaphoreHandle_t fullSem = NULL;           // 已读好的块数
+static SemaphoreHandle_t doneSem = NULL;           // 读卡任务已停止
+static TaskHandle_t streamTask = NULL;
+
+static File streamFile;
+static volatile bool stopFlag = false;
+static bool streamOpen = false;
+
+// 读取端状态（只在解码任务中访问）
+static uint8_t readIndex = 0;
+static size_t readPos = 0;
+static bool haveChunk = false;
+static bool atEnd = false;
+
+static SdStreamStats stats = { 0 };
+
+// ============================================================
+// 读卡任务
+// ============================================================
+
+static void StreamTask(void *parameter) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        uint8_t writeIndex = 0;
+        while (1) {
+            xSemaphoreTake(freeSem, portMAX_DELAY);
+            if (stopFlag) {
+                break;
+            }
+
+            uint32_t t0 = micros();
+            size_t n = streamFile.read(chunkBuf[writeIndex], SD_STREAM_CHUNK_SIZE);
+            stats.readUs += micros() - t0;
+            chunkLen[writeIndex] = n;
+            writeIndex = (writeIndex + 1) % SD_STREAM_CHUNKS;
+            stats.chunks++;
+            xSemaphoreGive(fullSem);
+
+            if (n == 0) {
+                break;      // 文件结束或读取失败：空块就是结束标记
+            }
+        }
+        xSemaphoreGive(doneSem);
+    }
+}
+
+// ============================================================
+// 对外接口
+// ============================================================
+
+bool SdStream_Init(void) {
+    if (streamTask != NULL) {
+        return true;
+    }
+
+    // 块缓冲区优先放内部 DMA 内存，SDMMC 可以直接写入，不经过驱动的中转缓冲
+    for (int i = 0; i < SD_STREAM_CHUNKS; i++) {
+        chunkBuf[i] = (uint8_t*)heap_caps_malloc(SD_STREAM_CHUNK_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (chunkBuf[i] == nullptr) {
+            chunkBuf[i] = (uint8_t*)heap_caps_malloc(SD_STREAM_CHUNK_SIZE, MALLOC_CAP_SPIRAM);
+        }
+        if (chunkBuf[i] == nullptr) {
+            Serial.println("✗ 流式读取缓冲区分配失败");
+            for (int j = 0; j <= i; j++) {
+                free(chunkBuf[j]);
+                chunkBuf[j] = nullptr;
+            }
+            return false;
+        }
+    }
+
+    freeSem = xSemaphoreCreateCounting(SD_STREAM_CHUNKS, SD_STREAM_CHUNKS);
+    fullSem = xSemaphoreCreateCounting(SD_STREAM_CHUNKS, 0);
+    doneSem = xSemaphoreCreateBinary();
+    if (freeSem == NULL || fullSem == NULL || doneSem == NULL) {
+        Serial.println("✗ 流式读取信号量创建失败");
+        return false;
+    }
+
+    xTaskCreatePinnedToCore(StreamTask, "SD_Stream", SD_STREAM_TASK_STACK, NULL,
+                            SD_STREAM_TASK_PRIO, &streamTask, SD_STREAM_TASK_CORE);
+    Serial.printf("✓ SD 流式读取已启动（%d × %d 字节）\n", SD_STREAM_CHUNKS, SD_STREAM_CHUNK_SIZE);
+    return streamTask != NULL;
+}
+
+bool SdStream_Open(const char* path, size_t* size) {
+    if (streamTask == NULL || streamOpen || path == nullptr) {
+        return false;
+    }
+
+    uint32_t t0 = micros();
+    streamFile = SD_MMC.open(path, FILE_READ);
+    ImageMetrics_AddOpen(micros() - t0);
+    if (!streamFile) {
+        Serial.printf("✗ 无法打开文件: %s\n", path);
+        return false;
+    }
+    if (size != nullptr) {
+        *size = streamFile.size();
+    }
+
+    // 复位信号量：全部块空闲，没有已读好的块
+    while (xSemaphoreTake(fullSem, 0) == pdTRUE) {
+    }
+    while (xSemaphoreTake(freeSem, 0) == pdTRUE) {
+    }
+    for (int i = 0; i < SD_STREAM_CHUNKS; i++) {
+        xSemaphoreGive(freeSem);
+    }
+
+    readIndex = 0;
+    readPos = 0;
+    haveChunk = false;
+    atEnd = false;
+    memset(&stats, 0, sizeof(stats));
+    stopFlag = false;
+    streamOpen = true;
+
+    xTaskNotifyGive(streamTask);
+    return true;
+}
+
+size_t SdStream_Read(void* user, uint8_t* buf, size_t len) {
+    size_t done = 0;
+    while (done < len && streamOpen && !atEnd) {
+        if (!haveChunk) {
+            if (xSemaphoreTake(fullSem, 0) != pdTRUE) {
+                // 解码比读卡快：缓冲区读空了
+                uint32_t t0 = micros();
+                xSemaphoreTake(fullSem, portMAX_DELAY);
+                stats.stalls++;
+                stats.stallUs += micros() - t0;
+            }
+            if (chunkLen[readIndex] == 0) {
+                atEnd = true;
+                break;
+            }
+            haveChunk = true;
+            readPos = 0;
+        }
+
+        size_t avail = chunkLen[readIndex] - readPos;
+        size_t n = (len - done) < avail ? (len - done) : avail;
+        memcpy(buf + done, chunkBuf[readIndex] + readPos, n);
+        done += n;
+        readPos += n;
+
+        // 整块读完，还给读卡任务
+        if (readPos == chunkLen[readIndex]) {
+            haveChunk = false;
+            readIndex = (readIndex + 1) % SD_STREAM_CHUNKS;
+            xSemaphoreGive(freeSem);
+        }
+    }
+    stats.bytes += done;
+    return done;
+}
+
+void SdStream_Close(void) {
+    if (!streamOpen) {
+        return;
+    }
+
+    // 读卡任务可能正等着空闲块：多给一个让它醒来看到 stopFlag（计数已满时 Give 失败也无妨）
+    stopFlag = true;
+    xSemaphoreGive(freeSem);
+    xSemaphoreTake(doneSem, portMAX_DELAY);
+
+    streamFile.close();
+    streamOpen = false;
+
+    // 读卡任务已停止，统计不会再变；解码流程只在缓冲区读空时等待 SD 卡
+    ImageMetrics_AddRead(stats.bytes, stats.readUs, stats.stallUs);
+}
+
+void SdStream_GetStats(SdStreamStats* out) {
+    if (out != nullptr) {
+        *out = stats;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================
+// SD 卡流式读取（环形缓冲区 + 后台读卡任务）
+// 读卡任务按块把文件读进环形缓冲区，解码器同时从另一端取数据，
+// SD 卡 DMA 等待与解码计算重叠，不需要把整个文件读进 PSRAM。
+// 同一时间只有一个流；调用方须在 Open 到 Close 期间持有 sdCardMutex。
+// ============================================================
+#define SD_STREAM_CHUNK_SIZE    4096    // 每次读卡的字节数
+#define SD_STREAM_CHUNKS        4       // 环形缓冲区块数（共 16 KB，内部 RAM）
+#define SD_STREAM_TASK_CORE     0
+#define SD_STREAM_TASK_PRIO     3       // 高于预取任务：读卡大部分时间在等 DMA，不占 CPU
+#define SD_STREAM_TASK_STACK    4096
+
+// 最近一次流的统计
+typedef struct {
+    uint32_t bytes;         // 已交给解码器的字节数
+    uint32_t chunks;        // 读卡次数
+    uint32_t readUs;        // 读卡任务读卡的总时间（与解码重叠）
+    uint32_t stalls;        // 解码器等数据的次数（缓冲区被读空）
+    uint32_t stallUs;       // 解码器等数据的总时间
+} SdStreamStats;
+
+/**
+ * @brief 分配环形缓冲区并创建读卡任务
+ * @return false 内存不足（调用方改用整文件读取）
+ */
+bool SdStream_Init(void);
+
+/**
+ * @brief 打开文件并立即开始预读
+ * @param size 输出文件大小（可为 nullptr）
+ * @return false 未初始化、已有流在使用或文件无法打开
+ */
+bool SdStream_Open(const char* path, size_t* size);
+
+/**
+ * @brief 读取数据，缓冲区为空时阻塞等待读卡任务
+ * @return 实际读取字节数，0 表示文件结束或读取失败
+ * @details 参数与 JpegReadFunc 相同，user 未使用
+ */
+size_t SdStream_Read(void* user, uint8_t* buf, size_t len);
+
+/**
+ * @brief 停止预读并关闭文件（未读完也可以调用）
+ */
+void SdStream_Close(void);
+
+/**
+ * @brief 最近一次流的统计（Close 之后仍然有效）
+ */
+void SdStream_GetStats(SdStreamStats* stats);
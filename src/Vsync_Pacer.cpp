@@ -0,0 +1,103 @@
+#include "Vsync_Pacer.h"
+#include <string.h>
+
+void VsyncPacer_Init(VsyncPacer* p, uint32_t nominalUs, uint32_t nowUs) {
+    memset(p, 0, sizeof(*p));
+    p->nominalUs = nominalUs;
+    p->periodUs = nominalUs;
+    p->lastTeUs = nowUs;
+}
+
+// ============================================================
+// 周期估计
+// ============================================================
+
+void VsyncPacer_Update(VsyncPacer* p, uint32_t edgeUs, uint32_t edgeCount) {
+    uint32_t n = edgeCount - p->lastEdges;
+    if (n == 0) {
+        return;
+    }
+    if (p->edges == 0) {
+        // 第一个边沿只确定相位
+        p->lastTeUs = edgeUs;
+        p->lastEdges = edgeCount;
+        p->edges = n;
+        return;
+    }
+
+    uint32_t dt = edgeUs - p->lastTeUs;
+    uint32_t periods = (dt + p->periodUs / 2) / p->periodUs;
+    if (periods > n) {
+        // 经过的周期比收到的边沿多：中间的边沿丢了（中断被屏蔽、TE 信号受干扰）
+        p->missedTe += periods - n;
+    } else {
+        periods = n;
+    }
+    uint32_t sample = dt / periods;
+
+    if (!p->locked) {
+        p->periodUs = sample;
+        p->locked = true;
+    } else if (sample + p->periodUs / 4 >= p->periodUs && sample <= p->periodUs + p->periodUs / 4) {
+        // 偏离超过 1/4 的样本视为毛刺，不参与平均
+        int32_t diff = (int32_t)(sample - p->periodUs);
+        p->periodUs += diff / (1 << VSYNC_PERIOD_SHIFT);
+    }
+
+    p->lastTeUs = edgeUs;
+    p->lastEdges = edgeCount;
+    p->edges += n;
+}
+
+uint32_t VsyncPacer_RefreshCentiHz(const VsyncPacer* p) {
+    return p->periodUs > 0 ? 100000000u / p->periodUs : 0;
+}
+
+// ============================================================
+// 排期
+// ============================================================
+
+bool VsyncPacer_Window(const VsyncPacer* p, uint32_t transferUs, uint32_t* lo, uint32_t* hi) {
+    uint32_t t = p->periodUs;
+    if (transferUs > 2 * t) {
+        *lo = 0;
+        *hi = 0;
+        return false;
+    }
+    // 写入落后于本次扫描（t − D 之后开始），且在下一次扫描到达前写完（2t − D 之前开始）
+    uint32_t a = transferUs < t ? t - transferUs : 0;
+    uint32_t b = transferUs < t ? t : 2 * t - transferUs;
+    uint32_t guard = t / VSYNC_GUARD_DIV;
+    if (b - a > 2 * guard) {
+        a += guard;
+        b -= guard;
+    } else {
+        a = b = (a + b) / 2;
+    }
+    *lo = a;
+    *hi = b;
+    return true;
+}
+
+uint32_t VsyncPacer_Schedule(VsyncPacer* p, uint32_t nowUs, uint32_t transferUs) {
+    p->presents++;
+    uint32_t lo, hi;
+    if (!VsyncPacer_Window(p, transferUs, &lo, &hi)) {
+        p->unavoidable++;
+    }
+
+    // 按估计的周期从最近一次边沿向后推算当前相位
+    uint32_t t = p->periodUs;
+    uint32_t phase = (nowUs - p->lastTeUs) % t;
+    uint32_t wait;
+    if (phase < lo) {
+        wait = lo - phase;
+    } else if (phase <= hi) {
+        wait = 0;
+    } else {
+        wait = t - phase + lo;
+        p->slipped++;
+    }
+    p->waitUs += wait;
+    return wait;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================
+// 垂直同步节拍：按面板 TE（撕裂效应）信号决定整帧写屏的起始时刻
+// 面板每个刷新周期 T 从第 0 行扫描到最后一行，TE 边沿标记扫描开始。整帧写屏耗时 D，写入位置同样从上到下移动：
+// - 写入一直落后于本次扫描、又领先于下一次扫描时不会撕裂，起始时刻（相对 TE）的可行区间为
+//   [max(0, T − D), min(T, 2T − D)]；D > 2T 时无法避免撕裂，退而在 TE 时开始
+// - 两端各留 guard 的余量，吸收中断延迟和 D 的估计误差
+// TE 周期由边沿时间估计（指数平均），相邻两次更新之间间隔超过 1.5 个周期时把缺少的边沿记为丢失。
+// 没有 TE 信号时以标称周期自由运行：只能把整帧写屏间隔到每个刷新周期一次，不能保证不撕裂。
+// 不依赖 Arduino，可直接在 x86 Linux 上编译（tools/vsync_sim.cpp 用模拟的 TE 时钟检查撕裂）。
+// ============================================================
+#define VSYNC_PERIOD_SHIFT      3       // 周期估计的平滑系数：新值占 1/8
+#define VSYNC_GUARD_DIV         16      // 起始区间两端的余量：周期的 1/16
+
+typedef struct {
+    uint32_t nominalUs;     // 标称周期（没有 TE 信号或尚未锁定时使用）
+    uint32_t periodUs;      // 估计的周期
+    uint32_t lastTeUs;      // 最近一次 TE 边沿的时间
+    uint32_t lastEdges;     // 最近一次更新时的边沿计数
+    uint32_t edges;         // 已处理的边沿数
+    uint32_t missedTe;      // 估计丢失的 TE 边沿数
+    uint32_t presents;      // 排期的整帧写屏次数
+    uint32_t slipped;       // 错过当前刷新周期的起始区间、顺延到下一个周期的次数
+    uint32_t unavoidable;   // 写屏耗时超过两个周期、无法避免撕裂的次数
+    uint64_t waitUs;        // 累计等待时间
+    bool locked;            // 已由 TE 边沿估计出周期与相位
+} VsyncPacer;
+
+/**
+ * @brief 初始化；没有 TE 信号时相位从 nowUs 开始自由运行
+ */
+void VsyncPacer_Init(VsyncPacer* p, uint32_t nominalUs, uint32_t nowUs);
+
+/**
+ * @brief 用 TE 中断记录的最近一次边沿时间与累计边沿数更新周期和相位（在任务中调用）
+ * @details 两次更新之间可能有多个边沿，按经过的时间与边沿数求平均周期；边沿数少于经过的周期数时记为丢失
+ */
+void VsyncPacer_Update(VsyncPacer* p, uint32_t edgeUs, uint32_t edgeCount);
+
+/**
+ * @brief 写屏耗时 transferUs 时相对 TE 的起始区间 [*lo, *hi]（已扣除余量）
+ * @return false 写屏耗时超过两个周期，无法避免撕裂（区间退化为 TE 时刻）
+ */
+bool VsyncPacer_Window(const VsyncPacer* p, uint32_t transferUs, uint32_t* lo, uint32_t* hi);
+
+/**
+ * @brief 为一次整帧写屏排期：返回从 nowUs 起需要等待的微秒数，并更新统计
+ * @details 当前相位已过起始区间时顺延到下一个周期的区间（记为 slipped）
+ */
+uint32_t VsyncPacer_Schedule(VsyncPacer* p, uint32_t nowUs, uint32_t transferUs);
+
+/**
+ * @brief 估计的刷新率（Hz × 100）
+ */
+uint32_t VsyncPacer_RefreshCentiHz(const VsyncPacer* p);
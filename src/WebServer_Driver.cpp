@@ -1,17 +1,45 @@
 #include "WebServer_Driver.h"
 #include "LED_Driver.h"
 #include "ColorTemp_Filter.h"
+#include "Frame_Cache.h"
+#include "Image_Prefetch.h"
+#include "Image_Transcode.h"
+#include "Image_Registry.h"
+#include "Image_Decoder.h"
+#include "MJPEG_Player.h"
+#include "Image_Metrics.h"
+#include "LVGL_Driver.h"
+#include "Log_Ring.h"
 #include <ArduinoJson.h>
+#include <esp_heap_caps.h>
 
 // 全局对象
 AsyncWebServer server(80);
 Preferences preferences;             // NVS 存储
 SemaphoreHandle_t sdCardMutex = NULL;
 char currentDisplayFile[100] = "";
+char benchmarkFile[100] = "";
+uint8_t benchmarkIterations = 3;
+char animCheckFile[100] = "";
+char qoiBenchFile[100] = "";
+uint8_t qoiBenchIterations = 3;
+char scaleModeFile[100] = "";
+volatile int scaleModeRequest = -1;
+volatile bool pixelBenchRequest = false;
+volatile bool lcdBenchRequest = false;
+uint8_t lcdBenchIterations = 5;
+volatile bool lvglBenchRequest = false;
+uint32_t lvglBenchMs = 5000;
+volatile int vsyncRequest = -1;
+volatile int rotationRequest = -1;
+volatile int exifRequest = -1;
+volatile int transitionRequest = -1;
+volatile int transitionMsRequest = -1;
 
 // 播放列表相关
 std::vector<String> customPlaylist;  // 自定义播放列表
 bool useCustomPlaylist = false;      // 是否使用自定义播放列表
+volatile bool playlistChanged = false; // 播放列表被修改
 
 // WiFi 状态
 bool isAPMode = false;               // 是否处于 AP 模式
@@ -413,9 +441,16 @@ const char index_html[] PROGMEM = R"rawliteral(
                 <div class="upload-area" id="uploadArea">
                     <p style="font-size: 3em; margin-bottom: 10px;">📁</p>
                     <p style="font-size: 1.2em; margin-bottom: 10px;">拖拽图片到此处或点击选择</p>
-                    <p style="color: #718096;">支持任意图片格式 (自动转换为 240x320 JPEG)</p>
-                    <input type="file" id="fileInput" accept="image/*" multiple>
+                    <p style="color: #718096;">支持任意图片格式 (自动转换为 240x320 JPEG 或 QOI)</p>
+                    <input type="file" id="fileInput" accept="image/*,.r565,.avi,.mjpeg,.mjpg,.qoi" multiple>
                 </div>
+                <p style="margin-top: 10px;">
+                    转换格式:
+                    <select id="uploadFormat">
+                        <option value="jpeg" selected>JPEG（有损，文件小）</option>
+                        <option value="qoi">QOI（无损，解码快）</option>
+                    </select>
+                </p>
                 <div class="progress-bar" id="progressBar">
                     <div class="progress-fill" id="progressFill">0%</div>
                 </div>
@@ -511,6 +546,17 @@ const char index_html[] PROGMEM = R"rawliteral(
         // 处理文件上传 (Canvas 预处理版本)
         async function handleFiles(files) {
             for (let file of files) {
+                // GIF 与 MJPEG 片段原样上传（转成 JPEG 会丢掉动画），.r565 / .qoi 已经是设备格式
+                const name = file.name.toLowerCase();
+                if (file.type === 'image/gif' || /\.(gif|r565|avi|mjpe?g|qoi)$/.test(name)) {
+                    try {
+                        await uploadFile(file);
+                    } catch (error) {
+                        showStatus('上传失败: ' + error.message, 'error');
+                    }
+                    continue;
+                }
+
                 if (!file.type.match('image/')) {
                     showStatus('仅支持图片格式', 'error');
                     continue;
@@ -526,7 +572,63 @@ const char index_html[] PROGMEM = R"rawliteral(
             }
         }
         
-        // 图片预处理：缩放到 240x320 并转换为 Baseline JPEG
+        // QOI 编码（3 通道 RGB：画布已填充黑色背景，没有透明像素）
+        function encodeQOI(rgba, width, height) {
+            const out = new Uint8Array(14 + width * height * 4 + 8);
+            const index = new Int16Array(64 * 3).fill(-1);   // 解码端的缓存初始为透明黑，这里不能当作命中
+            let p = 0;
+            const put32 = (v) => {
+                out[p++] = (v >>> 24) & 0xFF; out[p++] = (v >>> 16) & 0xFF;
+                out[p++] = (v >>> 8) & 0xFF; out[p++] = v & 0xFF;
+            };
+            out.set([0x71, 0x6F, 0x69, 0x66], 0);   // "qoif"
+            p = 4;
+            put32(width);
+            put32(height);
+            out[p++] = 3;   // 通道数
+            out[p++] = 0;   // sRGB
+            
+            let pr = 0, pg = 0, pb = 0, run = 0;
+            const last = width * height * 4 - 4;
+            for (let i = 0; i <= last; i += 4) {
+                const r = rgba[i], g = rgba[i + 1], b = rgba[i + 2];
+                if (r === pr && g === pg && b === pb) {
+                    run++;
+                    if (run === 62 || i === last) {
+                        out[p++] = 0xC0 | (run - 1);
+                        run = 0;
+                    }
+                    continue;
+                }
+                if (run > 0) {
+                    out[p++] = 0xC0 | (run - 1);
+                    run = 0;
+                }
+                const h = ((r * 3 + g * 5 + b * 7 + 255 * 11) & 63) * 3;
+                if (index[h] === r && index[h + 1] === g && index[h + 2] === b) {
+                    out[p++] = h / 3;
+                } else {
+                    index[h] = r; index[h + 1] = g; index[h + 2] = b;
+                    const dr = ((r - pr + 384) & 255) - 128;
+                    const dg = ((g - pg + 384) & 255) - 128;
+                    const db = ((b - pb + 384) & 255) - 128;
+                    const drg = dr - dg, dbg = db - dg;
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        out[p++] = 0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2);
+                    } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                        out[p++] = 0x80 | (dg + 32);
+                        out[p++] = ((drg + 8) << 4) | (dbg + 8);
+                    } else {
+                        out[p++] = 0xFE; out[p++] = r; out[p++] = g; out[p++] = b;
+                    }
+                }
+                pr = r; pg = g; pb = b;
+            }
+            out.set([0, 0, 0, 0, 0, 0, 0, 1], p);   // 结束标记
+            return out.slice(0, p + 8);
+        }
+        
+        // 图片预处理：缩放到 240x320 并转换为 Baseline JPEG（或 QOI）
         async function preprocessImage(file) {
             return new Promise((resolve, reject) => {
                 const reader = new FileReader();
@@ -574,6 +676,19 @@ const char index_html[] PROGMEM = R"rawliteral(
                         // 绘制图片
                         ctx.drawImage(img, offsetX, offsetY, drawWidth, drawHeight);
                         
+                        // 无损 QOI：直接编码画布像素
+                        if (document.getElementById('uploadFormat').value === 'qoi') {
+                            const pixels = ctx.getImageData(0, 0, targetWidth, targetHeight).data;
+                            const qoi = encodeQOI(pixels, targetWidth, targetHeight);
+                            const newFilename = file.name.replace(/\.[^.]+$/, '.qoi');
+                            console.log(`图片预处理完成: ${file.name} -> ${newFilename} (${(qoi.length / 1024).toFixed(2)} KB)`);
+                            resolve(new File([qoi], newFilename, {
+                                type: 'application/octet-stream',
+                                lastModified: Date.now()
+                            }));
+                            return;
+                        }
+                        
                         // 转换为 Baseline JPEG (质量 0.85)
                         canvas.toBlob((blob) => {
                             if (!blob) {
@@ -985,7 +1100,51 @@ void WebServer_Init() {
         json += "\"sta_ip\":\"" + staIP + "\",";
         json += "\"connected\":" + String(connected ? "true" : "false") + ",";
         json += "\"ap_mode\":" + String(isAPMode ? "true" : "false") + ",";
-        json += "\"ap_ip\":\"" + WiFi.softAPIP().toString() + "\"";
+        json += "\"ap_ip\":\"" + WiFi.softAPIP().toString() + "\",";
+        
+        // 帧缓存统计
+        FrameCacheStats cache;
+        FrameCache_GetStats(&cache);
+        json += "\"cache\":{";
+        json += "\"hits\":" + String(cache.hits) + ",";
+        json += "\"misses\":" + String(cache.misses) + ",";
+        json += "\"evictions\":" + String(cache.evictions) + ",";
+        json += "\"entries\":" + String(cache.entries) + ",";
+        json += "\"bytes_used\":" + String(cache.bytesUsed) + ",";
+        json += "\"bytes_limit\":" + String(cache.bytesLimit);
+        json += "},";
+        
+        // 后台预解码统计
+        PrefetchStats prefetch;
+        Prefetch_GetStats(&prefetch);
+        json += "\"prefetch\":{";
+        json += "\"prepared\":" + String(prefetch.prepared) + ",";
+        json += "\"used\":" + String(prefetch.used) + ",";
+        json += "\"cancelled\":" + String(prefetch.cancelled);
+        json += "}";
+        
+        // MJPEG 播放统计（正在播放或最近一次播放）
+        MjpegPlaybackStats mjpeg;
+        if (MjpegPlayer_GetStats(&mjpeg)) {
+            json += ",\"mjpeg\":{";
+            json += "\"playing\":" + String(mjpeg.playing ? "true" : "false") + ",";
+            json += "\"container\":\"" + String(mjpeg.avi ? "avi" : "mjpeg") + "\",";
+            json += "\"width\":" + String(mjpeg.width) + ",";
+            json += "\"height\":" + String(mjpeg.height) + ",";
+            json += "\"target_fps\":" + String(mjpeg.frameUs > 0 ? 1000000.0f / mjpeg.frameUs : 0.0f, 2) + ",";
+            json += "\"fps\":" + String(mjpeg.fps, 2) + ",";
+            json += "\"shown\":" + String(mjpeg.framesShown) + ",";
+            json += "\"dropped\":" + String(mjpeg.framesDropped) + ",";
+            json += "\"bad\":" + String(mjpeg.framesBad) + ",";
+            json += "\"stalls\":" + String(mjpeg.stalls) + ",";
+            json += "\"resyncs\":" + String(mjpeg.resyncs) + ",";
+            json += "\"loops\":" + String(mjpeg.loops) + ",";
+            json += "\"avg_decode_ms\":" + String(mjpeg.avgDecodeUs / 1000.0f, 2) + ",";
+            json += "\"max_decode_ms\":" + String(mjpeg.maxDecodeUs / 1000.0f, 2) + ",";
+            json += "\"avg_late_ms\":" + String(mjpeg.avgLateUs / 1000.0f, 2) + ",";
+            json += "\"max_late_ms\":" + String(mjpeg.maxLateUs / 1000.0f, 2);
+            json += "}";
+        }
         
         json += "}";
         
@@ -1044,7 +1203,7 @@ void WebServer_Init() {
         [](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
             // 开始上传
             if (index == 0) {
-                Serial.printf("\n--- 开始上传文件: %s ---\n", filename.c_str());
+                LOG_D("开始上传文件: %s\n", filename.c_str());
                 uploadFilename = filename;
                 uploadedBytes = 0;
                 
@@ -1054,13 +1213,13 @@ void WebServer_Init() {
                     uploadFile = SD_MMC.open(filepath.c_str(), FILE_WRITE);
                     
                     if (!uploadFile) {
-                        Serial.println("✗ 无法创建临时文件");
+                        LOG_E("✗ 上传: 无法创建临时文件 %s\n", filepath.c_str());
                         xSemaphoreGive(sdCardMutex);
                         request->send(500, "application/json", "{\"success\":false,\"message\":\"无法创建文件\"}");
                         return;
                     }
                 } else {
-                    Serial.println("✗ 无法获取 SD 卡锁");
+                    LOG_E("✗ 上传: 无法获取 SD 卡锁\n");
                     request->send(503, "application/json", "{\"success\":false,\"message\":\"SD 卡忙\"}");
                     return;
                 }
@@ -1073,7 +1232,7 @@ void WebServer_Init() {
                 
                 // 每 100KB 打印一次进度
                 if (uploadedBytes % 102400 < len) {
-                    Serial.printf("  已上传: %d KB\n", uploadedBytes / 1024);
+                    LOG_D("  已上传: %u KB\n", (unsigned)(uploadedBytes / 1024));
                 }
             }
             
@@ -1093,13 +1252,19 @@ void WebServer_Init() {
                     
                     // 重命名
                     SD_MMC.rename(tempPath.c_str(), finalPath.c_str());
+                    FrameCache_Invalidate(finalPath.c_str());
                     
                     xSemaphoreGive(sdCardMutex);
                     
-                    Serial.printf("✓ 上传完成: %s (%d 字节)\n", filename.c_str(), uploadedBytes);
+                    LOG_I("✓ 上传完成: %s (%u 字节)\n", filename.c_str(), (unsigned)uploadedBytes);
+                    
+#if R565_TRANSCODE_ON_UPLOAD
+                    // 后台转码为 .r565，之后显示时不再解码
+                    Transcode_Request(finalPath.c_str());
+#endif
                 } else {
                     xSemaphoreGive(sdCardMutex);
-                    Serial.println("✗ 上传失败");
+                    LOG_E("✗ 上传失败: %s\n", filename.c_str());
                 }
             }
         }
@@ -1133,6 +1298,503 @@ void WebServer_Init() {
         }
     });
     
+    // JPEG 解码基准测试：带 file 参数时排队执行，不带参数时返回最近一次结果
+    server.on("/benchmark", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("file")) {
+            String filepath = String(UPLOAD_DIR) + "/" + request->getParam("file")->value();
+            int n = request->hasParam("n") ? request->getParam("n")->value().toInt() : 3;
+            benchmarkIterations = (uint8_t)constrain(n, 1, 20);
+            strncpy(benchmarkFile, filepath.c_str(), sizeof(benchmarkFile) - 1);
+            request->send(200, "application/json", "{\"success\":true,\"queued\":true}");
+            return;
+        }
+        
+        JpegBenchResult r;
+        if (!getLastJpegBenchmark(&r)) {
+            request->send(404, "application/json", "{\"success\":false,\"message\":\"尚无测试结果\"}");
+            return;
+        }
+        
+        String json = "{\"success\":true,";
+        json += "\"width\":" + String(r.width) + ",";
+        json += "\"height\":" + String(r.height) + ",";
+        json += "\"mcus\":" + String(r.mcus) + ",";
+        json += "\"iterations\":" + String(r.iterations) + ",";
+        json += "\"native_cycles_per_mcu\":" + String(r.nativeCycles) + ",";
+        json += "\"entropy_cycles_per_mcu\":" + String(r.entropyCycles) + ",";
+        json += "\"idct_cycles_per_mcu\":" + String(r.idctCycles) + ",";
+        json += "\"color_cycles_per_mcu\":" + String(r.colorCycles) + ",";
+        json += "\"tjpgdec_cycles_per_mcu\":" + String(r.tjpgdecCycles) + ",";
+        json += "\"whole_first_pixel_us\":" + String(r.wholeFirstPixelUs) + ",";
+        json += "\"whole_total_us\":" + String(r.wholeTotalUs) + ",";
+        json += "\"stream_first_pixel_us\":" + String(r.streamFirstPixelUs) + ",";
+        json += "\"stream_total_us\":" + String(r.streamTotalUs);
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // 缩放模式：/scale?mode=fit|fill|center 修改全局默认，带 file 时只修改这张图片（mode=default 恢复跟随全局）
+    // 不带 mode 时返回当前设置
+    server.on("/scale", HTTP_GET, [](AsyncWebServerRequest *request) {
+        String filepath = "";
+        if (request->hasParam("file")) {
+            filepath = String(UPLOAD_DIR) + "/" + request->getParam("file")->value();
+        }
+        
+        if (!request->hasParam("mode")) {
+            String json = "{\"success\":true,\"default\":\"";
+            json += ImageScaler_ModeName(getImageScaleMode());
+            json += "\"";
+            if (filepath.length() > 0) {
+                json += ",\"mode\":\"";
+                json += ImageScaler_ModeName(getImageScaleModeFor(filepath.c_str()));
+                json += "\"";
+            }
+            json += "}";
+            request->send(200, "application/json", json);
+            return;
+        }
+        
+        ImageScaleMode mode;
+        String name = request->getParam("mode")->value();
+        if (!ImageScaler_ParseMode(name.c_str(), &mode) ||
+            (mode == IMG_SCALE_DEFAULT && filepath.length() == 0)) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"无效的缩放模式\"}");
+            return;
+        }
+        
+        // 修改会作废缓存并重新渲染，放到 loop 中执行
+        strncpy(scaleModeFile, filepath.c_str(), sizeof(scaleModeFile) - 1);
+        scaleModeRequest = mode;
+        request->send(200, "application/json", "{\"success\":true}");
+    });
+    
+    // 显示方向：/rotation?mode=0|90|180|270|auto|imu&exif=0|1（两个参数都可省略），
+    // 不带参数时返回当前设置
+    server.on("/rotation", HTTP_GET, [](AsyncWebServerRequest *request) {
+        int mode = -1, exif = -1;
+        if (request->hasParam("mode")) {
+            ImageRotationMode m;
+            if (!parseImageRotationMode(request->getParam("mode")->value().c_str(), &m)) {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"无效的显示方向\"}");
+                return;
+            }
+            mode = m;
+        }
+        if (request->hasParam("exif")) {
+            exif = request->getParam("exif")->value().toInt() != 0 ? 1 : 0;
+        }
+        
+        if (mode >= 0 || exif >= 0) {
+            // 修改后要重新渲染当前图片，放到 loop 中执行
+            exifRequest = exif;
+            rotationRequest = mode;
+            request->send(200, "application/json", "{\"success\":true}");
+            return;
+        }
+        
+        String json = "{\"success\":true";
+        json += ",\"mode\":\"" + String(getImageRotationModeName(getImageRotationMode())) + "\"";
+        json += ",\"exif\":" + String(getImageExifOrientation() ? "true" : "false");
+        json += ",\"device_turns\":" + String(getImageDeviceTurns());
+        json += ",\"lcd\":\"" + String(ImageOrient_Name(LCD_GetOrientation())) + "\"";
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // 切换过渡：/transition?type=cut|fade|wipe|slide&ms=400（两个参数都可省略），
+    // 不带参数时返回当前设置和最近一次过渡的统计
+    server.on("/transition", HTTP_GET, [](AsyncWebServerRequest *request) {
+        int type = -1, ms = -1;
+        if (request->hasParam("type")) {
+            ImageTransitionType t;
+            if (!ImageTransition_Parse(request->getParam("type")->value().c_str(), &t)) {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"无效的过渡效果\"}");
+                return;
+            }
+            type = t;
+        }
+        if (request->hasParam("ms")) {
+            ms = constrain(request->getParam("ms")->value().toInt(), 0, IMG_TRANSITION_MS_MAX);
+        }
+        
+        if (type >= 0 || ms >= 0) {
+            transitionMsRequest = ms;
+            transitionRequest = type >= 0 ? type : getImageTransitionType();
+            request->send(200, "application/json", "{\"success\":true}");
+            return;
+        }
+        
+        String json = "{\"success\":true";
+        json += ",\"type\":\"" + String(ImageTransition_Name(getImageTransitionType())) + "\"";
+        json += ",\"ms\":" + String(getImageTransitionMs());
+        json += ",\"fps\":" + String(IMG_TRANSITION_FPS);
+        ImageTransitionStats s;
+        if (getImageTransitionStats(&s)) {
+            json += ",\"last\":{\"type\":\"" + String(ImageTransition_Name(s.type)) + "\"";
+            json += ",\"planned_steps\":" + String(s.plannedSteps);
+            json += ",\"shown_steps\":" + String(s.shownSteps);
+            json += ",\"skipped_steps\":" + String(s.skippedSteps);
+            json += ",\"est_step_us\":" + String(s.estStepUs);
+            json += ",\"elapsed_us\":" + String(s.elapsedUs);
+            json += ",\"bytes\":" + String(s.bytes);
+            json += ",\"diff\":[" + String(s.diffX) + "," + String(s.diffY) + "," +
+                    String(s.diffW) + "," + String(s.diffH) + "]}";
+        }
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // PNG / QOI 基准测试：file 为同一张图片的文件名（a.png 与 a.qoi 都须已上传，可带或不带扩展名），
+    // 带 file 参数时排队执行，不带参数时返回最近一次结果
+    server.on("/qoibench", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("file")) {
+            String filepath = String(UPLOAD_DIR) + "/" + request->getParam("file")->value();
+            int n = request->hasParam("n") ? request->getParam("n")->value().toInt() : 3;
+            qoiBenchIterations = (uint8_t)constrain(n, 1, 20);
+            strncpy(qoiBenchFile, filepath.c_str(), sizeof(qoiBenchFile) - 1);
+            request->send(200, "application/json", "{\"success\":true,\"queued\":true}");
+            return;
+        }
+        
+        QoiBenchResult r;
+        if (!getLastQoiBenchmark(&r)) {
+            request->send(404, "application/json", "{\"success\":false,\"message\":\"尚无测试结果\"}");
+            return;
+        }
+        
+        String json = "{\"success\":true,";
+        json += "\"width\":" + String(r.width) + ",";
+        json += "\"height\":" + String(r.height) + ",";
+        json += "\"iterations\":" + String(r.iterations) + ",";
+        json += "\"png_bytes\":" + String(r.pngBytes) + ",";
+        json += "\"qoi_bytes\":" + String(r.qoiBytes) + ",";
+        json += "\"png_read_us\":" + String(r.pngReadUs) + ",";
+        json += "\"qoi_read_us\":" + String(r.qoiReadUs) + ",";
+        json += "\"png_decode_us\":" + String(r.pngUs) + ",";
+        json += "\"qoi_decode_us\":" + String(r.qoiUs);
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // BMP 像素转换基准测试：带 run 参数时排队执行，不带参数时返回最近一次结果（Mpixel/s）
+    server.on("/pixelbench", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("run")) {
+            pixelBenchRequest = true;
+            request->send(200, "application/json", "{\"success\":true,\"queued\":true}");
+            return;
+        }
+        
+        PixelBenchResult r;
+        if (!getLastPixelBenchmark(&r)) {
+            request->send(404, "application/json", "{\"success\":false,\"message\":\"尚无测试结果\"}");
+            return;
+        }
+        
+        String json = "{\"success\":true,";
+        json += "\"pixels\":" + String(r.pixels) + ",";
+        json += "\"match\":" + String(r.ok ? "true" : "false") + ",";
+        json += "\"bgr888\":" + String(r.bgr888, 2) + ",";
+        json += "\"bgr888_scalar\":" + String(r.bgr888Scalar, 2) + ",";
+        json += "\"bgra8888\":" + String(r.bgra8888, 2) + ",";
+        json += "\"rgb555\":" + String(r.rgb555, 2) + ",";
+        json += "\"rgb565\":" + String(r.rgb565, 2) + ",";
+        json += "\"pal8\":" + String(r.pal8, 2);
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // 写屏带宽测试：带 run 参数时排队执行（n 为每项的帧数），不带参数时返回最近一次结果（MB/s）
+    server.on("/lcdbench", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("run")) {
+            int n = request->hasParam("n") ? request->getParam("n")->value().toInt() : 5;
+            lcdBenchIterations = (uint8_t)constrain(n, 1, 50);
+            lcdBenchRequest = true;
+            request->send(200, "application/json", "{\"success\":true,\"queued\":true}");
+            return;
+        }
+        
+        LCD_BenchResult r;
+        if (!LCD_GetLastBenchmark(&r)) {
+            request->send(404, "application/json", "{\"success\":false,\"message\":\"尚无测试结果\"}");
+            return;
+        }
+        
+        String json = "{\"success\":true,";
+        json += "\"backend\":\"" + String(r.backend == LCD_BACKEND_DMA ? "dma" : "arduino") + "\",";
+        json += "\"iterations\":" + String(r.iterations) + ",";
+        json += "\"frame_bytes\":" + String(r.frameBytes) + ",";
+        json += "\"internal_mbps\":" + String(r.internalMBps, 2) + ",";
+        json += "\"psram_mbps\":" + String(r.psramMBps, 2) + ",";
+        json += "\"theoretical_mbps\":" + String(r.theoreticalMBps, 2) + ",";
+        json += "\"frame_ms\":" + String(r.psramUs / 1000.0f / r.iterations, 2) + ",";
+        json += "\"window_us\":" + String(r.windowUs, 1);
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // 动画拦截自检：带 file 参数时排队执行（会显示该文件），不带参数时返回最近一次结果。
+    // 用改了扩展名的多帧 GIF 检查预解码和帧缓存不会把它变成静止图片
+    server.on("/animcheck", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("file")) {
+            String filepath = String(UPLOAD_DIR) + "/" + request->getParam("file")->value();
+            strncpy(animCheckFile, filepath.c_str(), sizeof(animCheckFile) - 1);
+            request->send(200, "application/json", "{\"success\":true,\"queued\":true}");
+            return;
+        }
+        
+        AnimationGateResult r;
+        if (!getLastAnimationGate(&r)) {
+            request->send(404, "application/json", "{\"success\":false,\"message\":\"尚无测试结果\"}");
+            return;
+        }
+        
+        String json = "{\"success\":true,";
+        json += "\"content_animated\":" + String(r.contentAnimated ? "true" : "false") + ",";
+        json += "\"prefetch_rejected\":" + String(r.prefetchRejected ? "true" : "false") + ",";
+        json += "\"first_animating\":" + String(r.firstAnimating ? "true" : "false") + ",";
+        json += "\"second_animating\":" + String(r.secondAnimating ? "true" : "false") + ",";
+        json += "\"cached\":" + String(r.cached ? "true" : "false") + ",";
+        json += "\"passed\":" + String(r.passed ? "true" : "false");
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // LVGL 刷新测试：带 run 参数时排队执行（在仪表盘界面上，ms 为每种模式的时长），
+    // 不带参数时返回最近一次整屏重绘与局部刷新的对比，以及 music 页上同步 / 异步 flush 的帧率
+    server.on("/lvglbench", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("run")) {
+            int ms = request->hasParam("ms") ? request->getParam("ms")->value().toInt() : 5000;
+            lvglBenchMs = (uint32_t)constrain(ms, 1000, 30000);
+            lvglBenchRequest = true;
+            request->send(200, "application/json", "{\"success\":true,\"queued\":true}");
+            return;
+        }
+        
+        LvglBenchResult r;
+        if (!Lvgl_GetLastBenchmark(&r)) {
+            request->send(404, "application/json", "{\"success\":false,\"message\":\"尚无测试结果\"}");
+            return;
+        }
+        
+        const LvglBenchMode* modes[2] = { &r.full, &r.partial };
+        const char* names[2] = { "full", "partial" };
+        String json = "{\"success\":true,\"duration_ms\":" + String(r.durationMs);
+        for (int i = 0; i < 2; i++) {
+            json += ",\"" + String(names[i]) + "\":{";
+            json += "\"refreshes\":" + String(modes[i]->refreshes) + ",";
+            json += "\"pixels\":" + String(modes[i]->pixels) + ",";
+            json += "\"spi_bytes\":" + String(modes[i]->spiBytes) + ",";
+            json += "\"bytes_per_sec\":" + String(modes[i]->bytesPerSec, 0) + ",";
+            json += "\"cpu_percent\":" + String(modes[i]->cpuPercent, 1) + "}";
+        }
+        LvglFpsResult fps;
+        if (Lvgl_GetLastFps(&fps)) {
+            json += ",\"fps\":{\"buffers\":" + String(fps.buffers);
+            json += ",\"buf_lines\":" + String(fps.bufLines);
+            json += ",\"sync\":" + String(fps.syncFps, 1);
+            json += ",\"async\":" + String(fps.asyncFps, 1) + "}";
+        }
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // 垂直同步写屏：/vsync?enable=0|1 开关（loop 中执行），不带参数时返回估计的刷新率与排期统计
+    server.on("/vsync", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("enable")) {
+            vsyncRequest = request->getParam("enable")->value().toInt() != 0 ? 1 : 0;
+            request->send(200, "application/json", "{\"success\":true}");
+            return;
+        }
+        
+        LCD_VsyncStats v;
+        LCD_GetVsyncStats(&v);
+        String json = "{\"success\":true";
+        json += ",\"enabled\":" + String(v.enabled ? "true" : "false");
+        json += ",\"te\":" + String(v.hasTe ? "true" : "false");
+        json += ",\"locked\":" + String(v.locked ? "true" : "false");
+        json += ",\"refresh_hz\":" + String(v.refreshCentiHz / 100.0f, 2);
+        json += ",\"period_us\":" + String(v.periodUs);
+        json += ",\"te_edges\":" + String(v.teEdges);
+        json += ",\"missed_te\":" + String(v.missedTe);
+        json += ",\"presents\":" + String(v.presents);
+        json += ",\"slipped\":" + String(v.slipped);
+        json += ",\"unavoidable\":" + String(v.unavoidable);
+        json += ",\"avg_wait_us\":" + String(v.avgWaitUs);
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // 解码后端列表与各自的解码耗时（毫秒）
+    server.on("/decoders", HTTP_GET, [](AsyncWebServerRequest *request) {
+        String json = "{\"success\":true,\"decoders\":[";
+        for (int i = 0; i < ImageRegistry_Count(); i++) {
+            const ImageBackend* b = ImageRegistry_Get(i);
+            ImageBackendStats st;
+            ImageRegistry_GetStats(i, &st);
+            uint32_t succeeded = st.decodes - st.failures;
+            
+            if (i > 0) json += ",";
+            json += "{\"name\":\"" + String(b->name) + "\",\"extensions\":[";
+            for (const char* const* e = b->extensions; e != nullptr && *e != nullptr; e++) {
+                if (e != b->extensions) json += ",";
+                json += "\"" + String(*e) + "\"";
+            }
+            json += "],\"decodes\":" + String(st.decodes);
+            json += ",\"failures\":" + String(st.failures);
+            json += ",\"last_ms\":" + String(st.lastUs / 1000.0f, 1);
+            json += ",\"avg_ms\":" + String(succeeded > 0 ? st.totalUs / 1000.0f / succeeded : 0.0f, 1);
+            json += ",\"max_ms\":" + String(st.maxUs / 1000.0f, 1) + "}";
+        }
+        json += "]}";
+        request->send(200, "application/json", json);
+    });
+    
+    // 图片加载耗时：最近 IMAGE_METRICS_SAMPLES 次加载各阶段的 p50 / p95 / 最大值（微秒、字节），
+    // 以及最近 recent 条（默认 8）样本的明细
+    server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+        static const struct {
+            const char* name;
+            size_t offset;
+        } fields[] = {
+            { "total_us", offsetof(ImageMetricsSample, totalUs) },
+            { "open_us", offsetof(ImageMetricsSample, openUs) },
+            { "read_bytes", offsetof(ImageMetricsSample, readBytes) },
+            { "read_us", offsetof(ImageMetricsSample, readUs) },
+            { "read_wait_us", offsetof(ImageMetricsSample, readWaitUs) },
+            { "decode_us", offsetof(ImageMetricsSample, decodeUs) },
+            { "filter_us", offsetof(ImageMetricsSample, filterUs) },
+            { "spi_bytes", offsetof(ImageMetricsSample, spiBytes) },
+            { "spi_us", offsetof(ImageMetricsSample, spiUs) },
+            { "spi_wait_us", offsetof(ImageMetricsSample, spiWaitUs) },
+            { "spi_saved_bytes", offsetof(ImageMetricsSample, spiSavedBytes) },
+            { "spi_windows", offsetof(ImageMetricsSample, spiWindows) },
+            { "spi_windows_elided", offsetof(ImageMetricsSample, spiWindowsElided) },
+            { "heap_peak", offsetof(ImageMetricsSample, heapPeak) },
+            { "psram_peak", offsetof(ImageMetricsSample, psramPeak) },
+        };
+        const int fieldCount = sizeof(fields) / sizeof(fields[0]);
+        
+        // 样本数组约 3 KB，不放在 Web 任务的栈上
+        size_t bytes = sizeof(ImageMetricsSample) * IMAGE_METRICS_SAMPLES;
+        ImageMetricsSample* samples = (ImageMetricsSample*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+        if (samples == nullptr) {
+            samples = (ImageMetricsSample*)malloc(bytes);
+        }
+        if (samples == nullptr) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"内存不足\"}");
+            return;
+        }
+        int count = ImageMetrics_Snapshot(samples, IMAGE_METRICS_SAMPLES);
+        int recent = request->hasParam("recent") ? request->getParam("recent")->value().toInt() : 8;
+        recent = constrain(recent, 0, count);
+        
+        String json = "{\"success\":true,\"samples\":" + String(count);
+        json += ",\"capacity\":" + String(IMAGE_METRICS_SAMPLES) + ",\"summary\":{";
+        for (int f = 0; f < fieldCount; f++) {
+            ImageMetricsPercentiles p = { 0, 0, 0 };
+            ImageMetrics_Percentiles(samples, count, fields[f].offset, &p);
+            if (f > 0) json += ",";
+            json += "\"" + String(fields[f].name) + "\":{\"p50\":" + String(p.p50);
+            json += ",\"p95\":" + String(p.p95) + ",\"max\":" + String(p.max) + "}";
+        }
+        json += "},\"recent\":[";
+        uint32_t now = millis();
+        for (int i = 0; i < recent; i++) {
+            const ImageMetricsSample* s = &samples[i];
+            if (i > 0) json += ",";
+            json += "{\"file\":\"" + String(s->name) + "\"";
+            json += ",\"format\":\"" + String(s->format ? s->format : "") + "\"";
+            json += ",\"source\":\"" + String(ImageMetrics_SourceName(s->source)) + "\"";
+            json += ",\"ok\":" + String(s->ok ? "true" : "false");
+            json += ",\"age_ms\":" + String(now - s->timestampMs);
+            for (int f = 0; f < fieldCount; f++) {
+                uint32_t v = *(const uint32_t*)((const uint8_t*)s + fields[f].offset);
+                json += ",\"" + String(fields[f].name) + "\":" + String(v);
+            }
+            json += "}";
+        }
+        json += "]}";
+        free(samples);
+        request->send(200, "application/json", json);
+    });
+    
+    // 日志级别：?level=none/error/warn/info/debug 修改，不带参数只查询
+    server.on("/loglevel", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("level")) {
+            uint8_t level;
+            if (!Log_ParseLevel(request->getParam("level")->value().c_str(), &level)) {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"无效的级别\"}");
+                return;
+            }
+            Log_SetLevel(level);
+            LOG_I("✓ 日志级别: %s\n", Log_LevelName(level));
+        }
+        LogStats s;
+        Log_GetStats(&s);
+        String json = "{\"success\":true";
+        json += ",\"level\":\"" + String(Log_LevelName(Log_GetLevel())) + "\"";
+        json += ",\"compiled\":\"" + String(Log_LevelName(LOG_LEVEL_COMPILE)) + "\"";
+        json += ",\"written\":" + String(s.written);
+        json += ",\"dropped\":" + String(s.dropped);
+        json += ",\"truncated\":" + String(s.truncated);
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // GIF 播放统计（正在播放或最近一次播放）
+    server.on("/animation", HTTP_GET, [](AsyncWebServerRequest *request) {
+        GifPlaybackStats s;
+        if (!getGifPlaybackStats(&s)) {
+            request->send(200, "application/json", "{\"success\":false,\"message\":\"还没有播放过 GIF\"}");
+            return;
+        }
+        String json = "{\"success\":true";
+        json += ",\"playing\":" + String(s.playing ? "true" : "false");
+        json += ",\"width\":" + String(s.width);
+        json += ",\"height\":" + String(s.height);
+        json += ",\"frames\":" + String(s.frameCount);
+        json += ",\"loops\":" + String(s.loopCount);
+        json += ",\"shown\":" + String(s.framesShown);
+        json += ",\"late\":" + String(s.lateFrames);
+        json += ",\"fps\":" + String(s.elapsedMs > 0 ? s.framesShown * 1000.0f / s.elapsedMs : 0.0f, 1);
+        json += ",\"avg_frame_ms\":" + String(s.avgFrameUs / 1000.0f, 2);
+        json += ",\"max_frame_ms\":" + String(s.maxFrameUs / 1000.0f, 2);
+        json += ",\"avg_dirty_pixels\":" + String(s.avgDirtyPixels);
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // JPEG 读取方式：/jpegload?mode=stream|whole；不带 mode 时返回当前设置和最近一次的耗时
+    server.on("/jpegload", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("mode")) {
+            String name = request->getParam("mode")->value();
+            if (name == "stream") {
+                setJpegLoadMode(JPEG_LOAD_STREAM);
+            } else if (name == "whole") {
+                setJpegLoadMode(JPEG_LOAD_WHOLE);
+            } else {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"无效的读取方式\"}");
+                return;
+            }
+        }
+        
+        String json = "{\"success\":true,\"mode\":\"";
+        json += (getJpegLoadMode() == JPEG_LOAD_STREAM) ? "stream" : "whole";
+        json += "\"";
+        JpegLoadTiming t;
+        if (getLastJpegLoadTiming(&t)) {
+            json += ",\"last\":{\"mode\":\"";
+            json += (t.mode == JPEG_LOAD_STREAM) ? "stream" : "whole";
+            json += "\",\"bytes\":" + String(t.fileBytes);
+            json += ",\"first_pixel_us\":" + String(t.firstPixelUs);
+            json += ",\"total_us\":" + String(t.totalUs);
+            json += ",\"stalls\":" + String(t.stalls) + "}";
+        }
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
     // 删除图片
     server.on("/delete", HTTP_GET, [](AsyncWebServerRequest *request) {
         if (request->hasParam("file")) {
@@ -1175,6 +1837,7 @@ void WebServer_Init() {
             if (playlist.size() == 0) {
                 // 空数组，恢复全局轮播
                 useCustomPlaylist = false;
+                playlistChanged = true;
                 Serial.println("✓ 已恢复全局轮播模式");
                 request->send(200, "application/json", "{\"success\":true,\"message\":\"已恢复全局轮播\"}");
                 return;
@@ -1189,6 +1852,7 @@ void WebServer_Init() {
             
             // 启用自定义播放列表
             useCustomPlaylist = true;
+            playlistChanged = true;
             
             Serial.printf("✓ 播放列表已设置 (%d 张图片)\n", customPlaylist.size());
             
@@ -1317,38 +1981,27 @@ bool isClientConnected() {
 
 // 列出图片文件
 bool listImageFiles(const char* directory, String& jsonList) {
-    Serial.printf("\n--- 开始列出图片文件 ---\n");
-    Serial.printf("目录路径: %s\n", directory);
-    
     if (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
-        Serial.println("✗ 无法获取 SD 卡锁");
+        LOG_E("✗ 列出图片: 无法获取 SD 卡锁\n");
         return false;
     }
     
     File dir = SD_MMC.open(directory);
-    if (!dir) {
-        Serial.println("✗ 无法打开目录");
-        xSemaphoreGive(sdCardMutex);
-        return false;
-    }
-    
-    if (!dir.isDirectory()) {
-        Serial.println("✗ 路径不是目录");
-        dir.close();
+    if (!dir || !dir.isDirectory()) {
+        LOG_E("✗ 列出图片: 无法打开目录 %s\n", directory);
+        if (dir) {
+            dir.close();
+        }
         xSemaphoreGive(sdCardMutex);
         return false;
     }
     
-    Serial.println("✓ 目录打开成功，开始遍历文件...");
-    
     jsonList = "{\"files\":[";
     bool first = true;
     int fileCount = 0;
     
     File file = dir.openNextFile();
     while (file) {
-        Serial.printf("  发现文件: %s (目录: %s)\n", file.name(), file.isDirectory() ? "是" : "否");
-        
         if (!file.isDirectory()) {
             String filename = String(file.name());
             
@@ -1359,19 +2012,14 @@ bool listImageFiles(const char* directory, String& jsonList) {
                 filename = filename.substring(lastSlash + 1);
             }
             
-            Serial.printf("    处理后的文件名: %s\n", filename.c_str());
-            
             // 过滤图片文件
-            if (filename.endsWith(".jpg") || filename.endsWith(".jpeg") || 
-                filename.endsWith(".png") || filename.endsWith(".bmp") ||
-                filename.endsWith(".JPG") || filename.endsWith(".JPEG") ||
-                filename.endsWith(".PNG") || filename.endsWith(".BMP")) {
+            if (isImageFileName(filename.c_str())) {
                 
                 if (!first) jsonList += ",";
                 jsonList += "\"" + filename + "\"";
                 first = false;
                 fileCount++;
-                Serial.printf("    ✓ 添加到列表: %s\n", filename.c_str());
+                LOG_D("  图片: %s\n", filename.c_str());
             }
         }
         file = dir.openNextFile();
@@ -1381,10 +2029,7 @@ bool listImageFiles(const char* directory, String& jsonList) {
     dir.close();
     xSemaphoreGive(sdCardMutex);
     
-    Serial.printf("✓ 列表生成完成，共 %d 个图片文件\n", fileCount);
-    Serial.printf("JSON: %s\n", jsonList.c_str());
-    Serial.println("--- 列出图片文件完成 ---\n");
-    
+    LOG_D("✓ %s 中共 %d 个图片文件\n", directory, fileCount);
     return true;
 }
 
@@ -1401,9 +2046,16 @@ bool deleteImageFile(const char* filename) {
     
     String filepath = String(UPLOAD_DIR) + "/" + filename;
     bool result = SD_MMC.remove(filepath.c_str());
+    if (result) {
+        removeR565Cache(filepath.c_str());
+    }
     
     xSemaphoreGive(sdCardMutex);
     
+    if (result) {
+        FrameCache_Invalidate(filepath.c_str());
+    }
+    
     if (result) {
         Serial.printf("✓ 文件已删除: %s\n", filename);
     } else {
@@ -22,10 +22,28 @@ extern AsyncWebServer server;
 extern Preferences preferences;         // NVS 存储
 extern SemaphoreHandle_t sdCardMutex;  // SD 卡访问互斥锁
 extern char currentDisplayFile[100];   // 当前正在显示的文件
+extern char benchmarkFile[100];        // 待执行的 JPEG 基准测试文件（loop 中执行）
+extern uint8_t benchmarkIterations;    // 基准测试每个后端的解码次数
+extern char animCheckFile[100];        // 待执行动画拦截自检的文件（loop 中执行）
+extern char qoiBenchFile[100];         // 待执行的 PNG / QOI 基准测试（不带扩展名的路径，loop 中执行）
+extern uint8_t qoiBenchIterations;     // PNG / QOI 基准测试每种格式的解码次数
+extern char scaleModeFile[100];        // 待设置缩放模式的文件（空表示修改全局默认）
+extern volatile int scaleModeRequest;  // 待设置的缩放模式（-1 表示无请求，loop 中执行）
+extern volatile bool pixelBenchRequest; // 待执行的 BMP 像素转换基准测试（loop 中执行）
+extern volatile bool lcdBenchRequest;  // 待执行的写屏带宽测试（loop 中执行）
+extern uint8_t lcdBenchIterations;     // 写屏带宽测试每项的帧数
+extern volatile bool lvglBenchRequest; // 待执行的 LVGL 刷新测试（loop 中执行）
+extern uint32_t lvglBenchMs;           // LVGL 刷新测试每种模式的时长
+extern volatile int vsyncRequest;      // 待设置的垂直同步写屏开关（0 / 1，-1 表示无请求，loop 中执行）
+extern volatile int rotationRequest;   // 待设置的显示方向（ImageRotationMode，-1 表示无请求，loop 中执行）
+extern volatile int exifRequest;       // 待设置的 EXIF 方向开关（0 / 1，-1 表示无请求，loop 中执行）
+extern volatile int transitionRequest;   // 待设置的切换过渡（ImageTransitionType，-1 表示无请求，loop 中执行）
+extern volatile int transitionMsRequest; // 待设置的过渡时长（毫秒，-1 表示不变）
 
 // 播放列表相关
 extern std::vector<String> customPlaylist;  // 自定义播放列表
 extern bool useCustomPlaylist;              // 是否使用自定义播放列表
+extern volatile bool playlistChanged;       // 播放列表被修改（loop 需丢弃已预取的下一张）
 
 // WiFi 状态
 extern bool isAPMode;                   // 是否处于 AP 模式
@@ -18,8 +18,12 @@
 #include "Simulated_Gesture.h"
 #include "Image_Decoder.h"
 #include "WebServer_Driver.h"
+#include "Image_Transcode.h"
 #include "LED_Driver.h"
 #include "ColorTemp_Filter.h"
+#include "Image_Prefetch.h"
+#include "MJPEG_Player.h"
+#include "Log_Ring.h"
 
 // 后台驱动任务
 void DriverTask(void *parameter) {
@@ -71,6 +75,7 @@ void setup()
 {
   // 初始化基础硬件
   Flash_test();
+  Log_Init();              // 分级日志（串口输出移到后台任务）
   Button_Init();
   PWR_Init();
   BAT_Init();
@@ -105,6 +110,15 @@ void setup()
   // 初始化 Web 服务器
   WebServer_Init();
   
+  // 启动后台预解码（依赖 WebServer_Init 创建的 sdCardMutex）
+  Prefetch_Init();
+  
+  // 启动后台 .r565 转码（同样依赖 sdCardMutex）
+  Transcode_Init();
+  
+  // 启动 MJPEG 片段读取任务（同样依赖 sdCardMutex）
+  MjpegPlayer_Init();
+  
   // 初始化 RGB LED 灯珠
   LED_Init();
   
@@ -124,6 +138,8 @@ void setup()
 static File uploadedDir;           // 上传目录句柄
 static bool dirInitialized = false; // 目录是否已初始化
 static int playlistIndex = 0;       // 播放列表索引
+static String lastShownImage = "";  // 最近一次成功显示的图片（色温变化时重新渲染）
+static String upcomingImage = "";   // 轮播的下一张（已交给后台预解码）
 
 // 获取下一张图片文件
 // 返回值：成功返回完整路径，失败返回空字符串
@@ -175,10 +191,7 @@ String getNextImageFile() {
         }
         
         // 过滤图片格式
-        if (filename.endsWith(".jpg") || filename.endsWith(".jpeg") || 
-            filename.endsWith(".png") || filename.endsWith(".bmp") ||
-            filename.endsWith(".JPG") || filename.endsWith(".JPEG") ||
-            filename.endsWith(".PNG") || filename.endsWith(".BMP")) {
+        if (isImageFileName(filename.c_str())) {
             
             // 拼接完整路径
             String fullPath = String(UPLOAD_DIR) + "/" + filename;
@@ -188,11 +201,34 @@ String getNextImageFile() {
     }
 }
 
+// 推进轮播，返回下一张图片的完整路径（调用方须持有 sdCardMutex）
+String advanceSlideshow() {
+    if (useCustomPlaylist && customPlaylist.size() > 0) {
+        // 播放列表可能被缩短，索引越界时从头开始
+        if (playlistIndex >= (int)customPlaylist.size()) {
+            playlistIndex = 0;
+        }
+        
+        String nextImage = String(UPLOAD_DIR) + "/" + customPlaylist[playlistIndex];
+        
+        Serial.printf("→ 播放列表下一张 [%d/%d]: %s\n", 
+                     playlistIndex + 1, customPlaylist.size(), nextImage.c_str());
+        
+        // 更新索引（循环）
+        playlistIndex = (playlistIndex + 1) % customPlaylist.size();
+        return nextImage;
+    }
+    
+    // 使用全局目录轮播
+    return getNextImageFile();
+}
+
 // 主循环
 void loop()
 {
-    // ⛔ 【核心修改】：彻底注释掉 LVGL 的刷新，防止其抢占 SPI
-    // Lvgl_Loop(); 
+    // ⛔ loop 中不调用 Lvgl_Loop()：屏幕由图片流程直接写（异步条带、整帧写屏），LVGL 的 flush
+    // 不能与未完成的异步刷屏交错提交，重绘也会盖掉图片。LVGL 只在 /lvglbench 测试期间由
+    // Lvgl_Benchmark / Lvgl_MeasureFps 自己驱动 lv_timer_handler，局部刷新与 DMA 完成回调只在那时生效
 
     static unsigned long lastSwitchTime = 0;
     const unsigned long displayInterval = 5000; 
@@ -203,10 +239,10 @@ void loop()
         
         Serial.printf("\n--- 色温已变化: %d，重新渲染当前图片 ---\n", currentColorTemp);
         
-        // 如果有当前显示的图片，重新渲染
-        if (strlen(currentDisplayFile) > 0) {
+        // 如果有当前显示的图片，重新渲染（帧缓存命中时无需重新解码）
+        if (lastShownImage.length() > 0) {
             if (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-                if (loadAndDisplayImage(currentDisplayFile)) {
+                if (loadAndDisplayImage(lastShownImage.c_str())) {
                     Serial.println("✓ 色温调节成功！");
                 } else {
                     Serial.println("✗ 色温调节失败！");
@@ -216,13 +252,172 @@ void loop()
         }
     }
 
+    // 播放列表变化：已预取的下一张作废
+    if (playlistChanged) {
+        playlistChanged = false;
+        playlistIndex = 0;
+        upcomingImage = "";
+        Prefetch_Cancel();
+    }
+
+    // 缩放模式变化：作废按旧模式渲染的帧，重新渲染当前图片
+    if (scaleModeRequest >= 0) {
+        ImageScaleMode mode = (ImageScaleMode)scaleModeRequest;
+        scaleModeRequest = -1;
+        
+        Prefetch_Cancel();
+        Transcode_Yield();
+        if (strlen(scaleModeFile) > 0) {
+            setImageScaleModeFor(scaleModeFile, mode);
+        } else {
+            setImageScaleMode(mode);
+        }
+        
+        bool affectsCurrent = strlen(scaleModeFile) == 0 || lastShownImage == scaleModeFile;
+        scaleModeFile[0] = '\0';
+        if (affectsCurrent && lastShownImage.length() > 0 &&
+            xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            loadAndDisplayImage(lastShownImage.c_str());
+            xSemaphoreGive(sdCardMutex);
+        }
+        
+        if (upcomingImage.length() > 0) {
+            Prefetch_Request(upcomingImage.c_str());
+        }
+    }
+
+    // 显示方向变化（Web 设置，或跟随加速度计时设备转动）：按新方向重新渲染当前图片
+    if (rotationRequest >= 0 || exifRequest >= 0 || serviceImageOrientation()) {
+        int mode = rotationRequest;
+        int exif = exifRequest;
+        rotationRequest = -1;
+        exifRequest = -1;
+        
+        Prefetch_Cancel();
+        Transcode_Yield();
+        if (mode >= 0) {
+            setImageRotationMode((ImageRotationMode)mode);
+        }
+        if (exif >= 0) {
+            setImageExifOrientation(exif != 0);
+        }
+        
+        if (lastShownImage.length() > 0 &&
+            xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            loadAndDisplayImage(lastShownImage.c_str());
+            xSemaphoreGive(sdCardMutex);
+        }
+        
+        if (upcomingImage.length() > 0) {
+            Prefetch_Request(upcomingImage.c_str());
+        }
+    }
+
+    // 切换过渡设置（只影响之后的切换，不重新显示）
+    if (transitionRequest >= 0) {
+        int ms = transitionMsRequest;
+        ImageTransitionType type = (ImageTransitionType)transitionRequest;
+        transitionRequest = -1;
+        transitionMsRequest = -1;
+        setImageTransition(type, ms >= 0 ? ms : getImageTransitionMs());
+    }
+
+    // 垂直同步写屏开关（只影响之后的整帧写屏）
+    if (vsyncRequest >= 0) {
+        LCD_Vsync_Enable(vsyncRequest != 0);
+        vsyncRequest = -1;
+    }
+
+    // Web 请求的 JPEG 基准测试
+    if (strlen(benchmarkFile) > 0) {
+        Prefetch_Cancel();
+        Transcode_Yield();
+        if (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            benchmarkJPEG(benchmarkFile, benchmarkIterations, nullptr);
+            xSemaphoreGive(sdCardMutex);
+        }
+        benchmarkFile[0] = '\0';
+        lastSwitchTime = millis();
+    }
+
+    // Web 请求的动画拦截自检（测试文件留在屏幕上继续播放）
+    if (strlen(animCheckFile) > 0) {
+        Prefetch_Cancel();
+        Transcode_Yield();
+        if (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            checkAnimationGate(animCheckFile, nullptr);
+            lastShownImage = animCheckFile;
+            xSemaphoreGive(sdCardMutex);
+        }
+        animCheckFile[0] = '\0';
+        lastSwitchTime = millis();
+    }
+
+    // Web 请求的 PNG / QOI 基准测试
+    if (strlen(qoiBenchFile) > 0) {
+        Prefetch_Cancel();
+        Transcode_Yield();
+        if (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            benchmarkQOI(qoiBenchFile, qoiBenchIterations, nullptr);
+            xSemaphoreGive(sdCardMutex);
+        }
+        qoiBenchFile[0] = '\0';
+        lastSwitchTime = millis();
+    }
+
+    // Web 请求的 BMP 像素转换基准测试（不访问 SD 卡）
+    if (pixelBenchRequest) {
+        pixelBenchRequest = false;
+        benchmarkPixelConvert(nullptr);
+        lastSwitchTime = millis();
+    }
+
+    // Web 请求的写屏带宽测试（不访问 SD 卡，测试后恢复屏幕内容）
+    if (lcdBenchRequest) {
+        lcdBenchRequest = false;
+        Prefetch_Cancel();
+        benchmarkLcdTransfer(lcdBenchIterations, nullptr);
+        lastSwitchTime = millis();
+    }
+
+    // Web 请求的 LVGL 刷新测试：临时切到仪表盘界面（刷新测试在 Onboard 页，帧率测试在 music 页），
+    // 测完恢复图片界面并重新显示当前图片
+    if (lvglBenchRequest) {
+        lvglBenchRequest = false;
+        Prefetch_Cancel();
+        Transcode_Yield();
+        lv_obj_clean(lv_scr_act());
+        Lvgl_Example1();
+        Lvgl_Benchmark(lvglBenchMs, nullptr);
+        Lvgl_Example1_SelectPage(1);
+        Lvgl_MeasureFps(lvglBenchMs, nullptr);
+        Lvgl_Example1_close();
+        createImageDisplayUI();
+        invalidateShownFrame();
+        
+        if (lastShownImage.length() > 0 &&
+            xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            loadAndDisplayImage(lastShownImage.c_str());
+            xSemaphoreGive(sdCardMutex);
+        }
+        if (upcomingImage.length() > 0) {
+            Prefetch_Request(upcomingImage.c_str());
+        }
+        lastSwitchTime = millis();
+    }
+
     // 检查是否有 Web 请求显示图片
     if (strlen(currentDisplayFile) > 0) {
         Serial.printf("\n--- Web 请求显示: %s ---\n", currentDisplayFile);
         
+        // Web 请求优先：中止后台预解码和转码，尽快让出 SD 卡
+        Prefetch_Cancel();
+        Transcode_Yield();
+        
         // 获取 SD 卡锁
         if (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
             if (loadAndDisplayImage(currentDisplayFile)) {
+                lastShownImage = currentDisplayFile;
                 Serial.println("✓ Web 图片显示成功！");
             } else {
                 Serial.println("✗ Web 图片显示失败！");
@@ -233,49 +428,49 @@ void loop()
         // 清空请求
         currentDisplayFile[0] = '\0';
         lastSwitchTime = millis(); // 重置自动切换计时器
+        
+        // 重新预取轮播的下一张
+        if (upcomingImage.length() > 0) {
+            Prefetch_Request(upcomingImage.c_str());
+        }
     }
     // 自动轮播图片
     else if (millis() - lastSwitchTime > displayInterval) {
         lastSwitchTime = millis();
         
-        // 获取 SD 卡锁
+        // 获取 SD 卡锁（正在转码时让它尽快退出）
+        Transcode_Yield();
         if (xSemaphoreTake(sdCardMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            String nextImage = "";
-            
-            // 判断使用自定义播放列表还是全局轮播
-            if (useCustomPlaylist && customPlaylist.size() > 0) {
-                // 使用自定义播放列表
-                String filename = customPlaylist[playlistIndex];
-                nextImage = String(UPLOAD_DIR) + "/" + filename;
-                
-                Serial.printf("\n--- 播放列表轮播 [%d/%d]: %s ---\n", 
-                             playlistIndex + 1, customPlaylist.size(), nextImage.c_str());
-                
-                // 更新索引（循环）
-                playlistIndex = (playlistIndex + 1) % customPlaylist.size();
-            } else {
-                // 使用全局目录轮播
-                nextImage = getNextImageFile();
-                
-                if (nextImage.length() > 0) {
-                    Serial.printf("\n--- 全局轮播: %s ---\n", nextImage.c_str());
-                }
-            }
+            // 优先使用上一轮确定并已交给后台预解码的下一张
+            String nextImage = upcomingImage.length() > 0 ? upcomingImage : advanceSlideshow();
+            upcomingImage = "";
             
             // 显示图片
             if (nextImage.length() > 0) {
+                Serial.printf("\n--- 轮播: %s ---\n", nextImage.c_str());
                 if (loadAndDisplayImage(nextImage.c_str())) {
+                    lastShownImage = nextImage;
                     Serial.println("✓ 渲染成功！");
                 } else {
                     Serial.println("✗ 渲染失败！");
                 }
+                
+                // 提前确定下一张，停留期间由核心 0 预解码
+                upcomingImage = advanceSlideshow();
             } else {
                 Serial.println("✗ 没有可轮播的图片");
             }
             
             xSemaphoreGive(sdCardMutex);
+            
+            if (upcomingImage.length() > 0) {
+                Prefetch_Request(upcomingImage.c_str());
+            }
         }
     }
 
-    vTaskDelay(pdMS_TO_TICKS(10)); 
+    // GIF 动画 / MJPEG 片段：到时间就写出下一帧（播放期间缩短循环间隔，帧延迟更准）
+    serviceImageAnimation();
+
+    vTaskDelay(pdMS_TO_TICKS(isImageAnimating() ? 2 : 10)); 
 }
\ No newline at end of file
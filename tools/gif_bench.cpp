@@ -0,0 +1,116 @@
+// ============================================================
+// GIF 动画解码基准（x86）
+// 与设备使用同一份 GIF_Codec，逐帧解码若干遍，统计解码帧率、
+// 每帧耗时与变化矩形面积（设备上只上传变化矩形，面积越小写屏越快）。
+//
+// 编译:
+//   g++ -O2 -Isrc -o gif_bench tools/gif_bench.cpp src/GIF_Codec.cpp
+// 用法:
+//   gif_bench [-n 遍数] 文件.gif [文件.gif ...]
+// ============================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "GIF_Codec.h"
+
+static uint8_t* loadFile(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        return nullptr;
+    }
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* data = (uint8_t*)malloc(*size);
+    if (data != nullptr && fread(data, 1, *size, f) != *size) {
+        free(data);
+        data = nullptr;
+    }
+    fclose(f);
+    return data;
+}
+
+static double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool benchFile(const char* path, int loops) {
+    size_t size = 0;
+    uint8_t* data = loadFile(path, &size);
+    if (data == nullptr) {
+        fprintf(stderr, "✗ 无法读取 %s\n", path);
+        return false;
+    }
+
+    GifDecoder dec;
+    GifResult r = GifCodec_Open(&dec, data, size, 0x0000);
+    if (r != GIF_OK) {
+        fprintf(stderr, "✗ %s: %s\n", path, GifCodec_ResultName(r));
+        GifCodec_Close(&dec);
+        free(data);
+        return false;
+    }
+
+    uint32_t frames = 0;
+    uint64_t dirtyPixels = 0;
+    uint64_t playMs = 0;
+    double maxMs = 0;
+    double start = nowMs();
+
+    for (int i = 0; i < loops && r != GIF_ERR_DATA; i++) {
+        GifRect dirty;
+        uint32_t delayMs;
+        while (true) {
+            double t0 = nowMs();
+            r = GifCodec_NextFrame(&dec, &dirty, &delayMs);
+            double t = nowMs() - t0;
+            if (r != GIF_OK) {
+                break;
+            }
+            frames++;
+            dirtyPixels += (uint32_t)dirty.w * dirty.h;
+            playMs += delayMs;
+            if (t > maxMs) {
+                maxMs = t;
+            }
+        }
+        GifCodec_Rewind(&dec);
+    }
+    double totalMs = nowMs() - start;
+
+    if (r != GIF_DONE || frames == 0) {
+        fprintf(stderr, "✗ %s: %s\n", path, GifCodec_ResultName(r));
+    } else {
+        double canvas = (double)dec.width * dec.height;
+        printf("%-24s %4ux%-4u %4u 帧  %8.1f fps  平均 %6.3f ms  最大 %6.3f ms  变化区域 %5.1f%%  标称 %5.1f fps\n",
+               path, dec.width, dec.height, dec.frameCount,
+               frames * 1000.0 / totalMs, totalMs / frames, maxMs,
+               100.0 * dirtyPixels / frames / canvas,
+               playMs ? frames * 1000.0 / playMs : 0.0);
+    }
+
+    GifCodec_Close(&dec);
+    free(data);
+    return r == GIF_DONE;
+}
+
+int main(int argc, char** argv) {
+    int loops = 20;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+        loops = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || loops <= 0) {
+        fprintf(stderr, "用法: %s [-n 遍数] 文件.gif [文件.gif ...]\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = true;
+    for (int i = first; i < argc; i++) {
+        ok &= benchFile(argv[i], loops);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,306 @@
+// ============================================================
+// 内置 JPEG 解码器与 TJpgDec 的逐像素比较（x86）
+// 对每个文件、每种缩放（1/1、1/2、1/4、1/8）分别用 TJpgDec（ChaN tjpgd R0.03）和 JPEG_Codec 解码，
+// JPEG_Codec 再以小块流式输入解码一遍（覆盖输入缓冲区的补充与跨块的标记），三者的 RGB565 输出必须完全一致。
+// 同时报告两者的解码耗时与 JPEG_Codec 各阶段的每 MCU 周期数（x86 为 TSC 周期，设备上的数字见 /benchmark）。
+// TJpgDec 不支持渐进式，渐进式文件只检查 JPEG_Codec 能否解码（内存与流式结果一致）。
+//
+// 编译（参考解码器用 LVGL 自带的 tjpgd R0.03，配置换成 tools/tjpgdcnf_ref.h）:
+//   mkdir -p /tmp/tjpgd && cp lib/lvgl/src/extra/libs/sjpg/tjpgd.[ch] /tmp/tjpgd/
+//   cp tools/tjpgdcnf_ref.h /tmp/tjpgd/tjpgdcnf.h
+//   gcc -c -O2 -DLV_CONF_SKIP -DLV_USE_SJPG=1 -Ilib/lvgl/src/extra/libs/sjpg /tmp/tjpgd/tjpgd.c -o /tmp/tjpgd/tjpgd.o
+//   g++ -O2 -Isrc -I/tmp/tjpgd -Ilib/lvgl/src/extra/libs/sjpg -DLV_CONF_SKIP -DLV_USE_SJPG=1 -o jpeg_compare
+//       tools/jpeg_compare.cpp src/JPEG_Codec.cpp src/JPEG_Kernels.cpp /tmp/tjpgd/tjpgd.o
+// 用法:
+//   jpeg_compare [-s 缩放列表，如 0123] 文件.jpg|目录 [...]
+// 有任何不一致时返回 1
+// ============================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+extern "C" {
+#include "tjpgd.h"
+}
+#include "JPEG_Codec.h"
+
+#define COMPARE_POOL_BYTES      (32 * 1024)     // TJpgDec 工作区
+#define COMPARE_STREAM_CHUNK    97              // 流式输入每次读取的字节数（故意不对齐）
+
+typedef struct {
+    std::vector<uint16_t> pixels;
+    uint16_t w, h;
+    bool overflow;          // 输出块超出帧范围
+} Frame;
+
+static Frame* g_frame;
+
+static void frameReset(Frame* f, uint16_t w, uint16_t h) {
+    f->w = w;
+    f->h = h;
+    f->pixels.assign((size_t)w * h, 0);
+    f->overflow = false;
+}
+
+static double nowUs() {
+    using namespace std::chrono;
+    return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ============================================================
+// TJpgDec
+// ============================================================
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+} MemInput;
+
+static size_t tjpgdInput(JDEC* jd, uint8_t* buf, size_t len) {
+    MemInput* in = (MemInput*)jd->device;
+    if (len > in->size - in->pos) {
+        len = in->size - in->pos;
+    }
+    if (buf != nullptr) {
+        memcpy(buf, in->data + in->pos, len);
+    }
+    in->pos += len;
+    return len;
+}
+
+static int tjpgdOutput(JDEC* jd, void* bitmap, JRECT* rect) {
+    (void)jd;
+    Frame* f = g_frame;
+#if JD_FORMAT == 1
+    const uint16_t* src = (const uint16_t*)bitmap;
+#else
+    const uint8_t* src = (const uint8_t*)bitmap;    // 直接用 LVGL 的配置（RGB888）编译时
+#endif
+    for (int y = rect->top; y <= rect->bottom; y++) {
+        for (int x = rect->left; x <= rect->right; x++) {
+#if JD_FORMAT == 1
+            uint16_t c = *src++;
+#else
+            // 与 TJpgDec 在 JD_FORMAT == 1 时的转换相同
+            uint16_t c = (uint16_t)(((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3));
+            src += 3;
+#endif
+            if (x < f->w && y < f->h) {
+                f->pixels[(size_t)y * f->w + x] = c;
+            } else {
+                f->overflow = true;
+            }
+        }
+    }
+    return 1;
+}
+
+// ============================================================
+// JPEG_Codec
+// ============================================================
+
+static bool codecOutput(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    Frame* f = g_frame;
+    if (x < 0 || y < 0 || x + w > f->w || y + h > f->h) {
+        f->overflow = true;
+        return false;
+    }
+    for (uint16_t row = 0; row < h; row++) {
+        memcpy(&f->pixels[(size_t)(y + row) * f->w + x], pixels + (size_t)row * w, w * 2);
+    }
+    return true;
+}
+
+static size_t streamRead(void* user, uint8_t* buf, size_t len) {
+    MemInput* in = (MemInput*)user;
+    size_t n = len < COMPARE_STREAM_CHUNK ? len : COMPARE_STREAM_CHUNK;
+    if (n > in->size - in->pos) {
+        n = in->size - in->pos;
+    }
+    memcpy(buf, in->data + in->pos, n);
+    in->pos += n;
+    return n;
+}
+
+static long countDiff(const Frame& a, const Frame& b) {
+    long n = 0;
+    for (size_t i = 0; i < a.pixels.size(); i++) {
+        if (a.pixels[i] != b.pixels[i]) {
+            n++;
+        }
+    }
+    return n;
+}
+
+// ============================================================
+// 比较一个文件
+// ============================================================
+
+static uint8_t* loadFile(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        return nullptr;
+    }
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* data = (uint8_t*)malloc(*size);
+    if (data != nullptr && fread(data, 1, *size, f) != *size) {
+        free(data);
+        data = nullptr;
+    }
+    fclose(f);
+    return data;
+}
+
+/**
+ * @return 不一致的组合数
+ */
+static int compareFile(const char* path, const std::vector<uint8_t>& scales) {
+    size_t size = 0;
+    uint8_t* data = loadFile(path, &size);
+    if (data == nullptr) {
+        printf("✗ %s: 无法读取\n", path);
+        return 1;
+    }
+
+    static JpegDecoder dec;
+    static uint8_t pool[COMPARE_POOL_BYTES];
+    int failures = 0;
+    for (uint8_t scale : scales) {
+        Frame ref, mem, stream;
+
+        // JPEG_Codec（整个文件在内存中）
+        JpegResult r = JpegCodec_OpenMemory(&dec, data, size);
+        if (r != JPEG_OK) {
+            printf("- %s: JPEG_Codec 不支持（%s）\n", path, JpegCodec_ResultName(r));
+            break;
+        }
+        bool progressive = dec.progressive;
+        uint16_t w, h;
+        JpegCodec_ScaledSize(&dec, scale, &w, &h);
+        uint16_t srcW = dec.width, srcH = dec.height;
+        frameReset(&mem, w, h);
+        g_frame = &mem;
+        double t0 = nowUs();
+        r = JpegCodec_Decode(&dec, scale, 0, 0, codecOutput);
+        double codecUs = nowUs() - t0;
+        JpegProfile prof = dec.profile;
+        JpegCodec_Close(&dec);
+
+        // JPEG_Codec（流式输入）
+        MemInput sin = { data, size, 0 };
+        JpegResult rs = JpegCodec_OpenStream(&dec, streamRead, &sin);
+        frameReset(&stream, w, h);
+        g_frame = &stream;
+        if (rs == JPEG_OK) {
+            rs = JpegCodec_Decode(&dec, scale, 0, 0, codecOutput);
+        }
+        JpegCodec_Close(&dec);
+
+        // 内存与流式输入的结果码和输出都必须相同
+        bool streamSame = r == rs && (r != JPEG_OK || (!mem.overflow && !stream.overflow && countDiff(mem, stream) == 0));
+        bool refDecoded = false;
+        long refDiff = -1;
+        double refUs = 0;
+        int refErr = -1;
+        if (!progressive) {
+            // TJpgDec
+            MemInput tin = { data, size, 0 };
+            JDEC jd;
+            JRESULT jr = jd_prepare(&jd, tjpgdInput, pool, sizeof(pool), &tin);
+            frameReset(&ref, w, h);
+            g_frame = &ref;
+            if (jr == JDR_OK) {
+                t0 = nowUs();
+                jr = jd_decomp(&jd, tjpgdOutput, scale);
+                refUs = nowUs() - t0;
+            }
+            refDecoded = jr == JDR_OK;
+            refErr = (int)jr;
+            if (refDecoded && r == JPEG_OK) {
+                refDiff = countDiff(ref, mem);
+            }
+        }
+        // TJpgDec 能解码的文件 JPEG_Codec 也必须解码，且逐像素一致；
+        // TJpgDec 不支持的（渐进式、4:4:0、损坏的数据）只比较内存与流式
+        bool ok = streamSame && (!refDecoded || (r == JPEG_OK && !ref.overflow && refDiff == 0));
+
+        if (ok && r != JPEG_OK) {
+            printf("- %s 1/%d: 两者都不解码（JPEG_Codec: %s，TJpgDec: %s）\n", path, 1 << scale,
+                   JpegCodec_ResultName(r), progressive ? "不支持渐进式" : std::to_string(refErr).c_str());
+            continue;
+        }
+        uint32_t mcus = prof.mcus > 0 ? prof.mcus : 1;
+        printf("%s %s %u×%u 1/%d%s: ", ok ? "✓" : "✗", path, srcW, srcH, 1 << scale,
+               progressive ? "（渐进式）" : "");
+        if (refDiff >= 0) {
+            printf("与 TJpgDec 相差 %ld 像素，TJpgDec %.2f ms，", refDiff, refUs / 1000);
+        } else if (!progressive) {
+            printf("TJpgDec 错误 %d，", refErr);
+        }
+        printf("流式%s，JPEG_Codec %.2f ms，每 MCU 周期 熵 %llu IDCT %llu 色彩 %llu\n",
+               streamSame ? "一致" : "不一致", codecUs / 1000, (unsigned long long)(prof.entropy / mcus),
+               (unsigned long long)(prof.idct / mcus), (unsigned long long)(prof.color / mcus));
+        if (!ok) {
+            printf("    JPEG_Codec: 内存 %s，流式 %s\n", JpegCodec_ResultName(r), JpegCodec_ResultName(rs));
+            failures++;
+        }
+    }
+    free(data);
+    return failures;
+}
+
+static bool isJpegName(const char* name) {
+    const char* dot = strrchr(name, '.');
+    return dot != nullptr && (strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0);
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint8_t> scales = { 0, 1, 2, 3 };
+    int argi = 1;
+    if (argi + 1 < argc && strcmp(argv[argi], "-s") == 0) {
+        scales.clear();
+        for (const char* p = argv[argi + 1]; *p; p++) {
+            if (*p >= '0' && *p <= '3') {
+                scales.push_back(*p - '0');
+            }
+        }
+        argi += 2;
+    }
+    if (argi >= argc || scales.empty()) {
+        fprintf(stderr, "用法: %s [-s 0123] 文件.jpg|目录 [...]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> files;
+    for (; argi < argc; argi++) {
+        DIR* d = opendir(argv[argi]);
+        if (d == nullptr) {
+            files.push_back(argv[argi]);
+            continue;
+        }
+        std::vector<std::string> names;
+        while (dirent* e = readdir(d)) {
+            if (isJpegName(e->d_name)) {
+                names.push_back(std::string(argv[argi]) + "/" + e->d_name);
+            }
+        }
+        closedir(d);
+        std::sort(names.begin(), names.end());
+        files.insert(files.end(), names.begin(), names.end());
+    }
+
+    int failures = 0;
+    for (const std::string& f : files) {
+        failures += compareFile(f.c_str(), scales);
+    }
+    printf("%s %zu 个文件，%d 处不一致\n", failures == 0 ? "✓" : "✗", files.size(), failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+// ============================================================
+// MJPEG 片段解码与播放节拍模拟（x86）
+// 与设备使用同一份 MJPEG_Container / JPEG_Codec / MJPEG_Scheduler：
+// 先逐帧解码一遍，统计每帧解码耗时；再用假时钟按 “实测耗时 × 倍数” 模拟播放，
+// 报告能达到的帧率与丢帧数（倍数用来估算设备上的表现，设备比 x86 慢得多）。
+//
+// 编译:
+//   g++ -O2 -Isrc -o mjpeg_bench tools/mjpeg_bench.cpp src/MJPEG_Container.cpp src/MJPEG_Scheduler.cpp
+//       src/JPEG_Codec.cpp src/JPEG_Kernels.cpp
+// 用法:
+//   mjpeg_bench [-x 倍数] [-s 解码缩放 0..3] 文件.avi|.mjpeg [...]
+// ============================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "MJPEG_Container.h"
+#include "MJPEG_Scheduler.h"
+#include "JPEG_Codec.h"
+
+#define BENCH_MAX_FRAME_BYTES   (128 * 1024)    // 与 MJPEG_MAX_FRAME_BYTES 相同
+#define BENCH_MAX_DROP_RUN      3               // 与 MJPEG_MAX_DROP_RUN 相同
+#define BENCH_DEFAULT_FRAME_US  40000           // 裸 MJPEG 按 25 fps
+
+static size_t fileRead(void* user, uint8_t* buf, size_t len) {
+    return fread(buf, 1, len, (FILE*)user);
+}
+
+static bool fileSeek(void* user, uint32_t pos) {
+    return fseek((FILE*)user, pos, SEEK_SET) == 0;
+}
+
+static bool discardOutput(int16_t, int16_t, uint16_t, uint16_t, uint16_t*) {
+    return true;
+}
+
+static double nowUs() {
+    using namespace std::chrono;
+    return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+// 模拟播放：时钟只在 “解码” 和等待时前进；帧用完后返回 END（此时时钟停在下一帧的预定时间）
+typedef struct {
+    uint64_t now;
+    const std::vector<uint32_t>* costUs;
+    uint32_t next;
+} SimClip;
+
+static uint64_t simClock(void* user) {
+    return ((SimClip*)user)->now;
+}
+
+static MjpegSinkResult simPresent(void* user, uint32_t) {
+    SimClip* s = (SimClip*)user;
+    if (s->next >= s->costUs->size()) {
+        return MJPEG_SINK_END;
+    }
+    s->now += (*s->costUs)[s->next++];
+    return MJPEG_SINK_OK;
+}
+
+static MjpegSinkResult simSkip(void* user, uint32_t) {
+    SimClip* s = (SimClip*)user;
+    if (s->next >= s->costUs->size()) {
+        return MJPEG_SINK_END;
+    }
+    s->next++;
+    return MJPEG_SINK_OK;
+}
+
+static bool benchFile(const char* path, double factor, uint8_t scale) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        fprintf(stderr, "✗ 无法读取 %s\n", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    uint32_t size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    static MjpegContainer c;
+    static JpegDecoder dec;
+    static uint8_t buf[BENCH_MAX_FRAME_BYTES];
+    MjpegResult r = MjpegContainer_Open(&c, fileRead, fileSeek, f, size);
+    if (r != MJPEG_OK) {
+        fprintf(stderr, "✗ %s: %s\n", path, MjpegContainer_ResultName(r));
+        fclose(f);
+        return false;
+    }
+
+    std::vector<uint32_t> costUs;
+    uint32_t oversize = 0, bad = 0;
+    uint64_t bytes = 0;
+    uint16_t width = 0, height = 0;
+    while (true) {
+        size_t len = 0;
+        r = MjpegContainer_ReadFrame(&c, buf, sizeof(buf), &len);
+        if (r == MJPEG_ERR_TOO_BIG) {
+            oversize++;
+            continue;
+        }
+        if (r != MJPEG_OK) {
+            break;
+        }
+        if (len == 0) {
+            costUs.push_back(0);        // 重复上一帧
+            continue;
+        }
+        double t0 = nowUs();
+        JpegResult jr = JpegCodec_OpenMemory(&dec, buf, len);
+        if (jr == JPEG_OK) {
+            width = dec.width;
+            height = dec.height;
+            jr = JpegCodec_Decode(&dec, scale, 0, 0, discardOutput);
+        }
+        JpegCodec_Close(&dec);
+        bad += (jr != JPEG_OK);
+        costUs.push_back((uint32_t)((nowUs() - t0) * factor));
+        bytes += len;
+    }
+    fclose(f);
+    if (r != MJPEG_DONE || costUs.empty()) {
+        fprintf(stderr, "✗ %s: %s\n", path, r == MJPEG_DONE ? "没有帧" : MjpegContainer_ResultName(r));
+        return false;
+    }
+
+    uint32_t frameUs = c.frameUs ? c.frameUs : BENCH_DEFAULT_FRAME_US;
+    SimClip clip = { 0, &costUs, 0 };
+    MjpegSink sink = { simPresent, simSkip, &clip };
+    MjpegScheduler s;
+    MjpegScheduler_Init(&s, simClock, &clip, frameUs, BENCH_MAX_DROP_RUN);
+    uint32_t waitUs = 0;
+    while (MjpegScheduler_Step(&s, &sink, &waitUs) != MJPEG_STEP_END) {
+        clip.now += waitUs;
+    }
+
+    uint64_t total = 0;
+    uint32_t maxUs = 0;
+    for (uint32_t us : costUs) {
+        total += us;
+        maxUs = us > maxUs ? us : maxUs;
+    }
+    printf("%-24s %s %ux%u %4zu 帧 %5.1f KB/帧  解码平均 %6.2f ms 最长 %6.2f ms  "
+           "目标 %5.2f fps → 实际 %5.2f fps  丢帧 %u  超大 %u  损坏 %u\n",
+           path, c.type == MJPEG_CONTAINER_AVI ? "AVI " : "MJPG", width, height, costUs.size(),
+           bytes / 1024.0 / costUs.size(), total / 1000.0 / costUs.size(), maxUs / 1000.0,
+           1000000.0 / frameUs, MjpegScheduler_Fps(&s), s.stats.dropped, oversize, bad);
+    return bad == 0;
+}
+
+int main(int argc, char** argv) {
+    double factor = 1.0;
+    int scale = 0;
+    int first = 1;
+    while (first + 1 < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "-x") == 0) {
+            factor = atof(argv[first + 1]);
+        } else if (strcmp(argv[first], "-s") == 0) {
+            scale = atoi(argv[first + 1]);
+        } else {
+            break;
+        }
+        first += 2;
+    }
+    if (first >= argc || factor <= 0 || scale < 0 || scale > 3) {
+        fprintf(stderr, "用法: %s [-x 倍数] [-s 解码缩放 0..3] 文件.avi|.mjpeg [...]\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = true;
+    for (int i = first; i < argc; i++) {
+        ok &= benchFile(argv[i], factor, (uint8_t)scale);
+    }
+    return ok ? 0 : 1;
+}
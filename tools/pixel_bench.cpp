@@ -0,0 +1,41 @@
+// ============================================================
+// BMP 像素转换内核的 x86 微基准测试
+// 编译: g++ -O2 -Isrc tools/pixel_bench.cpp src/Pixel_Convert.cpp -o pixel_bench
+// 运行: ./pixel_bench [宽度] [行数]
+// 目标板上的同一测试由 GET /pixelbench?run=1 触发，结果打印到串口
+// ============================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "Pixel_Convert.h"
+
+static uint32_t hostMicros(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+}
+
+int main(int argc, char** argv) {
+    int width = (argc > 1) ? atoi(argv[1]) : 1920;
+    int rows = (argc > 2) ? atoi(argv[2]) : 1080;
+    if (width <= 0 || rows <= 0) {
+        fprintf(stderr, "用法: %s [宽度] [行数]\n", argv[0]);
+        return 2;
+    }
+
+    PixelBenchResult r;
+    if (!PixelConvert_Benchmark(hostMicros, width, rows, &r)) {
+        fprintf(stderr, "内存不足\n");
+        return 1;
+    }
+
+    printf("%d x %d，每个内核 %u 像素\n", width, rows, r.pixels);
+    printf("BGR888   %8.1f Mpixel/s（逐像素 %.1f，%.2fx）\n", r.bgr888, r.bgr888Scalar,
+           r.bgr888Scalar > 0 ? r.bgr888 / r.bgr888Scalar : 0.0f);
+    printf("BGRA8888 %8.1f Mpixel/s\n", r.bgra8888);
+    printf("RGB555   %8.1f Mpixel/s\n", r.rgb555);
+    printf("RGB565   %8.1f Mpixel/s\n", r.rgb565);
+    printf("Pal8     %8.1f Mpixel/s\n", r.pal8);
+    printf("%s\n", r.ok ? "结果与参考实现一致" : "✗ 结果与参考实现不一致");
+    return r.ok ? 0 : 1;
+}
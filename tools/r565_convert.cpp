@@ -0,0 +1,285 @@
+// ============================================================
+// .r565 转换工具（x86）
+// 与设备使用同一份代码：JPEG_Codec 解码、Pixel_Convert 转换 BMP 行、
+// Image_Scaler 按缩放模式摆放、R565_Format 编码。
+//
+// 编译:
+//   g++ -O2 -Isrc -o r565_convert tools/r565_convert.cpp src/R565_Format.cpp src/JPEG_Codec.cpp
+//       src/JPEG_Kernels.cpp src/Image_Scaler.cpp src/Pixel_Convert.cpp
+// 用法:
+//   r565_convert 输入.jpg|输入.bmp 输出.r565 [fit|fill|center|native] [rle|raw]
+//   fit / fill / center 生成 240×320 的整帧（与设备的缩放模式一致），native 保持原图尺寸；
+//   默认 fit + rle（压缩后不比原始数据小时自动存原始数据）。
+// PNG 依赖 PNGdec 库，只在设备上转码。
+// ============================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "R565_Format.h"
+#include "JPEG_Codec.h"
+#include "Image_Scaler.h"
+#include "Pixel_Convert.h"
+
+#define SCREEN_W 240
+#define SCREEN_H 320
+
+// 解码结果（原图或 JPEG 解码缩放后的尺寸）
+static uint16_t* srcPixels = nullptr;
+static uint16_t srcW = 0, srcH = 0;
+
+// 输出整帧
+static uint16_t* frame = nullptr;
+static uint16_t frameW = 0;
+
+static uint8_t* loadFile(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        return nullptr;
+    }
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* data = (uint8_t*)malloc(*size);
+    if (data != nullptr && fread(data, 1, *size, f) != *size) {
+        free(data);
+        data = nullptr;
+    }
+    fclose(f);
+    return data;
+}
+
+static bool jpegOut(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    for (uint16_t j = 0; j < h; j++) {
+        if (y + j >= srcH) {
+            break;
+        }
+        uint16_t n = (x + w > srcW) ? srcW - x : w;
+        memcpy(srcPixels + (size_t)(y + j) * srcW + x, pixels + (size_t)j * w, n * 2);
+    }
+    return true;
+}
+
+static bool frameOut(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    for (uint16_t j = 0; j < h; j++) {
+        memcpy(frame + (size_t)(y + j) * frameW + x, pixels + (size_t)j * w, w * 2);
+    }
+    return true;
+}
+
+/**
+ * JPEG：按摆放选择解码缩放（native 时为 1/1）
+ */
+static bool decodeJpeg(const uint8_t* data, size_t size, const ImageLayout* layout) {
+    static JpegDecoder dec;
+    JpegResult r = JpegCodec_OpenMemory(&dec, data, size);
+    if (r != JPEG_OK) {
+        fprintf(stderr, "JPEG: %s\n", JpegCodec_ResultName(r));
+        return false;
+    }
+
+    uint8_t scale = 0;
+    if (layout != nullptr) {
+        scale = ImageScaler_PickJpegScale(dec.width, dec.height, layout);
+    }
+    while (dec.progressive && scale < 3 && JpegCodec_ProgressiveBytes(&dec, scale) > JPEG_PROGRESSIVE_MAX_BYTES) {
+        scale++;
+    }
+    JpegCodec_ScaledSize(&dec, scale, &srcW, &srcH);
+    srcPixels = (uint16_t*)calloc((size_t)srcW * srcH, 2);
+    if (srcPixels == nullptr) {
+        return false;
+    }
+    r = JpegCodec_Decode(&dec, scale, 0, 0, jpegOut);
+    JpegCodec_Close(&dec);
+    if (r != JPEG_OK) {
+        fprintf(stderr, "JPEG: %s\n", JpegCodec_ResultName(r));
+        return false;
+    }
+    return true;
+}
+
+static inline uint32_t le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * BMP：与 displayBMP 支持的格式相同（8 位调色板、16/24/32 位未压缩，含自上而下存储）
+ */
+static bool decodeBmp(const uint8_t* data, size_t size) {
+    if (size < 54 || data[0] != 'B' || data[1] != 'M') {
+        fprintf(stderr, "BMP: 文件头无效\n");
+        return false;
+    }
+    uint32_t offset = le32(data + 10);
+    uint32_t infoSize = le32(data + 14);
+    int32_t w = (int32_t)le32(data + 18);
+    int32_t h = (int32_t)le32(data + 22);
+    uint16_t bpp = data[28] | (data[29] << 8);
+    uint32_t compression = le32(data + 30);
+    uint32_t colors = le32(data + 46);
+    bool topDown = h < 0;
+    if (topDown) {
+        h = -h;
+    }
+    if (w <= 0 || h <= 0 || w > 0xFFFF || h > 0xFFFF) {
+        fprintf(stderr, "BMP: 尺寸无效\n");
+        return false;
+    }
+
+    uint32_t masks[3] = { 0, 0, 0 };
+    if (compression == 3 && size >= 66) {
+        for (int i = 0; i < 3; i++) {
+            masks[i] = le32(data + 54 + i * 4);
+        }
+    }
+    bool pal8 = bpp == 8 && compression == 0;
+    bool rgb555 = bpp == 16 && (compression == 0 ||
+                  (compression == 3 && masks[0] == 0x7C00 && masks[1] == 0x03E0 && masks[2] == 0x001F));
+    bool rgb565 = bpp == 16 && compression == 3 && masks[0] == 0xF800 && masks[1] == 0x07E0 && masks[2] == 0x001F;
+    bool bgr = bpp == 24 && compression == 0;
+    bool bgra = bpp == 32 && (compression == 0 ||
+                (compression == 3 && masks[0] == 0xFF0000 && masks[1] == 0xFF00 && masks[2] == 0xFF));
+    if (!(pal8 || rgb555 || rgb565 || bgr || bgra)) {
+        fprintf(stderr, "BMP: 不支持的格式（%d 位，压缩方式 %u）\n", bpp, compression);
+        return false;
+    }
+
+    uint16_t palette[256];
+    if (pal8) {
+        if (colors == 0 || colors > 256) {
+            colors = 256;
+        }
+        if (14 + infoSize + colors * 4 > size) {
+            fprintf(stderr, "BMP: 调色板不完整\n");
+            return false;
+        }
+        PixelConvert_BuildPalette(data + 14 + infoSize, colors, palette);
+    }
+
+    uint32_t rowSize = ((uint32_t)w * bpp + 31) / 32 * 4;
+    if ((uint64_t)offset + (uint64_t)rowSize * h > size) {
+        fprintf(stderr, "BMP: 像素数据不完整\n");
+        return false;
+    }
+
+    // 内核按字读取时要求行首对齐：先把每行拷到对齐的缓冲区
+    srcW = w;
+    srcH = h;
+    srcPixels = (uint16_t*)malloc((size_t)w * h * 2);
+    uint32_t* row = (uint32_t*)malloc(rowSize);
+    if (srcPixels == nullptr || row == nullptr) {
+        free(row);
+        return false;
+    }
+    for (int32_t y = 0; y < h; y++) {
+        int32_t fileRow = topDown ? y : h - 1 - y;
+        memcpy(row, data + offset + (size_t)fileRow * rowSize, rowSize);
+        uint16_t* dst = srcPixels + (size_t)y * w;
+        const uint8_t* src = (const uint8_t*)row;
+        if (pal8) {
+            PixelConvert_Pal8ToRGB565(src, palette, dst, w);
+        } else if (rgb555) {
+            PixelConvert_RGB555ToRGB565(src, dst, w);
+        } else if (rgb565) {
+            PixelConvert_RGB565Copy(src, dst, w);
+        } else if (bgr) {
+            PixelConvert_BGR888ToRGB565(src, dst, w);
+        } else {
+            PixelConvert_BGRA8888ToRGB565(src, dst, w);
+        }
+    }
+    free(row);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "用法: %s 输入.jpg|输入.bmp 输出.r565 [fit|fill|center|native] [rle|raw]\n", argv[0]);
+        return 2;
+    }
+    const char* modeName = (argc > 3) ? argv[3] : "fit";
+    bool native = strcmp(modeName, "native") == 0;
+    ImageScaleMode mode = IMG_SCALE_FIT;
+    if (!native && (!ImageScaler_ParseMode(modeName, &mode) || mode == IMG_SCALE_DEFAULT)) {
+        fprintf(stderr, "无效的缩放模式: %s\n", modeName);
+        return 2;
+    }
+    bool rle = !(argc > 4 && strcmp(argv[4], "raw") == 0);
+
+    size_t size = 0;
+    uint8_t* data = loadFile(argv[1], &size);
+    if (data == nullptr) {
+        fprintf(stderr, "无法读取 %s\n", argv[1]);
+        return 1;
+    }
+
+    // JPEG 需要先知道摆放才能选解码缩放：先读尺寸
+    const char* ext = strrchr(argv[1], '.');
+    bool isJpeg = ext != nullptr && (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0);
+    ImageLayout layout;
+    bool ok;
+    if (isJpeg) {
+        static JpegDecoder probe;
+        if (JpegCodec_OpenMemory(&probe, data, size) != JPEG_OK) {
+            fprintf(stderr, "不是有效的 JPEG\n");
+            return 1;
+        }
+        ImageScaler_Layout(probe.width, probe.height, SCREEN_W, SCREEN_H, mode, &layout);
+        JpegCodec_Close(&probe);
+        ok = decodeJpeg(data, size, native ? nullptr : &layout);
+    } else {
+        ok = decodeBmp(data, size);
+        ImageScaler_Layout(srcW, srcH, SCREEN_W, SCREEN_H, mode, &layout);
+    }
+    free(data);
+    if (!ok) {
+        return 1;
+    }
+
+    R565Header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.compression = rle ? R565_RLE : R565_RAW;
+    uint16_t outW = srcW, outH = srcH;
+    const uint16_t* outPixels = srcPixels;
+
+    if (native) {
+        hdr.scaleMode = R565_NOT_RENDERED;
+    } else {
+        // 与设备相同：按摆放缩放 / 裁剪到整帧，其余区域为黑色
+        frameW = SCREEN_W;
+        frame = (uint16_t*)calloc(SCREEN_W * SCREEN_H, 2);
+        if (ImageScaler_IsPassthrough(&layout, srcW, srcH)) {
+            for (uint16_t y = 0; y < srcH; y++) {
+                memcpy(frame + (layout.offY + y) * SCREEN_W + layout.offX, srcPixels + (size_t)y * srcW, srcW * 2);
+            }
+        } else {
+            ImageScaler sc;
+            if (!ImageScaler_Begin(&sc, &layout, srcW, srcH, frameOut)) {
+                fprintf(stderr, "缩放器内存不足\n");
+                return 1;
+            }
+            ImageScaler_PushRows(&sc, srcPixels, srcH, srcW);
+            ImageScaler_Finish(&sc);
+            ImageScaler_End(&sc);
+        }
+        hdr.scaleMode = (uint8_t)mode;
+        outW = SCREEN_W;
+        outH = SCREEN_H;
+        outPixels = frame;
+    }
+
+    uint8_t* out = (uint8_t*)malloc(R565_MaxFileSize(outW, outH));
+    size_t outSize = R565_Encode(outPixels, outW, outH, outW, &hdr, out);
+    FILE* f = fopen(argv[2], "wb");
+    if (f == nullptr || fwrite(out, 1, outSize, f) != outSize) {
+        fprintf(stderr, "无法写入 %s\n", argv[2]);
+        return 1;
+    }
+    fclose(f);
+
+    printf("%s: %u×%u → %u×%u（%s），%s，%zu 字节\n", argv[1], srcW, srcH, outW, outH,
+           native ? "native" : ImageScaler_ModeName(mode),
+           hdr.compression == R565_RLE ? "RLE" : "未压缩", outSize);
+    return 0;
+}
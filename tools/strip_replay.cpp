@@ -0,0 +1,326 @@
+// ============================================================
+// JPEG 条带流水线回放（x86）
+// 把 TJpgDec 输出回调序列送进与设备相同的 Image_Strip（条带拼接 + 乒乓重叠），
+// 输出端是模拟的异步 SPI：交出的条带只记下指针，等到 waitOne / 收尾时才按提交顺序“传输”进帧缓冲区，
+// 条带缓冲区在传输完成前被改写会直接体现为帧内容错误。
+// 结果与把每个回调块直接写进参考帧缓冲区的结果逐像素比较。
+//
+// 回调序列来源：
+// - 设备上 JPEG_TRACE_RECORD 置 1 后录制的文件（格式见 Image_Decoder.h）
+// - 不带文件时用内置的合成序列：按 TJpgDec 的顺序（MCU 从左到右、从上到下，右 / 下边缘裁剪）
+//   生成多种 MCU 尺寸与摆放，另有 PNG/BMP 式的逐行输出
+//
+// 编译:
+//   g++ -O2 -Isrc -o strip_replay tools/strip_replay.cpp src/Image_Strip.cpp
+// 用法:
+//   strip_replay [-n 条带数] [-l 条带行数] [trace.jtr ...]
+// ============================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+#include "Image_Strip.h"
+
+#define REPLAY_STRIPS           2       // 与 JPEG_PIPELINE_STRIPS 相同
+#define REPLAY_STRIP_LINES      16      // 与 JPEG_STRIP_LINES 相同
+#define REPLAY_LONG_SIDE        320     // 与 LCD_LONG_SIDE 相同
+
+typedef struct {
+    int16_t x, y;
+    uint16_t w, h;
+    std::vector<uint16_t> pixels;
+} TraceBlock;
+
+typedef struct {
+    uint16_t frameW, frameH;
+    uint16_t viewX, viewW;
+    std::vector<TraceBlock> blocks;
+} Trace;
+
+// ============================================================
+// 模拟的异步 SPI
+// ============================================================
+
+typedef struct {
+    uint16_t x, y, w, h;
+    const uint16_t* pixels;
+} Transfer;
+
+typedef struct {
+    std::vector<uint16_t>* frame;
+    uint16_t frameW;
+    std::deque<Transfer> inFlight;
+    uint32_t submits;
+    uint32_t maxInFlight;
+} SimSpi;
+
+static void simBlit(SimSpi* spi, const Transfer& t) {
+    for (uint16_t row = 0; row < t.h; row++) {
+        memcpy(&(*spi->frame)[(size_t)(t.y + row) * spi->frameW + t.x], t.pixels + (size_t)row * t.w, t.w * 2);
+    }
+}
+
+static void simSubmit(void* user, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    SimSpi* spi = (SimSpi*)user;
+    spi->inFlight.push_back({ x, y, w, h, pixels });
+    spi->submits++;
+    if (spi->inFlight.size() > spi->maxInFlight) {
+        spi->maxInFlight = spi->inFlight.size();
+    }
+}
+
+static uint32_t simPending(void* user) {
+    return ((SimSpi*)user)->inFlight.size();
+}
+
+// 最早的一笔此时才读取条带内容
+static void simWaitOne(void* user) {
+    SimSpi* spi = (SimSpi*)user;
+    if (spi->inFlight.empty()) {
+        return;
+    }
+    simBlit(spi, spi->inFlight.front());
+    spi->inFlight.pop_front();
+}
+
+static void simWaitAll(SimSpi* spi) {
+    while (!spi->inFlight.empty()) {
+        simWaitOne(spi);
+    }
+}
+
+// ============================================================
+// 回放
+// ============================================================
+
+static void putBlock(std::vector<uint16_t>& frame, uint16_t frameW, const TraceBlock& b) {
+    for (uint16_t row = 0; row < b.h; row++) {
+        memcpy(&frame[(size_t)(b.y + row) * frameW + b.x], &b.pixels[(size_t)row * b.w], b.w * 2);
+    }
+}
+
+/**
+ * @brief 回放一个序列，返回不一致的像素数（-1 表示序列本身越界）
+ */
+static long replay(const Trace& t, uint8_t strips, uint16_t lines, bool verbose, const char* name) {
+    size_t frameSize = (size_t)t.frameW * t.frameH;
+    std::vector<uint16_t> expect(frameSize, 0);
+    std::vector<uint16_t> frame(frameSize, 0);
+    for (const TraceBlock& b : t.blocks) {
+        if (b.x < 0 || b.y < 0 || b.x + b.w > t.frameW || b.y + b.h > t.frameH) {
+            fprintf(stderr, "%s: 块 (%d,%d,%u,%u) 超出帧范围\n", name, b.x, b.y, b.w, b.h);
+            return -1;
+        }
+        putBlock(expect, t.frameW, b);
+    }
+
+    std::vector<std::vector<uint16_t>> bufStore(strips, std::vector<uint16_t>(REPLAY_LONG_SIDE * lines));
+    uint16_t* bufs[IMAGE_STRIP_MAX_BUFS];
+    for (uint8_t i = 0; i < strips; i++) {
+        bufs[i] = bufStore[i].data();
+    }
+
+    SimSpi spi = { &frame, t.frameW, {}, 0, 0 };
+    ImageStripSink sink = { &spi, simSubmit, simPending, simWaitOne };
+    ImageStrip s;
+    ImageStrip_Begin(&s, bufs, strips, lines, &sink, t.viewX, t.viewW > t.frameW ? t.frameW : t.viewW);
+
+    uint32_t fallbacks = 0;
+    uint32_t busyFills = 0;
+    for (const TraceBlock& b : t.blocks) {
+        if (!ImageStrip_Put(&s, b.x, b.y, b.w, b.h, b.pixels.data())) {
+            // 与 drawBlock 相同：排空流水线后同步写这一块
+            ImageStrip_Flush(&s);
+            simWaitAll(&spi);
+            putBlock(frame, t.frameW, b);
+            fallbacks++;
+            continue;
+        }
+        // 正在填充的条带不能还在传输中
+        for (const Transfer& tr : spi.inFlight) {
+            if (tr.pixels == s.bufs[s.index]) {
+                busyFills++;
+                break;
+            }
+        }
+    }
+    ImageStrip_Flush(&s);
+    simWaitAll(&spi);
+
+    long diff = 0;
+    for (size_t i = 0; i < frameSize; i++) {
+        if (frame[i] != expect[i]) {
+            diff++;
+        }
+    }
+    if (verbose || diff != 0 || busyFills != 0) {
+        printf("%-28s %3u×%-3u %6zu 块 → %4u 条带，最多在途 %u，同步写 %u，填充中的条带在途 %u，不一致 %ld 像素 %s\n",
+               name, t.frameW, t.frameH, t.blocks.size(), spi.submits, spi.maxInFlight, fallbacks, busyFills, diff,
+               diff == 0 && busyFills == 0 ? "✓" : "✗");
+    }
+    return busyFills != 0 && diff == 0 ? 1 : diff;
+}
+
+// ============================================================
+// 序列来源
+// ============================================================
+
+static bool loadTrace(const char* path, Trace* t) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        return false;
+    }
+    char magic[4];
+    uint16_t header[4];
+    bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, "JTR1", 4) == 0 &&
+              fread(header, sizeof(header), 1, f) == 1;
+    if (ok) {
+        t->frameW = header[0];
+        t->frameH = header[1];
+        t->viewX = header[2];
+        t->viewW = header[3];
+        int16_t rec[4];
+        while (fread(rec, sizeof(rec), 1, f) == 1) {
+            TraceBlock b;
+            b.x = rec[0];
+            b.y = rec[1];
+            b.w = (uint16_t)rec[2];
+            b.h = (uint16_t)rec[3];
+            b.pixels.resize((size_t)b.w * b.h);
+            if (fread(b.pixels.data(), 2, b.pixels.size(), f) != b.pixels.size()) {
+                ok = false;
+                break;
+            }
+            t->blocks.push_back(std::move(b));
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+// 每个像素由坐标算出，不同位置的像素几乎都不相同
+static uint16_t patternPixel(int x, int y) {
+    uint32_t v = (uint32_t)x * 2654435761u ^ (uint32_t)y * 40503u;
+    return (uint16_t)(v ^ (v >> 16));
+}
+
+static TraceBlock makeBlock(int x, int y, int w, int h) {
+    TraceBlock b;
+    b.x = x;
+    b.y = y;
+    b.w = w;
+    b.h = h;
+    b.pixels.resize((size_t)w * h);
+    for (int row = 0; row < h; row++) {
+        for (int col = 0; col < w; col++) {
+            b.pixels[(size_t)row * w + col] = patternPixel(x + col, y + row);
+        }
+    }
+    return b;
+}
+
+/**
+ * @brief TJpgDec 顺序的 MCU 回调：图片 imgW × imgH 放在 (offX, offY)，边缘 MCU 按图片尺寸裁剪
+ */
+static Trace makeJpegTrace(uint16_t frameW, uint16_t frameH, int offX, int offY, int imgW, int imgH,
+                           int mcuW, int mcuH) {
+    Trace t;
+    t.frameW = frameW;
+    t.frameH = frameH;
+    t.viewX = offX;
+    t.viewW = imgW;
+    for (int my = 0; my < imgH; my += mcuH) {
+        for (int mx = 0; mx < imgW; mx += mcuW) {
+            int w = imgW - mx < mcuW ? imgW - mx : mcuW;
+            int h = imgH - my < mcuH ? imgH - my : mcuH;
+            t.blocks.push_back(makeBlock(offX + mx, offY + my, w, h));
+        }
+    }
+    return t;
+}
+
+/**
+ * @brief PNG/BMP 式的输出：每次 rows 个整行
+ */
+static Trace makeRowTrace(uint16_t frameW, uint16_t frameH, int offX, int offY, int imgW, int imgH, int rows) {
+    Trace t;
+    t.frameW = frameW;
+    t.frameH = frameH;
+    t.viewX = offX;
+    t.viewW = imgW;
+    for (int y = 0; y < imgH; y += rows) {
+        t.blocks.push_back(makeBlock(offX, offY + y, imgW, imgH - y < rows ? imgH - y : rows));
+    }
+    return t;
+}
+
+int main(int argc, char** argv) {
+    uint8_t strips = REPLAY_STRIPS;
+    uint16_t lines = REPLAY_STRIP_LINES;
+    int argi = 1;
+    while (argi + 1 < argc && argv[argi][0] == '-') {
+        if (strcmp(argv[argi], "-n") == 0) {
+            strips = (uint8_t)atoi(argv[argi + 1]);
+        } else if (strcmp(argv[argi], "-l") == 0) {
+            lines = (uint16_t)atoi(argv[argi + 1]);
+        } else {
+            break;
+        }
+        argi += 2;
+    }
+    if (strips < 1 || strips > IMAGE_STRIP_MAX_BUFS || lines < 1 || lines > 64) {
+        fprintf(stderr, "用法: %s [-n 条带数 1..%d] [-l 条带行数] [trace.jtr ...]\n", argv[0], IMAGE_STRIP_MAX_BUFS);
+        return 2;
+    }
+
+    int failures = 0;
+    if (argi < argc) {
+        for (; argi < argc; argi++) {
+            Trace t;
+            if (!loadTrace(argv[argi], &t)) {
+                fprintf(stderr, "✗ 无法读取 %s\n", argv[argi]);
+                failures++;
+                continue;
+            }
+            failures += replay(t, strips, lines, true, argv[argi]) != 0;
+        }
+        return failures == 0 ? 0 : 1;
+    }
+
+    // 内置序列：4:4:4 / 4:2:2 / 4:2:0 / 4:4:0 的 MCU，整屏、居中、不对齐的尺寸、横屏帧
+    struct { int mcuW, mcuH; } mcus[] = { { 8, 8 }, { 16, 8 }, { 16, 16 }, { 8, 16 } };
+    struct { uint16_t fw, fh; int x, y, w, h; } places[] = {
+        { 240, 320, 0, 0, 240, 320 },
+        { 240, 320, 0, 70, 240, 180 },
+        { 240, 320, 13, 5, 213, 307 },
+        { 320, 240, 40, 0, 240, 240 },
+        { 320, 240, 0, 0, 320, 240 },
+        { 240, 320, 100, 150, 7, 3 },
+    };
+    int runs = 0;
+    for (const auto& p : places) {
+        for (const auto& m : mcus) {
+            char name[64];
+            snprintf(name, sizeof(name), "jpeg mcu %d×%d @%d,%d %d×%d", m.mcuW, m.mcuH, p.x, p.y, p.w, p.h);
+            Trace t = makeJpegTrace(p.fw, p.fh, p.x, p.y, p.w, p.h, m.mcuW, m.mcuH);
+            failures += replay(t, strips, lines, false, name) != 0;
+            runs++;
+        }
+        for (int rows : { 1, 3, 16 }) {
+            char name[64];
+            snprintf(name, sizeof(name), "rows ×%d @%d,%d %d×%d", rows, p.x, p.y, p.w, p.h);
+            Trace t = makeRowTrace(p.fw, p.fh, p.x, p.y, p.w, p.h, rows);
+            failures += replay(t, strips, lines, false, name) != 0;
+            runs++;
+        }
+    }
+    // MCU 高于条带：每块都退回同步写屏
+    Trace tall = makeJpegTrace(240, 320, 0, 0, 240, 320, 16, 32);
+    failures += replay(tall, strips, lines, true, "mcu taller than strip") != 0;
+    runs++;
+
+    printf("%s %d/%d 个序列一致（%u 条带 × %u 行）\n", failures == 0 ? "✓" : "✗", runs - failures, runs, strips,
+           lines);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+/*----------------------------------------------*/
+/* TJpgDec 参考配置（tools/jpeg_compare 使用）    */
+/*----------------------------------------------*/
+// 与设备上 TJpg_Decoder 库的配置一致：RGB565 输出、启用缩放、JD_FASTDECODE 2（int16 中间值，
+// 色彩转换前不截断）。JD_TBLCLIP 设为 0：查表截断在 |v| ≥ 512 时会回绕，
+// JPEG_Codec 有意改为饱和（只有损坏或人为构造的数据会走到），比较时参考解码器也用饱和截断
+#define JD_SZBUF        512
+#define JD_FORMAT       1
+#define JD_USE_SCALE    1
+#define JD_TBLCLIP      0
+#define JD_FASTDECODE   2
@@ -0,0 +1,211 @@
+// ============================================================
+// 垂直同步节拍模拟（x86）
+// 用模拟的 TE 时钟驱动与设备相同的 Vsync_Pacer：面板按真实周期 T 从第 0 行扫描到最后一行，
+// TE 中断记录的边沿时间带有延迟抖动，部分边沿丢失（中断被屏蔽）；写屏按 D 匀速从上到下写入。
+// 每次整帧写屏前与 LCD_Vsync_WaitForWindow 一样先读入最近的边沿（时间 + 累计数）再排期，
+// 然后按真实的扫描线精确判断写入线与扫描线是否相交（撕裂）。
+// 锁定相位（VsyncPacer.locked）之后，耗时不超过两个周期的写屏必须零撕裂；
+// 另外检查周期估计误差，以及周期估计足够准之后丢失边沿的计数：节拍器按估计周期折算两次更新之间
+// 经过的周期数，周期误差 × 周期数超过半个周期时会少算（刚开机从标称周期收敛的过程中、轮播长间隔下），
+// 只比较累计误差在 1/4 周期以内的更新（排期只从最近的边沿外推，不受影响）。
+// 微秒时钟从 2^32 前几秒开始，覆盖 micros() 回绕。
+//
+// 编译:
+//   g++ -O2 -Isrc -o vsync_sim tools/vsync_sim.cpp src/Vsync_Pacer.cpp
+// 用法:
+//   vsync_sim [-n 每个场景的写屏次数] [-s 随机种子]
+// 有撕裂或估计超差时返回 1
+// ============================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Vsync_Pacer.h"
+
+#define SIM_NOMINAL_US      16667   // 与 LCD_TE_NOMINAL_US 相同
+#define SIM_PANEL_ROWS      320     // 与 LCD_HEIGHT 相同：首尾一行以内的相交看不出来，不计为撕裂
+#define SIM_CLOCK_START     (0x100000000LL - 3000000)   // 3 s 后 32 位微秒时钟回绕
+
+typedef struct {
+    const char* name;
+    uint32_t periodUs;          // 面板真实刷新周期
+    uint32_t jitterUs;          // TE 中断记录时间的最大延迟
+    uint32_t dropPermille;      // 丢失边沿的比例（‰）
+    uint32_t transferUs;        // 整帧写屏耗时
+    uint32_t estimatePermille;  // 写屏耗时估计的最大误差（‰）
+    uint32_t idleMaxUs;         // 两次写屏之间的最长空闲（解码、轮播间隔）
+} SimScenario;
+
+static const SimScenario scenarios[] = {
+    { "标称 60 Hz，短写屏",          16667, 30,  0,  5000, 20,   40000 },
+    { "61.7 Hz，写屏接近一个周期",   16200, 50, 30, 15800, 20,   20000 },
+    { "58 Hz，写屏 1~2 个周期",      17241, 50, 30, 25000, 20,   10000 },
+    { "60 Hz，MJPEG 连续写屏",       16667, 80, 50, 15360, 30,       0 },
+    { "62.5 Hz，轮播间隔 2 s",       16000, 30, 20, 15360, 20, 2000000 },
+    { "60 Hz，丢边沿 20%",           16667, 50, 200, 9000, 20,   30000 },
+    { "55 Hz，写屏超过两个周期",     18182, 30, 20, 40000, 20,   20000 },
+};
+
+static uint64_t g_rand = 1;
+
+static uint32_t simRand(uint32_t n) {
+    g_rand = g_rand * 6364136223846793005ULL + 1442695040888963407ULL;
+    return n == 0 ? 0 : (uint32_t)((g_rand >> 33) % n);
+}
+
+// 面板：第 k 个刷新周期从 phase + k·T 开始扫描
+typedef struct {
+    const SimScenario* sc;
+    int64_t phase;
+    int64_t nextEdge;           // 下一个真实 TE 边沿
+    uint32_t nextLatency;       // 该边沿的中断延迟
+    uint32_t isrLastUs;         // TE 中断记录的最近一次边沿（含延迟，32 位微秒时钟）
+    uint32_t isrEdges;          // TE 中断计数（丢失的边沿不计）
+    uint32_t dropped;           // 丢失的边沿数
+    uint32_t droppedSeen;       // 最近一次收到的边沿之前丢失的边沿数（节拍器能推算出来的部分）
+} SimPanel;
+
+// 推进到 now：中断在边沿之后 nextLatency 才执行，执行时记录当时的时间
+static void panelAdvance(SimPanel* s, int64_t now) {
+    while (s->nextEdge + s->nextLatency <= now) {
+        if (simRand(1000) < s->sc->dropPermille) {
+            s->dropped++;
+        } else {
+            s->isrLastUs = (uint32_t)(s->nextEdge + s->nextLatency);
+            s->isrEdges++;
+            s->droppedSeen = s->dropped;
+        }
+        s->nextEdge += s->sc->periodUs;
+        s->nextLatency = simRand(s->sc->jitterUs + 1);
+    }
+}
+
+/**
+ * @brief 在 start 开始、耗时 d 的写屏是否与扫描线相交
+ * @details 写入第 r 行（r 为 0~1 的比例）的时刻为 start + r·d，扫描到达该行的时刻为 phase + k·T + r·T，
+ *          两者相等即 r = (phase + k·T − start) / (d − T)；r 落在首尾一行以内的不计
+ */
+static bool panelTears(const SimPanel* s, int64_t start, uint32_t d) {
+    const double t = s->sc->periodUs;
+    const double slope = (double)d - t;
+    const double margin = 1.0 / SIM_PANEL_ROWS;
+    int64_t k0 = (start - s->phase) / (int64_t)s->sc->periodUs;
+    for (int64_t k = k0 - 1; k <= k0 + 3; k++) {
+        double offset = (double)(s->phase - start) + k * t;
+        if (fabs(slope) < 1e-9) {
+            if (fabs(offset) < 1e-9) {
+                return true;
+            }
+            continue;
+        }
+        double r = offset / slope;
+        if (r > margin && r < 1.0 - margin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef struct {
+    uint32_t presents;
+    uint32_t locked;            // 锁定后排期的写屏数
+    uint32_t tears;             // 锁定后、可以避免的撕裂
+    uint32_t tearsUnlocked;     // 锁定前的撕裂（只报告）
+    uint32_t unavoidable;       // 写屏超过两个周期
+} SimResult;
+
+static bool runScenario(const SimScenario* sc, uint32_t presents) {
+    SimPanel panel;
+    memset(&panel, 0, sizeof(panel));
+    panel.sc = sc;
+    panel.phase = SIM_CLOCK_START + 1234;
+    panel.nextEdge = panel.phase;
+
+    int64_t now = SIM_CLOCK_START;
+    VsyncPacer pacer;
+    VsyncPacer_Init(&pacer, SIM_NOMINAL_US, (uint32_t)now);
+
+    SimResult res = { 0, 0, 0, 0, 0 };
+    uint32_t missedSettled = 0;     // 周期估计足够准时节拍器记下的丢失边沿
+    uint32_t droppedSettled = 0;    // 同一时段实际丢失的边沿
+    uint32_t droppedUpdated = 0;    // 上一次更新时节拍器能推算出的丢失边沿
+    for (uint32_t i = 0; i < presents; i++) {
+        now += simRand(sc->idleMaxUs + 1);
+        panelAdvance(&panel, now);
+
+        // 与 LCD_Vsync_WaitForWindow 相同：读入最近的边沿，按估计的写屏耗时排期
+        uint64_t drift = (uint64_t)abs((int32_t)(pacer.periodUs - sc->periodUs)) * (panel.isrLastUs - pacer.lastTeUs);
+        bool settled = pacer.locked && drift < (uint64_t)sc->periodUs * sc->periodUs / 4;
+        uint32_t missedBefore = pacer.missedTe;
+        VsyncPacer_Update(&pacer, panel.isrLastUs, panel.isrEdges);
+        if (settled) {
+            missedSettled += pacer.missedTe - missedBefore;
+            droppedSettled += panel.droppedSeen - droppedUpdated;
+        }
+        droppedUpdated = panel.droppedSeen;
+        bool locked = pacer.locked;
+        int32_t err = (int32_t)simRand(2 * sc->estimatePermille + 1) - (int32_t)sc->estimatePermille;
+        uint32_t estimate = (uint32_t)((int64_t)sc->transferUs * (1000 + err) / 1000);
+        uint32_t wait = VsyncPacer_Schedule(&pacer, (uint32_t)now, estimate);
+
+        int64_t start = now + wait;
+        bool avoidable = sc->transferUs <= 2 * sc->periodUs;
+        bool tear = panelTears(&panel, start, sc->transferUs);
+        res.presents++;
+        if (!avoidable) {
+            res.unavoidable++;
+        } else if (locked) {
+            res.locked++;
+            res.tears += tear;
+        } else {
+            res.tearsUnlocked += tear;
+        }
+
+        now = start + sc->transferUs;
+        panelAdvance(&panel, now);
+    }
+
+    double periodErr = fabs((double)pacer.periodUs - sc->periodUs) / sc->periodUs;
+    bool ok = res.tears == 0 && periodErr < 0.005 && missedSettled == droppedSettled &&
+              pacer.unavoidable == res.unavoidable;
+
+    printf("%s %s: 周期估计 %u µs（真值 %u），丢失边沿 %u（实际 %u），写屏 %u 次，锁定后 %u 次撕裂 %u",
+           ok ? "✓" : "✗", sc->name, pacer.periodUs, sc->periodUs, missedSettled, droppedSettled,
+           res.presents, res.locked, res.tears);
+    if (res.tearsUnlocked > 0) {
+        printf("（锁定前 %u）", res.tearsUnlocked);
+    }
+    if (res.unavoidable > 0) {
+        printf("，超过两个周期 %u 次（不计）", res.unavoidable);
+    }
+    printf("，顺延 %u，平均等待 %.1f ms\n", pacer.slipped,
+           pacer.presents > 0 ? pacer.waitUs / 1000.0 / pacer.presents : 0.0);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    uint32_t presents = 2000;
+    int argi = 1;
+    while (argi + 1 < argc && argv[argi][0] == '-') {
+        if (strcmp(argv[argi], "-n") == 0) {
+            presents = (uint32_t)atoi(argv[argi + 1]);
+        } else if (strcmp(argv[argi], "-s") == 0) {
+            g_rand = (uint64_t)atoll(argv[argi + 1]);
+        } else {
+            break;
+        }
+        argi += 2;
+    }
+    if (argi != argc || presents < 10) {
+        fprintf(stderr, "用法: %s [-n 写屏次数 ≥10] [-s 随机种子]\n", argv[0]);
+        return 2;
+    }
+
+    int failures = 0;
+    for (const SimScenario& sc : scenarios) {
+        failures += !runScenario(&sc, presents);
+    }
+    printf("%s %d 个场景，%d 个失败\n", failures == 0 ? "✓" : "✗",
+           (int)(sizeof(scenarios) / sizeof(scenarios[0])), failures);
+    return failures == 0 ? 0 : 1;
+}